@@ -0,0 +1,144 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctBench_h__
+#define ctBench_h__
+
+#include "ctString.h"
+#include "ctVector.h"
+#include <chrono>
+
+// Prevent the compiler from optimizing away the computation of 'value'
+template<typename T> inline void ctDoNotOptimize(const T &value);
+
+// Prevent the compiler from reordering or eliding memory writes across this point
+inline void ctClobberMemory();
+
+class ctBenchState
+{
+  friend class ctBench;
+
+public:
+  // Returns true while there are iterations left to run.
+  // The timer starts on the first call, so setup performed before the
+  // loop is not included in the measurement.
+  //
+  //   while (state.Next())
+  //     ctDoNotOptimize(Work());
+  bool Next();
+
+  // Pause/Resume the timer to exclude per-iteration setup from the measurement
+  void PauseTiming();
+  void ResumeTiming();
+
+  // Set the number of bytes/items processed by a single iteration.
+  // Used to report throughput.
+  void SetBytesPerIteration(const int64_t bytes);
+  void SetItemsPerIteration(const int64_t items);
+
+  // The number of iterations this sample will run
+  int64_t Iterations() const;
+
+protected:
+  ctBenchState(const int64_t iterations);
+
+  typedef std::chrono::steady_clock Clock;
+
+  int64_t m_iterations = 0;
+  int64_t m_remaining = 0;
+  int64_t m_elapsed = 0; // nanoseconds
+  int64_t m_bytes = 0;
+  int64_t m_items = 0;
+  bool m_started = false;
+  bool m_paused = false;
+  Clock::time_point m_start;
+};
+
+typedef void(*ctBenchFunc)(ctBenchState &state);
+
+class ctBench
+{
+public:
+  ctBench() = delete;
+
+  struct Options
+  {
+    ctString filter;           // Only run benchmarks whose full name contains this string
+    ctString outputPath;       // Write JSON results to this file
+    ctString baselinePath;     // Compare results against a JSON file written by a previous run
+    int64_t warmupTime = 50;   // Time spent warming up each benchmark (ms)
+    int64_t sampleTime = 20;   // Target duration of a single sample (ms)
+    int64_t sampleCount = 15;  // Number of timed samples to collect per benchmark
+    bool list = false;         // List registered benchmarks instead of running them
+  };
+
+  struct Result
+  {
+    ctString name;
+    int64_t iterations = 0;    // Iterations per sample
+    int64_t samples = 0;
+    double median = 0;         // Median time per iteration (ns)
+    double mad = 0;            // Median absolute deviation of the time per iteration (ns)
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double bytesPerSecond = 0;
+    double itemsPerSecond = 0;
+  };
+
+  // Register a benchmark. Normally invoked through ctBENCHMARK()
+  static bool Register(const char *suite, const char *name, ctBenchFunc func);
+
+  // Run all registered benchmarks matching the options filter.
+  // Returns the results in registration order.
+  static ctVector<Result> Run(const Options &options);
+
+  // Parse command line arguments into 'pOptions'.
+  // Returns false if the arguments are invalid.
+  static bool ParseArgs(int argc, char **argv, Options *pOptions);
+
+  // Serialize results to a JSON string
+  static ctString ToJSON(const ctVector<Result> &results);
+
+  // Load results from a JSON string produced by ToJSON()
+  static ctVector<Result> FromJSON(const ctString &json);
+
+  // Median of 'values'. 'values' is sorted in place.
+  static double Median(ctVector<double> *pValues);
+
+  // Median absolute deviation from 'median'
+  static double MedianAbsDeviation(const ctVector<double> &values, const double median);
+
+protected:
+  static Result Measure(const ctString &name, ctBenchFunc func, const Options &options);
+  static int64_t RunSample(ctBenchFunc func, const int64_t iterations, ctBenchState *pState);
+};
+
+#define ctBENCHMARK(suite, name)                                                                                \
+  static void _ctBench_##suite##_##name(ctBenchState &state);                                                   \
+  static const bool _ctBenchRegistered_##suite##_##name = ctBench::Register(#suite, #name, _ctBench_##suite##_##name); \
+  static void _ctBench_##suite##_##name(ctBenchState &state)
+
+#include "ctBench.inl"
+#endif // ctBench_h__
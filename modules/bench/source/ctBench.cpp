@@ -0,0 +1,309 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctJSON.h"
+#include "ctScan.h"
+#include "file/ctFile.h"
+#include <algorithm>
+#include <math.h>
+
+struct _ctBenchEntry
+{
+  ctString name;
+  ctBenchFunc func = nullptr;
+};
+
+static ctVector<_ctBenchEntry>& _Registry()
+{
+  static ctVector<_ctBenchEntry> registry;
+  return registry;
+}
+
+ctBenchState::ctBenchState(const int64_t iterations)
+  : m_iterations(iterations)
+  , m_remaining(iterations)
+{}
+
+bool ctBenchState::Next()
+{
+  if (!m_started)
+  {
+    m_started = true;
+    m_start = Clock::now();
+  }
+
+  if (m_remaining-- > 0)
+    return true;
+
+  if (!m_paused)
+    m_elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+  return false;
+}
+
+void ctBenchState::PauseTiming()
+{
+  if (m_paused || !m_started)
+    return;
+  m_elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+  m_paused = true;
+}
+
+void ctBenchState::ResumeTiming()
+{
+  if (!m_paused)
+    return;
+  m_paused = false;
+  m_start = Clock::now();
+}
+
+void ctBenchState::SetBytesPerIteration(const int64_t bytes) { m_bytes = bytes; }
+void ctBenchState::SetItemsPerIteration(const int64_t items) { m_items = items; }
+int64_t ctBenchState::Iterations() const { return m_iterations; }
+
+bool ctBench::Register(const char *suite, const char *name, ctBenchFunc func)
+{
+  _ctBenchEntry entry;
+  entry.name = ctString(suite) + "/" + name;
+  entry.func = func;
+  _Registry().push_back(entry);
+  return true;
+}
+
+double ctBench::Median(ctVector<double> *pValues)
+{
+  if (pValues->size() == 0)
+    return 0;
+
+  std::sort(pValues->begin(), pValues->end());
+  int64_t mid = pValues->size() / 2;
+  if (pValues->size() % 2 == 1)
+    return pValues->at(mid);
+  return (pValues->at(mid - 1) + pValues->at(mid)) / 2;
+}
+
+double ctBench::MedianAbsDeviation(const ctVector<double> &values, const double median)
+{
+  ctVector<double> deviations;
+  deviations.reserve(values.size());
+  for (const double &val : values)
+    deviations.push_back(fabs(val - median));
+  return Median(&deviations);
+}
+
+int64_t ctBench::RunSample(ctBenchFunc func, const int64_t iterations, ctBenchState *pState)
+{
+  *pState = ctBenchState(iterations);
+  func(*pState);
+  return pState->m_elapsed;
+}
+
+ctBench::Result ctBench::Measure(const ctString &name, ctBenchFunc func, const Options &options)
+{
+  const int64_t warmupNs = options.warmupTime * 1000000;
+  const int64_t sampleNs = ctMax(options.sampleTime, 1) * 1000000;
+
+  ctBenchState state(0);
+
+  // Calibrate the number of iterations so that a single sample takes roughly 'sampleTime'.
+  // This also warms up caches and branch predictors.
+  int64_t iterations = 1;
+  int64_t spent = 0;
+  while (true)
+  {
+    int64_t elapsed = ctMax(RunSample(func, iterations, &state), 1);
+    spent += elapsed;
+    if (elapsed >= sampleNs || !state.m_started)
+      break; // A benchmark that never calls Next() has nothing to calibrate
+
+    // Grow towards the target, at most 10x per step
+    double scale = ctMin(10.0, (double)sampleNs * 1.2 / elapsed);
+    iterations = ctMax(iterations + 1, (int64_t)(iterations * scale));
+  }
+
+  while (spent < warmupNs)
+  {
+    int64_t elapsed = RunSample(func, iterations, &state);
+    if (elapsed <= 0)
+      break; // No time was recorded, so the warmup would never end
+    spent += elapsed;
+  }
+
+  ctVector<double> perIteration;
+  perIteration.reserve(options.sampleCount);
+  for (int64_t i = 0; i < ctMax(options.sampleCount, 1); ++i)
+    perIteration.push_back((double)RunSample(func, iterations, &state) / iterations);
+
+  Result result;
+  result.name = name;
+  result.iterations = iterations;
+  result.samples = perIteration.size();
+  result.min = perIteration[0];
+  result.max = perIteration[0];
+  for (const double &val : perIteration)
+  {
+    result.mean += val;
+    result.min = ctMin(result.min, val);
+    result.max = ctMax(result.max, val);
+  }
+  result.mean /= perIteration.size();
+  result.median = Median(&perIteration);
+  result.mad = MedianAbsDeviation(perIteration, result.median);
+  if (result.median > 0)
+  {
+    result.bytesPerSecond = state.m_bytes * 1e9 / result.median;
+    result.itemsPerSecond = state.m_items * 1e9 / result.median;
+  }
+  return result;
+}
+
+ctVector<ctBench::Result> ctBench::Run(const Options &options)
+{
+  ctVector<Result> baseline;
+  if (options.baselinePath.length() > 0)
+  {
+    bool loaded = false;
+    baseline = FromJSON(ctFile::ReadText(options.baselinePath, &loaded));
+    if (!loaded)
+      printf("Failed to read baseline '%s'\n", options.baselinePath.c_str());
+  }
+
+  ctVector<Result> results;
+  for (const _ctBenchEntry &entry : _Registry())
+  {
+    if (options.filter.length() > 0 && entry.name.find(options.filter) == -1)
+      continue;
+
+    if (options.list)
+    {
+      printf("%s\n", entry.name.c_str());
+      continue;
+    }
+
+    Result res = Measure(entry.name, entry.func, options);
+    printf("%-40s %14.1f ns  +/- %8.1f ns  (%lld iters x %lld)", res.name.c_str(), res.median, res.mad, (long long)res.iterations, (long long)res.samples);
+    if (res.bytesPerSecond > 0)
+      printf("  %9.1f MB/s", res.bytesPerSecond / (1024 * 1024));
+    if (res.itemsPerSecond > 0)
+      printf("  %9.3f M items/s", res.itemsPerSecond / 1000000);
+
+    for (const Result &base : baseline)
+      if (base.name == res.name && base.median > 0)
+      {
+        printf("  [%+.1f%%]", (res.median - base.median) * 100 / base.median);
+        break;
+      }
+
+    printf("\n");
+    results.push_back(res);
+  }
+
+  if (options.outputPath.length() > 0)
+    ctFile::WriteTextFile(options.outputPath, ToJSON(results));
+
+  return results;
+}
+
+bool ctBench::ParseArgs(int argc, char **argv, Options *pOptions)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    ctString arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--list")
+      pOptions->list = true;
+    else if (arg == "--filter" && hasValue)
+      pOptions->filter = argv[++i];
+    else if (arg == "--json" && hasValue)
+      pOptions->outputPath = argv[++i];
+    else if (arg == "--baseline" && hasValue)
+      pOptions->baselinePath = argv[++i];
+    else if (arg == "--warmup" && hasValue)
+      pOptions->warmupTime = ctScan::Int(argv[++i]);
+    else if (arg == "--sample-time" && hasValue)
+      pOptions->sampleTime = ctScan::Int(argv[++i]);
+    else if (arg == "--samples" && hasValue)
+      pOptions->sampleCount = ctScan::Int(argv[++i]);
+    else
+      return false;
+  }
+  return true;
+}
+
+ctString ctBench::ToJSON(const ctVector<Result> &results)
+{
+  ctJSON benchmarks;
+  benchmarks.MakeArray();
+  for (int64_t i = 0; i < results.size(); ++i)
+  {
+    const Result &res = results[i];
+    ctJSON item;
+    item.MakeObject();
+    item["name"].SetValue(res.name);
+    item["iterations"].SetValue(res.iterations, false);
+    item["samples"].SetValue(res.samples, false);
+    item["median_ns"].SetDecimal(res.median);
+    item["mad_ns"].SetDecimal(res.mad);
+    item["min_ns"].SetDecimal(res.min);
+    item["max_ns"].SetDecimal(res.max);
+    item["mean_ns"].SetDecimal(res.mean);
+    item["bytes_per_second"].SetDecimal(res.bytesPerSecond);
+    item["items_per_second"].SetDecimal(res.itemsPerSecond);
+    benchmarks.SetElement(i, item);
+  }
+
+  ctJSON root;
+  root.MakeObject();
+  root.SetMember("benchmarks", benchmarks);
+  return root.ToString(true);
+}
+
+ctVector<ctBench::Result> ctBench::FromJSON(const ctString &json)
+{
+  ctVector<Result> results;
+  ctJSON root(json);
+  ctJSON *pBenchmarks = root.IsObject() ? root.TryGetMember("benchmarks") : nullptr;
+  if (!pBenchmarks || !pBenchmarks->IsArray())
+    return results;
+
+  for (const ctJSON &item : pBenchmarks->Array())
+  {
+    if (!item.IsObject())
+      continue;
+
+    Result res;
+    res.name = item["name"].Value();
+    res.iterations = item["iterations"].ToInt();
+    res.samples = item["samples"].ToInt();
+    res.median = item["median_ns"].ToDouble();
+    res.mad = item["mad_ns"].ToDouble();
+    res.min = item["min_ns"].ToDouble();
+    res.max = item["max_ns"].ToDouble();
+    res.mean = item["mean_ns"].ToDouble();
+    res.bytesPerSecond = item["bytes_per_second"].ToDouble();
+    res.itemsPerSecond = item["items_per_second"].ToDouble();
+    results.push_back(res);
+  }
+  return results;
+}
@@ -0,0 +1,654 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctHashMap.h"
+#include "ctScan.h"
+#include "ctMetrics.h"
+#include "ctJobSystem.h"
+#include "ctParallel.h"
+#include "ctSort.h"
+#include "ctPtr.h"
+#include "ctObject.h"
+#include "ctMemoryReader.h"
+#include "ctMemoryWriter.h"
+#include "ctChecksumStream.h"
+#include "ctCompressStream.h"
+#include <algorithm>
+
+static const int64_t _elementCount = 10000;
+
+ctBENCHMARK(ctVector, PushBack)
+{
+  while (state.Next())
+  {
+    ctVector<int64_t> vec;
+    for (int64_t i = 0; i < _elementCount; ++i)
+      vec.push_back(i);
+    ctDoNotOptimize(vec.data());
+  }
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctVector, PushBackReserved)
+{
+  while (state.Next())
+  {
+    ctVector<int64_t> vec;
+    vec.reserve(_elementCount);
+    for (int64_t i = 0; i < _elementCount; ++i)
+      vec.push_back(i);
+    ctDoNotOptimize(vec.data());
+  }
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctVector, Copy)
+{
+  ctVector<int64_t> src(_elementCount, 1);
+  while (state.Next())
+  {
+    ctVector<int64_t> copy = src;
+    ctDoNotOptimize(copy.data());
+  }
+  state.SetBytesPerIteration(_elementCount * sizeof(int64_t));
+}
+
+ctBENCHMARK(ctVector, Iterate)
+{
+  ctVector<int64_t> src(_elementCount, 1);
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (const int64_t &val : src)
+      sum += val;
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctVector, InsertFront)
+{
+  while (state.Next())
+  {
+    ctVector<int64_t> vec;
+    for (int64_t i = 0; i < 1000; ++i)
+      vec.push_front(i);
+    ctDoNotOptimize(vec.data());
+  }
+  state.SetItemsPerIteration(1000);
+}
+
+ctBENCHMARK(ctHashMap, AddInt)
+{
+  while (state.Next())
+  {
+    ctHashMap<int64_t, int64_t> map;
+    for (int64_t i = 0; i < _elementCount; ++i)
+      map.Add(i, i);
+    ctDoNotOptimize(map.Size());
+  }
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctHashMap, LookupInt)
+{
+  ctHashMap<int64_t, int64_t> map;
+  for (int64_t i = 0; i < _elementCount; ++i)
+    map.Add(i, i);
+
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < _elementCount; ++i)
+      sum += *map.TryGet(i);
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctHashMap, AddString)
+{
+  ctVector<ctString> keys;
+  for (int64_t i = 0; i < 1000; ++i)
+    keys.push_back("key_" + ctString(i));
+
+  while (state.Next())
+  {
+    ctHashMap<ctString, int64_t> map;
+    for (int64_t i = 0; i < keys.size(); ++i)
+      map.Add(keys[i], i);
+    ctDoNotOptimize(map.Size());
+  }
+  state.SetItemsPerIteration(keys.size());
+}
+
+ctBENCHMARK(ctHashMap, LookupString)
+{
+  ctVector<ctString> keys;
+  ctHashMap<ctString, int64_t> map;
+  for (int64_t i = 0; i < 1000; ++i)
+  {
+    keys.push_back("key_" + ctString(i));
+    map.Add(keys.back(), i);
+  }
+
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (const ctString &key : keys)
+      sum += *map.TryGet(key);
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(keys.size());
+}
+
+ctBENCHMARK(ctString, Append)
+{
+  while (state.Next())
+  {
+    ctString str;
+    for (int64_t i = 0; i < 1000; ++i)
+      str += "abc";
+    ctDoNotOptimize(str.c_str());
+  }
+  state.SetItemsPerIteration(1000);
+}
+
+ctBENCHMARK(ctString, Find)
+{
+  ctString haystack;
+  for (int64_t i = 0; i < 1000; ++i)
+    haystack += "the quick brown fox ";
+  haystack += "jumps over the lazy dog";
+
+  while (state.Next())
+    ctDoNotOptimize(haystack.find("lazy dog"));
+  state.SetBytesPerIteration(haystack.length());
+}
+
+ctBENCHMARK(ctString, Split)
+{
+  ctString csvLine;
+  for (int64_t i = 0; i < 1000; ++i)
+    csvLine += ctString(i) + ",";
+
+  while (state.Next())
+  {
+    ctVector<ctString> parts = csvLine.split(',');
+    ctDoNotOptimize(parts.data());
+  }
+  state.SetBytesPerIteration(csvLine.length());
+}
+
+ctBENCHMARK(ctString, Replace)
+{
+  ctString text;
+  for (int64_t i = 0; i < 1000; ++i)
+    text += "a/b/c/";
+
+  while (state.Next())
+  {
+    ctString replaced = text.replace("/", "\\");
+    ctDoNotOptimize(replaced.c_str());
+  }
+  state.SetBytesPerIteration(text.length());
+}
+
+ctBENCHMARK(ctScan, Int)
+{
+  ctVector<ctString> values;
+  for (int64_t i = 0; i < 1000; ++i)
+    values.push_back(ctString(i * 7919 - 500000));
+
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (const ctString &val : values)
+      sum += ctScan::Int(val.c_str());
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(values.size());
+}
+
+ctBENCHMARK(ctScan, Float)
+{
+  ctVector<ctString> values;
+  for (int64_t i = 0; i < 1000; ++i)
+    values.push_back(ctString(i * 3.14159 - 1000.5));
+
+  while (state.Next())
+  {
+    double sum = 0;
+    for (const ctString &val : values)
+      sum += ctScan::Float(val.c_str());
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(values.size());
+}
+
+ctBENCHMARK(ctScan, Quote)
+{
+  ctString text = "\"";
+  for (int64_t i = 0; i < 100; ++i)
+    text += "quoted text \\\" with escapes ";
+  text += "\"";
+
+  while (state.Next())
+  {
+    ctString quoted = ctScan::Quote(text.c_str());
+    ctDoNotOptimize(quoted.c_str());
+  }
+  state.SetBytesPerIteration(text.length());
+}
+
+ctBENCHMARK(ctMetrics, CounterAdd)
+{
+  ctMetricCounter *pCounter = ctMetrics::Counter("bench.counter");
+  while (state.Next())
+  {
+    for (int64_t i = 0; i < _elementCount; ++i)
+      pCounter->Add();
+  }
+  ctDoNotOptimize(pCounter->Value());
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctMetrics, HistogramRecord)
+{
+  ctMetricHistogram *pHistogram = ctMetrics::Histogram("bench.histogram");
+  while (state.Next())
+  {
+    for (int64_t i = 0; i < _elementCount; ++i)
+      pHistogram->Record(i * 97);
+  }
+  ctDoNotOptimize(pHistogram->Count());
+  state.SetItemsPerIteration(_elementCount);
+}
+
+ctBENCHMARK(ctJobSystem, RunWait)
+{
+  ctJobSystem *pJobs = ctJobSystem::Global();
+  std::atomic<int64_t> sum(0);
+  while (state.Next())
+  {
+    ctJobCounter counter;
+    pJobs->Run(_elementCount, [&sum](int64_t i) { sum.fetch_add(i, std::memory_order_relaxed); }, &counter);
+    pJobs->Wait(&counter);
+  }
+  ctDoNotOptimize(sum.load());
+  state.SetItemsPerIteration(_elementCount);
+}
+
+static const int64_t _parallelCount = 1000000;
+
+ctBENCHMARK(ctParallel, ReduceSerial)
+{
+  ctVector<double> values(_parallelCount, 0.5);
+  while (state.Next())
+  {
+    double sum = 0;
+    for (const double &val : values)
+      sum += val;
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(_parallelCount);
+}
+
+ctBENCHMARK(ctParallel, Reduce)
+{
+  ctVector<double> values(_parallelCount, 0.5);
+  while (state.Next())
+    ctDoNotOptimize(ctParallelReduce(values, 0.0, [](double a, double b) { return a + b; }));
+  state.SetItemsPerIteration(_parallelCount);
+}
+
+ctBENCHMARK(ctParallel, ReduceDeterministic)
+{
+  ctVector<double> values(_parallelCount, 0.5);
+  while (state.Next())
+    ctDoNotOptimize(ctParallelReduce(values, 0.0, [](double a, double b) { return a + b; }, true));
+  state.SetItemsPerIteration(_parallelCount);
+}
+
+ctBENCHMARK(ctParallel, InclusiveScan)
+{
+  ctVector<int64_t> values(_parallelCount, 1);
+  ctVector<int64_t> result;
+  while (state.Next())
+  {
+    ctParallelInclusiveScan(values, &result, [](int64_t a, int64_t b) { return a + b; });
+    ctDoNotOptimize(result.data());
+  }
+  state.SetItemsPerIteration(_parallelCount);
+}
+
+static const int64_t _sortCount = 100000;
+
+// Deterministic pseudo-random keys so every run sorts the same data
+template<typename T> static ctVector<T> _MakeSortInput()
+{
+  ctVector<T> values;
+  values.reserve(_sortCount);
+  uint64_t seed = 0x9E3779B97F4A7C15ull;
+  for (int64_t i = 0; i < _sortCount; ++i)
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    values.push_back((T)(int64_t)(seed % 2000000) - (T)1000000);
+  }
+  return values;
+}
+
+template<typename T, typename SortFunc> static void _BenchSort(ctBenchState &state, SortFunc sort)
+{
+  ctVector<T> input = _MakeSortInput<T>();
+  ctVector<T> values;
+  while (state.Next())
+  {
+    state.PauseTiming();
+    values = input;
+    state.ResumeTiming();
+
+    sort(values.begin(), values.end());
+    ctDoNotOptimize(values.data());
+  }
+  state.SetItemsPerIteration(_sortCount);
+}
+
+ctBENCHMARK(ctSort, StdSortInt)          { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { std::sort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, SortInt)             { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { ctSort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, RadixSortInt)        { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { ctRadixSort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, ParallelSortInt)     { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { ctParallelSort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, StdStableSortInt)    { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { std::stable_sort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, StableSortInt)       { _BenchSort<int64_t>(state, [](int64_t *pBegin, int64_t *pEnd) { ctStableSort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, StdSortDouble)       { _BenchSort<double>(state, [](double *pBegin, double *pEnd) { std::sort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, SortDouble)          { _BenchSort<double>(state, [](double *pBegin, double *pEnd) { ctSort(pBegin, pEnd); }); }
+ctBENCHMARK(ctSort, RadixSortDouble)     { _BenchSort<double>(state, [](double *pBegin, double *pEnd) { ctRadixSort(pBegin, pEnd); }); }
+
+ctBENCHMARK(ctPtr, Make)
+{
+  while (state.Next())
+  {
+    ctPtr<int64_t> ptr = ctMakePtr<int64_t>(1);
+    ctDoNotOptimize(ptr.Get());
+  }
+}
+
+ctBENCHMARK(ctPtr, FromRawPointer)
+{
+  while (state.Next())
+  {
+    ctPtr<int64_t> ptr(ctNew(int64_t)(1));
+    ctDoNotOptimize(ptr.Get());
+  }
+}
+
+ctBENCHMARK(ctPtr, Copy)
+{
+  ctPtr<int64_t> ptr = ctMakePtr<int64_t>(1);
+  while (state.Next())
+  {
+    ctPtr<int64_t> copy = ptr;
+    ctDoNotOptimize(copy.Get());
+  }
+}
+
+ctBENCHMARK(ctPtr, CopyLocal)
+{
+  ctLocalPtr<int64_t> ptr = ctMakeLocalPtr<int64_t>(1);
+  while (state.Next())
+  {
+    ctLocalPtr<int64_t> copy = ptr;
+    ctDoNotOptimize(copy.Get());
+  }
+}
+
+ctBENCHMARK(ctObject, AssignSmall)
+{
+  ctObject obj;
+  int64_t i = 0;
+  while (state.Next())
+  {
+    obj = ++i;
+    ctDoNotOptimize(obj.As<int64_t>());
+  }
+}
+
+ctBENCHMARK(ctObject, CopyPropertyBag)
+{
+  ctObject bag;
+  for (int64_t i = 0; i < 16; ++i)
+    bag.SetMember(ctString("prop") + ctString(i), i);
+
+  while (state.Next())
+  {
+    ctObject copy = bag;
+    ctDoNotOptimize(copy.GetMember<int64_t>("prop0"));
+  }
+}
+
+static const int64_t _payloadSize = 1 << 20;
+
+ctBENCHMARK(ctMemoryReader, ReadCopy)
+{
+  ctVector<uint8_t> payload(_payloadSize, (uint8_t)1);
+  ctVector<uint8_t> dst(_payloadSize, (uint8_t)0);
+  while (state.Next())
+  {
+    ctMemoryReader reader(payload);
+    reader.Read(dst.data(), _payloadSize);
+    ctDoNotOptimize(dst.data());
+  }
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+ctBENCHMARK(ctMemoryReader, ReadView)
+{
+  ctVector<uint8_t> payload(_payloadSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryReader reader(payload);
+    ctDoNotOptimize(reader.ReadView(_payloadSize));
+  }
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+static const int64_t _writerBlockSize = 4096;
+static const int64_t _writerBlockCount = 4096;
+
+ctBENCHMARK(ctMemoryWriter, WriteContiguous)
+{
+  ctVector<uint8_t> block(_writerBlockSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryWriter writer;
+    for (int64_t i = 0; i < _writerBlockCount; ++i)
+      writer.Write(block.data(), block.size());
+    ctDoNotOptimize(writer.Length());
+  }
+  state.SetBytesPerIteration(_writerBlockSize * _writerBlockCount);
+}
+
+ctBENCHMARK(ctMemoryWriter, WriteChunked)
+{
+  ctVector<uint8_t> block(_writerBlockSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryWriter writer(1 << 20);
+    for (int64_t i = 0; i < _writerBlockCount; ++i)
+      writer.Write(block.data(), block.size());
+    ctDoNotOptimize(writer.Length());
+  }
+  state.SetBytesPerIteration(_writerBlockSize * _writerBlockCount);
+}
+
+// Frames of a small header followed by a payload
+ctBENCHMARK(ctMemoryWriter, WriteFrames)
+{
+  ctVector<uint8_t> block(_writerBlockSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryWriter writer;
+    for (int64_t i = 0; i < _writerBlockCount; ++i)
+    {
+      writer.Write(block.size());
+      writer.Write(block.data(), block.size());
+    }
+    ctDoNotOptimize(writer.Length());
+  }
+  state.SetBytesPerIteration((_writerBlockSize + sizeof(int64_t)) * _writerBlockCount);
+}
+
+ctBENCHMARK(ctMemoryWriter, WriteFramesV)
+{
+  ctVector<uint8_t> block(_writerBlockSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryWriter writer;
+    for (int64_t i = 0; i < _writerBlockCount; ++i)
+    {
+      int64_t header = block.size();
+      ctIOSlice frame[2] = { { &header, sizeof(header) }, { block.data(), block.size() } };
+      writer.WriteV(frame, 2);
+    }
+    ctDoNotOptimize(writer.Length());
+  }
+  state.SetBytesPerIteration((_writerBlockSize + sizeof(int64_t)) * _writerBlockCount);
+}
+
+// Checksumming writes through to a memory writer, compared against WriteContiguous
+static void _BenchChecksumWrite(ctBenchState &state, const ctChecksumType type)
+{
+  ctVector<uint8_t> block(_writerBlockSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctMemoryWriter writer;
+    ctChecksumWriteStream checked(&writer, type);
+    for (int64_t i = 0; i < _writerBlockCount; ++i)
+      checked.Write(block.data(), block.size());
+    ctDoNotOptimize(checked.Checksum());
+  }
+  state.SetBytesPerIteration(_writerBlockSize * _writerBlockCount);
+}
+
+ctBENCHMARK(ctChecksum, WriteCRC32C)   { _BenchChecksumWrite(state, ctCT_CRC32C); }
+ctBENCHMARK(ctChecksum, WriteXXHash64) { _BenchChecksumWrite(state, ctCT_XXHash64); }
+
+ctBENCHMARK(ctChecksum, CRC32C)
+{
+  ctVector<uint8_t> payload(_payloadSize, (uint8_t)1);
+  while (state.Next())
+    ctDoNotOptimize(ctCRC32C(payload.data(), payload.size()));
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+ctBENCHMARK(ctChecksum, XXHash64)
+{
+  ctVector<uint8_t> payload(_payloadSize, (uint8_t)1);
+  while (state.Next())
+    ctDoNotOptimize(ctXXHash64(payload.data(), payload.size()));
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+// CSV rows, which compress about as well as typical exports
+static ctVector<uint8_t> _MakeCSV(const int64_t size)
+{
+  ctMemoryWriter csv;
+  for (int64_t i = 0; csv.Length() < size; ++i)
+  {
+    ctString row = ctString(i) + "," + ctString((i * 7919) % 1000) + ",name" + ctString(i % 50) + ",0.5\n";
+    csv.Write(row.c_str(), row.length());
+  }
+
+  csv.m_data.resize(size);
+  return std::move(csv.m_data);
+}
+
+static void _BenchCompress(ctBenchState &state, const ctCompressCodec codec)
+{
+  ctVector<uint8_t> payload = _MakeCSV(_payloadSize);
+  ctVector<uint8_t> compressed(ctCompressBound(codec, _payloadSize), (uint8_t)0);
+  while (state.Next())
+    ctDoNotOptimize(ctCompress(codec, payload.data(), payload.size(), compressed.data(), compressed.size()));
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+static void _BenchDecompress(ctBenchState &state, const ctCompressCodec codec)
+{
+  ctVector<uint8_t> payload = _MakeCSV(_payloadSize);
+  ctVector<uint8_t> compressed(ctCompressBound(codec, _payloadSize), (uint8_t)0);
+  int64_t size = ctCompress(codec, payload.data(), payload.size(), compressed.data(), compressed.size());
+  while (state.Next())
+    ctDoNotOptimize(ctDecompress(codec, compressed.data(), size, payload.data(), payload.size()));
+  state.SetBytesPerIteration(_payloadSize);
+}
+
+ctBENCHMARK(ctCompress, LZ)        { _BenchCompress(state, ctCC_LZ); }
+ctBENCHMARK(ctCompress, LZDecode)  { _BenchDecompress(state, ctCC_LZ); }
+ctBENCHMARK(ctCompress, Deflate)   { _BenchCompress(state, ctCC_Deflate); }
+ctBENCHMARK(ctCompress, Inflate)   { _BenchDecompress(state, ctCC_Deflate); }
+
+static const int64_t _streamPayloadSize = 16 << 20;
+
+static void _BenchCompressStream(ctBenchState &state, const bool parallel)
+{
+  ctVector<uint8_t> payload = _MakeCSV(_streamPayloadSize);
+  ctCompressWriteStream::Options options;
+  options.parallel = parallel;
+  while (state.Next())
+  {
+    ctMemoryWriter writer;
+    ctCompressWriteStream compress(&writer, options);
+    for (int64_t i = 0; i < _streamPayloadSize; i += _writerBlockSize)
+      compress.Write(payload.data() + i, _writerBlockSize);
+    compress.Finish();
+    ctDoNotOptimize(writer.Length());
+  }
+  state.SetBytesPerIteration(_streamPayloadSize);
+}
+
+ctBENCHMARK(ctCompressWriteStream, Write)         { _BenchCompressStream(state, false); }
+ctBENCHMARK(ctCompressWriteStream, WriteParallel) { _BenchCompressStream(state, true); }
+
+ctBENCHMARK(ctDecompressReadStream, Read)
+{
+  ctVector<uint8_t> payload = _MakeCSV(_streamPayloadSize);
+  ctMemoryWriter writer;
+  {
+    ctCompressWriteStream compress(&writer);
+    compress.Write(payload.data(), payload.size());
+  }
+
+  while (state.Next())
+  {
+    ctMemoryReader reader(writer.m_data);
+    ctDecompressReadStream decompress(&reader);
+    for (int64_t i = 0; i < _streamPayloadSize; i += _writerBlockSize)
+      decompress.Read(payload.data() + i, _writerBlockSize);
+    ctDoNotOptimize(payload.data());
+  }
+  state.SetBytesPerIteration(_streamPayloadSize);
+}
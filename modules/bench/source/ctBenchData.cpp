@@ -0,0 +1,127 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctJSON.h"
+#include "ctXML.h"
+#include "ctCSV.h"
+
+static ctString _MakeJSON(const int64_t count)
+{
+  ctString json = "{ \"items\": [";
+  for (int64_t i = 0; i < count; ++i)
+  {
+    if (i > 0)
+      json += ",";
+    json += "{ \"id\": " + ctString(i) + ", \"name\": \"item" + ctString(i) + "\", \"value\": " + ctString(i * 0.5) + ", \"enabled\": true, \"tags\": [1, 2, 3] }";
+  }
+  json += "] }";
+  return json;
+}
+
+static ctString _MakeXML(const int64_t count)
+{
+  ctString xml = "<items>";
+  for (int64_t i = 0; i < count; ++i)
+    xml += "<item id=\"" + ctString(i) + "\" enabled=\"true\"><name>item" + ctString(i) + "</name><value>" + ctString(i * 0.5) + "</value></item>";
+  xml += "</items>";
+  return xml;
+}
+
+static ctString _MakeCSV(const int64_t rows)
+{
+  ctString csv = "id,name,value,enabled\n";
+  for (int64_t i = 0; i < rows; ++i)
+    csv += ctString(i) + ",item" + ctString(i) + "," + ctString(i * 0.5) + ",true\n";
+  return csv;
+}
+
+ctBENCHMARK(ctJSON, Parse)
+{
+  ctString json = _MakeJSON(200);
+  while (state.Next())
+  {
+    ctJSON parsed;
+    ctDoNotOptimize(parsed.Parse(json));
+  }
+  state.SetBytesPerIteration(json.length());
+}
+
+ctBENCHMARK(ctJSON, Serialize)
+{
+  ctString json = _MakeJSON(200);
+  ctJSON parsed(json);
+  while (state.Next())
+  {
+    ctString str = parsed.ToString();
+    ctDoNotOptimize(str.c_str());
+  }
+  state.SetBytesPerIteration(json.length());
+}
+
+ctBENCHMARK(ctXML, Parse)
+{
+  ctString xml = _MakeXML(200);
+  while (state.Next())
+  {
+    ctXML parsed;
+    ctDoNotOptimize(parsed.Parse(xml));
+  }
+  state.SetBytesPerIteration(xml.length());
+}
+
+ctBENCHMARK(ctXML, Serialize)
+{
+  ctString xml = _MakeXML(200);
+  ctXML parsed(xml);
+  while (state.Next())
+  {
+    ctString str = ctToString(parsed);
+    ctDoNotOptimize(str.c_str());
+  }
+  state.SetBytesPerIteration(xml.length());
+}
+
+ctBENCHMARK(ctCSV, Parse)
+{
+  ctString csv = _MakeCSV(1000);
+  while (state.Next())
+  {
+    ctCSV parsed;
+    ctDoNotOptimize(parsed.Parse(csv));
+  }
+  state.SetBytesPerIteration(csv.length());
+}
+
+ctBENCHMARK(ctCSV, Serialize)
+{
+  ctString csv = _MakeCSV(1000);
+  ctCSV parsed(csv);
+  while (state.Next())
+  {
+    ctString str = ctToString(parsed);
+    ctDoNotOptimize(str.c_str());
+  }
+  state.SetBytesPerIteration(csv.length());
+}
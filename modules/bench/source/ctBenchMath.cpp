@@ -0,0 +1,117 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctMath.h"
+#include "LinearAlgebra/ctMatrix.h"
+#include "Geometry/ctBVH.h"
+#include "Geometry/Primitives/ctTriangle.h"
+
+static ctMatrix<double> _MakeMatrix(const int64_t size)
+{
+  ctMatrix<double> mat(size, size);
+  for (int64_t i = 0; i < size * size; ++i)
+    mat[i] = (double)((i * 7919) % 101) / 101.0;
+  return mat;
+}
+
+static void _MatrixMultiply(ctBenchState &state, const int64_t size)
+{
+  ctMatrix<double> a = _MakeMatrix(size);
+  ctMatrix<double> b = _MakeMatrix(size);
+  while (state.Next())
+  {
+    ctMatrix<double> c = a * b;
+    ctDoNotOptimize(c.m_data.data());
+  }
+  state.SetItemsPerIteration(size * size * size);
+}
+
+ctBENCHMARK(ctMatrix, Multiply16) { _MatrixMultiply(state, 16); }
+ctBENCHMARK(ctMatrix, Multiply64) { _MatrixMultiply(state, 64); }
+ctBENCHMARK(ctMatrix, Multiply128) { _MatrixMultiply(state, 128); }
+
+ctBENCHMARK(ctMatrix4, Multiply)
+{
+  ctMat4D a = ctMat4D::Translation(ctVec3D(1, 2, 3));
+  ctMat4D b = ctMat4D::RotationY(0.5);
+  while (state.Next())
+  {
+    a = a * b;
+    ctDoNotOptimize(a);
+  }
+}
+
+static ctVector<ctTriangleD> _MakeTriangleGrid(const int64_t size)
+{
+  ctVector<ctTriangleD> tris;
+  for (int64_t y = 0; y < size; ++y)
+    for (int64_t x = 0; x < size; ++x)
+    {
+      ctVec3D a((double)x, (double)y, 0);
+      ctVec3D b((double)x + 1, (double)y, 0);
+      ctVec3D c((double)x, (double)y + 1, 0);
+      ctVec3D d((double)x + 1, (double)y + 1, 0);
+      tris.push_back(ctTriangleD(a, b, c));
+      tris.push_back(ctTriangleD(b, d, c));
+    }
+  return tris;
+}
+
+ctBENCHMARK(ctBVH, Construct)
+{
+  ctVector<ctTriangleD> tris = _MakeTriangleGrid(16);
+  while (state.Next())
+  {
+    ctBVH<ctTriangleD> bvh(tris);
+    ctDoNotOptimize(bvh.m_root.children.data());
+  }
+  state.SetItemsPerIteration(tris.size());
+}
+
+ctBENCHMARK(ctBVH, RayCast)
+{
+  const int64_t gridSize = 32;
+  ctBVH<ctTriangleD> bvh(_MakeTriangleGrid(gridSize));
+
+  ctVector<ctRayD> rays;
+  for (int64_t i = 0; i < 256; ++i)
+  {
+    double x = (double)((i * 7919) % (gridSize * 100)) / 100.0;
+    double y = (double)((i * 104729) % (gridSize * 100)) / 100.0;
+    rays.push_back(ctRayD(ctVec3D(x, y, 10), ctVec3D(0, 0, -1)));
+  }
+
+  while (state.Next())
+  {
+    int64_t hits = 0;
+    for (const ctRayD &ray : rays)
+    {
+      double time = 0;
+      hits += ctIntersects(ray, bvh, &time);
+    }
+    ctDoNotOptimize(hits);
+  }
+  state.SetItemsPerIteration(rays.size());
+}
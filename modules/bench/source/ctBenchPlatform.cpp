@@ -0,0 +1,408 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctBufferedStream.h"
+#include "file/ctFile.h"
+#include "file/ctMappedFile.h"
+#include "file/ctAsyncFile.h"
+#include "file/ctFileSystem.h"
+#include "ctJSON.h"
+#include "ctParallel.h"
+
+static const char *_benchFilePath = "ctools-bench.tmp";
+static const int64_t _streamItemCount = 100000;
+
+static ctVector<ctString> _MakeStrings()
+{
+  ctVector<ctString> strings;
+  for (int64_t i = 0; i < _streamItemCount; ++i)
+    strings.push_back("item" + ctString(i));
+  return strings;
+}
+
+ctBENCHMARK(ctFile, SerializeStrings)
+{
+  ctVector<ctString> strings = _MakeStrings();
+  while (state.Next())
+  {
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    file.Write(strings);
+  }
+  state.SetItemsPerIteration(_streamItemCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, SerializeStringsBuffered)
+{
+  ctVector<ctString> strings = _MakeStrings();
+  while (state.Next())
+  {
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    ctBufferedWriter writer(&file);
+    writer.Write(strings);
+  }
+  state.SetItemsPerIteration(_streamItemCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, DeserializeStrings)
+{
+  {
+    ctVector<ctString> strings = _MakeStrings();
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    file.Write(strings);
+  }
+
+  while (state.Next())
+  {
+    ctVector<ctString> strings;
+    ctFile file(_benchFilePath, atFM_ReadBinary);
+    file.Read(&strings, 1);
+    ctDoNotOptimize(strings.data());
+  }
+  state.SetItemsPerIteration(_streamItemCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, DeserializeStringsBuffered)
+{
+  {
+    ctVector<ctString> strings = _MakeStrings();
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    file.Write(strings);
+  }
+
+  while (state.Next())
+  {
+    ctVector<ctString> strings;
+    ctFile file(_benchFilePath, atFM_ReadBinary);
+    ctBufferedReader reader(&file);
+    reader.Read(&strings, 1);
+    ctDoNotOptimize(strings.data());
+  }
+  state.SetItemsPerIteration(_streamItemCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctMappedFile, DeserializeStrings)
+{
+  {
+    ctVector<ctString> strings = _MakeStrings();
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    file.Write(strings);
+  }
+
+  while (state.Next())
+  {
+    ctVector<ctString> strings;
+    ctMappedFile file(_benchFilePath);
+    file.Advise(ctMappedFile::MA_Sequential);
+    file.Read(&strings, 1);
+    ctDoNotOptimize(strings.data());
+  }
+  state.SetItemsPerIteration(_streamItemCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+static void _WriteJSONFile()
+{
+  ctJSON json;
+  for (int64_t i = 0; i < _streamItemCount / 10; ++i)
+    json.GetElement(i).SetInt((int)i);
+  ctFile::WriteTextFile(_benchFilePath, json.ToString());
+}
+
+ctBENCHMARK(ctFile, ParseJSON)
+{
+  _WriteJSONFile();
+  while (state.Next())
+  {
+    ctJSON parsed;
+    ctDoNotOptimize(parsed.Parse(ctFile::ReadText(_benchFilePath)));
+  }
+  state.SetItemsPerIteration(_streamItemCount / 10);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctMappedFile, ParseJSON)
+{
+  _WriteJSONFile();
+  while (state.Next())
+  {
+    ctJSON parsed;
+    ctMappedFile file(_benchFilePath);
+    ctDoNotOptimize(parsed.Parse((const char*)file.Data(), file.Size()));
+  }
+  state.SetItemsPerIteration(_streamItemCount / 10);
+  ctFile::Delete(_benchFilePath);
+}
+
+static const int64_t _randomReadCount = 10000;
+static const int64_t _randomReadSize = 4096;
+
+// A 16MB file and a deterministic set of block aligned offsets into it
+static ctVector<int64_t> _MakeRandomReadFile()
+{
+  const int64_t blockCount = 4096;
+  ctVector<uint8_t> data(blockCount * _randomReadSize, (uint8_t)1);
+  ctFile::WriteFile(_benchFilePath, data.data(), data.size());
+
+  ctVector<int64_t> offsets;
+  uint64_t seed = 0x9E3779B97F4A7C15ull;
+  for (int64_t i = 0; i < _randomReadCount; ++i)
+  {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    offsets.push_back((int64_t)(seed % blockCount) * _randomReadSize);
+  }
+  return offsets;
+}
+
+ctBENCHMARK(ctFile, RandomSeekRead)
+{
+  ctVector<int64_t> offsets = _MakeRandomReadFile();
+  ctFile file(_benchFilePath, atFM_ReadBinary);
+  ctVector<uint8_t> buffer(_randomReadSize, (uint8_t)0);
+  while (state.Next())
+  {
+    for (int64_t offset : offsets)
+    {
+      file.Seek(offset);
+      file.Read(buffer.data(), buffer.size());
+    }
+    ctDoNotOptimize(buffer.data());
+  }
+  state.SetItemsPerIteration(_randomReadCount);
+  file.Close();
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, RandomReadAt)
+{
+  ctVector<int64_t> offsets = _MakeRandomReadFile();
+  ctFile file(_benchFilePath, atFM_ReadBinary);
+  file.Advise(atFA_Random);
+  ctVector<uint8_t> buffer(_randomReadSize, (uint8_t)0);
+  while (state.Next())
+  {
+    for (int64_t offset : offsets)
+      file.ReadAt(offset, buffer.data(), buffer.size());
+    ctDoNotOptimize(buffer.data());
+  }
+  state.SetItemsPerIteration(_randomReadCount);
+  file.Close();
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, RandomReadAtParallel)
+{
+  ctVector<int64_t> offsets = _MakeRandomReadFile();
+  ctFile file(_benchFilePath, atFM_ReadBinary);
+  file.Advise(atFA_Random);
+  while (state.Next())
+  {
+    ctParallelFor(offsets, 256, [&file](int64_t offset) {
+      uint8_t buffer[_randomReadSize];
+      file.ReadAt(offset, buffer, _randomReadSize);
+      ctDoNotOptimize(buffer);
+    });
+  }
+  state.SetItemsPerIteration(_randomReadCount);
+  file.Close();
+  ctFile::Delete(_benchFilePath);
+}
+
+static const int64_t _smallFileCount = 500;
+
+static ctVector<ctFilename> _MakeSmallFiles()
+{
+  ctVector<ctFilename> filenames;
+  ctVector<uint8_t> data(2048, (uint8_t)1);
+  for (int64_t i = 0; i < _smallFileCount; ++i)
+  {
+    filenames.push_back(ctString(_benchFilePath) + "." + ctString(i));
+    ctFile::WriteFile(filenames.back(), data.data(), data.size());
+  }
+  return filenames;
+}
+
+static void _DeleteSmallFiles(const ctVector<ctFilename> &filenames)
+{
+  for (const ctFilename &filename : filenames)
+    ctFile::Delete(filename);
+}
+
+ctBENCHMARK(ctFile, ReadSmallFiles)
+{
+  ctVector<ctFilename> filenames = _MakeSmallFiles();
+  while (state.Next())
+  {
+    for (const ctFilename &filename : filenames)
+      ctDoNotOptimize(ctFile::ReadFile(filename).data());
+  }
+  state.SetItemsPerIteration(_smallFileCount);
+  _DeleteSmallFiles(filenames);
+}
+
+ctBENCHMARK(ctAsyncFile, ReadSmallFiles)
+{
+  ctVector<ctFilename> filenames = _MakeSmallFiles();
+  while (state.Next())
+  {
+    for (const ctFuture<ctVector<uint8_t>> &file : ctAsyncFile::Global()->ReadFiles(filenames))
+      ctDoNotOptimize(file.Get().data());
+  }
+  state.SetItemsPerIteration(_smallFileCount);
+  _DeleteSmallFiles(filenames);
+}
+
+static const int64_t _framePayloadSize = 1024 * 1024;
+static const int64_t _frameCount = 16;
+
+// Header and payload copied into one buffer before writing
+ctBENCHMARK(ctFile, WriteFramesCopy)
+{
+  ctVector<uint8_t> payload(_framePayloadSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    for (int64_t i = 0; i < _frameCount; ++i)
+    {
+      ctVector<uint8_t> frame(sizeof(int64_t) + payload.size(), (uint8_t)0);
+      memcpy(frame.data(), &_framePayloadSize, sizeof(int64_t));
+      memcpy(frame.data() + sizeof(int64_t), payload.data(), payload.size());
+      file.Write(frame.data(), frame.size());
+    }
+  }
+  state.SetBytesPerIteration((_framePayloadSize + sizeof(int64_t)) * _frameCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, WriteFramesV)
+{
+  ctVector<uint8_t> payload(_framePayloadSize, (uint8_t)1);
+  while (state.Next())
+  {
+    ctFile file(_benchFilePath, atFM_WriteBinary);
+    for (int64_t i = 0; i < _frameCount; ++i)
+    {
+      int64_t header = payload.size();
+      ctIOSlice frame[2] = { { &header, sizeof(header) }, { payload.data(), payload.size() } };
+      file.WriteV(frame, 2);
+    }
+  }
+  state.SetBytesPerIteration((_framePayloadSize + sizeof(int64_t)) * _frameCount);
+  ctFile::Delete(_benchFilePath);
+}
+
+static const int64_t _copyFileSize = 64 * 1024 * 1024;
+
+// Copy through user space with ctFile reads and writes
+ctBENCHMARK(ctFile, CopyReadWrite)
+{
+  ctVector<uint8_t> data(_copyFileSize, (uint8_t)1);
+  ctFile::WriteFile(_benchFilePath, data.data(), data.size());
+  ctString dstPath = ctString(_benchFilePath) + ".copy";
+  ctVector<uint8_t> buffer(1024 * 1024, (uint8_t)0);
+  while (state.Next())
+  {
+    ctFile src(_benchFilePath, atFM_ReadBinary);
+    ctFile dst(dstPath, atFM_WriteBinary);
+    for (int64_t read = src.Read(buffer.data(), buffer.size()); read > 0; read = src.Read(buffer.data(), buffer.size()))
+      dst.Write(buffer.data(), read);
+  }
+  state.SetBytesPerIteration(_copyFileSize);
+  ctFile::Delete(dstPath);
+  ctFile::Delete(_benchFilePath);
+}
+
+ctBENCHMARK(ctFile, Copy)
+{
+  ctVector<uint8_t> data(_copyFileSize, (uint8_t)1);
+  ctFile::WriteFile(_benchFilePath, data.data(), data.size());
+  ctString dstPath = ctString(_benchFilePath) + ".copy";
+  while (state.Next())
+    ctFile::Copy(_benchFilePath, dstPath, true);
+  state.SetBytesPerIteration(_copyFileSize);
+  ctFile::Delete(dstPath);
+  ctFile::Delete(_benchFilePath);
+}
+
+static const char *_benchFolderPath = "ctools-bench-tree";
+static const int64_t _treeFolderCount = 100;
+static const int64_t _treeFileCount = 100;
+
+static void _MakeTree()
+{
+  for (int64_t i = 0; i < _treeFolderCount; ++i)
+  {
+    ctString folder = ctString(_benchFolderPath) + "/" + ctString(i / 10) + "/" + ctString(i);
+    ctFileSystem::CreateFolders(folder);
+    for (int64_t j = 0; j < _treeFileCount; ++j)
+      ctFile::Create(folder + "/" + ctString(j) + ".txt");
+  }
+}
+
+static void _DeleteTree()
+{
+  // Children are reported after their parents so delete in reverse
+  ctVector<ctFileSystem::FileInfo> entries = ctFileSystem::Walk(_benchFolderPath);
+  for (int64_t i = entries.size() - 1; i >= 0; --i)
+    ctFile::Delete(entries[i].path);
+  ctFile::Delete(_benchFolderPath);
+}
+
+static void _BenchWalk(ctBenchState &state, const ctFileSystem::WalkOptions &options)
+{
+  _MakeTree();
+  while (state.Next())
+  {
+    std::atomic<int64_t> count(0);
+    ctFileSystem::Walk(_benchFolderPath, [&](const ctFileSystem::FileInfo &) { ++count; return true; }, options);
+    ctDoNotOptimize(count.load());
+  }
+  state.SetItemsPerIteration(_treeFolderCount / 10 + _treeFolderCount * (1 + _treeFileCount));
+  _DeleteTree();
+}
+
+ctBENCHMARK(ctFileSystem, Walk)
+{
+  _BenchWalk(state, ctFileSystem::WalkOptions());
+}
+
+ctBENCHMARK(ctFileSystem, WalkNoSizes)
+{
+  ctFileSystem::WalkOptions options;
+  options.fileSizes = false;
+  _BenchWalk(state, options);
+}
+
+ctBENCHMARK(ctFileSystem, WalkParallel)
+{
+  ctFileSystem::WalkOptions options;
+  options.parallel = true;
+  _BenchWalk(state, options);
+}
@@ -0,0 +1,224 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBench.h"
+#include "ctThreading.h"
+#include "ctQueue.h"
+
+static const int64_t _lockCount = 10000;
+static const int64_t _contendedThreads = 4;
+
+// Lock and unlock from a single thread
+template<typename Lock> static void _UncontendedLock(ctBenchState &state)
+{
+  Lock lock;
+  int64_t value = 0;
+  while (state.Next())
+  {
+    for (int64_t i = 0; i < _lockCount; ++i)
+    {
+      lock.lock();
+      ++value;
+      lock.unlock();
+    }
+    ctDoNotOptimize(value);
+  }
+  state.SetItemsPerIteration(_lockCount);
+}
+
+// Several threads incrementing a counter behind the same lock
+template<typename Lock> static void _ContendedLock(ctBenchState &state)
+{
+  Lock lock;
+  int64_t value = 0;
+  while (state.Next())
+  {
+    std::thread threads[_contendedThreads];
+    for (std::thread &t : threads)
+      t = std::thread([&]() {
+        for (int64_t i = 0; i < _lockCount; ++i)
+        {
+          lock.lock();
+          ++value;
+          lock.unlock();
+        }
+      });
+
+    for (std::thread &t : threads)
+      t.join();
+    ctDoNotOptimize(value);
+  }
+  state.SetItemsPerIteration(_lockCount * _contendedThreads);
+}
+
+ctBENCHMARK(ctLocks, StdMutex)               { _UncontendedLock<std::mutex>(state); }
+ctBENCHMARK(ctLocks, SpinLock)               { _UncontendedLock<ctSpinLock>(state); }
+ctBENCHMARK(ctLocks, TicketLock)             { _UncontendedLock<ctTicketLock>(state); }
+ctBENCHMARK(ctLocks, AdaptiveMutex)          { _UncontendedLock<ctAdaptiveMutex>(state); }
+ctBENCHMARK(ctLocks, RWLock)                 { _UncontendedLock<ctRWLock>(state); }
+ctBENCHMARK(ctLocks, StdMutexContended)      { _ContendedLock<std::mutex>(state); }
+ctBENCHMARK(ctLocks, SpinLockContended)      { _ContendedLock<ctSpinLock>(state); }
+ctBENCHMARK(ctLocks, TicketLockContended)    { _ContendedLock<ctTicketLock>(state); }
+ctBENCHMARK(ctLocks, AdaptiveMutexContended) { _ContendedLock<ctAdaptiveMutex>(state); }
+
+// Read-mostly access: one writer for every 64 reads
+template<typename Lock, typename WriteLock, typename ReadLock> static void _ReadMostly(ctBenchState &state)
+{
+  Lock lock;
+  int64_t value = 0;
+  while (state.Next())
+  {
+    std::thread threads[_contendedThreads];
+    for (std::thread &t : threads)
+      t = std::thread([&]() {
+        int64_t sum = 0;
+        for (int64_t i = 0; i < _lockCount; ++i)
+        {
+          if ((i & 63) == 0)
+          {
+            WriteLock guard(lock);
+            ++value;
+          }
+          else
+          {
+            ReadLock guard(lock);
+            sum += value;
+          }
+        }
+        ctDoNotOptimize(sum);
+      });
+
+    for (std::thread &t : threads)
+      t.join();
+  }
+  state.SetItemsPerIteration(_lockCount * _contendedThreads);
+}
+
+ctBENCHMARK(ctLocks, StdMutexReadMostly) { _ReadMostly<std::mutex, ctScopeLock, ctScopeLock>(state); }
+ctBENCHMARK(ctLocks, RWLockReadMostly)   { _ReadMostly<ctRWLock, ctWriteScopeLock, ctReadScopeLock>(state); }
+
+struct _SeqLockValue
+{
+  int64_t a;
+  int64_t b;
+  int64_t c;
+};
+
+ctBENCHMARK(ctLocks, SeqLockRead)
+{
+  ctSeqLock<_SeqLockValue> lock({ 1, 2, 3 });
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < _lockCount; ++i)
+      sum += lock.Read().b;
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(_lockCount);
+}
+
+ctBENCHMARK(ctLocks, MutexRead)
+{
+  std::mutex lock;
+  _SeqLockValue value = { 1, 2, 3 };
+  while (state.Next())
+  {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < _lockCount; ++i)
+    {
+      ctScopeLock guard(lock);
+      sum += value.b;
+    }
+    ctDoNotOptimize(sum);
+  }
+  state.SetItemsPerIteration(_lockCount);
+}
+
+static const int64_t _queueItems = 100000;
+
+// Pass items from one thread to another through a mutex guarded ctVector
+ctBENCHMARK(ctQueue, MutexVectorHandoff)
+{
+  while (state.Next())
+  {
+    std::mutex lock;
+    ctVector<int64_t> queue;
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < _queueItems; ++i)
+      {
+        ctScopeLock guard(lock);
+        queue.push_back(i);
+      }
+    });
+
+    int64_t received = 0;
+    int64_t head = 0;
+    while (received < _queueItems)
+    {
+      ctScopeLock guard(lock);
+      for (; head < queue.size(); ++head)
+        ++received;
+    }
+    producer.join();
+    ctDoNotOptimize(received);
+  }
+  state.SetItemsPerIteration(_queueItems);
+}
+
+template<typename Queue> static void _QueueHandoff(ctBenchState &state, const int64_t batchSize)
+{
+  while (state.Next())
+  {
+    Queue queue(1024);
+    std::thread producer([&]() {
+      int64_t items[64];
+      for (int64_t i = 0; i < _queueItems; i += batchSize)
+      {
+        if (batchSize == 1)
+        {
+          queue.Push(i);
+          continue;
+        }
+
+        for (int64_t j = 0; j < batchSize; ++j)
+          items[j] = i + j;
+        queue.PushBatch(items, batchSize);
+      }
+    });
+
+    int64_t items[64];
+    int64_t received = 0;
+    while (received < _queueItems)
+      received += queue.PopBatch(items, batchSize);
+    producer.join();
+    ctDoNotOptimize(received);
+  }
+  state.SetItemsPerIteration(_queueItems);
+}
+
+ctBENCHMARK(ctQueue, SPSCHandoff)      { _QueueHandoff<ctSPSCQueue<int64_t>>(state, 1); }
+ctBENCHMARK(ctQueue, SPSCBatchHandoff) { _QueueHandoff<ctSPSCQueue<int64_t>>(state, 32); }
+ctBENCHMARK(ctQueue, MPSCHandoff)      { _QueueHandoff<ctMPSCQueue<int64_t>>(state, 1); }
+ctBENCHMARK(ctQueue, MPMCHandoff)      { _QueueHandoff<ctMPMCQueue<int64_t>>(state, 1); }
+ctBENCHMARK(ctQueue, MPMCBatchHandoff) { _QueueHandoff<ctMPMCQueue<int64_t>>(state, 32); }
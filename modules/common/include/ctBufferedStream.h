@@ -0,0 +1,110 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctBufferedStream_h__
+#define ctBufferedStream_h__
+
+#include "ctReadStream.h"
+#include "ctWriteStream.h"
+#include "ctVector.h"
+#include <cstring>
+
+#define ctBUFFERED_STREAM_SIZE (64 * 1024)
+
+// Reads from another stream in large blocks.
+// Small reads are copied out of the buffer without calling the wrapped stream.
+// The wrapped stream must not be used directly while the reader is in use.
+class ctBufferedReader : public ctReadStream
+{
+public:
+  ctBufferedReader(ctReadStream *pStream, const int64_t bufferSize = ctBUFFERED_STREAM_SIZE);
+
+  ctBufferedReader(const ctBufferedReader &) = delete;
+  ctBufferedReader& operator=(const ctBufferedReader &) = delete;
+
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  int64_t Peek(void *pBuffer, const int64_t size) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  // Seeks within the buffered data do not touch the wrapped stream
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+  int64_t Available() const override;
+
+  // Discard the buffered data and move the wrapped stream back to the read position
+  bool Reset();
+
+  ctReadStream* Stream() const;
+
+protected:
+  int64_t ReadSlow(void *pBuffer, const int64_t size);
+
+  // Move unread data to the start of the buffer and read more from the stream.
+  // Returns the number of bytes read.
+  int64_t Fill();
+
+  ctReadStream *m_pStream = nullptr;
+  ctVector<uint8_t> m_buffer;
+  int64_t m_pos = 0; // Read position in m_buffer
+  int64_t m_end = 0; // End of the valid data in m_buffer
+};
+
+// Collects writes in a buffer and passes them to another stream in large blocks.
+// Buffered data is written when the buffer is full, on Flush(), Seek() and destruction.
+// The wrapped stream must not be used directly while the writer has buffered data.
+class ctBufferedWriter : public ctWriteStream
+{
+public:
+  ctBufferedWriter(ctWriteStream *pStream, const int64_t bufferSize = ctBUFFERED_STREAM_SIZE);
+  ~ctBufferedWriter();
+
+  ctBufferedWriter(const ctBufferedWriter &) = delete;
+  ctBufferedWriter& operator=(const ctBufferedWriter &) = delete;
+
+  int64_t Write(const void *pData, const int64_t len) override;
+  template<typename T> int64_t Write(const T *pData, const int64_t count = 1);
+  template<typename T> int64_t Write(const T &data);
+
+  // Write the buffered data to the wrapped stream.
+  // Returns false if the stream did not accept all of it.
+  bool Flush();
+
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+
+  ctWriteStream* Stream() const;
+
+protected:
+  int64_t WriteSlow(const void *pData, const int64_t len);
+
+  ctWriteStream *m_pStream = nullptr;
+  ctVector<uint8_t> m_buffer;
+  int64_t m_size = 0; // Bytes buffered
+};
+
+#include "ctBufferedStream.inl"
+
+#endif // ctBufferedStream_h__
@@ -0,0 +1,26 @@
+#include "ctBufferedStream.h"
+
+inline int64_t ctBufferedReader::Read(void *pBuffer, const int64_t size)
+{
+  if (size > m_end - m_pos)
+    return ReadSlow(pBuffer, size);
+
+  memcpy(pBuffer, m_buffer.data() + m_pos, (size_t)size);
+  m_pos += size;
+  return size;
+}
+
+template<typename T> inline int64_t ctBufferedReader::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
+
+inline int64_t ctBufferedWriter::Write(const void *pData, const int64_t len)
+{
+  if (len > m_buffer.size() - m_size)
+    return WriteSlow(pData, len);
+
+  memcpy(m_buffer.data() + m_size, pData, (size_t)len);
+  m_size += len;
+  return len;
+}
+
+template<typename T> inline int64_t ctBufferedWriter::Write(const T *pData, const int64_t count) { return ctStreamWrite(this, pData, count); }
+template<typename T> inline int64_t ctBufferedWriter::Write(const T &data) { return Write(&data, 1); }
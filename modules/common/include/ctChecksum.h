@@ -0,0 +1,81 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ctChecksum_h__
+#define ctChecksum_h__
+
+#include "ctTypes.h"
+
+enum ctChecksumType
+{
+  ctCT_CRC32C,  // CRC-32 with the Castagnoli polynomial. Uses SSE4.2 when the CPU supports it.
+  ctCT_XXHash64 // 64-bit xxHash
+};
+
+// Returns the CRC32C of pData.
+// Pass the result of a previous call as crc to continue a checksum over several blocks.
+uint32_t ctCRC32C(const void *pData, const int64_t size, const uint32_t crc = 0);
+
+// Returns the 64-bit xxHash of pData
+uint64_t ctXXHash64(const void *pData, const int64_t size, const uint64_t seed = 0);
+
+// Computes a checksum incrementally.
+// Updating with several blocks gives the same result as one update with all of the data.
+class ctChecksum
+{
+public:
+  ctChecksum(const ctChecksumType type = ctCT_CRC32C, const uint64_t seed = 0);
+
+  void Update(const void *pData, const int64_t size);
+
+  // Returns the checksum of the data passed to Update() since the last Reset()
+  uint64_t Digest() const;
+
+  void Reset();
+
+  ctChecksumType Type() const;
+
+  // Returns the number of bytes in a digest of this type
+  int64_t DigestSize() const;
+
+  // Returns the number of bytes passed to Update() since the last Reset()
+  int64_t Count() const;
+
+protected:
+  void UpdateXXHash(const uint8_t *pData, int64_t size);
+
+  ctChecksumType m_type;
+  uint64_t m_seed;
+  int64_t m_count = 0;
+
+  uint32_t m_crc = 0;
+
+  // xxHash state. Input is consumed in 32 byte stripes and partial stripes are kept in m_stripe.
+  uint64_t m_acc[4];
+  uint8_t m_stripe[32];
+  int64_t m_stripeSize = 0;
+};
+
+#endif // ctChecksum_h__
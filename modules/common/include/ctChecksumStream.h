@@ -0,0 +1,113 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ctChecksumStream_h__
+#define ctChecksumStream_h__
+
+#include "ctChecksum.h"
+#include "ctReadStream.h"
+#include "ctWriteStream.h"
+
+// Passes writes through to another stream and computes a checksum of the bytes written.
+// Seeking is not supported as it would skip or repeat part of the checksummed data.
+class ctChecksumWriteStream : public ctWriteStream
+{
+public:
+  ctChecksumWriteStream(ctWriteStream *pStream, const ctChecksumType type = ctCT_CRC32C, const uint64_t seed = 0);
+
+  ctChecksumWriteStream(const ctChecksumWriteStream &) = delete;
+  ctChecksumWriteStream& operator=(const ctChecksumWriteStream &) = delete;
+
+  int64_t Write(const void *pData, const int64_t len) override;
+  int64_t WriteV(const ctIOSlice *pSlices, const int64_t count) override;
+  template<typename T> int64_t Write(const T *pData, const int64_t count = 1);
+  template<typename T> int64_t Write(const T &data);
+
+  // Write the checksum of the data written since the last Reset() to the wrapped stream and start a new checksum.
+  // Returns false if the stream did not accept all of it.
+  bool WriteChecksum();
+
+  // Returns the checksum of the data written since the last Reset()
+  uint64_t Checksum() const;
+  void Reset();
+
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+
+  ctWriteStream* Stream() const;
+
+protected:
+  ctWriteStream *m_pStream = nullptr;
+  ctChecksum m_checksum;
+};
+
+// Passes reads through to another stream and computes a checksum of the bytes read.
+// Peeked data is not included until it is read. Seeking is not supported.
+class ctChecksumReadStream : public ctReadStream
+{
+public:
+  ctChecksumReadStream(ctReadStream *pStream, const ctChecksumType type = ctCT_CRC32C, const uint64_t seed = 0);
+
+  ctChecksumReadStream(const ctChecksumReadStream &) = delete;
+  ctChecksumReadStream& operator=(const ctChecksumReadStream &) = delete;
+
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  int64_t ReadV(const ctIOSlice *pSlices, const int64_t count) override;
+  int64_t Peek(void *pBuffer, const int64_t size) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  // Read a checksum written by ctChecksumWriteStream::WriteChecksum() and compare it
+  // with the checksum of the data read since the last Reset(). Starts a new checksum.
+  // Returns false if the checksum could not be read or does not match.
+  bool VerifyChecksum();
+
+  // Returns the checksum of the data read since the last Reset()
+  uint64_t Checksum() const;
+  void Reset();
+
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+  int64_t Available() const override;
+
+  ctReadStream* Stream() const;
+
+protected:
+  ctReadStream *m_pStream = nullptr;
+  ctChecksum m_checksum;
+};
+
+// Serialize data followed by a checksum of its bytes.
+// Returns the number of bytes written, including the checksum, or 0 if the checksum could not be written.
+template<typename T> int64_t ctStreamWriteChecked(ctWriteStream *pStream, const T &data, const ctChecksumType type = ctCT_CRC32C);
+
+// Deserialize data written by ctStreamWriteChecked().
+// Returns false if the checksum does not match the bytes read.
+template<typename T> bool ctStreamReadChecked(ctReadStream *pStream, T *pData, const ctChecksumType type = ctCT_CRC32C);
+
+#include "ctChecksumStream.inl"
+
+#endif // ctChecksumStream_h__
@@ -0,0 +1,20 @@
+#include "ctChecksumStream.h"
+
+template<typename T> inline int64_t ctChecksumWriteStream::Write(const T *pData, const int64_t count) { return ctStreamWrite(this, pData, count); }
+template<typename T> inline int64_t ctChecksumWriteStream::Write(const T &data) { return Write(&data, 1); }
+template<typename T> inline int64_t ctChecksumReadStream::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
+
+template<typename T> inline int64_t ctStreamWriteChecked(ctWriteStream *pStream, const T &data, const ctChecksumType type)
+{
+  ctChecksumWriteStream checked(pStream, type);
+  int64_t written = checked.Write(data);
+  int64_t digestSize = ctChecksum(type).DigestSize();
+  return checked.WriteChecksum() ? written + digestSize : 0;
+}
+
+template<typename T> inline bool ctStreamReadChecked(ctReadStream *pStream, T *pData, const ctChecksumType type)
+{
+  ctChecksumReadStream checked(pStream, type);
+  checked.Read(pData, 1);
+  return checked.VerifyChecksum();
+}
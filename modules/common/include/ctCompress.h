@@ -0,0 +1,48 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ctCompress_h__
+#define ctCompress_h__
+
+#include "ctTypes.h"
+
+enum ctCompressCodec
+{
+  ctCC_LZ,     // Fast LZ77 codec. Blocks use the LZ4 block format.
+  ctCC_Deflate // Raw deflate (RFC 1951). Slower, but readable by zlib and other inflaters.
+};
+
+// Returns the largest compressed size of 'size' bytes
+int64_t ctCompressBound(const ctCompressCodec codec, const int64_t size);
+
+// Compress pSrc into pDst.
+// Returns the compressed size, or -1 if it does not fit in dstCapacity.
+int64_t ctCompress(const ctCompressCodec codec, const void *pSrc, const int64_t srcSize, void *pDst, const int64_t dstCapacity);
+
+// Decompress pSrc into pDst.
+// Returns the decompressed size, or -1 if the data is corrupt or does not fit in dstCapacity.
+int64_t ctDecompress(const ctCompressCodec codec, const void *pSrc, const int64_t srcSize, void *pDst, const int64_t dstCapacity);
+
+#endif // ctCompress_h__
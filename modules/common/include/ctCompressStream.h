@@ -0,0 +1,211 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ctCompressStream_h__
+#define ctCompressStream_h__
+
+#include "ctCompress.h"
+#include "ctChecksum.h"
+#include "ctReadStream.h"
+#include "ctWriteStream.h"
+#include "ctVector.h"
+#include "ctJobSystem.h"
+
+#define ctCOMPRESS_BLOCK_SIZE (256 * 1024)
+
+// Compresses data written to it and passes it on to another stream.
+// Data is split into blocks that are compressed independently, so they can be compressed
+// in parallel and decompressed without the blocks before them.
+// Each block is written with its own header and an optional checksum of the uncompressed data.
+class ctCompressWriteStream : public ctWriteStream
+{
+public:
+  struct Options
+  {
+    ctCompressCodec codec = ctCC_LZ;
+    int64_t blockSize = ctCOMPRESS_BLOCK_SIZE;
+
+    bool checksum = true;
+    ctChecksumType checksumType = ctCT_CRC32C;
+
+    // Compress blocks on a job system while more data is written.
+    // Blocks are still written to the stream in order.
+    bool parallel = false;
+    ctJobSystem *pJobs = nullptr; // Defaults to ctJobSystem::Global()
+  };
+
+  ctCompressWriteStream(ctWriteStream *pStream);
+  ctCompressWriteStream(ctWriteStream *pStream, const Options &options);
+
+  // Calls Finish()
+  ~ctCompressWriteStream();
+
+  ctCompressWriteStream(const ctCompressWriteStream &) = delete;
+  ctCompressWriteStream& operator=(const ctCompressWriteStream &) = delete;
+
+  int64_t Write(const void *pData, const int64_t len) override;
+  template<typename T> int64_t Write(const T *pData, const int64_t count = 1);
+  template<typename T> int64_t Write(const T &data);
+
+  // Compress the data written so far and write it to the stream, even if the block is not full.
+  // Use this to make the data available to a reader on the other end of a socket.
+  // Returns false if writing to the stream failed.
+  bool Flush();
+
+  // Flush the remaining data and write the end of the compressed stream.
+  // Nothing can be written afterwards. Returns false if writing to the stream failed.
+  bool Finish();
+
+  // Seeking is not supported. Tell() and Length() return the number of uncompressed bytes written.
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+
+  ctWriteStream* Stream() const;
+
+protected:
+  struct Block
+  {
+    ctVector<uint8_t> data;
+    int64_t size = 0;
+    ctVector<uint8_t> frame; // Header, payload and checksum, ready to write
+    int64_t frameSize = 0;
+    ctJobCounter done;
+  };
+
+  bool WriteHeader();
+
+  // Compress the current block and hand it on to be written
+  bool EndBlock();
+  void Encode(Block *pBlock) const;
+  bool WriteFrame(Block *pBlock);
+
+  // Wait for the oldest block being compressed and write it
+  bool Retire();
+
+  Block* NewBlock();
+
+  ctWriteStream *m_pStream = nullptr;
+  Options m_options;
+  Block *m_pBlock = nullptr;
+  ctVector<Block*> m_inFlight; // Blocks being compressed, oldest first
+  ctVector<Block*> m_free;
+  int64_t m_maxInFlight = 0;
+  int64_t m_written = 0;
+  bool m_started = false;
+  bool m_finished = false;
+  bool m_failed = false;
+};
+
+// Decompresses a stream written by ctCompressWriteStream.
+// Reading only needs a readable stream, so sockets work too. Seeking outside of the
+// current block needs the wrapped stream to support Seek() and Tell(). The block
+// headers are used to find the block to seek to, which is then decompressed on its own.
+class ctDecompressReadStream : public ctReadStream
+{
+public:
+  ctDecompressReadStream(ctReadStream *pStream);
+
+  ctDecompressReadStream(const ctDecompressReadStream &) = delete;
+  ctDecompressReadStream& operator=(const ctDecompressReadStream &) = delete;
+
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  // If the wrapped stream cannot seek, a peek stops at the end of the current block
+  int64_t Peek(void *pBuffer, const int64_t size) override;
+
+  // Positions are in uncompressed bytes
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+
+  // Returns the uncompressed length. If the end has not been read yet, this walks the
+  // remaining block headers, so it returns -1 if the wrapped stream cannot seek.
+  int64_t Length() const override;
+
+  // Returns the bytes left in the stream, or only those left in the current block
+  // if the length is not known.
+  int64_t Available() const override;
+
+  // Returns true if the stream is not a compressed stream, or a block is corrupt
+  // or does not match its checksum. Reads stop at the failed block.
+  bool Failed() const;
+
+  ctReadStream* Stream() const;
+
+protected:
+  struct BlockInfo
+  {
+    int64_t offset;    // Offset of the block frame from the end of the stream header
+    int64_t frameSize;
+    int64_t start;     // Uncompressed position of the first byte in the block
+    int64_t size;      // Uncompressed size
+  };
+
+  bool ReadHeader();
+
+  // Read and decompress the block at the current position of the wrapped stream.
+  // Returns false at the end of the stream or if the block is corrupt.
+  bool ReadBlock();
+
+  // Find the block containing an uncompressed position, walking unread block headers if needed.
+  // Returns the number of blocks if pos is at the end of the stream, or -1 if it is not found.
+  int64_t FindBlock(const int64_t pos);
+
+  // Add the next block header to the index without reading the block
+  bool IndexNextBlock();
+
+  // Returns true if the wrapped stream can seek. Probed once with a seek to the current position.
+  bool CanSeekStream();
+
+  // Move the wrapped stream to a block frame. If index == m_index.size() this is the frame after the last known block.
+  bool SeekFrame(const int64_t index);
+
+  ctReadStream *m_pStream = nullptr;
+  ctCompressCodec m_codec = ctCC_LZ;
+  bool m_checksum = false;
+  ctChecksumType m_checksumType = ctCT_CRC32C;
+  int64_t m_maxBlockSize = 0;
+
+  ctVector<uint8_t> m_compressed;
+  ctVector<uint8_t> m_block;
+  int64_t m_blockIndex = -1; // Index of the decompressed block in m_index
+  int64_t m_blockStart = 0;
+  int64_t m_blockSize = 0;
+  int64_t m_blockPos = 0;
+
+  ctVector<BlockInfo> m_index; // Blocks seen so far, in order
+  int64_t m_consumed = 0;      // Compressed bytes read since the end of the stream header
+  int64_t m_nextBlock = 0;     // Index of the block frame at m_consumed
+  int64_t m_length = -1;       // Uncompressed length, once the end marker has been seen
+
+  bool m_started = false;
+  bool m_failed = false;
+  int8_t m_canSeek = -1; // -1 until probed
+};
+
+#include "ctCompressStream.inl"
+
+#endif // ctCompressStream_h__
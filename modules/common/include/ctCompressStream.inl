@@ -0,0 +1,5 @@
+#include "ctCompressStream.h"
+
+template<typename T> inline int64_t ctCompressWriteStream::Write(const T *pData, const int64_t count) { return ctStreamWrite(this, pData, count); }
+template<typename T> inline int64_t ctCompressWriteStream::Write(const T &data) { return Write(&data, 1); }
+template<typename T> inline int64_t ctDecompressReadStream::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
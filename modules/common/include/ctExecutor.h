@@ -0,0 +1,97 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctExecutor_h__
+#define ctExecutor_h__
+
+#include "ctJobSystem.h"
+
+// Something that runs work items. Coroutines (see ctTask) are resumed on the executor
+// they were started on.
+class ctExecutor
+{
+public:
+  virtual ~ctExecutor() = default;
+
+  // Queue func to be called. Safe to call from any thread.
+  virtual void Post(std::function<void()> func) = 0;
+};
+
+// An executor that runs work as jobs on a ctJobSystem
+class ctJobExecutor : public ctExecutor
+{
+public:
+  // If pJobs is null the global job system is used
+  ctJobExecutor(ctJobSystem *pJobs = nullptr);
+
+  // An executor for the global job system
+  static ctJobExecutor* Global();
+
+  void Post(std::function<void()> func) override;
+
+  ctJobSystem* JobSystem() const;
+
+protected:
+  ctJobSystem *m_pJobs;
+};
+
+// An executor that runs work on the threads that call Run(), RunOne() or Poll().
+// Work is run in the order it was posted.
+class ctEventLoop : public ctExecutor
+{
+public:
+  ctEventLoop();
+
+  ctEventLoop(const ctEventLoop &) = delete;
+  ctEventLoop& operator=(const ctEventLoop &) = delete;
+
+  void Post(std::function<void()> func) override;
+
+  // Run work until Stop() is called. Returns the number of items that were run.
+  int64_t Run();
+
+  // Run one item, blocking until one is posted or Stop() is called.
+  // Returns false if the loop was stopped.
+  bool RunOne();
+
+  // Run all items that are ready without blocking. Returns the number of items that were run.
+  int64_t Poll();
+
+  // Stop Run() and RunOne() from blocking. Work that is queued is kept.
+  void Stop();
+
+  // Allow Run() and RunOne() to block again after Stop()
+  void Restart();
+
+  bool IsStopped() const;
+
+protected:
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+  ctVector<std::function<void()>> m_queue;
+  int64_t m_head;
+  std::atomic<bool> m_stopped;
+};
+
+#endif // ctExecutor_h__
@@ -0,0 +1,236 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctFuture_h__
+#define ctFuture_h__
+
+#include "ctJobSystem.h"
+#include "ctThreading.h"
+
+template<typename T> class ctFuture;
+template<typename T> class ctPromise;
+
+enum ctFutureStatus : int64_t
+{
+  ctFS_Pending,
+  ctFS_Ready,
+  ctFS_Failed,
+  ctFS_Cancelled,
+};
+
+// Reference counted state shared by a future and its promises
+struct _ctFutureStateBase
+{
+  _ctFutureStateBase();
+  virtual ~_ctFutureStateBase();
+
+  void Acquire();
+  void Release();
+
+  // A promise that is released without completing the state fails it
+  void AcquirePromise();
+  void ReleasePromise();
+
+  void AddCallback(std::function<void()> callback);
+
+  // Set the result status. construct() is called before the result is published.
+  // Returns false if the state was already complete.
+  template<typename Func> bool Complete(const ctFutureStatus result, Func &&construct);
+
+  void RunCallbacks(ctVector<std::function<void()>> *pCallbacks);
+
+  std::atomic<int64_t> refs;
+  std::atomic<int64_t> promises;
+  std::atomic<int64_t> status;
+  ctJobCounter done;
+
+  std::mutex lock;
+  ctVector<std::function<void()>> callbacks;
+};
+
+template<typename T> struct _ctFutureState : public _ctFutureStateBase
+{
+  typedef const T& ConstRef;
+
+  ~_ctFutureState();
+
+  template<typename... Args> void Construct(Args&&... args);
+  ConstRef Value() const;
+
+  alignas(T) uint8_t storage[sizeof(T)];
+};
+
+template<> struct _ctFutureState<void> : public _ctFutureStateBase
+{
+  typedef void ConstRef;
+
+  void Construct() {}
+  ConstRef Value() const {}
+};
+
+// A shared flag used to request that pending work is abandoned.
+// Copies of a token refer to the same flag.
+class ctCancellationToken
+{
+public:
+  // Construct a token that is never cancelled
+  ctCancellationToken();
+
+  ctCancellationToken(const ctCancellationToken &copy);
+  ctCancellationToken(ctCancellationToken &&move);
+  ~ctCancellationToken();
+
+  // Create a token that can be cancelled
+  static ctCancellationToken Create();
+
+  // Request cancellation. Has no effect on a token that cannot be cancelled.
+  void Cancel();
+
+  bool IsCancelled() const;
+  bool CanBeCancelled() const;
+
+  ctCancellationToken& operator=(const ctCancellationToken &copy);
+  ctCancellationToken& operator=(ctCancellationToken &&move);
+
+protected:
+  struct State
+  {
+    std::atomic<int64_t> refs;
+    std::atomic<bool> cancelled;
+  };
+
+  void Release();
+
+  State *m_pState;
+};
+
+// The result of an asynchronous operation.
+// A future is completed by the ctPromise it was created from. Copies of a
+// future refer to the same result.
+template<typename T> class ctFuture
+{
+  friend ctPromise<T>;
+
+public:
+  typedef typename _ctFutureState<T>::ConstRef ConstRef;
+
+  // Construct an invalid future
+  ctFuture();
+
+  ctFuture(const ctFuture<T> &copy);
+  ctFuture(ctFuture<T> &&move);
+  ~ctFuture();
+
+  // Returns false for a default constructed future
+  bool IsValid() const;
+
+  ctFutureStatus Status() const;
+
+  // Returns true if the future is no longer pending
+  bool IsDone() const;
+
+  bool IsReady() const;
+  bool Failed() const;
+  bool Cancelled() const;
+
+  // Block until the future is done. The calling thread runs jobs from pJobs
+  // (or the global job system) while it waits.
+  void Wait(ctJobSystem *pJobs = nullptr) const;
+
+  // Wait for the future and get the result.
+  // The future must complete successfully.
+  ConstRef Get(ctJobSystem *pJobs = nullptr) const;
+
+  // Call fn(*this) as a job once this future is done. Returns a future for the
+  // value returned by fn. The continuation is called when this future fails or is
+  // cancelled too, so fn should check the status before calling Get().
+  // If token is cancelled before the continuation starts, fn is not called and the
+  // returned future is cancelled.
+  template<typename Func>
+  auto Then(Func fn, ctJobSystem *pJobs = nullptr, const ctCancellationToken &token = ctCancellationToken()) const
+    -> ctFuture<decltype(fn(std::declval<const ctFuture<T>&>()))>;
+
+  // Call fn() on the thread that completes the future, or immediately if it is already done.
+  // fn should be short and must not block.
+  void OnComplete(std::function<void()> fn) const;
+
+  ctFuture<T>& operator=(const ctFuture<T> &copy);
+  ctFuture<T>& operator=(ctFuture<T> &&move);
+
+protected:
+  ctFuture(_ctFutureState<T> *pState);
+
+  _ctFutureState<T> *m_pState;
+};
+
+// The producer side of a ctFuture.
+// Copies of a promise refer to the same result, and the first call to one of the
+// Set functions completes it. If every copy of a promise is destroyed before it is
+// completed, the future fails.
+template<typename T> class ctPromise
+{
+public:
+  ctPromise();
+  ctPromise(const ctPromise<T> &copy);
+  ctPromise(ctPromise<T> &&move);
+  ~ctPromise();
+
+  ctFuture<T> Future() const;
+
+  // Complete the future with a value constructed from args.
+  // Returns false if the future was already completed.
+  template<typename... Args> bool SetValue(Args&&... args);
+
+  bool SetFailed();
+  bool SetCancelled();
+
+  ctPromise<T>& operator=(const ctPromise<T> &copy);
+  ctPromise<T>& operator=(ctPromise<T> &&move);
+
+protected:
+  void Release();
+
+  _ctFutureState<T> *m_pState;
+};
+
+// Run fn() as a job and return a future for its result
+template<typename Func>
+auto ctAsync(Func fn, ctJobSystem *pJobs = nullptr, const ctCancellationToken &token = ctCancellationToken())
+  -> ctFuture<decltype(fn())>;
+
+// Get a future that has already completed with the specified value
+template<typename T> ctFuture<T> ctMakeReadyFuture(const T &value);
+ctFuture<void> ctMakeReadyFuture();
+
+// Get a future that completes once all of the futures are done.
+// The result fails if any input failed, or is cancelled if any input was cancelled.
+template<typename T> ctFuture<void> ctWhenAll(const ctVector<ctFuture<T>> &futures);
+
+// Get a future that completes with the index of the first of the futures to finish.
+// 'futures' must not be empty, as no index could be returned. Otherwise the result fails.
+template<typename T> ctFuture<int64_t> ctWhenAny(const ctVector<ctFuture<T>> &futures);
+
+#include "ctFuture.inl"
+
+#endif // ctFuture_h__
@@ -0,0 +1,311 @@
+#include "ctFuture.h"
+
+template<typename Func>
+inline bool _ctFutureStateBase::Complete(const ctFutureStatus result, Func &&construct)
+{
+  // Keep the state alive until callbacks have run, as they may hold the last references
+  Acquire();
+
+  bool completed = false;
+  ctVector<std::function<void()>> completedCallbacks;
+  {
+    ctScopeLock guard(lock);
+    if (status.load(std::memory_order_acquire) == ctFS_Pending)
+    {
+      construct();
+      status.store(result, std::memory_order_release);
+      std::swap(completedCallbacks, callbacks);
+      completed = true;
+    }
+  }
+
+  if (completed)
+  {
+    done.Decrement();
+    RunCallbacks(&completedCallbacks);
+  }
+
+  Release();
+  return completed;
+}
+
+template<typename T>
+inline _ctFutureState<T>::~_ctFutureState()
+{
+  if (status.load() == ctFS_Ready)
+    ctDestruct((T*)storage);
+}
+
+template<typename T>
+template<typename... Args>
+inline void _ctFutureState<T>::Construct(Args&&... args) { ctConstruct((T*)storage, std::forward<Args>(args)...); }
+
+template<typename T>
+inline typename _ctFutureState<T>::ConstRef _ctFutureState<T>::Value() const { return *(const T*)storage; }
+
+// Calls fn(args...) and completes a promise with the result
+template<typename T> struct _ctFutureInvoke
+{
+  template<typename Func, typename... Args>
+  static void Invoke(ctPromise<T> &promise, Func &fn, Args&&... args) { promise.SetValue(fn(std::forward<Args>(args)...)); }
+};
+
+template<> struct _ctFutureInvoke<void>
+{
+  template<typename Func, typename... Args>
+  static void Invoke(ctPromise<void> &promise, Func &fn, Args&&... args)
+  {
+    fn(std::forward<Args>(args)...);
+    promise.SetValue();
+  }
+};
+
+//**********
+// ctFuture
+//**********
+
+template<typename T> inline ctFuture<T>::ctFuture() : m_pState(nullptr) {}
+template<typename T> inline ctFuture<T>::ctFuture(const ctFuture<T> &copy) : m_pState(nullptr) { *this = copy; }
+template<typename T> inline ctFuture<T>::ctFuture(ctFuture<T> &&move) : m_pState(nullptr) { *this = std::move(move); }
+
+template<typename T>
+inline ctFuture<T>::ctFuture(_ctFutureState<T> *pState)
+  : m_pState(pState)
+{
+  if (m_pState)
+    m_pState->Acquire();
+}
+
+template<typename T>
+inline ctFuture<T>::~ctFuture()
+{
+  if (m_pState)
+    m_pState->Release();
+}
+
+template<typename T> inline bool ctFuture<T>::IsValid() const { return m_pState != nullptr; }
+
+template<typename T>
+inline ctFutureStatus ctFuture<T>::Status() const
+{
+  return m_pState ? (ctFutureStatus)m_pState->status.load(std::memory_order_acquire) : ctFS_Failed;
+}
+
+template<typename T> inline bool ctFuture<T>::IsDone() const { return Status() != ctFS_Pending; }
+template<typename T> inline bool ctFuture<T>::IsReady() const { return Status() == ctFS_Ready; }
+template<typename T> inline bool ctFuture<T>::Failed() const { return Status() == ctFS_Failed; }
+template<typename T> inline bool ctFuture<T>::Cancelled() const { return Status() == ctFS_Cancelled; }
+
+template<typename T>
+inline void ctFuture<T>::Wait(ctJobSystem *pJobs) const
+{
+  if (!m_pState || IsDone())
+    return;
+  (pJobs ? pJobs : ctJobSystem::Global())->Wait(&m_pState->done);
+}
+
+template<typename T>
+inline typename ctFuture<T>::ConstRef ctFuture<T>::Get(ctJobSystem *pJobs) const
+{
+  Wait(pJobs);
+  ctAssert(IsReady(), "Getting the result of a future that did not complete");
+  return m_pState->Value();
+}
+
+template<typename T>
+template<typename Func>
+inline auto ctFuture<T>::Then(Func fn, ctJobSystem *pJobs, const ctCancellationToken &token) const
+  -> ctFuture<decltype(fn(std::declval<const ctFuture<T>&>()))>
+{
+  typedef decltype(fn(std::declval<const ctFuture<T>&>())) Result;
+
+  ctPromise<Result> promise;
+  ctFuture<T> self = *this;
+  ctJobSystem *pSystem = pJobs ? pJobs : ctJobSystem::Global();
+  OnComplete([=]() {
+    pSystem->Run([=]() mutable {
+      if (token.IsCancelled())
+        promise.SetCancelled();
+      else
+        _ctFutureInvoke<Result>::Invoke(promise, fn, self);
+    });
+  });
+
+  return promise.Future();
+}
+
+template<typename T>
+inline void ctFuture<T>::OnComplete(std::function<void()> fn) const
+{
+  if (m_pState)
+    m_pState->AddCallback(std::move(fn));
+  else
+    fn();
+}
+
+template<typename T>
+inline ctFuture<T>& ctFuture<T>::operator=(const ctFuture<T> &copy)
+{
+  if (copy.m_pState)
+    copy.m_pState->Acquire();
+  if (m_pState)
+    m_pState->Release();
+  m_pState = copy.m_pState;
+  return *this;
+}
+
+template<typename T>
+inline ctFuture<T>& ctFuture<T>::operator=(ctFuture<T> &&move)
+{
+  std::swap(m_pState, move.m_pState);
+  return *this;
+}
+
+//***********
+// ctPromise
+//***********
+
+template<typename T>
+inline ctPromise<T>::ctPromise()
+  : m_pState(ctNew(_ctFutureState<T>))
+{
+  m_pState->AcquirePromise();
+}
+
+template<typename T> inline ctPromise<T>::ctPromise(const ctPromise<T> &copy) : m_pState(nullptr) { *this = copy; }
+template<typename T> inline ctPromise<T>::ctPromise(ctPromise<T> &&move) : m_pState(nullptr) { std::swap(m_pState, move.m_pState); }
+template<typename T> inline ctPromise<T>::~ctPromise() { Release(); }
+
+template<typename T> inline ctFuture<T> ctPromise<T>::Future() const { return ctFuture<T>(m_pState); }
+
+template<typename T>
+template<typename... Args>
+inline bool ctPromise<T>::SetValue(Args&&... args)
+{
+  _ctFutureState<T> *pState = m_pState;
+  return pState && pState->Complete(ctFS_Ready, [&]() { pState->Construct(std::forward<Args>(args)...); });
+}
+
+template<typename T> inline bool ctPromise<T>::SetFailed() { return m_pState && m_pState->Complete(ctFS_Failed, []() {}); }
+template<typename T> inline bool ctPromise<T>::SetCancelled() { return m_pState && m_pState->Complete(ctFS_Cancelled, []() {}); }
+
+template<typename T>
+inline ctPromise<T>& ctPromise<T>::operator=(const ctPromise<T> &copy)
+{
+  if (copy.m_pState)
+    copy.m_pState->AcquirePromise();
+  Release();
+  m_pState = copy.m_pState;
+  return *this;
+}
+
+template<typename T>
+inline ctPromise<T>& ctPromise<T>::operator=(ctPromise<T> &&move)
+{
+  std::swap(m_pState, move.m_pState);
+  return *this;
+}
+
+template<typename T>
+inline void ctPromise<T>::Release()
+{
+  if (m_pState)
+    m_pState->ReleasePromise();
+  m_pState = nullptr;
+}
+
+//*************
+// Combinators
+//*************
+
+template<typename Func>
+inline auto ctAsync(Func fn, ctJobSystem *pJobs, const ctCancellationToken &token) -> ctFuture<decltype(fn())>
+{
+  typedef decltype(fn()) Result;
+
+  ctPromise<Result> promise;
+  ctFuture<Result> future = promise.Future();
+  (pJobs ? pJobs : ctJobSystem::Global())->Run([=]() mutable {
+    if (token.IsCancelled())
+      promise.SetCancelled();
+    else
+      _ctFutureInvoke<Result>::Invoke(promise, fn);
+  });
+  return future;
+}
+
+template<typename T>
+inline ctFuture<T> ctMakeReadyFuture(const T &value)
+{
+  ctPromise<T> promise;
+  promise.SetValue(value);
+  return promise.Future();
+}
+
+inline ctFuture<void> ctMakeReadyFuture()
+{
+  ctPromise<void> promise;
+  promise.SetValue();
+  return promise.Future();
+}
+
+template<typename T>
+inline ctFuture<void> ctWhenAll(const ctVector<ctFuture<T>> &futures)
+{
+  if (futures.size() == 0)
+    return ctMakeReadyFuture();
+
+  struct Shared
+  {
+    std::atomic<int64_t> remaining;
+    std::atomic<int64_t> result;
+    ctPromise<void> promise;
+  };
+
+  Shared *pShared = ctNew(Shared);
+  pShared->remaining = futures.size();
+  pShared->result = ctFS_Ready;
+
+  ctFuture<void> result = pShared->promise.Future();
+  for (const ctFuture<T> &future : futures)
+  {
+    ctFuture<T> input = future;
+    future.OnComplete([pShared, input]() {
+      ctFutureStatus status = input.Status();
+      if (status == ctFS_Cancelled)
+      {
+        pShared->result = ctFS_Cancelled;
+      }
+      else if (status == ctFS_Failed)
+      {
+        int64_t expected = ctFS_Ready;
+        pShared->result.compare_exchange_strong(expected, ctFS_Failed);
+      }
+
+      if (--pShared->remaining > 0)
+        return;
+
+      switch (pShared->result.load())
+      {
+      case ctFS_Ready: pShared->promise.SetValue(); break;
+      case ctFS_Failed: pShared->promise.SetFailed(); break;
+      case ctFS_Cancelled: pShared->promise.SetCancelled(); break;
+      }
+      ctDelete(pShared);
+    });
+  }
+
+  return result;
+}
+
+template<typename T>
+inline ctFuture<int64_t> ctWhenAny(const ctVector<ctFuture<T>> &futures)
+{
+  ctAssert(futures.size() > 0, "ctWhenAny() requires at least one future");
+
+  ctPromise<int64_t> promise;
+  ctFuture<int64_t> result = promise.Future();
+  for (int64_t i = 0; i < futures.size(); ++i)
+    futures[i].OnComplete([promise, i]() mutable { promise.SetValue(i); });
+  return result;
+}
@@ -0,0 +1,162 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctJobSystem_h__
+#define ctJobSystem_h__
+
+#include "ctVector.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+class ctJobSystem;
+class ctJobWorker;
+struct ctJob;
+
+// Counts outstanding work. Jobs queued with a counter increment it when they are
+// queued and decrement it when they complete. Jobs can also depend on a counter, in
+// which case they are not started until the counter reaches zero.
+// A counter must outlive any job that signals or depends on it.
+class ctJobCounter
+{
+  friend ctJobSystem;
+
+public:
+  ctJobCounter(const int64_t initialValue = 0);
+  ~ctJobCounter();
+
+  ctJobCounter(const ctJobCounter &) = delete;
+  ctJobCounter& operator=(const ctJobCounter &) = delete;
+
+  // Manually add to the counter. Each increment must be matched by a call to Decrement()
+  void Increment(const int64_t amount = 1);
+
+  // Release one reference. Jobs depending on this counter are queued once it reaches zero.
+  void Decrement();
+
+  int64_t Value() const;
+
+  // Returns true if the counter is zero
+  bool Done() const;
+
+protected:
+  // Queue pJob once the counter reaches zero.
+  // Returns false if the counter was already zero.
+  bool AddDependent(ctJob *pJob);
+
+  // Register/unregister a job system that has a thread blocked on this counter.
+  // Several systems may wait on the same counter, and each is woken when it reaches zero.
+  bool BeginWait(ctJobSystem *pSystem);
+  void EndWait(ctJobSystem *pSystem);
+
+  std::atomic<int64_t> m_value;
+
+  // The last decrement, dependents and waiters are guarded by m_lock
+  std::mutex m_lock;
+  ctVector<ctJob*> m_dependents;
+  ctVector<ctJobSystem*> m_waitingSystems; // One entry per blocked thread
+};
+
+// A fixed pool of worker threads that execute jobs.
+// Each worker owns a work-stealing deque. Jobs queued from a worker are pushed to its
+// own deque and executed most recent first, while idle workers steal the oldest jobs
+// from other workers. Jobs queued from other threads are placed in a shared queue.
+class ctJobSystem
+{
+  friend ctJobCounter;
+  friend ctJobWorker;
+
+public:
+  typedef std::function<void()> JobFunc;
+
+  // Create a job system with the specified number of workers.
+  // If workerCount < 0, one worker is created for each hardware thread except the calling thread.
+  ctJobSystem(const int64_t workerCount = -1);
+
+  // Completes all queued jobs before stopping the workers, including jobs still waiting
+  // on a dependency. Those dependencies must reach zero for the destructor to return.
+  ~ctJobSystem();
+
+  ctJobSystem(const ctJobSystem &) = delete;
+  ctJobSystem& operator=(const ctJobSystem &) = delete;
+
+  // A process wide job system, created on first use
+  static ctJobSystem* Global();
+
+  // Queue a job.
+  // If pCounter is not null it is incremented now and decremented when the job completes.
+  // If pDependency is not null the job will not start until pDependency reaches zero.
+  void Run(JobFunc func, ctJobCounter *pCounter = nullptr, ctJobCounter *pDependency = nullptr);
+
+  // Queue 'count' jobs calling func(index) for each index in [0, count)
+  void Run(const int64_t count, const std::function<void(int64_t)> &func, ctJobCounter *pCounter = nullptr, ctJobCounter *pDependency = nullptr);
+
+  // Block until pCounter reaches zero.
+  // The calling thread executes queued jobs while it waits.
+  void Wait(ctJobCounter *pCounter);
+
+  // Execute a single queued job if one is available
+  bool TryRunOne();
+
+  // Get the number of worker threads
+  int64_t WorkerCount() const;
+
+  // Get the index of the worker executing the calling thread,
+  // or -1 if the calling thread is not a worker of this job system.
+  int64_t CurrentWorker() const;
+
+protected:
+  void Submit(ctJob *pJob);
+
+  // Queue a job that was waiting for its dependency to reach zero
+  void Release(ctJob *pJob);
+
+  void Execute(ctJob *pJob);
+  ctJob* FindJob(ctJobWorker *pWorker);
+
+  // Block the calling thread until a job is queued, pCounter is done or the system stops
+  void Idle(ctJobCounter *pCounter);
+  void WakeAll();
+
+  static void WorkerMain(ctJobSystem *pSystem, ctJobWorker *pWorker);
+
+  ctVector<ctJobWorker*> m_workers;
+  ctVector<std::thread*> m_threads;
+
+  std::atomic<int64_t> m_queued;
+  std::atomic<int64_t> m_waiting; // Jobs held by a ctJobCounter until it reaches zero
+  std::atomic<int64_t> m_sleeping;
+  std::atomic<bool> m_stop;
+
+  std::mutex m_sleepLock;
+  std::condition_variable m_wake;
+
+  std::mutex m_sharedLock;
+  ctVector<ctJob*> m_sharedQueue;
+  int64_t m_sharedHead;
+};
+
+#endif // ctJobSystem_h__
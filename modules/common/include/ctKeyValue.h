@@ -90,8 +90,8 @@ template<typename Key, class Val> int64_t ctStreamWrite(ctWriteStream *pStream,
   int64_t ret = 0;
   for (const ctKeyValue<Key, Val> &vec : ctIterate(pData, count))
   {
-    ret += ctStreamWrite(pStream, &pData->m_key, 1);
-    ret += ctStreamWrite(pStream, &pData->m_val, 1);
+    ret += ctStreamWrite(pStream, &vec.m_key, 1);
+    ret += ctStreamWrite(pStream, &vec.m_val, 1);
   }
   return ret;
 }
@@ -101,8 +101,8 @@ template<typename Key, class Val> int64_t ctStreamRead(ctReadStream *pStream, ct
   int64_t ret = 0;
   for (ctKeyValue<Key, Val> &vec : ctIterate(pData, count))
   {
-    ret += ctStreamRead(pStream, &pData->m_key, 1);
-    ret += ctStreamRead(pStream, &pData->m_val, 1);
+    ret += ctStreamRead(pStream, &vec.m_key, 1);
+    ret += ctStreamRead(pStream, &vec.m_val, 1);
   }
   return ret;
 }
@@ -0,0 +1,72 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctMemoryReader_h__
+#define ctMemoryReader_h__
+
+#include "ctVector.h"
+#include "ctReadStream.h"
+
+// Reads from a block of memory owned by the caller.
+// The memory must outlive the reader and any views returned by ReadView().
+class ctMemoryReader : public ctReadStream
+{
+public:
+  ctMemoryReader();
+  ctMemoryReader(const void *pData, const int64_t size);
+  ctMemoryReader(const ctVector<uint8_t> &data);
+
+  // Read from a different block of memory
+  void Open(const void *pData, const int64_t size);
+
+  // Reads up to size bytes. Returns the number of bytes read.
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  int64_t Peek(void *pBuffer, const int64_t size) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  // Get a pointer to the next size bytes without copying them, and move past them.
+  // Returns nullptr, without moving, if fewer than size bytes are available.
+  const uint8_t* ReadView(const int64_t size);
+
+  // Get a pointer to the next size bytes without moving past them.
+  // Returns nullptr if fewer than size bytes are available.
+  const uint8_t* PeekView(const int64_t size) const;
+
+  // Returns false, without moving, if the location is outside of the data
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+  int64_t Available() const override;
+
+  const uint8_t* Data() const;
+
+protected:
+  const uint8_t *m_pData = nullptr;
+  int64_t m_size = 0;
+  int64_t m_pos = 0;
+};
+
+template<typename T> int64_t ctMemoryReader::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
+
+#endif // ctMemoryReader_h__
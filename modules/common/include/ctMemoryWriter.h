@@ -28,7 +28,14 @@
 
 #include "ctVector.h"
 #include "ctWriteStream.h"
+#include "ctIOSlice.h"
 
+// Writes to memory.
+//
+// By default data is written to a single buffer, m_data.
+// A chunked writer stores data in a list of fixed size chunks instead, so it never
+// reallocates or copies what has already been written. The chunks can be passed
+// to gather writes with GetSlices(), or joined into m_data with Flatten().
 class ctMemoryWriter : public ctWriteStream
 {
 public:
@@ -37,10 +44,36 @@ public:
   ctMemoryWriter(const ctMemoryWriter &move);
   ~ctMemoryWriter();
 
+  // Create a chunked writer
+  explicit ctMemoryWriter(const int64_t chunkSize);
+
+  ctMemoryWriter& operator=(ctMemoryWriter &&rhs);
+  ctMemoryWriter& operator=(const ctMemoryWriter &rhs);
+
   void Clear();
+
+  bool IsChunked() const;
+  int64_t ChunkSize() const;
+
+  // Get the written data as a list of slices.
+  // The slices are invalidated by writing, Clear() and Flatten().
+  ctVector<ctIOSlice> GetSlices() const;
+
+  // Copy size bytes starting at offset into pDst.
+  // Returns the number of bytes copied.
+  int64_t CopyTo(void *pDst, const int64_t size, const int64_t offset = 0) const;
+
+  // Copy the data of a chunked writer into m_data. The writer is no longer chunked afterwards.
+  // m_data is allocated in full before any chunk is freed, so the peak memory use is twice
+  // the written size. Prefer GetSlices() with WriteV() to pass large data on without a copy.
+  void Flatten();
   bool Seek(const int64_t offset, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
 
   int64_t Write(const void *pData, const int64_t len) override;
+
+  // Grows the buffer once for all of the slices
+  int64_t WriteV(const ctIOSlice *pSlices, const int64_t count) override;
   template<typename T> int64_t Write(const T &data);
   template<typename T> int64_t Write(const T *pData, const int64_t count);
 
@@ -49,10 +82,18 @@ public:
   bool operator!=(const ctMemoryWriter &rhs);
   bool operator==(const ctMemoryWriter &rhs);
 
+  // The written data. Empty for chunked writers.
   ctVector<uint8_t> m_data;
   
 protected:
+  int64_t WriteChunked(const void *pData, const int64_t len);
+  void FreeChunks();
+
   int64_t m_pos = 0;
+
+  int64_t m_chunkSize = 0;
+  int64_t m_length = 0; // Bytes written to the chunks
+  ctVector<uint8_t*> m_chunks;
 };
 
 template<typename T> int64_t ctMemoryWriter::Write(const T *pData, const int64_t count) { return ctStreamWrite(this, pData, count); }
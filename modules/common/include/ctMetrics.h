@@ -0,0 +1,191 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctMetrics_h__
+#define ctMetrics_h__
+
+#include "ctString.h"
+#include "ctVector.h"
+#include <atomic>
+
+// Number of slots a ctMetricCounter spreads its increments across
+#define ctMETRIC_COUNTER_SHARDS 16
+
+// Number of linear sub-buckets for each power of two in a ctMetricHistogram.
+// Recorded values are accurate to within 1/ctMETRIC_HISTOGRAM_SUB_BUCKETS.
+#define ctMETRIC_HISTOGRAM_SUB_BITS 4
+#define ctMETRIC_HISTOGRAM_SUB_BUCKETS (1 << ctMETRIC_HISTOGRAM_SUB_BITS)
+#define ctMETRIC_HISTOGRAM_BUCKETS ((64 - ctMETRIC_HISTOGRAM_SUB_BITS + 1) * ctMETRIC_HISTOGRAM_SUB_BUCKETS)
+
+// A monotonic counter. Each thread increments its own cache line sized
+// shard so concurrent updates to a busy counter do not contend.
+class ctMetricCounter
+{
+public:
+  ctMetricCounter(const ctString &name);
+
+  // Add to the counter. Lock-free.
+  void Add(const int64_t amount = 1);
+
+  // Sum of all shards
+  int64_t Value() const;
+
+  void Reset();
+
+  const ctString& Name() const;
+
+protected:
+  struct alignas(ctCACHE_LINE_SIZE) Shard
+  {
+    std::atomic<int64_t> value;
+    uint8_t padding[ctCACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  };
+
+  ctString m_name;
+  Shard m_shards[ctMETRIC_COUNTER_SHARDS];
+};
+
+// A value that can move up and down, such as a queue depth
+class ctMetricGauge
+{
+public:
+  ctMetricGauge(const ctString &name);
+
+  void Set(const int64_t value);
+  void Add(const int64_t amount = 1);
+  void Sub(const int64_t amount = 1);
+
+  int64_t Value() const;
+
+  const ctString& Name() const;
+
+protected:
+  ctString m_name;
+  std::atomic<int64_t> m_value;
+};
+
+// A log-linear histogram of non-negative values, typically latencies in nanoseconds.
+// Each power of two is split into ctMETRIC_HISTOGRAM_SUB_BUCKETS linear buckets
+// so the relative error is fixed regardless of magnitude.
+class ctMetricHistogram
+{
+public:
+  ctMetricHistogram(const ctString &name);
+
+  // Record a value. Negative values are recorded as 0. Lock-free.
+  void Record(const int64_t value);
+
+  int64_t Count() const;
+  int64_t Sum() const;
+  int64_t Min() const;
+  int64_t Max() const;
+  double Mean() const;
+
+  // Get the value at the specified percentile [0, 100]
+  int64_t Percentile(const double percentile) const;
+
+  void Reset();
+
+  const ctString& Name() const;
+
+  // Get the bucket a value is recorded in
+  static int64_t BucketIndex(const int64_t value);
+
+  // Get the range of values recorded in a bucket
+  static int64_t BucketLowerBound(const int64_t bucket);
+  static int64_t BucketUpperBound(const int64_t bucket);
+
+protected:
+  ctString m_name;
+  std::atomic<int64_t> m_sum;
+  std::atomic<int64_t> m_min;
+  std::atomic<int64_t> m_max;
+  std::atomic<int64_t> m_buckets[ctMETRIC_HISTOGRAM_BUCKETS];
+};
+
+// Point in time copy of all registered metrics
+struct ctMetricsSnapshot
+{
+  struct Value
+  {
+    ctString name;
+    int64_t value = 0;
+  };
+
+  struct Distribution
+  {
+    ctString name;
+    int64_t count = 0;
+    int64_t sum = 0;
+    int64_t min = 0;
+    int64_t max = 0;
+    double mean = 0;
+    int64_t p50 = 0;
+    int64_t p90 = 0;
+    int64_t p99 = 0;
+    int64_t p999 = 0;
+  };
+
+  int64_t timestamp = 0;
+  ctVector<Value> counters;
+  ctVector<Value> gauges;
+  ctVector<Distribution> histograms;
+};
+
+// Process wide registry of named metrics.
+// Looking up a metric takes a lock, so callers should cache the returned
+// pointer. Metrics are never destroyed so the pointers remain valid.
+class ctMetrics
+{
+public:
+  ctMetrics() = delete;
+
+  // Find or create a metric with the specified name
+  static ctMetricCounter* Counter(const ctString &name);
+  static ctMetricGauge* Gauge(const ctString &name);
+  static ctMetricHistogram* Histogram(const ctString &name);
+
+  // Copy the current value of all registered metrics
+  static ctMetricsSnapshot Snapshot();
+
+  // Reset all counters and histograms. Gauges are left unchanged.
+  static void Reset();
+
+  // Monotonic time in nanoseconds, for timing values to record
+  static int64_t Timestamp();
+};
+
+// Records the time between construction and destruction in a histogram
+class ctMetricScopeTimer
+{
+public:
+  ctMetricScopeTimer(ctMetricHistogram *pHistogram);
+  ~ctMetricScopeTimer();
+
+private:
+  ctMetricHistogram *m_pHistogram;
+  int64_t m_start;
+};
+
+#endif // ctMetrics_h__
@@ -31,6 +31,64 @@
 #include "ctHashMap.h"
 #include "ctString.h"
 
+// Values up to this size are stored inside the ctObject instead of on the heap
+#define ctOBJECT_INLINE_SIZE 32
+
+// Operations for the type of value stored in a ctObject. There is one static table per type.
+struct _ctObjectOps
+{
+  const std::type_info *pType;
+  int64_t size;
+  bool isInline;
+
+  void (*copy)(void *pDst, const void *pSrc); // Copy construct pDst from pSrc
+  void (*move)(void *pDst, void *pSrc);       // Move construct pDst from pSrc
+  void (*destruct)(void *pData);
+  int64_t (*write)(ctWriteStream *pStream, const void *pData);
+  int64_t (*read)(ctReadStream *pStream, void *pData);
+};
+
+// Detects a ctStreamWrite/ctStreamRead overload for T, other than the raw byte overloads.
+// The probes below are only chosen when argument dependent lookup finds nothing better.
+namespace _ctObjectStream
+{
+  struct NoOverload {};
+
+  template<typename T> NoOverload ctStreamWrite(ctWriteStream *pStream, const T *pData, const int64_t count);
+  template<typename T> NoOverload ctStreamRead(ctReadStream *pStream, T *pData, const int64_t count);
+
+  template<typename T> struct HasOverload
+  {
+    static const bool value =
+      !std::is_same<decltype(ctStreamWrite((ctWriteStream*)nullptr, (const T*)nullptr, (int64_t)1)), NoOverload>::value &&
+      !std::is_same<decltype(ctStreamRead((ctReadStream*)nullptr, (T*)nullptr, (int64_t)1)), NoOverload>::value;
+  };
+}
+
+// How a value of type T is written to a stream.
+// Types with their own overloads use them, other trivially copyable types are copied
+// as sizeof(T) bytes, and anything else cannot be serialized (the ops are null).
+enum _ctObjectStreamMode
+{
+  _ctOSM_Overload,
+  _ctOSM_Bytes,
+  _ctOSM_None,
+};
+
+template<typename T> struct _ctObjectStreamModeFor
+{
+  static const _ctObjectStreamMode value =
+    _ctObjectStream::HasOverload<T>::value ? _ctOSM_Overload : (std::is_trivially_copyable<T>::value ? _ctOSM_Bytes : _ctOSM_None);
+};
+
+template<typename T> struct _ctObjectOpsFor
+{
+  static const bool isInline = sizeof(T) <= ctOBJECT_INLINE_SIZE && alignof(T) <= alignof(void*) && std::is_move_constructible<T>::value;
+
+  static const _ctObjectOps ops;
+};
+
+// A dynamically typed value with a set of named members
 class ctObject
 {
 public:
@@ -43,11 +101,16 @@ public:
   void Assign(ctObject &&value);
   void SetMember(const ctString &name, const ctObject &value);
   void SetMember(const ctString &name, ctObject &&value);
+
+  // Destroy the value. Members are kept.
   void Destroy();
 
   bool HasMember(const ctString &name) const;
 
+  // Get a member, adding it if it does not exist
   ctObject& GetMember(const ctString &name);
+
+  // Get an existing member
   const ctObject& GetMember(const ctString &name) const;
 
   ctObject& operator=(const ctObject &rhs);
@@ -74,10 +137,7 @@ public:
   template<typename T>
   T AsOr(const T &defVal) const;
 
-  template<typename T>
-  ctObject& operator=(const T &val);
-
-  template<typename T>
+  template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, ctObject>::value>::type>
   ctObject& operator=(T &&val);
 
   template<typename T>
@@ -86,22 +146,13 @@ public:
   template<typename T>
   bool operator!=(const T &val) const;
 
-  template<typename T>
-  ctObject(const T &val);
-
-  template<typename T>
+  template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, ctObject>::value>::type>
   ctObject(T &&val);
 
-  template<typename T>
-  void Assign(const T &value);
-
-  template<typename T>
+  template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, ctObject>::value>::type>
   void Assign(T &&value);
 
-  template<typename T>
-  void SetMember(const ctString &name, const T &value);
-
-  template<typename T>
+  template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, ctObject>::value>::type>
   void SetMember(const ctString &name, T &&value);
 
   template<typename T>
@@ -119,30 +170,34 @@ public:
   ctVector<ctString> GetMemberNames() const;
 
   friend int64_t ctStreamRead(ctReadStream *pStream, ctObject *pData, const int64_t count);
-  friend int64_t ctStreamWrite(ctWriteStream *pStream, ctObject *pData, const int64_t count);
+  friend int64_t ctStreamWrite(ctWriteStream *pStream, const ctObject *pData, const int64_t count);
 
 protected:
-  void SetType(const ctObject &obj);
-  
-  template<typename T>
-  void SetType();
+  void* Data();
+  const void* Data() const;
 
-  std::type_index m_typeInfo;
-  ctVector<uint8_t> m_data;
-  ctHashMap<ctString, ctObject> m_members;
+  // Construct a value of type T. This object must not have a value.
+  template<typename T, typename... Args>
+  void Construct(Args&&... args);
 
-  void(*m_copyFunc) (ctVector<uint8_t> *pMem, const void *) = nullptr;
-  void(*m_moveFunc) (ctVector<uint8_t> *pMem, void *) = nullptr;
-  void(*m_destructFunc) (ctVector<uint8_t> *pMem) = nullptr;
-  int64_t (*m_writeFunc) (ctWriteStream *pStream, const ctVector<uint8_t> *pSrc);
-  int64_t (*m_readFunc) (ctReadStream *pStream, ctVector<uint8_t> *pDst);
-};
+  // Move the value from src into this object. This object must not have a value.
+  void TakeValue(ctObject &src);
+
+  void Swap(ctObject &other);
 
-template<typename T> void __ctObjectDestructFunc(ctVector<uint8_t> *pMem);
-template<typename T> void __ctObjectCopyFunc(ctVector<uint8_t> *pMem, const void *pData);
-template<typename T> void __ctObjectMoveFunc(ctVector<uint8_t> *pMem, void *pData);
-template<typename T> int64_t ctObjectWriteFunc(ctWriteStream *pStream, ctVector<uint8_t> *pData);
-template<typename T> int64_t ctObjectReadFunc(ctReadStream *pRead, ctVector<uint8_t> *pData);
+  ctHashMap<ctString, ctObject>& Members();
+
+  const _ctObjectOps *m_pOps = nullptr;
+
+  union Storage
+  {
+    uint8_t buffer[ctOBJECT_INLINE_SIZE];
+    void *pHeap;
+  } m_storage;
+
+  // Only allocated once a member is added
+  ctHashMap<ctString, ctObject> *m_pMembers = nullptr;
+};
 
 #include "ctObject.inl"
 #endif // atObject_h__
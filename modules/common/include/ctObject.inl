@@ -24,16 +24,70 @@
 // THE SOFTWARE.
 // -----------------------------------------------------------------------------
 
+//**************
+// Type ops
+//**************
+
+template<typename T>
+inline void _ctObjectCopy(void *pDst, const void *pSrc) { ctConstruct((T*)pDst, *(const T*)pSrc); }
+
+template<typename T>
+inline void _ctObjectMove(void *pDst, void *pSrc) { ctConstruct((T*)pDst, std::move(*(T*)pSrc)); }
+
+template<typename T>
+inline void _ctObjectDestruct(void *pData) { ctDestruct((T*)pData); }
+
+template<typename T, _ctObjectStreamMode mode = _ctObjectStreamModeFor<T>::value> struct _ctObjectStreamOps
+{
+  static int64_t Write(ctWriteStream *pStream, const void *pData) { return ctStreamWrite(pStream, (const T*)pData, 1); }
+  static int64_t Read(ctReadStream *pStream, void *pData) { return ctStreamRead(pStream, (T*)pData, 1); }
+
+  static constexpr int64_t (*write)(ctWriteStream*, const void*) = Write;
+  static constexpr int64_t (*read)(ctReadStream*, void*) = Read;
+};
+
+template<typename T> struct _ctObjectStreamOps<T, _ctOSM_Bytes>
+{
+  static int64_t Write(ctWriteStream *pStream, const void *pData) { return ctStreamWrite(pStream, pData, (int64_t)sizeof(T)); }
+  static int64_t Read(ctReadStream *pStream, void *pData) { return ctStreamRead(pStream, pData, (int64_t)sizeof(T)); }
+
+  static constexpr int64_t (*write)(ctWriteStream*, const void*) = Write;
+  static constexpr int64_t (*read)(ctReadStream*, void*) = Read;
+};
+
+template<typename T> struct _ctObjectStreamOps<T, _ctOSM_None>
+{
+  static constexpr int64_t (*write)(ctWriteStream*, const void*) = nullptr;
+  static constexpr int64_t (*read)(ctReadStream*, void*) = nullptr;
+};
+
+template<typename T>
+const _ctObjectOps _ctObjectOpsFor<T>::ops =
+{
+  &typeid(T),
+  (int64_t)sizeof(T),
+  _ctObjectOpsFor<T>::isInline,
+  _ctObjectCopy<T>,
+  _ctObjectMove<T>,
+  _ctObjectDestruct<T>,
+  _ctObjectStreamOps<T>::write,
+  _ctObjectStreamOps<T>::read
+};
+
+//**********
+// ctObject
+//**********
+
 template<typename T>
 inline bool ctObject::Is() const
 {
-  return m_typeInfo == typeid(T);
+  return (m_pOps ? *m_pOps->pType : typeid(void)) == typeid(T);
 }
 
 template<typename T>
 inline const typename std::enable_if<!std::is_void<T>::value, T>::type& ctObject::As() const
 {
-  return *(T*)m_data.data();
+  return *(const T*)Data();
 }
 
 template<typename T>
@@ -42,7 +96,7 @@ inline typename std::enable_if<std::is_void<T>::value, T>::type ctObject::As() c
 template<typename T>
 inline typename std::enable_if<!std::is_void<T>::value, T>::type &ctObject::As()
 {
-  return *(T *)m_data.data();
+  return *(T*)Data();
 }
 
 template<typename T>
@@ -56,17 +110,10 @@ inline T ctObject::AsOr(const T &defVal) const
   return As<T>();
 }
 
-template<typename T>
-inline ctObject& ctObject::operator=(const T &val)
-{
-  Assign(val);
-  return *this;
-}
-
-template<typename T>
+template<typename T, typename>
 inline ctObject& ctObject::operator=(T &&val)
 {
-  Assign(val);
+  Assign(std::forward<T>(val));
   return *this;
 }
 
@@ -82,81 +129,38 @@ inline bool ctObject::operator!=(const T &val) const
   return !(*this == val);
 }
 
-template<typename T>
-inline ctObject::ctObject(const T &val)
-  : ctObject()
-{
-  Assign(val);
-}
-
-template<typename T>
+template<typename T, typename>
 inline ctObject::ctObject(T &&val)
-  : ctObject()
-{
-  Assign(std::forward<T>(val));
-}
-
-template<typename T>
-inline void ctObject::Assign(const T &value)
 {
-  SetType<T>();
-  m_copyFunc(&m_data, &value);
+  Construct<typename std::decay<T>::type>(std::forward<T>(val));
 }
 
-template<typename T>
+template<typename T, typename>
 inline void ctObject::Assign(T &&value)
 {
-  SetType<T>();
-  m_moveFunc(&m_data, &value);
-}
-
-template<typename T>
-inline void ctObject::SetMember(const ctString &name, const T &value)
-{
-  SetMember(name, ctObject(value));
-}
-
-template<typename T>
-inline void ctObject::SetMember(const ctString &name, T &&value)
-{
-  SetMember(name, ctObject(std::move(value)));
-}
-
-inline void ctObject::SetType(const ctObject &obj)
-{
-  if (obj.m_typeInfo == m_typeInfo)
-    return;
-
+  // Construct the new value before destroying the old one, as value may be part of it
+  ctObject tmp;
+  tmp.Construct<typename std::decay<T>::type>(std::forward<T>(value));
   Destroy();
-  m_typeInfo = obj.m_typeInfo;
-  m_moveFunc = obj.m_moveFunc;
-  m_copyFunc = obj.m_copyFunc;
-  m_destructFunc = obj.m_destructFunc;
-  m_data.reserve(obj.m_data.size());
+  TakeValue(tmp);
 }
 
-template<typename T>
-inline void __ctObjectDestructFunc(ctVector<uint8_t> *pMem)
+template<typename T, typename>
+inline void ctObject::SetMember(const ctString &name, T &&value)
 {
-  T* pObj = (T*)pMem->data();
-  pObj->~T();
-  pMem->clear();
+  Members().GetOrAdd(name).Assign(std::forward<T>(value));
 }
 
 template<typename T>
-inline void __ctObjectCopyFunc(ctVector<uint8_t> *pMem, const void *pData)
+inline T& ctObject::GetMember(const ctString &name)
 {
-  const T* pSrc = (const T*)pData;
-  T* pDst = (T*)pMem->data();
-  new (pDst)T(*pSrc);
+  return GetMember(name).As<T>();
 }
 
 template<typename T>
-inline void __ctObjectMoveFunc(ctVector<uint8_t> *pMem, void *pData)
+inline const T& ctObject::GetMember(const ctString &name) const
 {
-  T* pSrc = (T*)pData;
-  T* pDst = (T*)pMem->data();
-  new (pDst)T(std::move(*pSrc));
+  return GetMember(name).As<T>();
 }
 
 template<typename T>
@@ -167,21 +171,16 @@ T ctObject::GetMemberOr(const ctString &name, const T &defVal) const
   return GetMember(name).AsOr<T>(defVal);
 }
 
-template<typename T>
-inline void ctObjectWriteFunc(ctWriteStream *pStream, ctVector<uint8_t> *pData) { return ctStreamWrite(pStream, (T*)pData->data(), 1); }
+inline void* ctObject::Data() { return m_pOps && !m_pOps->isInline ? m_storage.pHeap : m_storage.buffer; }
+inline const void* ctObject::Data() const { return m_pOps && !m_pOps->isInline ? m_storage.pHeap : m_storage.buffer; }
 
-template<typename T>
-inline void ctObjectReadFunc(ctReadStream *pStream, ctVector<uint8_t> *pData) { return ctStreamRead(pStream, (T*)pData->data(), 1); }
-template<typename T>
-inline void ctObject::SetType()
+template<typename T, typename... Args>
+inline void ctObject::Construct(Args&&... args)
 {
-  if (Is<T>())
-    return;
-
-  Destroy();
-  m_destructFunc = __ctObjectDestructFunc<std::decay_t<T>>;
-  m_copyFunc = __ctObjectCopyFunc<std::decay_t<T>>;
-  m_moveFunc = __ctObjectMoveFunc<std::decay_t<T>>;
-  m_typeInfo = typeid(T);
-  m_data.resize(sizeof(T));
+  const _ctObjectOps *pOps = &_ctObjectOpsFor<T>::ops;
+  T *pValue = pOps->isInline ? (T*)m_storage.buffer : (T*)ctAlloc(sizeof(T));
+  ctConstruct(pValue, std::forward<Args>(args)...);
+  if (!pOps->isInline)
+    m_storage.pHeap = pValue;
+  m_pOps = pOps;
 }
@@ -0,0 +1,89 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctParallel_h__
+#define ctParallel_h__
+
+#include "ctJobSystem.h"
+
+// Parallel algorithms built on ctJobSystem.
+//
+// Work is split into chunks of 'grain' items which are executed as jobs. The calling
+// thread helps execute the chunks and returns once all of them have completed.
+// Passing a grain <= 0 selects a grain size automatically.
+// If pJobs is null the global job system is used.
+
+// Get the grain size used when one is not specified
+int64_t ctParallelGrainSize(const int64_t count, ctJobSystem *pJobs = nullptr);
+
+// Call fn(i) for each i in [begin, end)
+template<typename Func> void ctParallelFor(const int64_t begin, const int64_t end, const int64_t grain, Func &&fn, ctJobSystem *pJobs = nullptr);
+
+// Call fn(item) for each item in the range
+template<typename T, typename Func> void ctParallelFor(T *pBegin, T *pEnd, const int64_t grain, Func &&fn, ctJobSystem *pJobs = nullptr);
+template<typename T, typename Func> void ctParallelFor(ctVector<T> &vec, const int64_t grain, Func &&fn, ctJobSystem *pJobs = nullptr);
+template<typename T, typename Func> void ctParallelFor(const ctVector<T> &vec, const int64_t grain, Func &&fn, ctJobSystem *pJobs = nullptr);
+
+// Reduce map(i) for each i in [begin, end) using reduce(a, b).
+// 'identity' must satisfy reduce(identity, x) == x.
+// If deterministic is true the range is partitioned independently of the number of
+// workers and partial results are combined in index order, so results are identical
+// across runs and machines (important for floating point sums). Otherwise partial
+// results are combined in the order they complete.
+template<typename T, typename MapFunc, typename ReduceFunc>
+T ctParallelReduce(const int64_t begin, const int64_t end, const int64_t grain, const T &identity, MapFunc &&map, ReduceFunc &&reduce, const bool deterministic = false, ctJobSystem *pJobs = nullptr);
+
+// Reduce a range of values using reduce(a, b)
+template<typename T, typename ReduceFunc>
+T ctParallelReduce(const T *pBegin, const T *pEnd, const T &identity, ReduceFunc &&reduce, const bool deterministic = false, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+template<typename T, typename ReduceFunc>
+T ctParallelReduce(const ctVector<T> &vec, const T &identity, ReduceFunc &&reduce, const bool deterministic = false, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+
+// Write fn(pSrc[i]) to pDst[i] for each item in the range.
+// pDst must have space for 'count' items and may alias pSrc.
+template<typename T, typename T2, typename Func>
+void ctParallelTransform(const T *pSrc, T2 *pDst, const int64_t count, Func &&fn, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+
+// Resizes pDst to the size of src
+template<typename T, typename T2, typename Func>
+void ctParallelTransform(const ctVector<T> &src, ctVector<T2> *pDst, Func &&fn, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+
+// Prefix scans using the associative operation op(a, b).
+// An inclusive scan writes op(pSrc[0], ..., pSrc[i]) to pDst[i].
+// An exclusive scan writes op(init, pSrc[0], ..., pSrc[i - 1]) to pDst[i].
+// pDst must have space for 'count' items and may alias pSrc.
+template<typename T, typename Func>
+void ctParallelInclusiveScan(const T *pSrc, T *pDst, const int64_t count, Func &&op, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+template<typename T, typename Func>
+void ctParallelExclusiveScan(const T *pSrc, T *pDst, const int64_t count, const T &init, Func &&op, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+
+// Resizes pDst to the size of src
+template<typename T, typename Func>
+void ctParallelInclusiveScan(const ctVector<T> &src, ctVector<T> *pDst, Func &&op, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+template<typename T, typename Func>
+void ctParallelExclusiveScan(const ctVector<T> &src, ctVector<T> *pDst, const T &init, Func &&op, const int64_t grain = 0, ctJobSystem *pJobs = nullptr);
+
+#include "ctParallel.inl"
+
+#endif // ctParallel_h__
@@ -0,0 +1,223 @@
+#include "ctParallel.h"
+
+// Number of chunks a range is split into when a deterministic partition is required
+static const int64_t _ctParallelDeterministicChunks = 64;
+
+inline ctJobSystem* _ctParallelJobs(ctJobSystem *pJobs) { return pJobs ? pJobs : ctJobSystem::Global(); }
+
+inline int64_t _ctParallelGrain(const int64_t count, const int64_t grain, ctJobSystem *pJobs)
+{
+  return grain > 0 ? grain : ctParallelGrainSize(count, pJobs);
+}
+
+// Call fn(chunk, begin, end) for each chunk of 'grain' items in [0, count).
+// The first chunk runs on the calling thread.
+template<typename Func>
+inline void _ctParallelForChunks(const int64_t count, const int64_t grain, ctJobSystem *pJobs, Func &&fn)
+{
+  if (count <= 0)
+    return;
+
+  int64_t chunkCount = (count + grain - 1) / grain;
+  if (chunkCount == 1 || pJobs->WorkerCount() == 0)
+  {
+    for (int64_t chunk = 0; chunk < chunkCount; ++chunk)
+      fn(chunk, chunk * grain, ctMin(count, (chunk + 1) * grain));
+    return;
+  }
+
+  // Jobs only capture a pointer to the chunk function, so they are cheap to create
+  auto runChunk = [&](const int64_t chunk) { fn(chunk, chunk * grain, ctMin(count, (chunk + 1) * grain)); };
+  auto *pRunChunk = &runChunk;
+
+  ctJobCounter counter;
+  for (int64_t chunk = 1; chunk < chunkCount; ++chunk)
+    pJobs->Run([pRunChunk, chunk]() { (*pRunChunk)(chunk); }, &counter);
+
+  runChunk(0);
+  pJobs->Wait(&counter);
+}
+
+template<typename Func>
+inline void ctParallelFor(const int64_t begin, const int64_t end, const int64_t grain, Func &&fn, ctJobSystem *pJobs)
+{
+  pJobs = _ctParallelJobs(pJobs);
+  int64_t count = end - begin;
+  _ctParallelForChunks(count, _ctParallelGrain(count, grain, pJobs), pJobs,
+    [&](const int64_t, const int64_t chunkBegin, const int64_t chunkEnd)
+    {
+      for (int64_t i = begin + chunkBegin; i < begin + chunkEnd; ++i)
+        fn(i);
+    });
+}
+
+template<typename T, typename Func>
+inline void ctParallelFor(T *pBegin, T *pEnd, const int64_t grain, Func &&fn, ctJobSystem *pJobs)
+{
+  ctParallelFor(0, pEnd - pBegin, grain, [&](const int64_t i) { fn(pBegin[i]); }, pJobs);
+}
+
+template<typename T, typename Func>
+inline void ctParallelFor(ctVector<T> &vec, const int64_t grain, Func &&fn, ctJobSystem *pJobs)
+{
+  ctParallelFor(vec.begin(), vec.end(), grain, std::forward<Func>(fn), pJobs);
+}
+
+template<typename T, typename Func>
+inline void ctParallelFor(const ctVector<T> &vec, const int64_t grain, Func &&fn, ctJobSystem *pJobs)
+{
+  ctParallelFor(vec.begin(), vec.end(), grain, std::forward<Func>(fn), pJobs);
+}
+
+template<typename T, typename MapFunc, typename ReduceFunc>
+inline T ctParallelReduce(const int64_t begin, const int64_t end, const int64_t grain, const T &identity, MapFunc &&map, ReduceFunc &&reduce, const bool deterministic, ctJobSystem *pJobs)
+{
+  pJobs = _ctParallelJobs(pJobs);
+  int64_t count = end - begin;
+  if (count <= 0)
+    return identity;
+
+  int64_t chunkGrain = grain;
+  if (chunkGrain <= 0)
+    chunkGrain = deterministic ? ctMax((count + _ctParallelDeterministicChunks - 1) / _ctParallelDeterministicChunks, (int64_t)1) : ctParallelGrainSize(count, pJobs);
+
+  auto reduceChunk = [&](const int64_t chunkBegin, const int64_t chunkEnd)
+  {
+    T result = identity;
+    for (int64_t i = begin + chunkBegin; i < begin + chunkEnd; ++i)
+      result = reduce(result, map(i));
+    return result;
+  };
+
+  if (deterministic)
+  {
+    ctVector<T> partials((count + chunkGrain - 1) / chunkGrain, identity);
+    _ctParallelForChunks(count, chunkGrain, pJobs, [&](const int64_t chunk, const int64_t chunkBegin, const int64_t chunkEnd) {
+      partials[chunk] = reduceChunk(chunkBegin, chunkEnd);
+    });
+
+    T result = identity;
+    for (const T &partial : partials)
+      result = reduce(result, partial);
+    return result;
+  }
+
+  std::mutex resultLock;
+  T result = identity;
+  _ctParallelForChunks(count, chunkGrain, pJobs, [&](const int64_t, const int64_t chunkBegin, const int64_t chunkEnd) {
+    T partial = reduceChunk(chunkBegin, chunkEnd);
+    std::unique_lock<std::mutex> lock(resultLock);
+    result = reduce(result, partial);
+  });
+  return result;
+}
+
+template<typename T, typename ReduceFunc>
+inline T ctParallelReduce(const T *pBegin, const T *pEnd, const T &identity, ReduceFunc &&reduce, const bool deterministic, const int64_t grain, ctJobSystem *pJobs)
+{
+  return ctParallelReduce(0, pEnd - pBegin, grain, identity, [pBegin](const int64_t i) -> const T& { return pBegin[i]; }, std::forward<ReduceFunc>(reduce), deterministic, pJobs);
+}
+
+template<typename T, typename ReduceFunc>
+inline T ctParallelReduce(const ctVector<T> &vec, const T &identity, ReduceFunc &&reduce, const bool deterministic, const int64_t grain, ctJobSystem *pJobs)
+{
+  return ctParallelReduce(vec.begin(), vec.end(), identity, std::forward<ReduceFunc>(reduce), deterministic, grain, pJobs);
+}
+
+template<typename T, typename T2, typename Func>
+inline void ctParallelTransform(const T *pSrc, T2 *pDst, const int64_t count, Func &&fn, const int64_t grain, ctJobSystem *pJobs)
+{
+  ctParallelFor(0, count, grain, [&](const int64_t i) { pDst[i] = fn(pSrc[i]); }, pJobs);
+}
+
+template<typename T, typename T2, typename Func>
+inline void ctParallelTransform(const ctVector<T> &src, ctVector<T2> *pDst, Func &&fn, const int64_t grain, ctJobSystem *pJobs)
+{
+  pDst->resize(src.size());
+  ctParallelTransform(src.data(), pDst->data(), src.size(), std::forward<Func>(fn), grain, pJobs);
+}
+
+// Scan each chunk in parallel, then offset each chunk by the combined result of the chunks before it.
+// pInit is the value the first item is combined with, or null for an inclusive scan.
+template<typename T, typename Func>
+inline void _ctParallelScan(const T *pSrc, T *pDst, const int64_t count, const T *pInit, Func &&op, const int64_t grain, ctJobSystem *pJobs)
+{
+  if (count <= 0)
+    return;
+
+  pJobs = _ctParallelJobs(pJobs);
+  int64_t chunkGrain = _ctParallelGrain(count, grain, pJobs);
+  int64_t chunkCount = (count + chunkGrain - 1) / chunkGrain;
+
+  // Combined value of each chunk, excluding the last which is never needed
+  ctVector<T> offsets(chunkCount, pSrc[0]);
+  if (chunkCount > 1)
+  {
+    _ctParallelForChunks((chunkCount - 1) * chunkGrain, chunkGrain, pJobs, [&](const int64_t chunk, const int64_t chunkBegin, const int64_t chunkEnd) {
+      T sum = pSrc[chunkBegin];
+      for (int64_t i = chunkBegin + 1; i < chunkEnd; ++i)
+        sum = op(sum, pSrc[i]);
+      offsets[chunk + 1] = sum;
+    });
+
+    // offsets[chunk] becomes the combination of all items before the chunk
+    for (int64_t chunk = 2; chunk < chunkCount; ++chunk)
+      offsets[chunk] = op(offsets[chunk - 1], offsets[chunk]);
+    if (pInit)
+      for (int64_t chunk = 1; chunk < chunkCount; ++chunk)
+        offsets[chunk] = op(*pInit, offsets[chunk]);
+  }
+
+  _ctParallelForChunks(count, chunkGrain, pJobs, [&](const int64_t chunk, const int64_t chunkBegin, const int64_t chunkEnd) {
+    int64_t i = chunkBegin;
+    T sum = chunk > 0 ? offsets[chunk] : (pInit ? *pInit : pSrc[i]);
+    if (pInit)
+    { // Exclusive
+      for (; i < chunkEnd; ++i)
+      {
+        T value = pSrc[i];
+        pDst[i] = sum;
+        sum = op(sum, value);
+      }
+    }
+    else
+    { // Inclusive
+      if (chunk > 0)
+        sum = op(sum, pSrc[i]);
+      pDst[i++] = sum;
+      for (; i < chunkEnd; ++i)
+      {
+        sum = op(sum, pSrc[i]);
+        pDst[i] = sum;
+      }
+    }
+  });
+}
+
+template<typename T, typename Func>
+inline void ctParallelInclusiveScan(const T *pSrc, T *pDst, const int64_t count, Func &&op, const int64_t grain, ctJobSystem *pJobs)
+{
+  _ctParallelScan(pSrc, pDst, count, (const T*)nullptr, std::forward<Func>(op), grain, pJobs);
+}
+
+template<typename T, typename Func>
+inline void ctParallelExclusiveScan(const T *pSrc, T *pDst, const int64_t count, const T &init, Func &&op, const int64_t grain, ctJobSystem *pJobs)
+{
+  _ctParallelScan(pSrc, pDst, count, &init, std::forward<Func>(op), grain, pJobs);
+}
+
+template<typename T, typename Func>
+inline void ctParallelInclusiveScan(const ctVector<T> &src, ctVector<T> *pDst, Func &&op, const int64_t grain, ctJobSystem *pJobs)
+{
+  if (pDst != &src)
+    pDst->resize(src.size());
+  ctParallelInclusiveScan(src.data(), pDst->data(), src.size(), std::forward<Func>(op), grain, pJobs);
+}
+
+template<typename T, typename Func>
+inline void ctParallelExclusiveScan(const ctVector<T> &src, ctVector<T> *pDst, const T &init, Func &&op, const int64_t grain, ctJobSystem *pJobs)
+{
+  if (pDst != &src)
+    pDst->resize(src.size());
+  ctParallelExclusiveScan(src.data(), pDst->data(), src.size(), init, std::forward<Func>(op), grain, pJobs);
+}
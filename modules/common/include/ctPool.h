@@ -26,6 +26,7 @@
 // -----------------------------------------------------------------------------
 
 #include "ctVector.h"
+#include "ctMetrics.h"
 
 template<typename T> class ctPool
 {
@@ -88,6 +89,15 @@ public:
 
   // Construct a pool with the specified initial capacity
   ctPool(const int64_t &capacity = 1);
+  ctPool(const ctPool &copy);
+  ctPool(ctPool &&move);
+  ~ctPool();
+
+  ctPool& operator=(const ctPool &rhs);
+  ctPool& operator=(ctPool &&rhs);
+
+  // Destroy all items and release the pools memory
+  void clear();
 
   // Get the number of the items in the pool
   const int64_t& size() const;
@@ -127,6 +137,10 @@ protected:
   bool TryGrow(const int64_t &requiredCapacity);
   bool Grow(const int64_t &capacity);
   int64_t GetNextAvailSlot();
+
+  // Occupancy metrics shared by all pools
+  static ctMetricGauge* ItemsMetric();
+  static ctMetricGauge* ReservedBytesMetric();
   
   T *m_pData;
   int64_t m_capacity;
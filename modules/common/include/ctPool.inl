@@ -9,6 +9,76 @@ inline ctPool<T>::ctPool(const int64_t &capacity)
   TryGrow(capacity);
 }
 
+template<typename T>
+inline ctPool<T>::ctPool(const ctPool &copy)
+  : ctPool(0)
+{
+  *this = copy;
+}
+
+template<typename T>
+inline ctPool<T>::ctPool(ctPool &&move)
+  : ctPool(0)
+{
+  *this = std::move(move);
+}
+
+template<typename T>
+inline ctPool<T>::~ctPool() { clear(); }
+
+template<typename T>
+inline ctPool<T>& ctPool<T>::operator=(const ctPool &rhs)
+{
+  if (&rhs == this)
+    return *this;
+
+  clear();
+  if (!Grow(rhs.m_capacity))
+    return *this;
+
+  // Keep the same slots so indices stay valid in the copy
+  for (int64_t i = 0; i < rhs.m_capacity; ++i)
+    if (rhs.m_usedFlags[i])
+      ctUninitializedFillArray(m_pData + i, 1, rhs.m_pData[i]);
+  m_usedFlags = rhs.m_usedFlags;
+  m_freeSlots = rhs.m_freeSlots;
+  m_size = rhs.m_size;
+  ItemsMetric()->Add(m_size);
+  return *this;
+}
+
+template<typename T>
+inline ctPool<T>& ctPool<T>::operator=(ctPool &&rhs)
+{
+  if (&rhs == this)
+    return *this;
+
+  clear();
+  std::swap(m_pData, rhs.m_pData);
+  std::swap(m_capacity, rhs.m_capacity);
+  std::swap(m_size, rhs.m_size);
+  std::swap(m_usedFlags, rhs.m_usedFlags);
+  std::swap(m_freeSlots, rhs.m_freeSlots);
+  return *this;
+}
+
+template<typename T>
+inline void ctPool<T>::clear()
+{
+  for (int64_t i = 0; i < m_capacity; ++i)
+    if (m_usedFlags[i])
+      ctDestructArray(m_pData + i, 1);
+
+  ItemsMetric()->Sub(m_size);
+  ReservedBytesMetric()->Sub(m_capacity * sizeof(T));
+  ctFree(m_pData);
+  m_pData = nullptr;
+  m_capacity = 0;
+  m_size = 0;
+  m_usedFlags.clear();
+  m_freeSlots.clear();
+}
+
 template<typename T>
 inline const int64_t& ctPool<T>::size() const
 {
@@ -57,9 +127,11 @@ inline bool ctPool<T>::erase(const int64_t &index)
   if (!m_usedFlags[index])
     return false;
 
-  ctDestructArray(m_pData, 1);
+  ctDestructArray(m_pData + index, 1);
   m_freeSlots.push_back(index);
   m_usedFlags[index] = false;
+  --m_size;
+  ItemsMetric()->Sub();
   return true;
 }
 
@@ -98,6 +170,7 @@ inline bool ctPool<T>::Grow(const int64_t &capacity)
 
   ctFree(m_pData);
 
+  ReservedBytesMetric()->Add((capacity - m_capacity) * sizeof(T));
   m_capacity = capacity;
   m_usedFlags.resize(capacity, false);
   m_pData = pNewMem;
@@ -117,6 +190,20 @@ inline int64_t ctPool<T>::GetNextAvailSlot()
   return m_size;
 }
 
+template<typename T>
+inline ctMetricGauge* ctPool<T>::ItemsMetric()
+{
+  static ctMetricGauge *pGauge = ctMetrics::Gauge("ctPool.items");
+  return pGauge;
+}
+
+template<typename T>
+inline ctMetricGauge* ctPool<T>::ReservedBytesMetric()
+{
+  static ctMetricGauge *pGauge = ctMetrics::Gauge("ctPool.reservedBytes");
+  return pGauge;
+}
+
 template<typename T>
 template<typename ...Args>
 inline int64_t ctPool<T>::emplace(Args&&... args)
@@ -126,6 +213,7 @@ inline int64_t ctPool<T>::emplace(Args&&... args)
     return -1;
 
   ++m_size;
+  ItemsMetric()->Add();
   ctUninitializedFillArray(m_pData + slot, 1, T(std::forward<Args>(args)...));
   m_usedFlags[slot] = true;
   return slot;
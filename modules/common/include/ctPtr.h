@@ -7,22 +7,71 @@
 #include "ctHash.h"
 #include "ctMemory.h"
 
-template<typename T> class ctPtr
+// Reference count that can be shared between threads
+class ctAtomicRefCount
 {
+public:
+  ctAtomicRefCount(const int64_t count = 0);
+
+  int64_t Increment();
+  int64_t Decrement();
+  int64_t Get() const;
+
 protected:
-  struct Instance
+  std::atomic<int64_t> m_count;
+};
+
+// Reference count for pointers that are only used by one thread at a time
+class ctLocalRefCount
+{
+public:
+  ctLocalRefCount(const int64_t count = 0);
+
+  int64_t Increment();
+  int64_t Decrement();
+  int64_t Get() const;
+
+protected:
+  int64_t m_count;
+};
+
+template<typename T, typename RefCount = ctAtomicRefCount> class ctPtr
+{
+protected:
+  // Optional callbacks. Only allocated if one is set.
+  struct Callbacks
   {
-    T *pData = nullptr;                 // Raw pointer
-    bool isForeign = false;             // Was this created by atPtr
-    std::atomic<int64_t> refCount;      // How many references are there
-    std::function<void(T *)> onDelete;  // What to do when deleting the pointer
+    std::function<void(T *)> onDelete;           // What to do when deleting the pointer
     std::function<void(T *, int64_t)> onRelease; // What to do when releasing a reference to the pointer
     std::function<void(T *, int64_t)> onAcquire; // What to do when acquiring a reference to the pointer
+  };
+
+  struct Instance
+  {
+    T *pData = nullptr;                       // Raw pointer
+    RefCount refCount;                        // How many references are there
+    bool isForeign = false;                   // Was pData allocated outside of ctPtr
+    void (*deleteData)(T *) = nullptr;        // Default delete for foreign pointers
+    void (*free)(Instance *) = nullptr;       // Frees this instance, and the object if it was allocated with it
+    Callbacks *pCallbacks = nullptr;
   } *m_pInstance = nullptr;
 
+  // An instance allocated together with the object it points to
+  template<typename U> struct InlineInstance : public Instance
+  {
+    template<typename... Args> InlineInstance(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    U value;
+  };
+
 public:
-  ctPtr(T *pPtr = nullptr,
-    std::function<void(T *)> onDelete = [](T *pPtr) { ctDelete(pPtr); },
+  // Take ownership of pPtr. It is deleted using ctDelete.
+  ctPtr(T *pPtr = nullptr);
+
+  // Take ownership of pPtr with custom callbacks.
+  // If onDelete is null pPtr is not deleted.
+  ctPtr(T *pPtr,
+    std::function<void(T *)> onDelete,
     std::function<void(T *, int64_t)> onRelease = nullptr,
     std::function<void(T *, int64_t)> onAcquire = nullptr);
 
@@ -30,12 +79,14 @@ public:
 
   ctPtr(T &&o);
   ctPtr(const T &o);
-  ctPtr(ctPtr<T> &&o);
-  ctPtr(const ctPtr<T> &o);
+  ctPtr(ctPtr &&o);
+  ctPtr(const ctPtr &o);
 
   // Create a pointer to a derived type
-  template<typename T2> explicit ctPtr(T2 &&o);
-  template<typename T2> explicit ctPtr(const T2 &o);
+  template<typename T2, typename = typename std::enable_if<std::is_base_of<T, typename std::decay<T2>::type>::value>::type> explicit ctPtr(T2 &&o);
+  template<typename T2, typename = typename std::enable_if<std::is_base_of<T, T2>::value>::type> explicit ctPtr(const T2 &o);
+
+  ~ctPtr();
 
   T* Get();
   T* operator->();
@@ -45,25 +96,25 @@ public:
   const T* operator->() const;
   const T& operator*() const;
 
-  ctPtr<T> &operator=(T *pPtr);
-  ctPtr<T>& operator=(ctPtr<T> &&rhs);
-  ctPtr<T>& operator=(const ctPtr<T> &rhs);
+  ctPtr &operator=(T *pPtr);
+  ctPtr& operator=(ctPtr &&rhs);
+  ctPtr& operator=(const ctPtr &rhs);
 
   operator bool() const;
   bool operator==(const T *pRhs) const;
   bool operator==(const std::nullptr_t &rhs) const;
-  bool operator==(const ctPtr<T> &rhs) const;
+  bool operator==(const ctPtr &rhs) const;
   bool operator!=(const T *pRhs) const;
   bool operator!=(const std::nullptr_t &rhs) const;
-  bool operator!=(const ctPtr<T> &rhs) const;
+  bool operator!=(const ctPtr &rhs) const;
   bool operator<(const T *pRhs) const;
-  bool operator<(const ctPtr<T> &rhs) const;
+  bool operator<(const ctPtr &rhs) const;
   bool operator>(const T *pRhs) const;
-  bool operator>(const ctPtr<T> &rhs) const;
+  bool operator>(const ctPtr &rhs) const;
   bool operator<=(const T *pRhs) const;
-  bool operator<=(const ctPtr<T> &rhs) const;
+  bool operator<=(const ctPtr &rhs) const;
   bool operator>=(const T *pRhs) const;
-  bool operator>=(const ctPtr<T> &rhs) const;
+  bool operator>=(const ctPtr &rhs) const;
 
   // Get the number of references to this pointer
   int64_t GetReferenceCount() const;
@@ -94,18 +145,34 @@ public:
 
   // Take ownership of the internal pointer.
   // This will set all atPtr's with this reference to null.
+  // Returns nullptr if the object was allocated by ctPtr, as it shares
+  // an allocation with the reference count.
   T* TakePtr();
 
-  template<typename U> friend int64_t atHash(const ctPtr<U> &o);
+  template<typename U, typename R> friend int64_t ctHash(const ctPtr<U, R> &o);
+  template<typename U, typename R, typename... Args> friend ctPtr<U, R> ctMakePtr(Args&&... args);
 
 protected:
   void Release();
   void Acquire(Instance *pInstance);
-  void Create(T *pData, bool isForeign,
-    std::function<void(T *)> onDelete,
-    std::function<void(T *, int64_t)> onRelease,
-    std::function<void(T *, int64_t)> onAcquire);
+  void Create(T *pData, void (*deleteData)(T *));
+  template<typename U, typename... Args> void CreateInline(Args&&... args);
+
+  Callbacks* GetCallbacks();
+
+  static void DeleteData(T *pData);
+  static void FreeInstance(Instance *pInstance);
+  template<typename U> static void FreeInlineInstance(Instance *pInstance);
 };
 
+// A ctPtr for objects that are only referenced by one thread at a time
+template<typename T> using ctLocalPtr = ctPtr<T, ctLocalRefCount>;
+
+// Create an object and its reference count in a single allocation
+template<typename T, typename RefCount = ctAtomicRefCount, typename... Args> ctPtr<T, RefCount> ctMakePtr(Args&&... args);
+
+// Create an object for a ctLocalPtr in a single allocation
+template<typename T, typename... Args> ctLocalPtr<T> ctMakeLocalPtr(Args&&... args);
+
 #include "ctPtr.inl"
 #endif // atPtr_h__
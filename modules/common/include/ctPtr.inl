@@ -1,149 +1,192 @@
+//******************
+// Reference counts
+//******************
 
-template<typename T>
-inline ctPtr<T>::ctPtr(T *pPtr, std::function<void(T *)> onDelete,
+inline ctAtomicRefCount::ctAtomicRefCount(const int64_t count) : m_count(count) {}
+
+// New references are made from existing ones so the increment does not need to synchronise.
+// The final decrement synchronises with every other release before the object is deleted.
+inline int64_t ctAtomicRefCount::Increment() { return m_count.fetch_add(1, std::memory_order_relaxed) + 1; }
+inline int64_t ctAtomicRefCount::Decrement() { return m_count.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+inline int64_t ctAtomicRefCount::Get() const { return m_count.load(std::memory_order_relaxed); }
+
+inline ctLocalRefCount::ctLocalRefCount(const int64_t count) : m_count(count) {}
+inline int64_t ctLocalRefCount::Increment() { return ++m_count; }
+inline int64_t ctLocalRefCount::Decrement() { return --m_count; }
+inline int64_t ctLocalRefCount::Get() const { return m_count; }
+
+//*******
+// ctPtr
+//*******
+
+template<typename T, typename RefCount>
+inline ctPtr<T, RefCount>::ctPtr(T *pPtr)
+{
+  if (pPtr)
+    Create(pPtr, DeleteData);
+}
+
+template<typename T, typename RefCount>
+inline ctPtr<T, RefCount>::ctPtr(T *pPtr, std::function<void(T *)> onDelete,
   std::function<void(T *, int64_t)> onRelease,
   std::function<void(T *, int64_t)> onAcquire)
 {
-  Create(pPtr, true, onDelete, onRelease, onAcquire);
+  Create(pPtr, nullptr);
+  if (onDelete || onRelease || onAcquire)
+  {
+    Callbacks *pCallbacks = GetCallbacks();
+    pCallbacks->onDelete = std::move(onDelete);
+    pCallbacks->onRelease = std::move(onRelease);
+    pCallbacks->onAcquire = std::move(onAcquire);
+  }
 }
 
-template<typename T> inline ctPtr<T>::ctPtr(std::nullptr_t) : ctPtr((T*)nullptr) {}
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::ctPtr(std::nullptr_t) {}
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::ctPtr(T &&o) { CreateInline<T>(std::move(o)); }
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::ctPtr(const T &o) { CreateInline<T>(o); }
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::ctPtr(ctPtr &&o) { std::swap(m_pInstance, o.m_pInstance); }
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::ctPtr(const ctPtr &o) { Acquire(o.m_pInstance); }
 
-template<typename T>
-inline ctPtr<T>::ctPtr(T &&o)
+template<typename T, typename RefCount>
+template<typename T2, typename>
+inline ctPtr<T, RefCount>::ctPtr(T2 &&o)
 {
-  Create(ctNew(T)(std::move(o)), false, [](T *pPtr) { ctDelete(pPtr); }, nullptr, nullptr);
+  CreateInline<typename std::decay<T2>::type>(std::forward<T2>(o));
 }
 
-template<typename T>
-inline ctPtr<T>::ctPtr(const T &o)
-  : ctPtr(std::move(T(o)))
-{}
-
-template<typename T> inline ctPtr<T>::ctPtr(ctPtr<T> &&o) { *this = std::move(o); }
-template<typename T> inline ctPtr<T>::ctPtr(const ctPtr<T> &o) { *this = o; }
-
-template<typename T>
-template<typename T2>
-inline ctPtr<T>::ctPtr(T2 &&o)
+template<typename T, typename RefCount>
+template<typename T2, typename>
+inline ctPtr<T, RefCount>::ctPtr(const T2 &o)
 {
-  Create((T*)ctNew(T2)(std::move(o)), false, [](T *pPtr) { ctDelete((T2 *)pPtr); }, nullptr, nullptr);
+  CreateInline<T2>(o);
 }
 
-template<typename T>
-template<typename T2>
-inline ctPtr<T>::ctPtr(const T2 &o)
-  : ctPtr(T2(o))
-{}
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::~ctPtr() { Release(); }
 
-template<typename T> inline T *ctPtr<T>::Get() { return m_pInstance ? m_pInstance->pData : nullptr; }
-template<typename T> inline T *ctPtr<T>::operator->() { return Get(); }
+template<typename T, typename RefCount> inline T *ctPtr<T, RefCount>::Get() { return m_pInstance ? m_pInstance->pData : nullptr; }
+template<typename T, typename RefCount> inline T *ctPtr<T, RefCount>::operator->() { return Get(); }
 
-template<typename T>
-inline T &ctPtr<T>::operator*()
+template<typename T, typename RefCount>
+inline T &ctPtr<T, RefCount>::operator*()
 {
   ctAssert(!IsNull(), "Dereferencing a null ptr");
   return *Get();
 }
 
-template<typename T> inline const T *ctPtr<T>::Get() const { return m_pInstance ? m_pInstance->pData : nullptr; }
-template<typename T> inline const T *ctPtr<T>::operator->() const { return Get(); }
+template<typename T, typename RefCount> inline const T *ctPtr<T, RefCount>::Get() const { return m_pInstance ? m_pInstance->pData : nullptr; }
+template<typename T, typename RefCount> inline const T *ctPtr<T, RefCount>::operator->() const { return Get(); }
 
-template<typename T>
-inline const T &ctPtr<T>::operator*() const
+template<typename T, typename RefCount>
+inline const T &ctPtr<T, RefCount>::operator*() const
 {
   ctAssert(!IsNull(), "Dereferencing a null ptr");
   return *Get();
 }
 
-template<typename T>
-inline ctPtr<T>& ctPtr<T>::operator=(T *pPtr)
+template<typename T, typename RefCount>
+inline ctPtr<T, RefCount>& ctPtr<T, RefCount>::operator=(T *pPtr)
 {
   if (pPtr == Get())
     return *this;
-  Create(pPtr, true, nullptr, nullptr, nullptr);
+  Create(pPtr, nullptr);
   return *this;
 }
 
-template<typename T>
-inline ctPtr<T> &ctPtr<T>::operator=(ctPtr<T> &&rhs)
+template<typename T, typename RefCount>
+inline ctPtr<T, RefCount> &ctPtr<T, RefCount>::operator=(ctPtr &&rhs)
 {
-  Release();
-  std::swap(m_pInstance, rhs.m_pInstance);
+  if (this != &rhs)
+  {
+    Release();
+    std::swap(m_pInstance, rhs.m_pInstance);
+  }
   return *this;
 }
 
-template<typename T>
-inline ctPtr<T> &ctPtr<T>::operator=(const ctPtr<T> &rhs)
+template<typename T, typename RefCount>
+inline ctPtr<T, RefCount> &ctPtr<T, RefCount>::operator=(const ctPtr &rhs)
 {
   Acquire(rhs.m_pInstance);
   return *this;
 }
 
-template<typename T> inline int64_t ctPtr<T>::GetReferenceCount() const { return m_pInstance ? m_pInstance->refCount.load() : 1; }
+template<typename T, typename RefCount> inline int64_t ctPtr<T, RefCount>::GetReferenceCount() const { return m_pInstance ? m_pInstance->refCount.Get() : 1; }
 
-template<typename T>
-inline bool ctPtr<T>::OnRelease(std::function<void(T *, int64_t)> onRelease)
+template<typename T, typename RefCount>
+inline bool ctPtr<T, RefCount>::OnRelease(std::function<void(T *, int64_t)> onRelease)
 {
   if (!m_pInstance)
     return false;
-  m_pInstance->onRelease = onRelease;
+  GetCallbacks()->onRelease = onRelease;
   return true;
 }
 
-template<typename T>
-inline bool ctPtr<T>::OnAqcuire(std::function<void(T *, int64_t)> onAcquire)
+template<typename T, typename RefCount>
+inline bool ctPtr<T, RefCount>::OnAqcuire(std::function<void(T *, int64_t)> onAcquire)
 {
   if (!m_pInstance)
     return false;
-  m_pInstance->onAcquire = onAcquire;
+  GetCallbacks()->onAcquire = onAcquire;
   return true;
 }
 
-template<typename T>
-inline bool ctPtr<T>::OnDelete(std::function<void(T *)> onDelete)
+template<typename T, typename RefCount>
+inline bool ctPtr<T, RefCount>::OnDelete(std::function<void(T *)> onDelete)
 {
   if (!m_pInstance || !m_pInstance->isForeign)
     return false;
-  m_pInstance->onDelete = onDelete;
+  GetCallbacks()->onDelete = onDelete;
+  m_pInstance->deleteData = nullptr;
   return true;
 }
 
-template<typename T> inline bool ctPtr<T>::IsForeign() const { return m_pInstance && m_pInstance->isForeign; }
-template<typename T> inline bool ctPtr<T>::IsNull() const { return Get() == nullptr; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::IsForeign() const { return m_pInstance && m_pInstance->isForeign; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::IsNull() const { return Get() == nullptr; }
 
-template<typename T> inline T *ctPtr<T>::TakePtr()
+template<typename T, typename RefCount> inline T *ctPtr<T, RefCount>::TakePtr()
 {
+  if (!m_pInstance || !m_pInstance->isForeign)
+    return nullptr;
+
   T *pPtr = m_pInstance->pData;
   m_pInstance->pData = nullptr;
   return pPtr;
 }
 
-template<typename T>
-inline void ctPtr<T>::Release()
+template<typename T, typename RefCount>
+inline void ctPtr<T, RefCount>::Release()
 {
   if (!m_pInstance)
     return;
   Instance *pInstance = m_pInstance;
   m_pInstance = nullptr;
-  int64_t refCount = --pInstance->refCount;
+  int64_t refCount = pInstance->refCount.Decrement();
 
   // Try call the released callback
-  if (pInstance->onRelease)
-    pInstance->onRelease(pInstance->pData, refCount);
+  Callbacks *pCallbacks = pInstance->pCallbacks;
+  if (pCallbacks && pCallbacks->onRelease)
+    pCallbacks->onRelease(pInstance->pData, refCount);
 
   // If there are no more references delete the ptr and
   // the instance struct
   if (refCount == 0)
   {
-    if (pInstance->pData && pInstance->onDelete)
-      pInstance->onDelete(pInstance->pData);
-    ctDelete(pInstance);
+    if (pInstance->pData && pInstance->isForeign)
+    {
+      if (pInstance->deleteData)
+        pInstance->deleteData(pInstance->pData);
+      else if (pCallbacks && pCallbacks->onDelete)
+        pCallbacks->onDelete(pInstance->pData);
+    }
+
+    if (pCallbacks)
+      ctDelete(pCallbacks);
+    pInstance->free(pInstance);
   }
 }
 
-template<typename T>
-inline void ctPtr<T>::Acquire(typename ctPtr<T>::Instance *pInstance)
+template<typename T, typename RefCount>
+inline void ctPtr<T, RefCount>::Acquire(Instance *pInstance)
 {
   if (m_pInstance == pInstance)
     return; // Same ptr
@@ -152,40 +195,81 @@ inline void ctPtr<T>::Acquire(typename ctPtr<T>::Instance *pInstance)
   if (!pInstance)
     return; // Setting to null
 
-  int64_t refCount = ++pInstance->refCount;
+  int64_t refCount = pInstance->refCount.Increment();
   m_pInstance = pInstance;
 
   // Try call acquire callback
-  if (m_pInstance->onAcquire)
-    m_pInstance->onAcquire(m_pInstance->pData, refCount);
+  Callbacks *pCallbacks = m_pInstance->pCallbacks;
+  if (pCallbacks && pCallbacks->onAcquire)
+    pCallbacks->onAcquire(m_pInstance->pData, refCount);
 }
 
-template<typename T>
-inline void ctPtr<T>::Create(T *pData, bool isForeign, std::function<void(T *)> onDelete, std::function<void(T *, int64_t)> onRelease, std::function<void(T *, int64_t)> onAcquire)
+template<typename T, typename RefCount>
+inline void ctPtr<T, RefCount>::Create(T *pData, void (*deleteData)(T *))
 {
   Release();
   m_pInstance = ctNew(Instance);
   m_pInstance->pData = pData;
   m_pInstance->isForeign = true;
-  m_pInstance->refCount = 1;
-  m_pInstance->onDelete = onDelete;
-  m_pInstance->onRelease = onRelease;
-  m_pInstance->onAcquire = onAcquire;
-}
-
-template<typename T> inline ctPtr<T>::operator bool() const { return !IsNull(); }
-template<typename T> inline bool ctPtr<T>::operator==(const T *pRhs) const { return Get() == pRhs; }
-template<typename T> inline bool ctPtr<T>::operator==(const std::nullptr_t &) const { return IsNull(); }
-template<typename T> inline bool ctPtr<T>::operator==(const ctPtr<T> &rhs) const { return Get() == rhs.Get(); }
-template<typename T> inline bool ctPtr<T>::operator!=(const T *pRhs) const { return !(*this == pRhs); }
-template<typename T> inline bool ctPtr<T>::operator!=(const std::nullptr_t &) const { return !IsNull(); }
-template<typename T> inline bool ctPtr<T>::operator!=(const ctPtr<T> &rhs) const { return !(*this == rhs); }
-template<typename T> inline bool ctPtr<T>::operator<(const T *pRhs) const { return Get() < pRhs; }
-template<typename T> inline bool ctPtr<T>::operator<(const ctPtr<T> &rhs) const { return *this < rhs.Get(); }
-template<typename T> inline bool ctPtr<T>::operator>(const T *pRhs) const { return Get > pRhs; }
-template<typename T> inline bool ctPtr<T>::operator>(const ctPtr<T> &rhs) const { return *this > rhs.Get(); }
-template<typename T> inline bool ctPtr<T>::operator<=(const T *pRhs) const { return Get() <= pRhs; }
-template<typename T> inline bool ctPtr<T>::operator<=(const ctPtr<T> &rhs) const { return *this <= rhs.Get(); }
-template<typename T> inline bool ctPtr<T>::operator>=(const T *pRhs) const { return Get >= pRhs; }
-template<typename T> inline bool ctPtr<T>::operator>=(const ctPtr<T> &rhs) const { return *this >= rhs.Get(); }
-template<typename U> inline int64_t ctHash(const ctPtr<U> &o) { return ctHash(o.Get()) ;}
+  m_pInstance->refCount.Increment();
+  m_pInstance->deleteData = deleteData;
+  m_pInstance->free = FreeInstance;
+}
+
+template<typename T, typename RefCount>
+template<typename U, typename... Args>
+inline void ctPtr<T, RefCount>::CreateInline(Args&&... args)
+{
+  Release();
+  InlineInstance<U> *pInstance = ctNew(InlineInstance<U>)(std::forward<Args>(args)...);
+  pInstance->pData = static_cast<T*>(&pInstance->value);
+  pInstance->refCount.Increment();
+  pInstance->free = FreeInlineInstance<U>;
+  m_pInstance = pInstance;
+}
+
+template<typename T, typename RefCount>
+inline typename ctPtr<T, RefCount>::Callbacks* ctPtr<T, RefCount>::GetCallbacks()
+{
+  if (!m_pInstance->pCallbacks)
+    m_pInstance->pCallbacks = ctNew(Callbacks);
+  return m_pInstance->pCallbacks;
+}
+
+template<typename T, typename RefCount> inline void ctPtr<T, RefCount>::DeleteData(T *pData) { ctDelete(pData); }
+template<typename T, typename RefCount> inline void ctPtr<T, RefCount>::FreeInstance(Instance *pInstance) { ctDelete(pInstance); }
+
+template<typename T, typename RefCount>
+template<typename U>
+inline void ctPtr<T, RefCount>::FreeInlineInstance(Instance *pInstance)
+{
+  ctDelete(static_cast<InlineInstance<U>*>(pInstance));
+}
+
+template<typename T, typename RefCount> inline ctPtr<T, RefCount>::operator bool() const { return !IsNull(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator==(const T *pRhs) const { return Get() == pRhs; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator==(const std::nullptr_t &) const { return IsNull(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator==(const ctPtr &rhs) const { return Get() == rhs.Get(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator!=(const T *pRhs) const { return !(*this == pRhs); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator!=(const std::nullptr_t &) const { return !IsNull(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator!=(const ctPtr &rhs) const { return !(*this == rhs); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator<(const T *pRhs) const { return Get() < pRhs; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator<(const ctPtr &rhs) const { return *this < rhs.Get(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator>(const T *pRhs) const { return Get() > pRhs; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator>(const ctPtr &rhs) const { return *this > rhs.Get(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator<=(const T *pRhs) const { return Get() <= pRhs; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator<=(const ctPtr &rhs) const { return *this <= rhs.Get(); }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator>=(const T *pRhs) const { return Get() >= pRhs; }
+template<typename T, typename RefCount> inline bool ctPtr<T, RefCount>::operator>=(const ctPtr &rhs) const { return *this >= rhs.Get(); }
+template<typename U, typename R> inline int64_t ctHash(const ctPtr<U, R> &o) { return ctHash(o.Get()) ;}
+
+template<typename T, typename RefCount, typename... Args>
+inline ctPtr<T, RefCount> ctMakePtr(Args&&... args)
+{
+  ctPtr<T, RefCount> ptr;
+  ptr.template CreateInline<T>(std::forward<Args>(args)...);
+  return ptr;
+}
+
+template<typename T, typename... Args>
+inline ctLocalPtr<T> ctMakeLocalPtr(Args&&... args) { return ctMakePtr<T, ctLocalRefCount>(std::forward<Args>(args)...); }
@@ -0,0 +1,157 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctQueue_h__
+#define ctQueue_h__
+
+#include "ctThreading.h"
+#include "ctMemory.h"
+
+// Blocks threads until a queue changes state.
+// Notifying is cheap when there are no blocked threads.
+class _ctQueueWaiter
+{
+public:
+  _ctQueueWaiter();
+
+  // Block until cond() returns true. Spins briefly before parking the thread.
+  template<typename Func> void Wait(Func &&cond);
+
+  // Wake all blocked threads
+  void NotifyAll();
+
+protected:
+  std::atomic<int64_t> m_waiters;
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+};
+
+// A bounded ring queue with a sequence number for each slot.
+// Use ctSPSCQueue, ctMPSCQueue or ctMPMCQueue rather than this type directly.
+//
+// The Try* functions never block. Batched functions claim a range of slots with a
+// single atomic operation, but may briefly wait for another thread that is still
+// accessing one of the claimed slots.
+template<typename T, bool MultiProducer, bool MultiConsumer> class _ctRingQueue
+{
+public:
+  // The capacity is rounded up to a power of 2
+  _ctRingQueue(const int64_t capacity);
+  ~_ctRingQueue();
+
+  _ctRingQueue(const _ctRingQueue &) = delete;
+  _ctRingQueue& operator=(const _ctRingQueue &) = delete;
+
+  // Add an item if there is space. Returns false if the queue is full or closed.
+  // 'value' is only moved from if the item was added.
+  bool TryPush(const T &value);
+  bool TryPush(T &&value);
+  template<typename... Args> bool TryEmplace(Args&&... args);
+
+  // Add an item, blocking while the queue is full. Returns false if the queue is closed.
+  bool Push(const T &value);
+  bool Push(T &&value);
+
+  // Add up to 'count' items. Returns the number of items added.
+  int64_t TryPushBatch(const T *pItems, const int64_t count);
+
+  // Add all 'count' items, blocking while the queue is full.
+  // Returns the number of items added, which is less than 'count' if the queue was closed.
+  int64_t PushBatch(const T *pItems, const int64_t count);
+
+  // Remove an item if one is available
+  bool TryPop(T *pValue);
+
+  // Remove an item, blocking while the queue is empty.
+  // Returns false once the queue is closed and empty.
+  bool Pop(T *pValue);
+
+  // Remove up to 'maxCount' items. Returns the number of items removed.
+  int64_t TryPopBatch(T *pItems, const int64_t maxCount);
+
+  // Remove up to 'maxCount' items, blocking until at least one is available.
+  // Returns 0 once the queue is closed and empty.
+  int64_t PopBatch(T *pItems, const int64_t maxCount);
+
+  // Stop accepting new items and wake all blocked threads.
+  // Consumers can still remove the items that are in the queue. Items pushed
+  // concurrently with Close() may not be seen by consumers that are already blocked.
+  void Close();
+  bool IsClosed() const;
+
+  int64_t Capacity() const;
+
+  // The number of items in the queue. This is only a snapshot if other threads are using the queue.
+  int64_t SizeApprox() const;
+  bool EmptyApprox() const;
+  bool FullApprox() const;
+
+protected:
+  struct Cell
+  {
+    std::atomic<int64_t> sequence;
+    alignas(T) uint8_t data[sizeof(T)];
+
+    T* Get() { return (T*)data; }
+  };
+
+  Cell *m_pCells;
+  int64_t m_mask;
+
+  // Producer and consumer positions are kept on separate cache lines
+  uint8_t m_tailPadding[ctCACHE_LINE_SIZE];
+  std::atomic<int64_t> m_tail;
+  uint8_t m_headPadding[ctCACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> m_head;
+  uint8_t m_endPadding[ctCACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+
+  std::atomic<bool> m_closed;
+  _ctQueueWaiter m_notEmpty;
+  _ctQueueWaiter m_notFull;
+};
+
+// A bounded queue for passing items from one producer thread to one consumer thread
+template<typename T> class ctSPSCQueue : public _ctRingQueue<T, false, false>
+{
+public:
+  ctSPSCQueue(const int64_t capacity) : _ctRingQueue<T, false, false>(capacity) {}
+};
+
+// A bounded queue for passing items from any number of producer threads to one consumer thread
+template<typename T> class ctMPSCQueue : public _ctRingQueue<T, true, false>
+{
+public:
+  ctMPSCQueue(const int64_t capacity) : _ctRingQueue<T, true, false>(capacity) {}
+};
+
+// A bounded queue that any number of threads can push to and pop from
+template<typename T> class ctMPMCQueue : public _ctRingQueue<T, true, true>
+{
+public:
+  ctMPMCQueue(const int64_t capacity) : _ctRingQueue<T, true, true>(capacity) {}
+};
+
+#include "ctQueue.inl"
+
+#endif // ctQueue_h__
@@ -0,0 +1,334 @@
+#include "ctQueue.h"
+
+//****************
+// _ctQueueWaiter
+//****************
+
+inline _ctQueueWaiter::_ctQueueWaiter()
+  : m_waiters(0)
+{}
+
+template<typename Func>
+inline void _ctQueueWaiter::Wait(Func &&cond)
+{
+  // Spin, then yield for a while, before parking
+  int64_t spins = 0;
+  while (spins < ctSPIN_YIELD_COUNT * 2)
+  {
+    if (cond())
+      return;
+    ctSpinWait(&spins);
+  }
+
+  std::unique_lock<std::mutex> lock(m_lock);
+  m_waiters.fetch_add(1);
+
+  // Pairs with the fence in NotifyAll() so that either the waiter sees the
+  // change to the queue, or the notifier sees the waiter
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  m_wake.wait(lock, cond);
+  m_waiters.fetch_sub(1);
+}
+
+inline void _ctQueueWaiter::NotifyAll()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_waiters.load(std::memory_order_relaxed) == 0)
+    return;
+
+  { // Synchronise with threads that are about to park
+    ctScopeLock lock(m_lock);
+  }
+  m_wake.notify_all();
+}
+
+//**************
+// _ctRingQueue
+//**************
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline _ctRingQueue<T, MultiProducer, MultiConsumer>::_ctRingQueue(const int64_t capacity)
+  : m_tail(0)
+  , m_head(0)
+  , m_closed(false)
+{
+  int64_t size = 2;
+  while (size < capacity)
+    size <<= 1;
+
+  m_mask = size - 1;
+  m_pCells = (Cell*)ctAlloc(sizeof(Cell) * size);
+  for (int64_t i = 0; i < size; ++i)
+    new (&m_pCells[i].sequence) std::atomic<int64_t>(i);
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline _ctRingQueue<T, MultiProducer, MultiConsumer>::~_ctRingQueue()
+{
+  int64_t tail = m_tail.load(std::memory_order_relaxed);
+  for (int64_t pos = m_head.load(std::memory_order_relaxed); pos < tail; ++pos)
+    m_pCells[pos & m_mask].Get()->~T();
+  ctFree(m_pCells);
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::TryPush(const T &value) { return TryEmplace(value); }
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::TryPush(T &&value) { return TryEmplace(std::move(value)); }
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+template<typename... Args>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::TryEmplace(Args&&... args)
+{
+  if (m_closed.load(std::memory_order_relaxed))
+    return false;
+
+  int64_t pos = m_tail.load(std::memory_order_relaxed);
+  Cell *pCell = nullptr;
+  while (true)
+  {
+    pCell = &m_pCells[pos & m_mask];
+    int64_t diff = pCell->sequence.load(std::memory_order_acquire) - pos;
+    if (diff == 0)
+    { // The slot is free. Claim it.
+      if (!MultiProducer)
+      {
+        m_tail.store(pos + 1, std::memory_order_relaxed);
+        break;
+      }
+
+      if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    { // The slot has not been consumed yet
+      return false;
+    }
+    else
+    { // Another producer claimed the slot
+      pos = m_tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  new (pCell->Get()) T(std::forward<Args>(args)...);
+  pCell->sequence.store(pos + 1, std::memory_order_release);
+  m_notEmpty.NotifyAll();
+  return true;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::Push(const T &value)
+{
+  while (!TryPush(value))
+  {
+    if (IsClosed())
+      return false;
+    m_notFull.Wait([this]() { return !FullApprox() || IsClosed(); });
+  }
+  return true;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::Push(T &&value)
+{
+  while (!TryPush(std::move(value)))
+  {
+    if (IsClosed())
+      return false;
+    m_notFull.Wait([this]() { return !FullApprox() || IsClosed(); });
+  }
+  return true;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::TryPushBatch(const T *pItems, const int64_t count)
+{
+  if (count <= 0 || m_closed.load(std::memory_order_relaxed))
+    return 0;
+
+  int64_t pos = m_tail.load(std::memory_order_relaxed);
+  int64_t claimed = 0;
+  while (true)
+  {
+    claimed = ctMin(count, Capacity() - (pos - m_head.load(std::memory_order_acquire)));
+    if (claimed <= 0)
+      return 0;
+
+    if (!MultiProducer)
+    {
+      m_tail.store(pos + claimed, std::memory_order_relaxed);
+      break;
+    }
+
+    if (m_tail.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+      break;
+  }
+
+  for (int64_t i = 0; i < claimed; ++i)
+  {
+    Cell *pCell = &m_pCells[(pos + i) & m_mask];
+
+    // A consumer may still be reading the slot
+    int64_t spins = 0;
+    while (pCell->sequence.load(std::memory_order_acquire) != pos + i)
+      ctSpinWait(&spins);
+
+    new (pCell->Get()) T(pItems[i]);
+    pCell->sequence.store(pos + i + 1, std::memory_order_release);
+  }
+
+  m_notEmpty.NotifyAll();
+  return claimed;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::PushBatch(const T *pItems, const int64_t count)
+{
+  int64_t pushed = 0;
+  while (pushed < count)
+  {
+    pushed += TryPushBatch(pItems + pushed, count - pushed);
+    if (pushed < count)
+    {
+      if (IsClosed())
+        break;
+      m_notFull.Wait([this]() { return !FullApprox() || IsClosed(); });
+    }
+  }
+  return pushed;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::TryPop(T *pValue)
+{
+  int64_t pos = m_head.load(std::memory_order_relaxed);
+  Cell *pCell = nullptr;
+  while (true)
+  {
+    pCell = &m_pCells[pos & m_mask];
+    int64_t diff = pCell->sequence.load(std::memory_order_acquire) - (pos + 1);
+    if (diff == 0)
+    { // The slot has been written. Claim it.
+      if (!MultiConsumer)
+      {
+        m_head.store(pos + 1, std::memory_order_relaxed);
+        break;
+      }
+
+      if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    { // Nothing has been written to the slot yet
+      return false;
+    }
+    else
+    { // Another consumer claimed the slot
+      pos = m_head.load(std::memory_order_relaxed);
+    }
+  }
+
+  T *pItem = pCell->Get();
+  *pValue = std::move(*pItem);
+  pItem->~T();
+  pCell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+  m_notFull.NotifyAll();
+  return true;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::Pop(T *pValue)
+{
+  while (!TryPop(pValue))
+  {
+    if (IsClosed() && EmptyApprox())
+      return false;
+    m_notEmpty.Wait([this]() { return !EmptyApprox() || IsClosed(); });
+  }
+  return true;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::TryPopBatch(T *pItems, const int64_t maxCount)
+{
+  if (maxCount <= 0)
+    return 0;
+
+  int64_t pos = m_head.load(std::memory_order_relaxed);
+  int64_t claimed = 0;
+  while (true)
+  {
+    claimed = ctMin(maxCount, m_tail.load(std::memory_order_acquire) - pos);
+    if (claimed <= 0)
+      return 0;
+
+    if (!MultiConsumer)
+    {
+      m_head.store(pos + claimed, std::memory_order_relaxed);
+      break;
+    }
+
+    if (m_head.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+      break;
+  }
+
+  for (int64_t i = 0; i < claimed; ++i)
+  {
+    Cell *pCell = &m_pCells[(pos + i) & m_mask];
+
+    // A producer may still be writing the slot
+    int64_t spins = 0;
+    while (pCell->sequence.load(std::memory_order_acquire) != pos + i + 1)
+      ctSpinWait(&spins);
+
+    T *pItem = pCell->Get();
+    pItems[i] = std::move(*pItem);
+    pItem->~T();
+    pCell->sequence.store(pos + i + m_mask + 1, std::memory_order_release);
+  }
+
+  m_notFull.NotifyAll();
+  return claimed;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::PopBatch(T *pItems, const int64_t maxCount)
+{
+  int64_t popped = 0;
+  while ((popped = TryPopBatch(pItems, maxCount)) == 0 && maxCount > 0)
+  {
+    if (IsClosed() && EmptyApprox())
+      break;
+    m_notEmpty.Wait([this]() { return !EmptyApprox() || IsClosed(); });
+  }
+  return popped;
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline void _ctRingQueue<T, MultiProducer, MultiConsumer>::Close()
+{
+  m_closed.store(true);
+  m_notEmpty.NotifyAll();
+  m_notFull.NotifyAll();
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::IsClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::Capacity() const { return m_mask + 1; }
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline int64_t _ctRingQueue<T, MultiProducer, MultiConsumer>::SizeApprox() const
+{
+  int64_t head = m_head.load(std::memory_order_acquire);
+  int64_t tail = m_tail.load(std::memory_order_acquire);
+  return ctClamp(tail - head, 0, Capacity());
+}
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::EmptyApprox() const { return SizeApprox() == 0; }
+
+template<typename T, bool MultiProducer, bool MultiConsumer>
+inline bool _ctRingQueue<T, MultiProducer, MultiConsumer>::FullApprox() const { return SizeApprox() == Capacity(); }
@@ -27,6 +27,7 @@
 #define ctReadStream_h__
 
 #include "ctStreamSeekable.h"
+#include "ctIOSlice.h"
 
 #define ctTrivialStreamRead(type) inline int64_t ctStreamRead(ctReadStream *pStream, type *pData, const int64_t count) { return ctStreamRead(pStream, (void*)pData, sizeof(type) * count); }
 
@@ -37,6 +38,10 @@ public:
   // Returns the number of bytes read
   virtual int64_t Peek(void *pBuffer, const int64_t size);
   virtual int64_t Read(void *pBuffer, const int64_t size) = 0;
+
+  // Fill a list of slices in order, as if they were one block.
+  // Returns the number of bytes read. By default each slice is read in turn.
+  virtual int64_t ReadV(const ctIOSlice *pSlices, const int64_t count);
   template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
 };
 
@@ -42,6 +42,10 @@ public:
   // Create a seek-able string
   ctStringSeeker(ctString const *pText);
 
+  // Create a seeker over 'length' characters of 'pText'. The text is not copied and
+  // must be null terminated, as the seek functions search up to the terminator.
+  ctStringSeeker(const char *pText, const int64_t &length);
+
   // Manually seek 
   bool Seek(int64_t pos = 0, const ctSeekOrigin &origin = atSO_Current);
 
@@ -89,7 +93,8 @@ public:
 
 protected:
   bool DoSeek(const bool &success);
-  ctString const * m_pStr;
+  const char *m_pBegin;
+  const char *m_pEnd;
   const char *m_pText;
   const char *m_pLast;
   const char *m_pLastLast;
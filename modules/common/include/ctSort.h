@@ -0,0 +1,69 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctSort_h__
+#define ctSort_h__
+
+#include "ctParallel.h"
+#include <functional>
+
+// Sorting algorithms.
+//
+// Comparison sorts take a strict weak ordering less(a, b), which defaults to operator<.
+// ctSort is an unstable pattern-defeating quicksort. It is O(n log n) in the worst case,
+// and close to linear for inputs that are already sorted or have few distinct values.
+// ctStableSort is a merge sort that keeps equal items in their original order.
+// ctParallelSort is a stable merge sort that sorts and merges on a ctJobSystem.
+// ctRadixSort is a stable LSD radix sort for integer and floating point keys.
+//
+// The stable sorts allocate a temporary copy of the range.
+
+template<typename T, typename Less = std::less<T>> void ctSort(T *pBegin, T *pEnd, Less less = Less());
+template<typename T, typename Less = std::less<T>> void ctSort(ctVector<T> &vec, Less less = Less());
+
+template<typename T, typename Less = std::less<T>> void ctStableSort(T *pBegin, T *pEnd, Less less = Less());
+template<typename T, typename Less = std::less<T>> void ctStableSort(ctVector<T> &vec, Less less = Less());
+
+// If pJobs is null the global job system is used.
+// Small ranges are sorted on the calling thread.
+template<typename T, typename Less = std::less<T>> void ctParallelSort(T *pBegin, T *pEnd, Less less = Less(), ctJobSystem *pJobs = nullptr);
+template<typename T, typename Less = std::less<T>> void ctParallelSort(ctVector<T> &vec, Less less = Less(), ctJobSystem *pJobs = nullptr);
+
+// Sort integers or floating point values.
+// Floating point values are ordered by sign and magnitude, so -0.0 sorts before 0.0 and
+// NaNs sort before negative or after positive values depending on their sign bit.
+template<typename T> void ctRadixSort(T *pBegin, T *pEnd);
+template<typename T> void ctRadixSort(ctVector<T> &vec);
+
+// Sort items by the integer or floating point key returned by key(item)
+template<typename T, typename KeyFunc> void ctRadixSortBy(T *pBegin, T *pEnd, KeyFunc key);
+template<typename T, typename KeyFunc> void ctRadixSortBy(ctVector<T> &vec, KeyFunc key);
+
+// Check if a range is sorted
+template<typename T, typename Less = std::less<T>> bool ctIsSorted(const T *pBegin, const T *pEnd, Less less = Less());
+template<typename T, typename Less = std::less<T>> bool ctIsSorted(const ctVector<T> &vec, Less less = Less());
+
+#include "ctSort.inl"
+
+#endif // ctSort_h__
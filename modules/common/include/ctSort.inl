@@ -0,0 +1,555 @@
+#include "ctSort.h"
+#include <algorithm>
+#include <cstring>
+
+// Ranges smaller than this are insertion sorted
+static const int64_t _ctSortInsertionLimit = 24;
+
+// Ranges larger than this use the median of 3 medians as the pivot
+static const int64_t _ctSortNintherLimit = 128;
+
+// Partial insertion sort gives up after moving this many items
+static const int64_t _ctSortPartialInsertionLimit = 8;
+
+// Length of the runs the merge sort builds with insertion sort
+static const int64_t _ctMergeSortRunLength = 32;
+
+// Ranges smaller than this are not split across jobs by ctParallelSort
+static const int64_t _ctParallelSortMinChunk = 1 << 14;
+
+// Ranges smaller than this are insertion sorted by ctRadixSort
+static const int64_t _ctRadixSortInsertionLimit = 64;
+
+//****************
+// Insertion sort
+//****************
+
+template<typename T, typename Less>
+inline void _ctInsertionSort(T *pBegin, T *pEnd, Less &less)
+{
+  if (pBegin == pEnd)
+    return;
+
+  for (T *pCur = pBegin + 1; pCur != pEnd; ++pCur)
+  {
+    T *pSift = pCur;
+    T *pPrev = pCur - 1;
+    if (less(*pSift, *pPrev))
+    {
+      T tmp = std::move(*pSift);
+      do
+      {
+        *pSift-- = std::move(*pPrev);
+      } while (pSift != pBegin && less(tmp, *--pPrev));
+      *pSift = std::move(tmp);
+    }
+  }
+}
+
+// Insertion sort where *(pBegin - 1) is known to be <= every item in the range
+template<typename T, typename Less>
+inline void _ctUnguardedInsertionSort(T *pBegin, T *pEnd, Less &less)
+{
+  if (pBegin == pEnd)
+    return;
+
+  for (T *pCur = pBegin + 1; pCur != pEnd; ++pCur)
+  {
+    T *pSift = pCur;
+    T *pPrev = pCur - 1;
+    if (less(*pSift, *pPrev))
+    {
+      T tmp = std::move(*pSift);
+      do
+      {
+        *pSift-- = std::move(*pPrev);
+      } while (less(tmp, *--pPrev));
+      *pSift = std::move(tmp);
+    }
+  }
+}
+
+// Insertion sort that gives up if too many items need to move.
+// Returns true if the range was sorted.
+template<typename T, typename Less>
+inline bool _ctPartialInsertionSort(T *pBegin, T *pEnd, Less &less)
+{
+  if (pBegin == pEnd)
+    return true;
+
+  int64_t moved = 0;
+  for (T *pCur = pBegin + 1; pCur != pEnd; ++pCur)
+  {
+    T *pSift = pCur;
+    T *pPrev = pCur - 1;
+    if (less(*pSift, *pPrev))
+    {
+      T tmp = std::move(*pSift);
+      do
+      {
+        *pSift-- = std::move(*pPrev);
+      } while (pSift != pBegin && less(tmp, *--pPrev));
+      *pSift = std::move(tmp);
+
+      moved += pCur - pSift;
+      if (moved > _ctSortPartialInsertionLimit)
+        return pCur + 1 == pEnd;
+    }
+  }
+  return true;
+}
+
+//*********
+// ctSort
+//*********
+
+template<typename T, typename Less>
+inline void _ctSort2(T *pA, T *pB, Less &less)
+{
+  if (less(*pB, *pA))
+    std::swap(*pA, *pB);
+}
+
+template<typename T, typename Less>
+inline void _ctSort3(T *pA, T *pB, T *pC, Less &less)
+{
+  _ctSort2(pA, pB, less);
+  _ctSort2(pB, pC, less);
+  _ctSort2(pA, pB, less);
+}
+
+// Partition around the pivot *pBegin, placing items equal to the pivot on the right.
+// Returns the final position of the pivot. *pAlreadyPartitioned is set if no items were swapped.
+template<typename T, typename Less>
+inline T* _ctPartitionRight(T *pBegin, T *pEnd, Less &less, bool *pAlreadyPartitioned)
+{
+  T pivot = std::move(*pBegin);
+  T *pFirst = pBegin;
+  T *pLast = pEnd;
+
+  // The median of 3 selection guarantees an item >= pivot exists, so the first scan is unguarded
+  while (less(*++pFirst, pivot));
+
+  if (pFirst - 1 == pBegin)
+    while (pFirst < pLast && !less(*--pLast, pivot));
+  else
+    while (!less(*--pLast, pivot));
+
+  *pAlreadyPartitioned = pFirst >= pLast;
+  while (pFirst < pLast)
+  {
+    std::swap(*pFirst, *pLast);
+    while (less(*++pFirst, pivot));
+    while (!less(*--pLast, pivot));
+  }
+
+  T *pPivot = pFirst - 1;
+  *pBegin = std::move(*pPivot);
+  *pPivot = std::move(pivot);
+  return pPivot;
+}
+
+// Partition around the pivot *pBegin, placing items equal to the pivot on the left.
+// Used when the pivot is equal to the previous pivot, so every item equal to it is
+// already in its final position.
+template<typename T, typename Less>
+inline T* _ctPartitionLeft(T *pBegin, T *pEnd, Less &less)
+{
+  T pivot = std::move(*pBegin);
+  T *pFirst = pBegin;
+  T *pLast = pEnd;
+
+  while (less(pivot, *--pLast));
+
+  if (pLast + 1 == pEnd)
+    while (pFirst < pLast && !less(pivot, *++pFirst));
+  else
+    while (!less(pivot, *++pFirst));
+
+  while (pFirst < pLast)
+  {
+    std::swap(*pFirst, *pLast);
+    while (less(pivot, *--pLast));
+    while (!less(pivot, *++pFirst));
+  }
+
+  *pBegin = std::move(*pLast);
+  *pLast = std::move(pivot);
+  return pLast;
+}
+
+template<typename T, typename Less>
+inline void _ctPdqSort(T *pBegin, T *pEnd, Less &less, int64_t badAllowed, bool leftmost)
+{
+  while (true)
+  {
+    int64_t size = pEnd - pBegin;
+    if (size < _ctSortInsertionLimit)
+    {
+      if (leftmost)
+        _ctInsertionSort(pBegin, pEnd, less);
+      else
+        _ctUnguardedInsertionSort(pBegin, pEnd, less);
+      return;
+    }
+
+    // Choose a pivot and move it to the start of the range
+    int64_t half = size / 2;
+    if (size > _ctSortNintherLimit)
+    {
+      _ctSort3(pBegin, pBegin + half, pEnd - 1, less);
+      _ctSort3(pBegin + 1, pBegin + (half - 1), pEnd - 2, less);
+      _ctSort3(pBegin + 2, pBegin + (half + 1), pEnd - 3, less);
+      _ctSort3(pBegin + (half - 1), pBegin + half, pBegin + (half + 1), less);
+      std::swap(*pBegin, *(pBegin + half));
+    }
+    else
+    {
+      _ctSort3(pBegin + half, pBegin, pEnd - 1, less);
+    }
+
+    // If the pivot equals the item before this range (the previous pivot), every
+    // item equal to it can be skipped
+    if (!leftmost && !less(*(pBegin - 1), *pBegin))
+    {
+      pBegin = _ctPartitionLeft(pBegin, pEnd, less) + 1;
+      continue;
+    }
+
+    bool alreadyPartitioned = false;
+    T *pPivot = _ctPartitionRight(pBegin, pEnd, less, &alreadyPartitioned);
+
+    int64_t leftSize = pPivot - pBegin;
+    int64_t rightSize = pEnd - (pPivot + 1);
+    if (leftSize < size / 8 || rightSize < size / 8)
+    { // A bad partition. Fall back to heap sort if this keeps happening.
+      if (--badAllowed == 0)
+      {
+        std::make_heap(pBegin, pEnd, less);
+        std::sort_heap(pBegin, pEnd, less);
+        return;
+      }
+
+      // Shuffle some items to break up patterns
+      if (leftSize >= _ctSortInsertionLimit)
+      {
+        std::swap(pBegin[0], pBegin[leftSize / 4]);
+        std::swap(pPivot[-1], pPivot[-leftSize / 4]);
+        if (leftSize > _ctSortNintherLimit)
+        {
+          std::swap(pBegin[1], pBegin[leftSize / 4 + 1]);
+          std::swap(pBegin[2], pBegin[leftSize / 4 + 2]);
+          std::swap(pPivot[-2], pPivot[-(leftSize / 4 + 1)]);
+          std::swap(pPivot[-3], pPivot[-(leftSize / 4 + 2)]);
+        }
+      }
+
+      if (rightSize >= _ctSortInsertionLimit)
+      {
+        std::swap(pPivot[1], pPivot[1 + rightSize / 4]);
+        std::swap(pEnd[-1], pEnd[-rightSize / 4]);
+        if (rightSize > _ctSortNintherLimit)
+        {
+          std::swap(pPivot[2], pPivot[2 + rightSize / 4]);
+          std::swap(pPivot[3], pPivot[3 + rightSize / 4]);
+          std::swap(pEnd[-2], pEnd[-(1 + rightSize / 4)]);
+          std::swap(pEnd[-3], pEnd[-(2 + rightSize / 4)]);
+        }
+      }
+    }
+    else if (alreadyPartitioned && _ctPartialInsertionSort(pBegin, pPivot, less) && _ctPartialInsertionSort(pPivot + 1, pEnd, less))
+    { // The range was probably already sorted
+      return;
+    }
+
+    // Recurse into the left side and loop on the right
+    _ctPdqSort(pBegin, pPivot, less, badAllowed, leftmost);
+    pBegin = pPivot + 1;
+    leftmost = false;
+  }
+}
+
+template<typename T, typename Less>
+inline void ctSort(T *pBegin, T *pEnd, Less less)
+{
+  int64_t size = pEnd - pBegin;
+  int64_t log2 = 0;
+  while (size > 1)
+  {
+    size >>= 1;
+    ++log2;
+  }
+
+  _ctPdqSort(pBegin, pEnd, less, log2 + 1, true);
+}
+
+template<typename T, typename Less>
+inline void ctSort(ctVector<T> &vec, Less less) { ctSort(vec.begin(), vec.end(), less); }
+
+//**************
+// ctStableSort
+//**************
+
+// Merge the sorted ranges [pA, pAEnd) and [pB, pBEnd) into pDst.
+// Items from the first range are taken first when items are equal.
+template<typename T, typename Less>
+inline void _ctMerge(T *pA, T *pAEnd, T *pB, T *pBEnd, T *pDst, Less &less)
+{
+  while (pA != pAEnd && pB != pBEnd)
+  {
+    if (less(*pB, *pA))
+      *pDst++ = std::move(*pB++);
+    else
+      *pDst++ = std::move(*pA++);
+  }
+
+  while (pA != pAEnd)
+    *pDst++ = std::move(*pA++);
+  while (pB != pBEnd)
+    *pDst++ = std::move(*pB++);
+}
+
+// Merge sort [pBegin, pEnd) using pScratch, which must hold as many items as the range
+template<typename T, typename Less>
+inline void _ctMergeSort(T *pBegin, T *pEnd, T *pScratch, Less &less)
+{
+  int64_t count = pEnd - pBegin;
+  for (int64_t start = 0; start < count; start += _ctMergeSortRunLength)
+    _ctInsertionSort(pBegin + start, pBegin + ctMin(start + _ctMergeSortRunLength, count), less);
+
+  // Merge runs back and forth between the range and the scratch buffer
+  T *pSrc = pBegin;
+  T *pDst = pScratch;
+  for (int64_t width = _ctMergeSortRunLength; width < count; width *= 2)
+  {
+    for (int64_t start = 0; start < count; start += width * 2)
+    {
+      int64_t mid = ctMin(start + width, count);
+      int64_t end = ctMin(start + width * 2, count);
+      _ctMerge(pSrc + start, pSrc + mid, pSrc + mid, pSrc + end, pDst + start, less);
+    }
+    std::swap(pSrc, pDst);
+  }
+
+  if (pSrc != pBegin)
+    for (int64_t i = 0; i < count; ++i)
+      pBegin[i] = std::move(pSrc[i]);
+}
+
+template<typename T, typename Less>
+inline void ctStableSort(T *pBegin, T *pEnd, Less less)
+{
+  int64_t count = pEnd - pBegin;
+  if (count <= _ctMergeSortRunLength)
+  {
+    _ctInsertionSort(pBegin, pEnd, less);
+    return;
+  }
+
+  ctVector<T> scratch(pBegin, count);
+  _ctMergeSort(pBegin, pEnd, scratch.data(), less);
+}
+
+template<typename T, typename Less>
+inline void ctStableSort(ctVector<T> &vec, Less less) { ctStableSort(vec.begin(), vec.end(), less); }
+
+//****************
+// ctParallelSort
+//****************
+
+// Find how many of the first 'diagonal' merged items come from [pA, pA + aCount).
+// Equal items are taken from A first, matching _ctMerge.
+template<typename T, typename Less>
+inline int64_t _ctMergeSplit(const T *pA, const int64_t aCount, const T *pB, const int64_t bCount, const int64_t diagonal, Less &less)
+{
+  int64_t low = ctMax((int64_t)0, diagonal - bCount);
+  int64_t high = ctMin(diagonal, aCount);
+  while (low < high)
+  {
+    int64_t mid = (low + high) / 2;
+    if (less(pB[diagonal - mid - 1], pA[mid]))
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return low;
+}
+
+template<typename T, typename Less>
+inline void ctParallelSort(T *pBegin, T *pEnd, Less less, ctJobSystem *pJobs)
+{
+  int64_t count = pEnd - pBegin;
+  if (pJobs == nullptr)
+    pJobs = ctJobSystem::Global();
+
+  // Use a power of 2 number of chunks so they merge in pairs
+  int64_t chunkCount = 1;
+  while (chunkCount < (pJobs->WorkerCount() + 1) * 2 && count / (chunkCount * 2) >= _ctParallelSortMinChunk)
+    chunkCount *= 2;
+
+  if (chunkCount == 1)
+  {
+    ctStableSort(pBegin, pEnd, less);
+    return;
+  }
+
+  ctVector<T> scratch(pBegin, count);
+  T *pScratch = scratch.data();
+  int64_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+  ctParallelFor(0, chunkCount, 1, [=, &less](int64_t chunk) {
+    int64_t start = ctMin(chunk * chunkSize, count);
+    int64_t end = ctMin(start + chunkSize, count);
+    _ctMergeSort(pBegin + start, pBegin + end, pScratch + start, less);
+  }, pJobs);
+
+  // Merge pairs of runs. Each merge is split into 'chunkCount / pairs' pieces along
+  // its output so every level keeps all of the workers busy.
+  T *pSrc = pBegin;
+  T *pDst = pScratch;
+  for (int64_t width = chunkSize; width < count; width *= 2)
+  {
+    int64_t pairs = (count + width * 2 - 1) / (width * 2);
+    int64_t pieces = ctMax((int64_t)1, chunkCount / pairs);
+    ctParallelFor(0, pairs * pieces, 1, [=, &less](int64_t job) {
+      int64_t start = (job / pieces) * width * 2;
+      int64_t mid = ctMin(start + width, count);
+      int64_t end = ctMin(start + width * 2, count);
+      int64_t aCount = mid - start;
+      int64_t bCount = end - mid;
+
+      int64_t piece = job % pieces;
+      int64_t outBegin = (end - start) * piece / pieces;
+      int64_t outEnd = (end - start) * (piece + 1) / pieces;
+      int64_t aBegin = _ctMergeSplit(pSrc + start, aCount, pSrc + mid, bCount, outBegin, less);
+      int64_t aEnd = _ctMergeSplit(pSrc + start, aCount, pSrc + mid, bCount, outEnd, less);
+      _ctMerge(pSrc + start + aBegin, pSrc + start + aEnd, pSrc + mid + (outBegin - aBegin), pSrc + mid + (outEnd - aEnd), pDst + start + outBegin, less);
+    }, pJobs);
+    std::swap(pSrc, pDst);
+  }
+
+  if (pSrc != pBegin)
+    ctParallelFor(0, count, 0, [=](int64_t i) { pBegin[i] = std::move(pSrc[i]); }, pJobs);
+}
+
+template<typename T, typename Less>
+inline void ctParallelSort(ctVector<T> &vec, Less less, ctJobSystem *pJobs) { ctParallelSort(vec.begin(), vec.end(), less, pJobs); }
+
+//*************
+// ctRadixSort
+//*************
+
+// Maps a key to an unsigned integer with the same ordering
+template<typename Key, bool isFloat = std::is_floating_point<Key>::value> struct _ctRadixKey
+{
+  static_assert(std::is_integral<Key>::value, "ctRadixSort keys must be integers or floating point values");
+
+  typedef typename std::make_unsigned<Key>::type Bits;
+
+  static Bits Get(const Key &key)
+  {
+    Bits bits = (Bits)key;
+    if (std::is_signed<Key>::value)
+      bits ^= (Bits)1 << (sizeof(Bits) * 8 - 1);
+    return bits;
+  }
+};
+
+template<typename Key> struct _ctRadixKey<Key, true>
+{
+  typedef typename std::conditional<sizeof(Key) == 4, uint32_t, uint64_t>::type Bits;
+
+  static Bits Get(const Key &key)
+  {
+    Bits bits;
+    memcpy(&bits, &key, sizeof(Bits));
+
+    // Flip every bit of negative values, and only the sign bit of positive values
+    Bits signBit = (Bits)1 << (sizeof(Bits) * 8 - 1);
+    return bits ^ ((bits & signBit) ? ~(Bits)0 : signBit);
+  }
+};
+
+template<typename T, typename KeyFunc>
+inline void ctRadixSortBy(T *pBegin, T *pEnd, KeyFunc key)
+{
+  typedef typename std::decay<decltype(key(*pBegin))>::type Key;
+  typedef _ctRadixKey<Key> Radix;
+  typedef typename Radix::Bits Bits;
+  static const int64_t digits = sizeof(Bits);
+
+  int64_t count = pEnd - pBegin;
+  if (count < _ctRadixSortInsertionLimit)
+  {
+    auto less = [&key](const T &a, const T &b) { return Radix::Get(key(a)) < Radix::Get(key(b)); };
+    _ctInsertionSort(pBegin, pEnd, less);
+    return;
+  }
+
+  // Count the items for each value of every digit in a single pass
+  ctVector<int64_t> histograms(digits * 256, 0);
+  int64_t *pHistograms = histograms.data();
+  for (const T *pItem = pBegin; pItem != pEnd; ++pItem)
+  {
+    Bits bits = Radix::Get(key(*pItem));
+    for (int64_t digit = 0; digit < digits; ++digit)
+      ++pHistograms[digit * 256 + ((bits >> (digit * 8)) & 0xFF)];
+  }
+
+  ctVector<T> scratch(pBegin, count);
+  T *pSrc = pBegin;
+  T *pDst = scratch.data();
+  for (int64_t digit = 0; digit < digits; ++digit)
+  {
+    int64_t *pCounts = pHistograms + digit * 256;
+
+    // Skip digits that are the same for every item
+    Bits firstValue = (Radix::Get(key(*pSrc)) >> (digit * 8)) & 0xFF;
+    if (pCounts[firstValue] == count)
+      continue;
+
+    int64_t offset = 0;
+    for (int64_t i = 0; i < 256; ++i)
+    {
+      int64_t bucketSize = pCounts[i];
+      pCounts[i] = offset;
+      offset += bucketSize;
+    }
+
+    for (T *pItem = pSrc; pItem != pSrc + count; ++pItem)
+    {
+      Bits value = (Radix::Get(key(*pItem)) >> (digit * 8)) & 0xFF;
+      pDst[pCounts[value]++] = std::move(*pItem);
+    }
+    std::swap(pSrc, pDst);
+  }
+
+  if (pSrc != pBegin)
+    for (int64_t i = 0; i < count; ++i)
+      pBegin[i] = std::move(pSrc[i]);
+}
+
+template<typename T, typename KeyFunc>
+inline void ctRadixSortBy(ctVector<T> &vec, KeyFunc key) { ctRadixSortBy(vec.begin(), vec.end(), key); }
+
+template<typename T>
+inline void ctRadixSort(T *pBegin, T *pEnd) { ctRadixSortBy(pBegin, pEnd, [](const T &value) { return value; }); }
+
+template<typename T>
+inline void ctRadixSort(ctVector<T> &vec) { ctRadixSort(vec.begin(), vec.end()); }
+
+//************
+// ctIsSorted
+//************
+
+template<typename T, typename Less>
+inline bool ctIsSorted(const T *pBegin, const T *pEnd, Less less)
+{
+  for (const T *pItem = pBegin + 1; pItem < pEnd; ++pItem)
+    if (less(*pItem, *(pItem - 1)))
+      return false;
+  return true;
+}
+
+template<typename T, typename Less>
+inline bool ctIsSorted(const ctVector<T> &vec, Less less) { return ctIsSorted(vec.begin(), vec.end(), less); }
@@ -0,0 +1,179 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctTask_h__
+#define ctTask_h__
+
+#include "ctExecutor.h"
+#include "ctFuture.h"
+
+// ctTask requires compiler support for C++20 coroutines
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define ctCOROUTINES 1
+#else
+#define ctCOROUTINES 0
+#endif
+
+#if ctCOROUTINES
+
+#include <coroutine>
+#include <optional>
+
+template<typename T> class ctTask;
+
+// State shared by all task promises.
+// pExecutor is the executor the coroutine is resumed on after it waits on an awaitable.
+struct _ctTaskPromiseBase
+{
+  struct FinalAwaiter
+  {
+    bool await_ready() noexcept { return false; }
+    template<typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception();
+
+  ctExecutor *pExecutor = nullptr;
+  std::coroutine_handle<> continuation;
+};
+
+template<typename T> struct _ctTaskPromise : public _ctTaskPromiseBase
+{
+  ctTask<T> get_return_object();
+  template<typename U> void return_value(U &&value) { result.emplace(std::forward<U>(value)); }
+  T TakeResult() { return std::move(*result); }
+
+  std::optional<T> result;
+};
+
+template<> struct _ctTaskPromise<void> : public _ctTaskPromiseBase
+{
+  ctTask<void> get_return_object();
+  void return_void() {}
+  void TakeResult() {}
+};
+
+// Get the executor a coroutine is running on, or nullptr if it is not a ctTask
+template<typename Promise> ctExecutor* _ctCoroutineExecutor(std::coroutine_handle<Promise> handle);
+
+// Resume a coroutine on pExecutor, or on the calling thread if pExecutor is null
+void _ctResumeOn(ctExecutor *pExecutor, std::coroutine_handle<> handle);
+
+// A lazily started coroutine that produces a T.
+//
+// A task does not run until it is awaited with co_await, or started with ctSpawn().
+// An awaited task runs on the same executor as the coroutine that awaited it.
+// Exceptions are not supported. A task that throws terminates the program.
+template<typename T> class ctTask
+{
+public:
+  typedef _ctTaskPromise<T> promise_type;
+  typedef std::coroutine_handle<promise_type> Handle;
+
+  struct Awaiter
+  {
+    bool await_ready() const noexcept { return handle.done(); }
+    template<typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> caller) noexcept;
+    T await_resume() { return handle.promise().TakeResult(); }
+
+    Handle handle;
+  };
+
+  ctTask();
+  explicit ctTask(Handle handle);
+  ctTask(ctTask<T> &&move);
+  ~ctTask();
+
+  ctTask(const ctTask<T> &) = delete;
+  ctTask<T>& operator=(const ctTask<T> &) = delete;
+  ctTask<T>& operator=(ctTask<T> &&move);
+
+  bool IsValid() const;
+  bool IsDone() const;
+
+  Awaiter operator co_await() const noexcept;
+
+protected:
+  Handle m_handle;
+};
+
+// Start a task on pExecutor. Returns a future that completes with the task's result.
+// If pExecutor is null the task is started on the global job executor.
+template<typename T> ctFuture<T> ctSpawn(ctTask<T> task, ctExecutor *pExecutor = nullptr);
+
+// Start a task and block until it completes. Returns a copy of the result.
+// pExecutor must not need the calling thread to make progress.
+template<typename T> T ctSyncWait(ctTask<T> task, ctExecutor *pExecutor = nullptr);
+
+// Awaitable that moves the calling task to pExecutor.
+// co_await ctSchedule(&loop) continues the task on 'loop'.
+struct ctSchedule
+{
+  ctSchedule(ctExecutor *pExecutor) : pExecutor(pExecutor) {}
+
+  bool await_ready() const noexcept { return false; }
+  template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller);
+  void await_resume() const noexcept {}
+
+  ctExecutor *pExecutor;
+};
+
+// Awaitable that waits for a ctFuture without blocking a thread.
+// co_await returns the completed future. Check Failed()/Cancelled() before calling Get().
+template<typename T> struct _ctFutureAwaiter
+{
+  bool await_ready() const { return future.IsDone(); }
+  template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller);
+  ctFuture<T> await_resume() { return std::move(future); }
+
+  ctFuture<T> future;
+};
+
+template<typename T> _ctFutureAwaiter<T> operator co_await(const ctFuture<T> &future);
+
+// Awaitable that calls fn() as a job on pJobs (or the global job system) and resumes
+// the calling task with the result. Use this to keep blocking calls off an event loop.
+template<typename Func> struct _ctOffloadAwaiter
+{
+  typedef decltype(std::declval<Func&>()()) Result;
+
+  bool await_ready() const noexcept { return false; }
+  template<typename Promise> void await_suspend(std::coroutine_handle<Promise> caller);
+  Result await_resume();
+
+  Func fn;
+  ctJobSystem *pJobs;
+  std::optional<typename std::conditional<std::is_void<Result>::value, bool, Result>::type> result;
+};
+
+template<typename Func> _ctOffloadAwaiter<Func> ctOffload(Func fn, ctJobSystem *pJobs = nullptr);
+
+#include "ctTask.inl"
+
+#endif // ctCOROUTINES
+
+#endif // ctTask_h__
@@ -0,0 +1,175 @@
+#include "ctTask.h"
+
+template<typename Promise>
+inline std::coroutine_handle<> _ctTaskPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> handle) noexcept
+{
+  // Continue the awaiting coroutine on this thread
+  std::coroutine_handle<> next = handle.promise().continuation;
+  return next ? next : std::noop_coroutine();
+}
+
+template<typename T>
+inline ctTask<T> _ctTaskPromise<T>::get_return_object() { return ctTask<T>(ctTask<T>::Handle::from_promise(*this)); }
+
+inline ctTask<void> _ctTaskPromise<void>::get_return_object() { return ctTask<void>(ctTask<void>::Handle::from_promise(*this)); }
+
+template<typename Promise>
+inline ctExecutor* _ctCoroutineExecutor(std::coroutine_handle<Promise> handle)
+{
+  if constexpr (std::is_base_of<_ctTaskPromiseBase, Promise>::value)
+    return handle.promise().pExecutor;
+  else
+    return nullptr;
+}
+
+//********
+// ctTask
+//********
+
+template<typename T> inline ctTask<T>::ctTask() {}
+template<typename T> inline ctTask<T>::ctTask(Handle handle) : m_handle(handle) {}
+template<typename T> inline ctTask<T>::ctTask(ctTask<T> &&move) : m_handle(move.m_handle) { move.m_handle = nullptr; }
+
+template<typename T>
+inline ctTask<T>::~ctTask()
+{
+  if (m_handle)
+    m_handle.destroy();
+}
+
+template<typename T>
+inline ctTask<T>& ctTask<T>::operator=(ctTask<T> &&move)
+{
+  if (m_handle)
+    m_handle.destroy();
+  m_handle = move.m_handle;
+  move.m_handle = nullptr;
+  return *this;
+}
+
+template<typename T> inline bool ctTask<T>::IsValid() const { return (bool)m_handle; }
+template<typename T> inline bool ctTask<T>::IsDone() const { return m_handle && m_handle.done(); }
+
+template<typename T>
+inline typename ctTask<T>::Awaiter ctTask<T>::operator co_await() const noexcept
+{
+  ctAssert(m_handle, "Awaiting an invalid task");
+  return Awaiter{ m_handle };
+}
+
+template<typename T>
+template<typename Promise>
+inline std::coroutine_handle<> ctTask<T>::Awaiter::await_suspend(std::coroutine_handle<Promise> caller) noexcept
+{
+  // Run the task on the caller's executor and resume the caller when it finishes
+  handle.promise().continuation = caller;
+  handle.promise().pExecutor = _ctCoroutineExecutor(caller);
+  return handle;
+}
+
+//*********
+// ctSpawn
+//*********
+
+// A self destroying coroutine used to run a task that nothing awaits
+struct _ctDetachedTask
+{
+  struct promise_type : public _ctTaskPromiseBase
+  {
+    _ctDetachedTask get_return_object() { return _ctDetachedTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+inline _ctDetachedTask _ctRunDetached(ctTask<T> task, ctPromise<T> promise)
+{
+  if constexpr (std::is_void<T>::value)
+  {
+    co_await task;
+    promise.SetValue();
+  }
+  else
+  {
+    promise.SetValue(co_await task);
+  }
+}
+
+template<typename T>
+inline ctFuture<T> ctSpawn(ctTask<T> task, ctExecutor *pExecutor)
+{
+  if (pExecutor == nullptr)
+    pExecutor = ctJobExecutor::Global();
+
+  ctPromise<T> promise;
+  ctFuture<T> future = promise.Future();
+  _ctDetachedTask detached = _ctRunDetached(std::move(task), std::move(promise));
+  detached.handle.promise().pExecutor = pExecutor;
+  _ctResumeOn(pExecutor, detached.handle);
+  return future;
+}
+
+template<typename T>
+inline T ctSyncWait(ctTask<T> task, ctExecutor *pExecutor)
+{
+  ctFuture<T> future = ctSpawn(std::move(task), pExecutor);
+  if constexpr (std::is_void<T>::value)
+    future.Wait();
+  else
+    return future.Get();
+}
+
+//************
+// Awaitables
+//************
+
+template<typename Promise>
+inline void ctSchedule::await_suspend(std::coroutine_handle<Promise> caller)
+{
+  if constexpr (std::is_base_of<_ctTaskPromiseBase, Promise>::value)
+    caller.promise().pExecutor = pExecutor;
+  _ctResumeOn(pExecutor, caller);
+}
+
+template<typename T>
+template<typename Promise>
+inline void _ctFutureAwaiter<T>::await_suspend(std::coroutine_handle<Promise> caller)
+{
+  ctExecutor *pExecutor = _ctCoroutineExecutor(caller);
+  future.OnComplete([pExecutor, caller]() { _ctResumeOn(pExecutor, caller); });
+}
+
+template<typename T>
+inline _ctFutureAwaiter<T> operator co_await(const ctFuture<T> &future) { return _ctFutureAwaiter<T>{ future }; }
+
+template<typename Func>
+template<typename Promise>
+inline void _ctOffloadAwaiter<Func>::await_suspend(std::coroutine_handle<Promise> caller)
+{
+  ctExecutor *pExecutor = _ctCoroutineExecutor(caller);
+  (pJobs ? pJobs : ctJobSystem::Global())->Run([this, pExecutor, caller]() {
+    if constexpr (std::is_void<Result>::value)
+    {
+      fn();
+      result.emplace(true);
+    }
+    else
+    {
+      result.emplace(fn());
+    }
+    _ctResumeOn(pExecutor, caller);
+  });
+}
+
+template<typename Func>
+inline typename _ctOffloadAwaiter<Func>::Result _ctOffloadAwaiter<Func>::await_resume()
+{
+  if constexpr (!std::is_void<Result>::value)
+    return std::move(*result);
+}
+
+template<typename Func>
+inline _ctOffloadAwaiter<Func> ctOffload(Func fn, ctJobSystem *pJobs) { return _ctOffloadAwaiter<Func>{ std::move(fn), pJobs }; }
@@ -0,0 +1,126 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ctThreadLocal_h__
+#define ctThreadLocal_h__
+
+#include "ctThreading.h"
+#include "ctVector.h"
+#include <functional>
+
+// Per-thread slot in the table of thread local values
+struct _ctThreadLocalSlot
+{
+  uint64_t generation = 0;
+  void *pValue = nullptr;
+};
+
+// The calling thread's table of values, indexed by ctThreadLocal instance
+extern thread_local _ctThreadLocalSlot *_ctThreadLocalSlots;
+extern thread_local int64_t _ctThreadLocalSlotCount;
+
+class _ctThreadLocalBase
+{
+  friend class _ctThreadLocalRegistry;
+
+public:
+  _ctThreadLocalBase(const _ctThreadLocalBase &) = delete;
+  _ctThreadLocalBase& operator=(const _ctThreadLocalBase &) = delete;
+
+  // The number of threads that have a value
+  int64_t ThreadCount() const;
+
+protected:
+  _ctThreadLocalBase();
+  virtual ~_ctThreadLocalBase();
+
+  // Get the calling thread's value, or nullptr if it has not been created
+  void* Find() const;
+
+  // Create the calling thread's value
+  void* Create();
+
+  // Destroy every thread's value. Must be called by derived destructors.
+  void Release();
+
+  virtual void* Construct() = 0;
+  virtual void Destruct(void *pValue) = 0;
+
+  // Destroy a value created for a thread that has exited
+  void ReleaseValue(void *pValue);
+
+  int64_t m_index = -1;
+  uint64_t m_generation = 0;
+
+  mutable std::mutex m_lock;
+  ctVector<void*> m_values;
+};
+
+// An instance of T for each thread that accesses it.
+//
+// Values are created on a thread's first call to Get() and destroyed when the thread
+// exits or the ctThreadLocal is destroyed. Get() does not lock once the value exists.
+// ForEach() and Combine() visit the values of every thread, e.g. to aggregate per-thread
+// counters. They are not synchronised with the owning threads' use of their values.
+template<typename T>
+class ctThreadLocal : public _ctThreadLocalBase
+{
+public:
+  // Values are default constructed
+  ctThreadLocal();
+
+  // Values are copy constructed from initial
+  explicit ctThreadLocal(const T &initial);
+
+  // Values are created by calling create()
+  explicit ctThreadLocal(std::function<T()> create);
+
+  ~ctThreadLocal();
+
+  // Get the calling thread's value
+  T& Get();
+  T* operator->();
+  T& operator*();
+
+  // Call fn(T &value) for each thread's value
+  template<typename Func> void ForEach(Func &&fn);
+  template<typename Func> void ForEach(Func &&fn) const;
+
+  // Reduce all thread's values using reduce(Result, const T &)
+  template<typename Result, typename ReduceFunc> Result Combine(Result initial, ReduceFunc &&reduce) const;
+
+  // Destroy every thread's value. Threads will create a new value on their next call to Get().
+  // Must not be called while other threads may be using their value.
+  void Clear();
+
+protected:
+  void* Construct() override;
+  void Destruct(void *pValue) override;
+
+  std::function<T()> m_create;
+};
+
+#include "ctThreadLocal.inl"
+
+#endif // ctThreadLocal_h__
@@ -0,0 +1,78 @@
+#include "ctThreadLocal.h"
+
+inline void* _ctThreadLocalBase::Find() const
+{
+  if (m_index >= _ctThreadLocalSlotCount)
+    return nullptr;
+
+  // Slots left by a previous instance with the same index have an older generation
+  const _ctThreadLocalSlot &slot = _ctThreadLocalSlots[m_index];
+  return slot.generation == m_generation ? slot.pValue : nullptr;
+}
+
+template<typename T> inline ctThreadLocal<T>::ctThreadLocal() {}
+template<typename T> inline ctThreadLocal<T>::ctThreadLocal(const T &initial) : m_create([initial]() { return initial; }) {}
+template<typename T> inline ctThreadLocal<T>::ctThreadLocal(std::function<T()> create) : m_create(std::move(create)) {}
+template<typename T> inline ctThreadLocal<T>::~ctThreadLocal() { Release(); }
+
+template<typename T>
+inline T& ctThreadLocal<T>::Get()
+{
+  void *pValue = Find();
+  if (pValue == nullptr)
+    pValue = Create();
+  return *(T*)pValue;
+}
+
+template<typename T> inline T* ctThreadLocal<T>::operator->() { return &Get(); }
+template<typename T> inline T& ctThreadLocal<T>::operator*() { return Get(); }
+
+template<typename T>
+template<typename Func>
+inline void ctThreadLocal<T>::ForEach(Func &&fn)
+{
+  ctScopeLock lock(m_lock);
+  for (void *pValue : m_values)
+    fn(*(T*)pValue);
+}
+
+template<typename T>
+template<typename Func>
+inline void ctThreadLocal<T>::ForEach(Func &&fn) const
+{
+  ctScopeLock lock(m_lock);
+  for (void *pValue : m_values)
+    fn(*(const T*)pValue);
+}
+
+template<typename T>
+template<typename Result, typename ReduceFunc>
+inline Result ctThreadLocal<T>::Combine(Result initial, ReduceFunc &&reduce) const
+{
+  ForEach([&](const T &value) { initial = reduce(std::move(initial), value); });
+  return initial;
+}
+
+template<typename T>
+inline void ctThreadLocal<T>::Clear()
+{
+  Release();
+}
+
+template<typename T>
+inline void* ctThreadLocal<T>::Construct()
+{
+  T *pValue = (T*)ctAlloc(sizeof(T));
+  if (m_create)
+    ctConstruct(pValue, m_create());
+  else
+    ctConstruct(pValue);
+  return pValue;
+}
+
+template<typename T>
+inline void ctThreadLocal<T>::Destruct(void *pValue)
+{
+  ctDestruct((T*)pValue);
+  ctFree(pValue);
+}
@@ -3,6 +3,12 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include <chrono>
+#include <condition_variable>
+#include "ctMetrics.h"
 
 class ctScopeLock
 {
@@ -46,6 +52,164 @@ private:
   std::recursive_mutex &m_mutex;
 };
 
+// Number of spins before a spin-wait loop starts yielding
+#define ctSPIN_YIELD_COUNT 64
+
+// Pause briefly inside a spin-wait loop
+void ctCpuRelax();
+
+// Pause, or yield once *pSpins reaches ctSPIN_YIELD_COUNT
+void ctSpinWait(int64_t *pSpins);
+
+// A test-and-test-and-set spinlock for very short critical sections
+class ctSpinLock
+{
+public:
+  ctSpinLock();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+private:
+  std::atomic<bool> m_locked;
+};
+
+// A fair spinlock. Threads acquire the lock in the order they requested it.
+class ctTicketLock
+{
+public:
+  ctTicketLock();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+private:
+  std::atomic<uint32_t> m_next;
+  std::atomic<uint32_t> m_serving;
+};
+
+// A mutex that spins for a short time before parking the thread.
+// The spin limit adapts to how long the lock is typically held.
+class ctAdaptiveMutex
+{
+public:
+  ctAdaptiveMutex();
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+private:
+  enum State : int32_t
+  {
+    Unlocked,
+    Locked,
+    Contended,
+  };
+
+  void LockSlow();
+  void Wake();
+
+  std::atomic<int32_t> m_state;
+  std::atomic<int32_t> m_spinLimit;
+
+  std::mutex m_parkLock;
+  std::condition_variable m_parked;
+};
+
+// A reader-writer lock for read-mostly data.
+// Any number of readers may hold the lock at once. Waiting writers block new
+// readers so that they are not starved. Threads spin briefly before parking.
+class ctRWLock
+{
+public:
+  ctRWLock();
+
+  // Exclusive (writer) access
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  // Shared (reader) access
+  void lock_shared();
+  bool try_lock_shared();
+  void unlock_shared();
+
+private:
+  static const int64_t Writer = 1ll << 62;
+  static const int64_t WriterPending = 1ll << 61;
+  static const int64_t ReaderMask = WriterPending - 1;
+
+  void LockSlow();
+  void LockSharedSlow();
+  void Park(const int64_t blockingMask);
+  void WakeAll();
+
+  std::atomic<int64_t> m_state;
+  std::atomic<int64_t> m_parkedCount;
+
+  std::mutex m_parkLock;
+  std::condition_variable m_parked;
+};
+
+// A sequence lock protecting a small trivially copyable value.
+// Readers never write to shared memory. They copy the value and retry if a
+// writer modified it during the copy. Writers are serialized by a spinlock.
+template<typename T> class ctSeqLock
+{
+public:
+  ctSeqLock(const T &initial = T());
+
+  // Copy the current value
+  T Read() const;
+
+  // Try to copy the current value without retrying.
+  // Returns false if a writer was active.
+  bool TryRead(T *pValue) const;
+
+  void Write(const T &value);
+
+  // Call fn(T &value) to modify the value in place
+  template<typename Func> void Update(Func &&fn);
+
+private:
+  std::atomic<uint64_t> m_sequence;
+  ctSpinLock m_writeLock;
+  T m_value;
+};
+
+// Holds exclusive ownership of a lock for the lifetime of the object.
+// Works with any type that has lock() and unlock().
+template<typename T> class ctExclusiveScopeLock
+{
+public:
+  ctExclusiveScopeLock(T &lock);
+  ~ctExclusiveScopeLock();
+
+private:
+  T &m_lock;
+};
+
+// Holds shared ownership of a lock for the lifetime of the object.
+// Works with any type that has lock_shared() and unlock_shared().
+template<typename T> class ctSharedScopeLock
+{
+public:
+  ctSharedScopeLock(T &lock);
+  ~ctSharedScopeLock();
+
+private:
+  T &m_lock;
+};
+
+typedef ctExclusiveScopeLock<ctSpinLock> ctSpinScopeLock;
+typedef ctExclusiveScopeLock<ctTicketLock> ctTicketScopeLock;
+typedef ctExclusiveScopeLock<ctAdaptiveMutex> ctAdaptiveScopeLock;
+typedef ctExclusiveScopeLock<ctRWLock> ctWriteScopeLock;
+typedef ctSharedScopeLock<ctRWLock> ctReadScopeLock;
+
 class ctThreadedObject
 {
 public:
@@ -55,9 +219,12 @@ public:
     CO_Sleep,
     CO_Pause,
     CO_Stop,
+    CO_Wait,
   };
 
-  ctThreadedObject(void *pUserData = nullptr);
+  // 'name' selects the wake latency histogram. Objects with the same name share one
+  // histogram in the metrics registry ("ctThreadedObject.wakeLatency.<name>").
+  ctThreadedObject(void *pUserData = nullptr, const char *name = nullptr);
   ~ctThreadedObject();
 
   // Cause the thread to start executing
@@ -69,6 +236,11 @@ public:
   // Cause the thread to exit as soon as possible
   void Stop();
 
+  // Wake the thread if it is sleeping or waiting so that Execute is called again
+  // immediately. If the thread is busy, its next attempt to sleep or wait returns
+  // straight away so the notification is not lost.
+  void Notify();
+
   // Cause the thread to sleep for the specified duration before the next call
   // to Process. The duration passed to Sleep is accumulated until it the
   // threads next attempt to sleep. This means if for example, Sleep(10) then Sleep(20) is
@@ -92,10 +264,15 @@ public:
   // Returns the std::thread::id object accosiated with this thread
   std::thread::id ThreadID() const;
 
+  // Time in nanoseconds between a call to Notify() and the thread calling Execute.
+  // Shared by every object constructed with the same name.
+  const ctMetricHistogram& WakeLatency() const;
+
   // This will be called repeatedly until one of the following occurs.
   //  1. CO_Stop is returned (causing the thread to exit)
   //  2. Stop() is called.
-  // The return value of this function determines how the thread shall continue
+  // The return value of this function determines how the thread shall continue.
+  // CO_Sleep sleeps for SleepTime() and CO_Wait waits until Notify() is called.
   virtual ControlOption Execute(void *pUserData) = 0;
 
   // Overload this function to specify the time for the thread to sleep
@@ -103,21 +280,33 @@ public:
   // Default is 0 (resulting in a Yield)
   virtual int64_t SleepTime() { return 1; }
 
+protected:
+  // Block the thread until Notify(), Pause() or Stop() is called, or the deadline passes.
+  // Returns true if woken by Notify(). Should only be called from Execute.
+  bool WaitUntil(const std::chrono::steady_clock::time_point &deadline);
+  bool WaitFor(const int64_t milliseconds);
+
 private:
   void* m_pUserData;
   
-  volatile int64_t m_nextSleepTime;
-  volatile bool m_shouldPause;
-  volatile bool m_shouldStop;
-  volatile bool m_isPaused;
-  volatile bool m_isRunning;
-  volatile bool m_isSleeping;
+  int64_t m_nextSleepTime;
+  int64_t m_notifyTime;
+  bool m_notified;
+  bool m_shouldPause;
+  bool m_shouldStop;
+  bool m_isPaused;
+  bool m_isRunning;
+  bool m_isSleeping;
 
   int64_t m_threadID;
 
-  std::mutex m_writeLock;
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+  ctMetricHistogram *m_pWakeLatency;
 
-  void Sleep();
+  // Wait until woken or the deadline passes. m_lock must be held.
+  bool Wait(std::unique_lock<std::mutex> &lock, const std::chrono::steady_clock::time_point *pDeadline);
+  void OnWake();
 
   static void Run(ctThreadedObject *pBase);
   
@@ -129,4 +318,6 @@ private:
 void ctSleep(const int64_t milliseconds);
 void ctYield();
 
+#include "ctThreading.inl"
+
 #endif // atThreading_h__
@@ -0,0 +1,202 @@
+#include "ctThreading.h"
+
+#if ctMSVC
+#include <intrin.h>
+#endif
+
+inline void ctCpuRelax()
+{
+#if ctMSVC
+  _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+inline void ctSpinWait(int64_t *pSpins)
+{
+  // Give up the time slice if the holder may have been preempted
+  if (++*pSpins < ctSPIN_YIELD_COUNT)
+    ctCpuRelax();
+  else
+    std::this_thread::yield();
+}
+
+//************
+// ctSpinLock
+//************
+
+inline ctSpinLock::ctSpinLock() : m_locked(false) {}
+
+inline void ctSpinLock::lock()
+{
+  int64_t spins = 0;
+  while (m_locked.exchange(true, std::memory_order_acquire))
+  { // Wait on a plain load so the cache line is shared while the lock is held
+    while (m_locked.load(std::memory_order_relaxed))
+      ctSpinWait(&spins);
+  }
+}
+
+inline bool ctSpinLock::try_lock() { return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire); }
+inline void ctSpinLock::unlock() { m_locked.store(false, std::memory_order_release); }
+
+//**************
+// ctTicketLock
+//**************
+
+inline ctTicketLock::ctTicketLock()
+  : m_next(0)
+  , m_serving(0)
+{}
+
+inline void ctTicketLock::lock()
+{
+  uint32_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+  int64_t spins = 0;
+  while (m_serving.load(std::memory_order_acquire) != ticket)
+    ctSpinWait(&spins);
+}
+
+inline bool ctTicketLock::try_lock()
+{
+  uint32_t serving = m_serving.load(std::memory_order_acquire);
+  return m_next.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void ctTicketLock::unlock() { m_serving.store(m_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+//*****************
+// ctAdaptiveMutex
+//*****************
+
+inline void ctAdaptiveMutex::lock()
+{
+  if (!try_lock())
+    LockSlow();
+}
+
+inline bool ctAdaptiveMutex::try_lock()
+{
+  int32_t state = Unlocked;
+  return m_state.compare_exchange_strong(state, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void ctAdaptiveMutex::unlock()
+{
+  if (m_state.exchange(Unlocked, std::memory_order_release) == Contended)
+    Wake();
+}
+
+//**********
+// ctRWLock
+//**********
+
+inline void ctRWLock::lock()
+{
+  if (!try_lock())
+    LockSlow();
+}
+
+inline bool ctRWLock::try_lock()
+{
+  int64_t state = m_state.load(std::memory_order_relaxed);
+  return (state & (Writer | ReaderMask)) == 0 && m_state.compare_exchange_strong(state, Writer, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void ctRWLock::unlock()
+{
+  // Sequentially consistent so WakeAll sees threads that parked before the store.
+  // Leave WriterPending set if another writer is waiting
+  m_state.fetch_and(~Writer);
+  WakeAll();
+}
+
+inline void ctRWLock::lock_shared()
+{
+  if (!try_lock_shared())
+    LockSharedSlow();
+}
+
+inline bool ctRWLock::try_lock_shared()
+{
+  int64_t state = m_state.load(std::memory_order_relaxed);
+  return (state & (Writer | WriterPending)) == 0 && m_state.compare_exchange_strong(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+inline void ctRWLock::unlock_shared()
+{
+  int64_t state = m_state.fetch_sub(1) - 1;
+
+  // The last reader out wakes a waiting writer
+  if ((state & ReaderMask) == 0 && (state & WriterPending) != 0)
+    WakeAll();
+}
+
+//***********
+// ctSeqLock
+//***********
+
+template<typename T>
+inline ctSeqLock<T>::ctSeqLock(const T &initial)
+  : m_sequence(0)
+  , m_value(initial)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "ctSeqLock requires a trivially copyable type");
+}
+
+template<typename T>
+inline T ctSeqLock<T>::Read() const
+{
+  T value;
+  int64_t spins = 0;
+  while (!TryRead(&value))
+    ctSpinWait(&spins);
+  return value;
+}
+
+template<typename T>
+inline bool ctSeqLock<T>::TryRead(T *pValue) const
+{
+  uint64_t before = m_sequence.load(std::memory_order_acquire);
+  if (before & 1)
+    return false; // Write in progress
+
+  memcpy((void*)pValue, (const void*)&m_value, sizeof(T));
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return m_sequence.load(std::memory_order_relaxed) == before;
+}
+
+template<typename T>
+inline void ctSeqLock<T>::Write(const T &value)
+{
+  Update([&value](T &dst) { memcpy((void*)&dst, (const void*)&value, sizeof(T)); });
+}
+
+template<typename T>
+template<typename Func>
+inline void ctSeqLock<T>::Update(Func &&fn)
+{
+  ctSpinScopeLock lock(m_writeLock);
+
+  // An odd sequence number tells readers a write is in progress
+  uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+  m_sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  fn(m_value);
+  m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//*************
+// Scope locks
+//*************
+
+template<typename T> inline ctExclusiveScopeLock<T>::ctExclusiveScopeLock(T &lock) : m_lock(lock) { m_lock.lock(); }
+template<typename T> inline ctExclusiveScopeLock<T>::~ctExclusiveScopeLock() { m_lock.unlock(); }
+
+template<typename T> inline ctSharedScopeLock<T>::ctSharedScopeLock(T &lock) : m_lock(lock) { m_lock.lock_shared(); }
+template<typename T> inline ctSharedScopeLock<T>::~ctSharedScopeLock() { m_lock.unlock_shared(); }
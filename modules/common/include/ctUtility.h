@@ -61,10 +61,13 @@
 #define ctLINE __LINE__
 #define ctFILE __FILE__
 
+// Size in bytes assumed for a cache line when padding shared data
+#define ctCACHE_LINE_SIZE 64
+
 // OS Defines
 #if defined(_WIN32) || defined(_WIN64)
 #define ctPLATFORM_WIN32
-#elif defined linux
+#elif defined(__linux__) || defined(linux)
 #define ctPLATFORM_LINUX
 #endif
 
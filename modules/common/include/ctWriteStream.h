@@ -28,6 +28,7 @@
 
 #include "ctStreamSeekable.h"
 #include "ctTypes.h"
+#include "ctIOSlice.h"
 
 #define ctTrivialStreamWrite(type) inline int64_t ctStreamWrite(ctWriteStream *pStream, const type *pData, const int64_t count) { return ctStreamWrite(pStream, (const void*)pData, (int64_t)sizeof(type) * count); }
 
@@ -36,6 +37,10 @@ class ctWriteStream : public ctStreamSeekable
 public:
   // Writes pData to the file
   virtual int64_t Write(const void *pData, const int64_t len) = 0;
+
+  // Write a list of slices in order, as if they were one block.
+  // Returns the number of bytes written. By default each slice is written in turn.
+  virtual int64_t WriteV(const ctIOSlice *pSlices, const int64_t count);
   template<typename T> int64_t Write(const T *pData, const int64_t count = 1);
   template<typename T> int64_t Write(const T &data);
 };
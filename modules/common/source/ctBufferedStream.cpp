@@ -0,0 +1,190 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctBufferedStream.h"
+
+//******************
+// ctBufferedReader
+//******************
+
+ctBufferedReader::ctBufferedReader(ctReadStream *pStream, const int64_t bufferSize)
+  : m_pStream(pStream)
+  , m_buffer(ctMax(bufferSize, (int64_t)1), (uint8_t)0)
+{}
+
+int64_t ctBufferedReader::ReadSlow(void *pBuffer, const int64_t size)
+{
+  uint8_t *pDst = (uint8_t*)pBuffer;
+
+  // Use what is left in the buffer first
+  int64_t buffered = m_end - m_pos;
+  memcpy(pDst, m_buffer.data() + m_pos, (size_t)buffered);
+  m_pos = m_end = 0;
+
+  int64_t total = buffered;
+  int64_t remaining = size - buffered;
+
+  // Large reads go straight to the destination
+  if (remaining >= m_buffer.size())
+  {
+    int64_t read = m_pStream->Read(pDst + total, remaining);
+    return total + ctMax(read, (int64_t)0);
+  }
+
+  while (remaining > 0)
+  {
+    if (Fill() <= 0)
+      break;
+
+    int64_t count = ctMin(remaining, m_end - m_pos);
+    memcpy(pDst + total, m_buffer.data() + m_pos, (size_t)count);
+    m_pos += count;
+    total += count;
+    remaining -= count;
+  }
+
+  return total;
+}
+
+int64_t ctBufferedReader::Peek(void *pBuffer, const int64_t size)
+{
+  if (size > m_buffer.size())
+    return ctReadStream::Peek(pBuffer, size);
+
+  while (m_end - m_pos < size)
+    if (Fill() <= 0)
+      break;
+
+  int64_t count = ctMin(size, m_end - m_pos);
+  memcpy(pBuffer, m_buffer.data() + m_pos, (size_t)count);
+  return count;
+}
+
+int64_t ctBufferedReader::Fill()
+{
+  if (m_pos > 0)
+  {
+    memmove(m_buffer.data(), m_buffer.data() + m_pos, (size_t)(m_end - m_pos));
+    m_end -= m_pos;
+    m_pos = 0;
+  }
+
+  int64_t read = m_pStream->Read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+  if (read > 0)
+    m_end += read;
+  return read;
+}
+
+bool ctBufferedReader::Seek(const int64_t loc, const ctSeekOrigin origin)
+{
+  // The wrapped stream is positioned at the end of the buffered data
+  int64_t target = 0;
+  switch (origin)
+  {
+  case atSO_Current:
+    if (m_pos + loc >= 0 && m_pos + loc <= m_end)
+    {
+      m_pos += loc;
+      return true;
+    }
+    target = Tell() + loc;
+    break;
+  case atSO_Start: target = loc; break;
+  case atSO_End: target = m_pStream->Length() + loc; break;
+  default: return false;
+  }
+
+  int64_t bufferStart = m_pStream->Tell() - m_end;
+  if (target >= bufferStart && target <= bufferStart + m_end)
+  {
+    m_pos = target - bufferStart;
+    return true;
+  }
+
+  // Keep the buffered data if the wrapped stream cannot seek
+  if (!m_pStream->Seek(target, atSO_Start))
+    return false;
+  m_pos = m_end = 0;
+  return true;
+}
+
+int64_t ctBufferedReader::Tell() const { return m_pStream->Tell() - (m_end - m_pos); }
+int64_t ctBufferedReader::Length() const { return m_pStream->Length(); }
+int64_t ctBufferedReader::Available() const { return (m_end - m_pos) + m_pStream->Available(); }
+
+bool ctBufferedReader::Reset()
+{
+  int64_t unread = m_end - m_pos;
+  m_pos = m_end = 0;
+  return unread == 0 || m_pStream->Seek(-unread, atSO_Current);
+}
+
+ctReadStream* ctBufferedReader::Stream() const { return m_pStream; }
+
+//******************
+// ctBufferedWriter
+//******************
+
+ctBufferedWriter::ctBufferedWriter(ctWriteStream *pStream, const int64_t bufferSize)
+  : m_pStream(pStream)
+  , m_buffer(ctMax(bufferSize, (int64_t)1), (uint8_t)0)
+{}
+
+ctBufferedWriter::~ctBufferedWriter() { Flush(); }
+
+int64_t ctBufferedWriter::WriteSlow(const void *pData, const int64_t len)
+{
+  if (!Flush())
+    return 0;
+
+  // Large writes go straight to the stream
+  if (len >= m_buffer.size())
+    return m_pStream->Write(pData, len);
+
+  memcpy(m_buffer.data(), pData, (size_t)len);
+  m_size = len;
+  return len;
+}
+
+bool ctBufferedWriter::Flush()
+{
+  if (m_size == 0)
+    return true;
+
+  int64_t written = m_pStream->Write(m_buffer.data(), m_size);
+  if (written > 0 && written < m_size)
+    memmove(m_buffer.data(), m_buffer.data() + written, (size_t)(m_size - written));
+  m_size -= ctMax(written, (int64_t)0);
+  return m_size == 0;
+}
+
+bool ctBufferedWriter::Seek(const int64_t loc, const ctSeekOrigin origin)
+{
+  return Flush() && m_pStream->Seek(loc, origin);
+}
+
+int64_t ctBufferedWriter::Tell() const { return m_pStream->Tell() + m_size; }
+int64_t ctBufferedWriter::Length() const { return ctMax(m_pStream->Length(), Tell()); }
+
+ctWriteStream* ctBufferedWriter::Stream() const { return m_pStream; }
@@ -0,0 +1,402 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "ctChecksum.h"
+#include "ctUtility.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ctCRC32C_SSE42 1
+#if ctMSVC
+#include <intrin.h>
+#else
+#include <nmmintrin.h>
+#endif
+#endif
+
+//*******
+// CRC32C
+//*******
+
+static const uint32_t _crcPolynomial = 0x82F63B78; // Reflected Castagnoli polynomial
+
+// Tables for slicing-by-8. table[0] is the usual byte at a time table and
+// table[n] advances a byte through n more bytes of zeros.
+struct _CRCTables
+{
+  _CRCTables()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit)
+        crc = (crc >> 1) ^ (_crcPolynomial & (0 - (crc & 1)));
+      table[0][i] = crc;
+    }
+
+    for (uint32_t i = 0; i < 256; ++i)
+      for (int n = 1; n < 8; ++n)
+        table[n][i] = (table[n - 1][i] >> 8) ^ table[0][table[n - 1][i] & 0xFF];
+  }
+
+  uint32_t table[8][256];
+};
+
+static uint64_t _Read64(const uint8_t *pData)
+{
+  uint64_t val;
+  memcpy(&val, pData, sizeof(val));
+  return val;
+}
+
+static uint32_t _Read32(const uint8_t *pData)
+{
+  uint32_t val;
+  memcpy(&val, pData, sizeof(val));
+  return val;
+}
+
+static uint32_t _CRC32CSoftware(uint32_t crc, const uint8_t *pData, int64_t size)
+{
+  static const _CRCTables tables;
+  const uint32_t (&t)[8][256] = tables.table;
+
+  for (; size >= 8; size -= 8, pData += 8)
+  {
+    uint64_t word = _Read64(pData) ^ crc;
+    crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF]
+        ^ t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+  }
+
+  for (; size > 0; --size, ++pData)
+    crc = (crc >> 8) ^ t[0][(crc ^ *pData) & 0xFF];
+  return crc;
+}
+
+#ifdef ctCRC32C_SSE42
+// The crc32 instruction has a latency of 3 cycles but can start every cycle, so large
+// buffers are checksummed as three interleaved lanes which are then combined.
+static const int64_t _crcLongLane = 8192;
+static const int64_t _crcShortLane = 256;
+
+// Multiply a vector by a 32x32 matrix over GF(2)
+static uint32_t _GF2Multiply(const uint32_t *pMatrix, uint32_t vec)
+{
+  uint32_t sum = 0;
+  for (; vec != 0; vec >>= 1, ++pMatrix)
+    if (vec & 1)
+      sum ^= *pMatrix;
+  return sum;
+}
+
+static void _GF2Square(uint32_t *pSquare, const uint32_t *pMatrix)
+{
+  for (int n = 0; n < 32; ++n)
+    pSquare[n] = _GF2Multiply(pMatrix, pMatrix[n]);
+}
+
+// Tables that advance a CRC through a fixed number of zero bytes.
+// Used to append the CRC of one lane to the CRC of the lane before it.
+struct _CRCShiftTable
+{
+  _CRCShiftTable(int64_t len)
+  {
+    // Operator for one zero bit, squared up to the number of zero bytes
+    uint32_t odd[32];
+    uint32_t even[32];
+    odd[0] = _crcPolynomial;
+    for (int n = 1; n < 32; ++n)
+      odd[n] = 1u << (n - 1);
+    _GF2Square(even, odd); // 2 bits
+    _GF2Square(odd, even); // 4 bits
+
+    const uint32_t *pOp = odd;
+    while (len > 0)
+    {
+      _GF2Square(even, odd);
+      pOp = even;
+      len >>= 1;
+      if (len == 0)
+        break;
+      _GF2Square(odd, even);
+      pOp = odd;
+      len >>= 1;
+    }
+
+    for (uint32_t i = 0; i < 256; ++i)
+      for (int n = 0; n < 4; ++n)
+        table[n][i] = _GF2Multiply(pOp, i << (n * 8));
+  }
+
+  uint32_t Shift(const uint32_t crc) const
+  {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+  }
+
+  uint32_t table[4][256];
+};
+
+#if !ctMSVC
+__attribute__((target("sse4.2")))
+#endif
+static uint64_t _CRC32CLanes(uint64_t crc, const uint8_t **ppData, int64_t *pSize, const int64_t lane, const _CRCShiftTable &shift)
+{
+  const uint8_t *pData = *ppData;
+  int64_t size = *pSize;
+  for (; size >= lane * 3; size -= lane * 3, pData += lane * 3)
+  {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (int64_t i = 0; i < lane; i += 8)
+    {
+      crc = _mm_crc32_u64(crc, _Read64(pData + i));
+      crc1 = _mm_crc32_u64(crc1, _Read64(pData + lane + i));
+      crc2 = _mm_crc32_u64(crc2, _Read64(pData + lane * 2 + i));
+    }
+    crc = shift.Shift((uint32_t)crc) ^ (uint32_t)crc1;
+    crc = shift.Shift((uint32_t)crc) ^ (uint32_t)crc2;
+  }
+
+  *ppData = pData;
+  *pSize = size;
+  return crc;
+}
+
+#if !ctMSVC
+__attribute__((target("sse4.2")))
+#endif
+static uint32_t _CRC32CHardware(uint32_t crc, const uint8_t *pData, int64_t size)
+{
+  static const _CRCShiftTable longShift(_crcLongLane);
+  static const _CRCShiftTable shortShift(_crcShortLane);
+
+  uint64_t crc64 = crc;
+  crc64 = _CRC32CLanes(crc64, &pData, &size, _crcLongLane, longShift);
+  crc64 = _CRC32CLanes(crc64, &pData, &size, _crcShortLane, shortShift);
+
+  for (; size >= 8; size -= 8, pData += 8)
+    crc64 = _mm_crc32_u64(crc64, _Read64(pData));
+
+  crc = (uint32_t)crc64;
+  for (; size > 0; --size, ++pData)
+    crc = _mm_crc32_u8(crc, *pData);
+  return crc;
+}
+
+static bool _HasSSE42()
+{
+#if ctMSVC
+  int info[4] = { 0 };
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+}
+#endif
+
+typedef uint32_t (*_CRCFunc)(uint32_t crc, const uint8_t *pData, int64_t size);
+
+static _CRCFunc _SelectCRC()
+{
+#ifdef ctCRC32C_SSE42
+  if (_HasSSE42())
+    return _CRC32CHardware;
+#endif
+  return _CRC32CSoftware;
+}
+
+uint32_t ctCRC32C(const void *pData, const int64_t size, const uint32_t crc)
+{
+  static const _CRCFunc impl = _SelectCRC();
+  return ~impl(~crc, (const uint8_t*)pData, size);
+}
+
+//*********
+// xxHash64
+//*********
+
+static const uint64_t _xxPrime1 = 11400714785074694791ULL;
+static const uint64_t _xxPrime2 = 14029467366897019727ULL;
+static const uint64_t _xxPrime3 = 1609587929392839161ULL;
+static const uint64_t _xxPrime4 = 9650029242287828579ULL;
+static const uint64_t _xxPrime5 = 2870177450012600261ULL;
+
+static uint64_t _RotL(const uint64_t val, const int bits) { return (val << bits) | (val >> (64 - bits)); }
+
+static uint64_t _XXRound(uint64_t acc, const uint64_t input)
+{
+  acc += input * _xxPrime2;
+  acc = _RotL(acc, 31);
+  return acc * _xxPrime1;
+}
+
+static uint64_t _XXMerge(uint64_t acc, const uint64_t val)
+{
+  acc ^= _XXRound(0, val);
+  return acc * _xxPrime1 + _xxPrime4;
+}
+
+static void _XXStripes(uint64_t *pAcc, const uint8_t *pData, const int64_t stripes)
+{
+  uint64_t v1 = pAcc[0], v2 = pAcc[1], v3 = pAcc[2], v4 = pAcc[3];
+  for (int64_t i = 0; i < stripes; ++i, pData += 32)
+  {
+    v1 = _XXRound(v1, _Read64(pData));
+    v2 = _XXRound(v2, _Read64(pData + 8));
+    v3 = _XXRound(v3, _Read64(pData + 16));
+    v4 = _XXRound(v4, _Read64(pData + 24));
+  }
+  pAcc[0] = v1; pAcc[1] = v2; pAcc[2] = v3; pAcc[3] = v4;
+}
+
+static void _XXInit(uint64_t *pAcc, const uint64_t seed)
+{
+  pAcc[0] = seed + _xxPrime1 + _xxPrime2;
+  pAcc[1] = seed + _xxPrime2;
+  pAcc[2] = seed;
+  pAcc[3] = seed - _xxPrime1;
+}
+
+// Mix the accumulators with the trailing bytes that did not fill a stripe
+static uint64_t _XXFinish(const uint64_t *pAcc, const uint64_t seed, const int64_t total, const uint8_t *pTail, int64_t size)
+{
+  uint64_t hash;
+  if (total >= 32)
+  {
+    hash = _RotL(pAcc[0], 1) + _RotL(pAcc[1], 7) + _RotL(pAcc[2], 12) + _RotL(pAcc[3], 18);
+    for (int i = 0; i < 4; ++i)
+      hash = _XXMerge(hash, pAcc[i]);
+  }
+  else
+  {
+    hash = seed + _xxPrime5;
+  }
+
+  hash += (uint64_t)total;
+  for (; size >= 8; size -= 8, pTail += 8)
+  {
+    hash ^= _XXRound(0, _Read64(pTail));
+    hash = _RotL(hash, 27) * _xxPrime1 + _xxPrime4;
+  }
+
+  if (size >= 4)
+  {
+    hash ^= (uint64_t)_Read32(pTail) * _xxPrime1;
+    hash = _RotL(hash, 23) * _xxPrime2 + _xxPrime3;
+    size -= 4;
+    pTail += 4;
+  }
+
+  for (; size > 0; --size, ++pTail)
+  {
+    hash ^= *pTail * _xxPrime5;
+    hash = _RotL(hash, 11) * _xxPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= _xxPrime2;
+  hash ^= hash >> 29;
+  hash *= _xxPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t ctXXHash64(const void *pData, const int64_t size, const uint64_t seed)
+{
+  uint64_t acc[4];
+  _XXInit(acc, seed);
+  int64_t stripes = size / 32;
+  _XXStripes(acc, (const uint8_t*)pData, stripes);
+  return _XXFinish(acc, seed, size, (const uint8_t*)pData + stripes * 32, size - stripes * 32);
+}
+
+//***********
+// ctChecksum
+//***********
+
+ctChecksum::ctChecksum(const ctChecksumType type, const uint64_t seed)
+  : m_type(type)
+  , m_seed(seed)
+{
+  Reset();
+}
+
+void ctChecksum::Update(const void *pData, const int64_t size)
+{
+  if (size <= 0)
+    return;
+
+  m_count += size;
+  switch (m_type)
+  {
+  case ctCT_CRC32C: m_crc = ctCRC32C(pData, size, m_crc); break;
+  case ctCT_XXHash64: UpdateXXHash((const uint8_t*)pData, size); break;
+  }
+}
+
+void ctChecksum::UpdateXXHash(const uint8_t *pData, int64_t size)
+{
+  if (m_stripeSize > 0)
+  { // Complete the partial stripe first
+    int64_t count = ctMin(size, 32 - m_stripeSize);
+    memcpy(m_stripe + m_stripeSize, pData, (size_t)count);
+    m_stripeSize += count;
+    pData += count;
+    size -= count;
+    if (m_stripeSize < 32)
+      return;
+
+    _XXStripes(m_acc, m_stripe, 1);
+    m_stripeSize = 0;
+  }
+
+  int64_t stripes = size / 32;
+  _XXStripes(m_acc, pData, stripes);
+  m_stripeSize = size - stripes * 32;
+  memcpy(m_stripe, pData + stripes * 32, (size_t)m_stripeSize);
+}
+
+uint64_t ctChecksum::Digest() const
+{
+  switch (m_type)
+  {
+  case ctCT_CRC32C: return m_crc;
+  case ctCT_XXHash64: return _XXFinish(m_acc, m_seed, m_count, m_stripe, m_stripeSize);
+  }
+  return 0;
+}
+
+void ctChecksum::Reset()
+{
+  m_count = 0;
+  m_crc = (uint32_t)m_seed;
+  m_stripeSize = 0;
+  _XXInit(m_acc, m_seed);
+}
+
+ctChecksumType ctChecksum::Type() const { return m_type; }
+int64_t ctChecksum::DigestSize() const { return m_type == ctCT_CRC32C ? sizeof(uint32_t) : sizeof(uint64_t); }
+int64_t ctChecksum::Count() const { return m_count; }
@@ -0,0 +1,142 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "ctChecksumStream.h"
+
+// Update a checksum with the first 'size' bytes of a slice list
+static void _UpdateSlices(ctChecksum *pChecksum, const ctIOSlice *pSlices, const int64_t count, int64_t size)
+{
+  for (int64_t i = 0; i < count && size > 0; ++i)
+  {
+    int64_t len = ctMin(pSlices[i].size, size);
+    pChecksum->Update(pSlices[i].pData, len);
+    size -= len;
+  }
+}
+
+//***********************
+// ctChecksumWriteStream
+//***********************
+
+ctChecksumWriteStream::ctChecksumWriteStream(ctWriteStream *pStream, const ctChecksumType type, const uint64_t seed)
+  : m_pStream(pStream)
+  , m_checksum(type, seed)
+{}
+
+int64_t ctChecksumWriteStream::Write(const void *pData, const int64_t len)
+{
+  int64_t written = m_pStream->Write(pData, len);
+  m_checksum.Update(pData, written);
+  return written;
+}
+
+int64_t ctChecksumWriteStream::WriteV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t written = m_pStream->WriteV(pSlices, count);
+  _UpdateSlices(&m_checksum, pSlices, count, written);
+  return written;
+}
+
+bool ctChecksumWriteStream::WriteChecksum()
+{
+  bool result = false;
+  if (m_checksum.Type() == ctCT_CRC32C)
+  {
+    uint32_t digest = (uint32_t)m_checksum.Digest();
+    result = m_pStream->Write(&digest, 1) == sizeof(digest);
+  }
+  else
+  {
+    uint64_t digest = m_checksum.Digest();
+    result = m_pStream->Write(&digest, 1) == sizeof(digest);
+  }
+
+  Reset();
+  return result;
+}
+
+uint64_t ctChecksumWriteStream::Checksum() const { return m_checksum.Digest(); }
+void ctChecksumWriteStream::Reset() { m_checksum.Reset(); }
+
+bool ctChecksumWriteStream::Seek(const int64_t loc, const ctSeekOrigin origin) { return false; }
+int64_t ctChecksumWriteStream::Tell() const { return m_pStream->Tell(); }
+int64_t ctChecksumWriteStream::Length() const { return m_pStream->Length(); }
+
+ctWriteStream* ctChecksumWriteStream::Stream() const { return m_pStream; }
+
+//**********************
+// ctChecksumReadStream
+//**********************
+
+ctChecksumReadStream::ctChecksumReadStream(ctReadStream *pStream, const ctChecksumType type, const uint64_t seed)
+  : m_pStream(pStream)
+  , m_checksum(type, seed)
+{}
+
+int64_t ctChecksumReadStream::Read(void *pBuffer, const int64_t size)
+{
+  int64_t read = m_pStream->Read(pBuffer, size);
+  m_checksum.Update(pBuffer, read);
+  return read;
+}
+
+int64_t ctChecksumReadStream::ReadV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t read = m_pStream->ReadV(pSlices, count);
+  _UpdateSlices(&m_checksum, pSlices, count, read);
+  return read;
+}
+
+int64_t ctChecksumReadStream::Peek(void *pBuffer, const int64_t size) { return m_pStream->Peek(pBuffer, size); }
+
+bool ctChecksumReadStream::VerifyChecksum()
+{
+  uint64_t expected = m_checksum.Digest();
+  uint64_t digest = 0;
+  bool result = false;
+  if (m_checksum.Type() == ctCT_CRC32C)
+  {
+    uint32_t crc = 0;
+    result = m_pStream->Read(&crc, 1) == sizeof(crc);
+    digest = crc;
+  }
+  else
+  {
+    result = m_pStream->Read(&digest, 1) == sizeof(digest);
+  }
+
+  Reset();
+  return result && digest == expected;
+}
+
+uint64_t ctChecksumReadStream::Checksum() const { return m_checksum.Digest(); }
+void ctChecksumReadStream::Reset() { m_checksum.Reset(); }
+
+bool ctChecksumReadStream::Seek(const int64_t loc, const ctSeekOrigin origin) { return false; }
+int64_t ctChecksumReadStream::Tell() const { return m_pStream->Tell(); }
+int64_t ctChecksumReadStream::Length() const { return m_pStream->Length(); }
+int64_t ctChecksumReadStream::Available() const { return m_pStream->Available(); }
+
+ctReadStream* ctChecksumReadStream::Stream() const { return m_pStream; }
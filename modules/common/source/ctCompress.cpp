@@ -0,0 +1,790 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "ctCompress.h"
+#include "ctUtility.h"
+#include "ctVector.h"
+#include <cstring>
+
+#if ctMSVC
+#include <intrin.h>
+#endif
+
+static uint16_t _Read16(const uint8_t *pData) { uint16_t val; memcpy(&val, pData, sizeof(val)); return val; }
+static uint32_t _Read32(const uint8_t *pData) { uint32_t val; memcpy(&val, pData, sizeof(val)); return val; }
+static uint64_t _Read64(const uint8_t *pData) { uint64_t val; memcpy(&val, pData, sizeof(val)); return val; }
+static void _Write16(uint8_t *pData, const uint16_t val) { memcpy(pData, &val, sizeof(val)); }
+
+static int64_t _LowestBit(const uint64_t value)
+{
+#if ctMSVC
+  unsigned long index = 0;
+  _BitScanForward64(&index, value);
+  return (int64_t)index;
+#else
+  return (int64_t)__builtin_ctzll(value);
+#endif
+}
+
+static int64_t _HighestBit(const uint64_t value)
+{
+#if ctMSVC
+  unsigned long index = 0;
+  _BitScanReverse64(&index, value);
+  return (int64_t)index;
+#else
+  return 63 - (int64_t)__builtin_clzll(value);
+#endif
+}
+
+// Returns the number of bytes that match at pA and pB, comparing no further than pLimit from pA
+static int64_t _MatchLength(const uint8_t *pA, const uint8_t *pB, const uint8_t *pLimit)
+{
+  const uint8_t *pStart = pA;
+  while (pA + 8 <= pLimit)
+  {
+    uint64_t diff = _Read64(pA) ^ _Read64(pB);
+    if (diff != 0)
+      return (pA - pStart) + (_LowestBit(diff) >> 3);
+    pA += 8;
+    pB += 8;
+  }
+
+  while (pA < pLimit && *pA == *pB)
+  {
+    ++pA;
+    ++pB;
+  }
+  return pA - pStart;
+}
+
+//***
+// LZ
+//***
+
+// A sequence is a token holding 4 bits of literal length and 4 bits of match length,
+// extra literal length bytes, the literals, a 16-bit offset and extra match length bytes.
+static const int64_t _lzMinMatch = 4;
+static const int64_t _lzLastLiterals = 5; // The last 5 bytes of a block are always literals
+static const int64_t _lzMatchSafety = 12; // and the last match starts at least 12 bytes before the end
+static const int64_t _lzMaxOffset = 65535;
+static const int _lzHashBits = 14;
+
+static uint32_t _LZHash(const uint32_t val) { return (val * 2654435761u) >> (32 - _lzHashBits); }
+
+static uint8_t* _LZWriteLength(uint8_t *pOut, int64_t len)
+{
+  for (; len >= 255; len -= 255)
+    *pOut++ = 255;
+  *pOut++ = (uint8_t)len;
+  return pOut;
+}
+
+// Returns the most bytes a sequence with this many literals and match bytes can take
+static int64_t _LZSequenceBound(const int64_t literals, const int64_t matchLength)
+{
+  return 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1;
+}
+
+static int64_t _LZCompress(const uint8_t *pSrc, const int64_t srcSize, uint8_t *pDst, const int64_t dstCapacity)
+{
+  uint32_t table[1 << _lzHashBits];
+  memset(table, 0, sizeof(table));
+
+  uint8_t *pOut = pDst;
+  uint8_t *pOutEnd = pDst + dstCapacity;
+  int64_t anchor = 0;
+
+  if (srcSize > _lzMatchSafety)
+  {
+    const int64_t matchStartLimit = srcSize - _lzMatchSafety;
+    const uint8_t *pMatchLimit = pSrc + srcSize - _lzLastLiterals;
+    int64_t ip = 1;
+    int64_t misses = 0;
+    while (ip <= matchStartLimit)
+    {
+      uint32_t hash = _LZHash(_Read32(pSrc + ip));
+      int64_t ref = table[hash];
+      table[hash] = (uint32_t)ip;
+      if (ref >= ip || ip - ref > _lzMaxOffset || _Read32(pSrc + ref) != _Read32(pSrc + ip))
+      { // Step faster through data that is not compressing
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+
+      // Extend the match back over the pending literals
+      while (ip > anchor && ref > 0 && pSrc[ip - 1] == pSrc[ref - 1])
+      {
+        --ip;
+        --ref;
+      }
+
+      int64_t length = _lzMinMatch + _MatchLength(pSrc + ip + _lzMinMatch, pSrc + ref + _lzMinMatch, pMatchLimit);
+      int64_t literals = ip - anchor;
+      if (_LZSequenceBound(literals, length - _lzMinMatch) > pOutEnd - pOut)
+        return -1;
+
+      uint8_t *pToken = pOut++;
+      uint8_t token = 0;
+      if (literals >= 15)
+      {
+        token = 15 << 4;
+        pOut = _LZWriteLength(pOut, literals - 15);
+      }
+      else
+      {
+        token = (uint8_t)(literals << 4);
+      }
+
+      memcpy(pOut, pSrc + anchor, (size_t)literals);
+      pOut += literals;
+      _Write16(pOut, (uint16_t)(ip - ref));
+      pOut += 2;
+
+      int64_t extra = length - _lzMinMatch;
+      if (extra >= 15)
+      {
+        token |= 15;
+        pOut = _LZWriteLength(pOut, extra - 15);
+      }
+      else
+      {
+        token |= (uint8_t)extra;
+      }
+      *pToken = token;
+
+      ip += length;
+      anchor = ip;
+      if (ip <= matchStartLimit)
+        table[_LZHash(_Read32(pSrc + ip - 2))] = (uint32_t)(ip - 2);
+    }
+  }
+
+  int64_t literals = srcSize - anchor;
+  if (_LZSequenceBound(literals, 0) > pOutEnd - pOut)
+    return -1;
+
+  if (literals >= 15)
+  {
+    *pOut++ = 15 << 4;
+    pOut = _LZWriteLength(pOut, literals - 15);
+  }
+  else
+  {
+    *pOut++ = (uint8_t)(literals << 4);
+  }
+  if (literals > 0)
+    memcpy(pOut, pSrc + anchor, (size_t)literals);
+  pOut += literals;
+  return pOut - pDst;
+}
+
+// Reads extra length bytes. Returns false if the input ends first.
+static bool _LZReadLength(const uint8_t **ppIn, const uint8_t *pEnd, int64_t *pLength)
+{
+  uint8_t byte = 255;
+  while (byte == 255)
+  {
+    if (*ppIn >= pEnd)
+      return false;
+    byte = *(*ppIn)++;
+    *pLength += byte;
+  }
+  return true;
+}
+
+static int64_t _LZDecompress(const uint8_t *pSrc, const int64_t srcSize, uint8_t *pDst, const int64_t dstCapacity)
+{
+  const uint8_t *pIn = pSrc;
+  const uint8_t *pInEnd = pSrc + srcSize;
+  uint8_t *pOut = pDst;
+  uint8_t *pOutEnd = pDst + dstCapacity;
+
+  while (true)
+  {
+    if (pIn >= pInEnd)
+      return -1;
+
+    uint8_t token = *pIn++;
+    int64_t literals = token >> 4;
+    if (literals == 15 && !_LZReadLength(&pIn, pInEnd, &literals))
+      return -1;
+    if (literals > pInEnd - pIn || literals > pOutEnd - pOut)
+      return -1;
+
+    if (literals <= 16 && pInEnd - pIn >= 16 && pOutEnd - pOut >= 16)
+      memcpy(pOut, pIn, 16); // Fixed size copies are much faster for the common short runs
+    else
+      memcpy(pOut, pIn, (size_t)literals);
+    pIn += literals;
+    pOut += literals;
+    if (pIn == pInEnd)
+      break; // The last sequence has no match
+
+    if (pInEnd - pIn < 2)
+      return -1;
+    int64_t offset = _Read16(pIn);
+    pIn += 2;
+    if (offset == 0 || offset > pOut - pDst)
+      return -1;
+
+    int64_t length = token & 15;
+    if (length == 15 && !_LZReadLength(&pIn, pInEnd, &length))
+      return -1;
+    length += _lzMinMatch;
+    if (length > pOutEnd - pOut)
+      return -1;
+
+    // Matches may overlap the bytes they produce
+    const uint8_t *pMatch = pOut - offset;
+    if (offset >= 8 && pOutEnd - pOut >= length + 8)
+    { // Copy in 8 byte steps, possibly past the end of the match
+      for (int64_t i = 0; i < length; i += 8)
+        memcpy(pOut + i, pMatch + i, 8);
+    }
+    else if (offset >= length)
+    {
+      memcpy(pOut, pMatch, (size_t)length);
+    }
+    else if (offset >= 8)
+    {
+      for (int64_t i = 0; i < length; i += 8)
+        memcpy(pOut + i, pMatch + i, (size_t)ctMin(length - i, (int64_t)8));
+    }
+    else
+    {
+      for (int64_t i = 0; i < length; ++i)
+        pOut[i] = pMatch[i];
+    }
+    pOut += length;
+  }
+
+  return pOut - pDst;
+}
+
+//********
+// Deflate
+//********
+
+static const int64_t _deflateWindow = 32768;
+static const int64_t _deflateMaxMatch = 258;
+static const int64_t _deflateMinMatch = 4; // Deflate allows 3, but matches are found with a 4 byte hash
+static const int64_t _deflateChainDepth = 16;
+static const int _deflateHashBits = 15;
+static const int _huffmanFastBits = 10;
+
+static const uint16_t _lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t _lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t _distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t _distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t _codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Huffman codes are packed starting from their most significant bit
+static uint32_t _ReverseBits(uint32_t code, const int64_t length)
+{
+  uint32_t reversed = 0;
+  for (int64_t i = 0; i < length; ++i, code >>= 1)
+    reversed = (reversed << 1) | (code & 1);
+  return reversed;
+}
+
+static void _FixedLengths(uint8_t *pLitLengths, uint8_t *pDistLengths)
+{
+  for (int i = 0; i < 288; ++i)
+    pLitLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+  for (int i = 0; i < 30; ++i)
+    pDistLengths[i] = 5;
+}
+
+// The fixed Huffman codes, bit reversed and ready to write
+struct _FixedCodes
+{
+  _FixedCodes()
+  {
+    uint8_t distLengths[30];
+    _FixedLengths(litLength, distLengths);
+    for (uint32_t i = 0; i < 288; ++i)
+    {
+      uint32_t code = i < 144 ? 0x30 + i : i < 256 ? 0x190 + (i - 144) : i < 280 ? i - 256 : 0xC0 + (i - 280);
+      litCode[i] = (uint16_t)_ReverseBits(code, litLength[i]);
+    }
+
+    for (uint32_t i = 0; i < 30; ++i)
+      distCode[i] = (uint16_t)_ReverseBits(i, 5);
+  }
+
+  uint16_t litCode[288];
+  uint8_t litLength[288];
+  uint16_t distCode[30];
+};
+
+class _BitWriter
+{
+public:
+  _BitWriter(uint8_t *pOut, const int64_t capacity) : m_pOut(pOut), m_pEnd(pOut + capacity) {}
+
+  void Put(const uint32_t value, const int64_t count)
+  {
+    m_bits |= (uint64_t)value << m_count;
+    m_count += count;
+    if (m_count >= 32)
+      Drain();
+  }
+
+  // Write the last partial byte. Returns the number of bytes written, or -1 if they did not fit.
+  int64_t Finish(uint8_t *pStart)
+  {
+    m_count += 7;
+    Drain();
+    return m_overflow ? -1 : m_pOut - pStart;
+  }
+
+protected:
+  void Drain()
+  {
+    for (; m_count >= 8; m_count -= 8, m_bits >>= 8)
+    {
+      if (m_pOut == m_pEnd)
+      {
+        m_overflow = true;
+        return;
+      }
+      *m_pOut++ = (uint8_t)m_bits;
+    }
+  }
+
+  uint8_t *m_pOut;
+  uint8_t *m_pEnd;
+  uint64_t m_bits = 0;
+  int64_t m_count = 0;
+  bool m_overflow = false;
+};
+
+static void _DeflateLiteral(_BitWriter *pWriter, const _FixedCodes &codes, const uint32_t symbol)
+{
+  pWriter->Put(codes.litCode[symbol], codes.litLength[symbol]);
+}
+
+static void _DeflateMatch(_BitWriter *pWriter, const _FixedCodes &codes, const int64_t length, const int64_t distance)
+{
+  // Lengths 3-10 have a code each, then each group of 4 codes doubles the range covered
+  int64_t code = 28;
+  int64_t len = length - 3;
+  if (length < _deflateMaxMatch)
+    code = len < 8 ? len : 4 * (_HighestBit(len) - 1) + ((len >> (_HighestBit(len) - 2)) & 3);
+  _DeflateLiteral(pWriter, codes, 257 + (uint32_t)code);
+  if (_lengthExtra[code] > 0)
+    pWriter->Put((uint32_t)(length - _lengthBase[code]), _lengthExtra[code]);
+
+  // Distances 1-4 have a code each, then each pair of codes doubles the range covered
+  int64_t dist = distance - 1;
+  code = dist < 4 ? dist : 2 * _HighestBit(dist) + ((dist >> (_HighestBit(dist) - 1)) & 1);
+  pWriter->Put(codes.distCode[code], 5);
+  if (_distExtra[code] > 0)
+    pWriter->Put((uint32_t)(distance - _distBase[code]), _distExtra[code]);
+}
+
+// Writes a single block using the fixed Huffman codes, so no code tables need to be stored
+static int64_t _Deflate(const uint8_t *pSrc, const int64_t srcSize, uint8_t *pDst, const int64_t dstCapacity)
+{
+  static const _FixedCodes codes;
+
+  ctVector<int32_t> head(1 << _deflateHashBits, -1);
+  ctVector<int32_t> prev(_deflateWindow, -1);
+  auto insert = [&](const int64_t pos) {
+    int64_t hash = (_Read32(pSrc + pos) * 2654435761u) >> (32 - _deflateHashBits);
+    prev[pos & (_deflateWindow - 1)] = head[hash];
+    head[hash] = (int32_t)pos;
+    return prev[pos & (_deflateWindow - 1)];
+  };
+
+  _BitWriter writer(pDst, dstCapacity);
+  writer.Put(1 | (1 << 1), 3); // Final block, fixed codes
+
+  int64_t ip = 0;
+  while (ip < srcSize)
+  {
+    int64_t bestLength = 0;
+    int64_t bestDistance = 0;
+    if (ip + _deflateMinMatch <= srcSize)
+    {
+      const uint8_t *pLimit = pSrc + ctMin(srcSize, ip + _deflateMaxMatch);
+      int64_t candidate = insert(ip);
+      for (int64_t depth = 0; depth < _deflateChainDepth && candidate >= 0 && ip - candidate <= _deflateWindow; ++depth)
+      {
+        int64_t length = _MatchLength(pSrc + ip, pSrc + candidate, pLimit);
+        if (length > bestLength)
+        {
+          bestLength = length;
+          bestDistance = ip - candidate;
+          if (pSrc + ip + length == pLimit)
+            break;
+        }
+
+        int64_t next = prev[candidate & (_deflateWindow - 1)];
+        if (next >= candidate)
+          break; // Overwritten by a newer position
+        candidate = next;
+      }
+    }
+
+    if (bestLength < _deflateMinMatch)
+    {
+      _DeflateLiteral(&writer, codes, pSrc[ip]);
+      ++ip;
+      continue;
+    }
+
+    _DeflateMatch(&writer, codes, bestLength, bestDistance);
+    for (int64_t i = 1; i < bestLength && ip + i + _deflateMinMatch <= srcSize; ++i)
+      insert(ip + i);
+    ip += bestLength;
+  }
+
+  _DeflateLiteral(&writer, codes, 256);
+  return writer.Finish(pDst);
+}
+
+class _BitReader
+{
+public:
+  _BitReader(const uint8_t *pIn, const int64_t size) : m_pIn(pIn), m_pEnd(pIn + size) {}
+
+  // Make sure at least 57 bits are buffered. Past the end of the input zeros are added.
+  void Refill()
+  {
+    for (; m_count <= 56; m_count += 8)
+    {
+      if (m_pIn < m_pEnd)
+        m_bits |= (uint64_t)*m_pIn++ << m_count;
+      else
+        ++m_padding;
+    }
+  }
+
+  uint32_t Get(const int64_t count)
+  {
+    if (m_count < count)
+      Refill();
+    uint32_t value = (uint32_t)(m_bits & ((1ull << count) - 1));
+    Consume(count);
+    return value;
+  }
+
+  void Consume(const int64_t count)
+  {
+    m_bits >>= count;
+    m_count -= count;
+  }
+
+  // Drop bits up to the next byte boundary and give any whole bytes that are buffered back to the input.
+  // Returns false if bits past the end of the input were used.
+  bool Align()
+  {
+    Consume(m_count & 7);
+    int64_t buffered = m_count / 8 - m_padding;
+    if (buffered < 0)
+      return false;
+    m_pIn -= buffered;
+    m_bits = 0;
+    m_count = 0;
+    m_padding = 0;
+    return true;
+  }
+
+  // Returns true if bits past the end of the input have been used
+  bool Overrun() const { return m_padding * 8 > m_count; }
+
+  const uint8_t *m_pIn;
+  const uint8_t *m_pEnd;
+  uint64_t m_bits = 0;
+  int64_t m_count = 0;
+  int64_t m_padding = 0;
+};
+
+// A canonical Huffman code. Short codes are decoded with a table lookup and longer codes bit by bit.
+struct _Huffman
+{
+  uint16_t count[16];
+  uint16_t symbol[288];
+  uint16_t fast[1 << _huffmanFastBits]; // (length << 9) | symbol, or 0 if the code is longer
+};
+
+static bool _BuildHuffman(_Huffman *pCode, const uint8_t *pLengths, const int64_t count)
+{
+  memset(pCode->count, 0, sizeof(pCode->count));
+  for (int64_t i = 0; i < count; ++i)
+    ++pCode->count[pLengths[i]];
+  pCode->count[0] = 0;
+
+  int64_t left = 1;
+  for (int64_t len = 1; len < 16; ++len)
+  {
+    left = (left << 1) - pCode->count[len];
+    if (left < 0)
+      return false; // Over-subscribed
+  }
+
+  uint16_t offsets[16] = { 0 };
+  for (int64_t len = 1; len < 15; ++len)
+    offsets[len + 1] = offsets[len] + pCode->count[len];
+  for (int64_t i = 0; i < count; ++i)
+    if (pLengths[i] != 0)
+      pCode->symbol[offsets[pLengths[i]]++] = (uint16_t)i;
+
+  memset(pCode->fast, 0, sizeof(pCode->fast));
+  uint32_t code = 0;
+  int64_t index = 0;
+  for (int64_t len = 1; len <= _huffmanFastBits; ++len, code <<= 1)
+  {
+    for (int64_t i = 0; i < pCode->count[len]; ++i, ++code, ++index)
+    {
+      uint16_t entry = (uint16_t)((len << 9) | pCode->symbol[index]);
+      for (uint32_t slot = _ReverseBits(code, len); slot < (1u << _huffmanFastBits); slot += 1u << len)
+        pCode->fast[slot] = entry;
+    }
+  }
+  return true;
+}
+
+// Returns the next symbol, or -1 if the bits are not a valid code
+static int64_t _DecodeSymbol(_BitReader *pReader, const _Huffman &code)
+{
+  if (pReader->m_count < 15)
+    pReader->Refill();
+
+  uint16_t entry = code.fast[pReader->m_bits & ((1 << _huffmanFastBits) - 1)];
+  if (entry != 0)
+  {
+    pReader->Consume(entry >> 9);
+    return entry & 511;
+  }
+
+  int64_t value = 0;
+  int64_t first = 0;
+  int64_t index = 0;
+  for (int64_t len = 1; len < 16; ++len)
+  {
+    value |= pReader->Get(1);
+    int64_t count = code.count[len];
+    if (value - first < count)
+      return code.symbol[index + value - first];
+    index += count;
+    first = (first + count) << 1;
+    value <<= 1;
+  }
+  return -1;
+}
+
+static bool _ReadDynamicCodes(_BitReader *pReader, _Huffman *pLit, _Huffman *pDist)
+{
+  int64_t litCount = pReader->Get(5) + 257;
+  int64_t distCount = pReader->Get(5) + 1;
+  int64_t lengthCount = pReader->Get(4) + 4;
+  if (litCount > 286 || distCount > 30)
+    return false;
+
+  uint8_t lengths[288 + 32] = { 0 };
+  for (int64_t i = 0; i < lengthCount; ++i)
+    lengths[_codeLengthOrder[i]] = (uint8_t)pReader->Get(3);
+
+  _Huffman lengthCode;
+  if (!_BuildHuffman(&lengthCode, lengths, 19))
+    return false;
+
+  // Literal/length and distance code lengths are run length encoded as one list
+  memset(lengths, 0, sizeof(lengths));
+  int64_t index = 0;
+  while (index < litCount + distCount)
+  {
+    int64_t symbol = _DecodeSymbol(pReader, lengthCode);
+    if (symbol < 0)
+      return false;
+    if (symbol < 16)
+    {
+      lengths[index++] = (uint8_t)symbol;
+      continue;
+    }
+
+    uint8_t value = 0;
+    int64_t repeat = 0;
+    if (symbol == 16)
+    {
+      if (index == 0)
+        return false;
+      value = lengths[index - 1];
+      repeat = 3 + pReader->Get(2);
+    }
+    else if (symbol == 17)
+    {
+      repeat = 3 + pReader->Get(3);
+    }
+    else
+    {
+      repeat = 11 + pReader->Get(7);
+    }
+
+    if (index + repeat > litCount + distCount)
+      return false;
+    for (; repeat > 0; --repeat)
+      lengths[index++] = value;
+  }
+
+  if (lengths[256] == 0)
+    return false; // No end of block code
+  return _BuildHuffman(pLit, lengths, litCount) && _BuildHuffman(pDist, lengths + litCount, distCount);
+}
+
+static int64_t _Inflate(const uint8_t *pSrc, const int64_t srcSize, uint8_t *pDst, const int64_t dstCapacity)
+{
+  struct FixedTables
+  {
+    FixedTables()
+    {
+      uint8_t litLengths[288];
+      uint8_t distLengths[30];
+      _FixedLengths(litLengths, distLengths);
+      _BuildHuffman(&lit, litLengths, 288);
+      _BuildHuffman(&dist, distLengths, 30);
+    }
+
+    _Huffman lit;
+    _Huffman dist;
+  };
+  static const FixedTables fixed;
+
+  _BitReader reader(pSrc, srcSize);
+  uint8_t *pOut = pDst;
+  uint8_t *pOutEnd = pDst + dstCapacity;
+  _Huffman dynamicLit;
+  _Huffman dynamicDist;
+
+  bool last = false;
+  while (!last)
+  {
+    last = reader.Get(1) == 1;
+    uint32_t type = reader.Get(2);
+    if (type == 0)
+    { // Stored
+      if (!reader.Align() || reader.m_pEnd - reader.m_pIn < 4)
+        return -1;
+      uint16_t len = _Read16(reader.m_pIn);
+      uint16_t check = _Read16(reader.m_pIn + 2);
+      reader.m_pIn += 4;
+      if (len != (uint16_t)~check || len > reader.m_pEnd - reader.m_pIn || len > pOutEnd - pOut)
+        return -1;
+      memcpy(pOut, reader.m_pIn, len);
+      reader.m_pIn += len;
+      pOut += len;
+      continue;
+    }
+
+    const _Huffman *pLit = &fixed.lit;
+    const _Huffman *pDist = &fixed.dist;
+    if (type == 2)
+    {
+      if (!_ReadDynamicCodes(&reader, &dynamicLit, &dynamicDist))
+        return -1;
+      pLit = &dynamicLit;
+      pDist = &dynamicDist;
+    }
+    else if (type != 1)
+    {
+      return -1;
+    }
+
+    while (true)
+    {
+      int64_t symbol = _DecodeSymbol(&reader, *pLit);
+      if (symbol < 0 || reader.Overrun())
+        return -1;
+
+      if (symbol < 256)
+      {
+        if (pOut == pOutEnd)
+          return -1;
+        *pOut++ = (uint8_t)symbol;
+        continue;
+      }
+
+      if (symbol == 256)
+        break;
+
+      symbol -= 257;
+      if (symbol >= 29)
+        return -1;
+      int64_t length = _lengthBase[symbol] + reader.Get(_lengthExtra[symbol]);
+
+      symbol = _DecodeSymbol(&reader, *pDist);
+      if (symbol < 0 || symbol >= 30)
+        return -1;
+      int64_t distance = _distBase[symbol] + reader.Get(_distExtra[symbol]);
+      if (distance > pOut - pDst || length > pOutEnd - pOut)
+        return -1;
+
+      const uint8_t *pMatch = pOut - distance;
+      for (int64_t i = 0; i < length; ++i)
+        pOut[i] = pMatch[i];
+      pOut += length;
+    }
+  }
+
+  return reader.Overrun() ? -1 : pOut - pDst;
+}
+
+//***********
+// ctCompress
+//***********
+
+int64_t ctCompressBound(const ctCompressCodec codec, const int64_t size)
+{
+  switch (codec)
+  {
+  case ctCC_LZ: return size + size / 255 + 16;
+  case ctCC_Deflate: return size + size / 8 + 16; // Literals take at most 9 bits
+  }
+  return 0;
+}
+
+int64_t ctCompress(const ctCompressCodec codec, const void *pSrc, const int64_t srcSize, void *pDst, const int64_t dstCapacity)
+{
+  switch (codec)
+  {
+  case ctCC_LZ: return _LZCompress((const uint8_t*)pSrc, srcSize, (uint8_t*)pDst, dstCapacity);
+  case ctCC_Deflate: return _Deflate((const uint8_t*)pSrc, srcSize, (uint8_t*)pDst, dstCapacity);
+  }
+  return -1;
+}
+
+int64_t ctDecompress(const ctCompressCodec codec, const void *pSrc, const int64_t srcSize, void *pDst, const int64_t dstCapacity)
+{
+  switch (codec)
+  {
+  case ctCC_LZ: return _LZDecompress((const uint8_t*)pSrc, srcSize, (uint8_t*)pDst, dstCapacity);
+  case ctCC_Deflate: return _Inflate((const uint8_t*)pSrc, srcSize, (uint8_t*)pDst, dstCapacity);
+  }
+  return -1;
+}
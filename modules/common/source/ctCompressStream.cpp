@@ -0,0 +1,591 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "ctCompressStream.h"
+#include <cstring>
+
+// Stream header: magic, version, codec, checksum type (0 for none), reserved, block size
+static const uint32_t _streamMagic = 0x5A437463; // "ctCZ"
+static const uint8_t _streamVersion = 1;
+static const int64_t _streamHeaderSize = 12;
+
+// Block frame: payload size, uncompressed size, payload, checksum of the uncompressed data.
+// Blocks that do not compress are stored and flagged in the payload size.
+// The stream ends with an empty frame followed by the total uncompressed size.
+static const int64_t _frameHeaderSize = 8;
+static const int64_t _endMarkerSize = _frameHeaderSize + sizeof(uint64_t);
+static const uint32_t _storedFlag = 0x80000000;
+static const int64_t _maxBlockSize = 1 << 26;
+
+static uint32_t _ReadU32(const uint8_t *pData) { uint32_t val; memcpy(&val, pData, sizeof(val)); return val; }
+static void _WriteU32(uint8_t *pData, const uint32_t val) { memcpy(pData, &val, sizeof(val)); }
+
+// Read exactly 'size' bytes. Streams such as sockets may return less than requested.
+static bool _ReadFull(ctReadStream *pStream, void *pBuffer, const int64_t size)
+{
+  int64_t total = 0;
+  while (total < size)
+  {
+    int64_t read = pStream->Read((uint8_t*)pBuffer + total, size - total);
+    if (read <= 0)
+      return false;
+    total += read;
+  }
+  return true;
+}
+
+static int64_t _DigestSize(const ctChecksumType type) { return ctChecksum(type).DigestSize(); }
+
+//***********************
+// ctCompressWriteStream
+//***********************
+
+ctCompressWriteStream::ctCompressWriteStream(ctWriteStream *pStream)
+  : ctCompressWriteStream(pStream, Options())
+{}
+
+ctCompressWriteStream::ctCompressWriteStream(ctWriteStream *pStream, const Options &options)
+  : m_pStream(pStream)
+  , m_options(options)
+{
+  m_options.blockSize = ctClamp(m_options.blockSize, (int64_t)1, _maxBlockSize);
+  if (m_options.parallel)
+  {
+    if (m_options.pJobs == nullptr)
+      m_options.pJobs = ctJobSystem::Global();
+
+    // Enough blocks to keep every worker busy while the next block is filled
+    m_maxInFlight = ctMax(m_options.pJobs->WorkerCount() + 1, (int64_t)2);
+  }
+}
+
+ctCompressWriteStream::~ctCompressWriteStream()
+{
+  Finish();
+
+  ctDelete(m_pBlock);
+  for (Block *pBlock : m_free)
+    ctDelete(pBlock);
+}
+
+int64_t ctCompressWriteStream::Write(const void *pData, const int64_t len)
+{
+  if (m_finished || m_failed || (!m_started && !WriteHeader()))
+    return 0;
+
+  const uint8_t *pSrc = (const uint8_t*)pData;
+  int64_t done = 0;
+  while (done < len)
+  {
+    if (m_pBlock == nullptr)
+      m_pBlock = NewBlock();
+
+    int64_t count = ctMin(len - done, m_options.blockSize - m_pBlock->size);
+    memcpy(m_pBlock->data.data() + m_pBlock->size, pSrc + done, (size_t)count);
+    m_pBlock->size += count;
+    done += count;
+    m_written += count;
+
+    if (m_pBlock->size == m_options.blockSize && !EndBlock())
+      break;
+  }
+
+  return done;
+}
+
+bool ctCompressWriteStream::Flush()
+{
+  if (m_finished || (!m_started && !WriteHeader()))
+    return false;
+
+  bool result = EndBlock();
+  while (m_inFlight.size() > 0)
+    result &= Retire();
+  return result && !m_failed;
+}
+
+bool ctCompressWriteStream::Finish()
+{
+  if (m_finished)
+    return !m_failed;
+
+  bool result = Flush();
+  m_finished = true;
+  if (!result)
+    return false;
+
+  uint8_t marker[_endMarkerSize] = { 0 };
+  uint64_t total = (uint64_t)m_written;
+  memcpy(marker + _frameHeaderSize, &total, sizeof(total));
+  m_failed = m_pStream->Write(marker, _endMarkerSize) != _endMarkerSize;
+  return !m_failed;
+}
+
+bool ctCompressWriteStream::WriteHeader()
+{
+  m_started = true;
+
+  uint8_t header[_streamHeaderSize] = { 0 };
+  _WriteU32(header, _streamMagic);
+  header[4] = _streamVersion;
+  header[5] = (uint8_t)m_options.codec;
+  header[6] = m_options.checksum ? (uint8_t)(m_options.checksumType + 1) : 0;
+  _WriteU32(header + 8, (uint32_t)m_options.blockSize);
+  m_failed = m_pStream->Write(header, _streamHeaderSize) != _streamHeaderSize;
+  return !m_failed;
+}
+
+bool ctCompressWriteStream::EndBlock()
+{
+  if (m_pBlock == nullptr || m_pBlock->size == 0)
+    return !m_failed;
+
+  if (!m_options.parallel)
+  { // Reuse the same block
+    Encode(m_pBlock);
+    m_pBlock->size = 0;
+    return WriteFrame(m_pBlock);
+  }
+
+  Block *pBlock = m_pBlock;
+  m_pBlock = nullptr;
+  m_options.pJobs->Run([this, pBlock]() { Encode(pBlock); }, &pBlock->done);
+  m_inFlight.push_back(pBlock);
+
+  bool result = true;
+  while (m_inFlight.size() > m_maxInFlight)
+    result &= Retire();
+  return result;
+}
+
+void ctCompressWriteStream::Encode(Block *pBlock) const
+{
+  uint8_t *pFrame = pBlock->frame.data();
+  uint8_t *pPayload = pFrame + _frameHeaderSize;
+  int64_t capacity = ctCompressBound(m_options.codec, m_options.blockSize);
+  int64_t size = pBlock->size;
+
+  int64_t payloadSize = ctCompress(m_options.codec, pBlock->data.data(), size, pPayload, capacity);
+  uint32_t sizeField = (uint32_t)payloadSize;
+  if (payloadSize < 0 || payloadSize >= size)
+  {
+    memcpy(pPayload, pBlock->data.data(), (size_t)size);
+    payloadSize = size;
+    sizeField = (uint32_t)size | _storedFlag;
+  }
+
+  _WriteU32(pFrame, sizeField);
+  _WriteU32(pFrame + 4, (uint32_t)size);
+  pBlock->frameSize = _frameHeaderSize + payloadSize;
+
+  if (m_options.checksum)
+  {
+    ctChecksum checksum(m_options.checksumType);
+    checksum.Update(pBlock->data.data(), size);
+    uint64_t digest = checksum.Digest();
+    if (checksum.DigestSize() == sizeof(uint32_t))
+      _WriteU32(pFrame + pBlock->frameSize, (uint32_t)digest);
+    else
+      memcpy(pFrame + pBlock->frameSize, &digest, sizeof(digest));
+    pBlock->frameSize += checksum.DigestSize();
+  }
+}
+
+bool ctCompressWriteStream::WriteFrame(Block *pBlock)
+{
+  if (!m_failed)
+    m_failed = m_pStream->Write(pBlock->frame.data(), pBlock->frameSize) != pBlock->frameSize;
+  return !m_failed;
+}
+
+bool ctCompressWriteStream::Retire()
+{
+  Block *pBlock = m_inFlight[0];
+  m_options.pJobs->Wait(&pBlock->done);
+  m_inFlight.erase(0);
+
+  bool result = WriteFrame(pBlock);
+  pBlock->size = 0;
+  m_free.push_back(pBlock);
+  return result;
+}
+
+ctCompressWriteStream::Block* ctCompressWriteStream::NewBlock()
+{
+  if (m_free.size() > 0)
+  {
+    Block *pBlock = m_free.back();
+    m_free.pop_back();
+    return pBlock;
+  }
+
+  Block *pBlock = ctNew(Block);
+  pBlock->data.resize(m_options.blockSize);
+  pBlock->frame.resize(_frameHeaderSize + ctCompressBound(m_options.codec, m_options.blockSize) + sizeof(uint64_t));
+  return pBlock;
+}
+
+bool ctCompressWriteStream::Seek(const int64_t loc, const ctSeekOrigin origin) { return false; }
+int64_t ctCompressWriteStream::Tell() const { return m_written; }
+int64_t ctCompressWriteStream::Length() const { return m_written; }
+
+ctWriteStream* ctCompressWriteStream::Stream() const { return m_pStream; }
+
+//************************
+// ctDecompressReadStream
+//************************
+
+ctDecompressReadStream::ctDecompressReadStream(ctReadStream *pStream)
+  : m_pStream(pStream)
+{}
+
+int64_t ctDecompressReadStream::Read(void *pBuffer, const int64_t size)
+{
+  if (!ReadHeader())
+    return 0;
+
+  uint8_t *pDst = (uint8_t*)pBuffer;
+  int64_t total = 0;
+  while (total < size)
+  {
+    if (m_blockPos == m_blockSize)
+    {
+      int64_t next = m_blockIndex + 1;
+      if (m_failed || (m_nextBlock != next && !SeekFrame(next)) || !ReadBlock())
+        break;
+      continue;
+    }
+
+    int64_t count = ctMin(size - total, m_blockSize - m_blockPos);
+    memcpy(pDst + total, m_block.data() + m_blockPos, (size_t)count);
+    m_blockPos += count;
+    total += count;
+  }
+
+  return total;
+}
+
+int64_t ctDecompressReadStream::Peek(void *pBuffer, const int64_t size)
+{
+  if (!ReadHeader())
+    return 0;
+
+  if (m_blockPos == m_blockSize)
+  { // Nothing is left in this block, so the next one can be loaded without losing data
+    int64_t next = m_blockIndex + 1;
+    if (m_failed || (m_nextBlock != next && !SeekFrame(next)) || !ReadBlock())
+      return 0;
+  }
+
+  if (size > m_blockSize - m_blockPos && CanSeekStream())
+    return ctReadStream::Peek(pBuffer, size);
+
+  // Reading ahead would lose data on a stream that cannot seek back, so stop at the end of the block
+  int64_t count = ctMin(size, m_blockSize - m_blockPos);
+  memcpy(pBuffer, m_block.data() + m_blockPos, (size_t)count);
+  return count;
+}
+
+bool ctDecompressReadStream::Seek(const int64_t loc, const ctSeekOrigin origin)
+{
+  if (!ReadHeader())
+    return false;
+
+  int64_t target = loc;
+  switch (origin)
+  {
+  case atSO_Start: break;
+  case atSO_Current: target += Tell(); break;
+  case atSO_End:
+    if (Length() < 0)
+      return false;
+    target += m_length;
+    break;
+  default: return false;
+  }
+
+  if (target < 0)
+    return false;
+
+  if (target >= m_blockStart && target <= m_blockStart + m_blockSize)
+  { // Within the current block
+    m_blockPos = target - m_blockStart;
+    return true;
+  }
+
+  int64_t index = FindBlock(target);
+  if (index < 0)
+    return false;
+
+  if (index == m_index.size())
+  { // At the end. The next read finds the end marker.
+    m_blockIndex = index - 1;
+    m_blockStart = target;
+    m_blockSize = m_blockPos = 0;
+    return true;
+  }
+
+  if (!SeekFrame(index) || !ReadBlock())
+    return false;
+  m_blockPos = target - m_blockStart;
+  return true;
+}
+
+int64_t ctDecompressReadStream::Tell() const { return m_blockStart + m_blockPos; }
+
+int64_t ctDecompressReadStream::Length() const
+{
+  if (m_length < 0)
+  { // Walk the block headers up to the end marker
+    ctDecompressReadStream *pThis = const_cast<ctDecompressReadStream*>(this);
+    if (pThis->CanSeekStream() && pThis->ReadHeader())
+      pThis->FindBlock(INT64_MAX);
+  }
+
+  return m_length;
+}
+
+int64_t ctDecompressReadStream::Available() const
+{
+  int64_t length = Length();
+  return length < 0 ? m_blockSize - m_blockPos : length - Tell();
+}
+
+bool ctDecompressReadStream::Failed() const { return m_failed; }
+ctReadStream* ctDecompressReadStream::Stream() const { return m_pStream; }
+
+bool ctDecompressReadStream::ReadHeader()
+{
+  if (m_started)
+    return !m_failed;
+  m_started = true;
+
+  uint8_t header[_streamHeaderSize];
+  if (!_ReadFull(m_pStream, header, _streamHeaderSize))
+  {
+    m_failed = true;
+    return false;
+  }
+
+  int64_t blockSize = _ReadU32(header + 8);
+  m_codec = (ctCompressCodec)header[5];
+  m_checksum = header[6] != 0;
+  m_checksumType = (ctChecksumType)(header[6] - 1);
+  if (_ReadU32(header) != _streamMagic || header[4] != _streamVersion || header[5] > ctCC_Deflate ||
+    header[6] > ctCT_XXHash64 + 1 || blockSize <= 0 || blockSize > _maxBlockSize)
+  {
+    m_failed = true;
+    return false;
+  }
+
+  m_maxBlockSize = blockSize;
+  m_block.resize(m_maxBlockSize);
+  m_compressed.resize(ctCompressBound(m_codec, m_maxBlockSize) + sizeof(uint64_t));
+  return true;
+}
+
+bool ctDecompressReadStream::ReadBlock()
+{
+  uint8_t header[_frameHeaderSize];
+  if (!_ReadFull(m_pStream, header, _frameHeaderSize))
+  { // Missing the end marker
+    m_failed = true;
+    return false;
+  }
+
+  uint32_t sizeField = _ReadU32(header);
+  int64_t size = _ReadU32(header + 4);
+  int64_t start = m_nextBlock == 0 ? 0 : m_index[m_nextBlock - 1].start + m_index[m_nextBlock - 1].size;
+  if (sizeField == 0 && size == 0)
+  {
+    uint64_t total = 0;
+    if (!_ReadFull(m_pStream, &total, sizeof(total)) || (int64_t)total != start)
+    {
+      m_failed = true;
+      return false;
+    }
+
+    m_length = start;
+    m_consumed += _endMarkerSize;
+    m_nextBlock = -1;
+    return false;
+  }
+
+  bool stored = (sizeField & _storedFlag) != 0;
+  int64_t payloadSize = sizeField & ~_storedFlag;
+  int64_t digestSize = m_checksum ? _DigestSize(m_checksumType) : 0;
+  if (size > m_maxBlockSize || payloadSize + digestSize > m_compressed.size() || (stored && payloadSize != size))
+  {
+    m_failed = true;
+    return false;
+  }
+
+  uint8_t *pPayload = stored ? m_block.data() : m_compressed.data();
+  uint8_t *pDigest = m_compressed.data() + (stored ? 0 : payloadSize);
+  if (!_ReadFull(m_pStream, pPayload, payloadSize) || !_ReadFull(m_pStream, pDigest, digestSize))
+  {
+    m_failed = true;
+    return false;
+  }
+
+  if (!stored && ctDecompress(m_codec, pPayload, payloadSize, m_block.data(), size) != size)
+  {
+    m_failed = true;
+    return false;
+  }
+
+  if (m_checksum)
+  {
+    ctChecksum checksum(m_checksumType);
+    checksum.Update(m_block.data(), size);
+    uint64_t expected = 0;
+    memcpy(&expected, pDigest, (size_t)digestSize);
+    if (checksum.Digest() != expected)
+    {
+      m_failed = true;
+      return false;
+    }
+  }
+
+  int64_t frameSize = _frameHeaderSize + payloadSize + digestSize;
+  if (m_nextBlock == m_index.size())
+    m_index.push_back({ m_consumed, frameSize, start, size });
+
+  m_blockIndex = m_nextBlock;
+  m_blockStart = start;
+  m_blockSize = size;
+  m_blockPos = 0;
+  m_consumed += frameSize;
+  ++m_nextBlock;
+  return true;
+}
+
+int64_t ctDecompressReadStream::FindBlock(const int64_t pos)
+{
+  while (true)
+  {
+    if (m_index.size() > 0 && pos < m_index.back().start + m_index.back().size)
+    { // Binary search the known blocks
+      int64_t first = 0;
+      int64_t last = m_index.size() - 1;
+      while (first < last)
+      {
+        int64_t mid = (first + last + 1) / 2;
+        if (m_index[mid].start <= pos)
+          first = mid;
+        else
+          last = mid - 1;
+      }
+      return first;
+    }
+
+    if (m_length >= 0)
+      return pos == m_length ? m_index.size() : -1;
+
+    if (m_failed || !CanSeekStream() || !IndexNextBlock())
+      return -1;
+  }
+}
+
+bool ctDecompressReadStream::IndexNextBlock()
+{
+  int64_t index = m_index.size();
+  if (m_nextBlock != index && !SeekFrame(index))
+    return false;
+
+  uint8_t header[_frameHeaderSize];
+  if (!_ReadFull(m_pStream, header, _frameHeaderSize))
+  {
+    m_failed = true;
+    return false;
+  }
+
+  uint32_t sizeField = _ReadU32(header);
+  int64_t size = _ReadU32(header + 4);
+  int64_t start = index == 0 ? 0 : m_index.back().start + m_index.back().size;
+  int64_t offset = m_consumed;
+  if (sizeField == 0 && size == 0)
+  {
+    uint64_t total = 0;
+    if (!_ReadFull(m_pStream, &total, sizeof(total)) || (int64_t)total != start)
+    {
+      m_failed = true;
+      return false;
+    }
+
+    m_length = start;
+    m_consumed += _endMarkerSize;
+    m_nextBlock = -1;
+    return true;
+  }
+
+  int64_t payloadSize = sizeField & ~_storedFlag;
+  int64_t frameSize = _frameHeaderSize + payloadSize + (m_checksum ? _DigestSize(m_checksumType) : 0);
+  if (size > m_maxBlockSize)
+  {
+    m_failed = true;
+    return false;
+  }
+
+  if (!m_pStream->Seek(frameSize - _frameHeaderSize, atSO_Current))
+  { // Put the header back so the frame can still be read in order
+    m_canSeek = 0;
+    if (!m_pStream->Seek(-_frameHeaderSize, atSO_Current))
+      m_failed = true;
+    return false;
+  }
+
+  m_index.push_back({ offset, frameSize, start, size });
+  m_consumed = offset + frameSize;
+  m_nextBlock = index + 1;
+  return true;
+}
+
+bool ctDecompressReadStream::CanSeekStream()
+{
+  if (m_canSeek < 0)
+    m_canSeek = m_pStream->Seek(0, atSO_Current) ? 1 : 0;
+  return m_canSeek == 1;
+}
+
+bool ctDecompressReadStream::SeekFrame(const int64_t index)
+{
+  int64_t offset = 0;
+  if (index < m_index.size())
+    offset = m_index[index].offset;
+  else if (index == m_index.size() && index > 0)
+    offset = m_index.back().offset + m_index.back().frameSize;
+  else if (index != 0)
+    return false;
+
+  // The position of the first frame in the wrapped stream
+  int64_t dataStart = m_pStream->Tell() - m_consumed;
+  if (!m_pStream->Seek(dataStart + offset, atSO_Start))
+    return false;
+
+  m_consumed = offset;
+  m_nextBlock = index;
+  return true;
+}
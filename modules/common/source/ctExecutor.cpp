@@ -0,0 +1,122 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctExecutor.h"
+#include "ctThreading.h"
+
+//***************
+// ctJobExecutor
+//***************
+
+ctJobExecutor::ctJobExecutor(ctJobSystem *pJobs)
+  : m_pJobs(pJobs ? pJobs : ctJobSystem::Global())
+{}
+
+ctJobExecutor* ctJobExecutor::Global()
+{
+  static ctJobExecutor executor;
+  return &executor;
+}
+
+void ctJobExecutor::Post(std::function<void()> func) { m_pJobs->Run(std::move(func)); }
+ctJobSystem* ctJobExecutor::JobSystem() const { return m_pJobs; }
+
+//*************
+// ctEventLoop
+//*************
+
+ctEventLoop::ctEventLoop()
+  : m_head(0)
+  , m_stopped(false)
+{}
+
+void ctEventLoop::Post(std::function<void()> func)
+{
+  // Notify while locked so the loop can be destroyed as soon as the last item has run
+  ctScopeLock lock(m_lock);
+  m_queue.push_back(std::move(func));
+  m_wake.notify_one();
+}
+
+int64_t ctEventLoop::Run()
+{
+  int64_t count = 0;
+  while (RunOne())
+    ++count;
+  return count;
+}
+
+bool ctEventLoop::RunOne()
+{
+  std::function<void()> func;
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_wake.wait(lock, [this]() { return m_stopped || m_head < m_queue.size(); });
+    if (m_stopped)
+      return false;
+
+    func = std::move(m_queue[m_head++]);
+    if (m_head == m_queue.size())
+    {
+      m_queue.clear();
+      m_head = 0;
+    }
+  }
+
+  func();
+  return true;
+}
+
+int64_t ctEventLoop::Poll()
+{
+  ctVector<std::function<void()>> ready;
+  {
+    ctScopeLock lock(m_lock);
+    for (int64_t i = m_head; i < m_queue.size(); ++i)
+      ready.push_back(std::move(m_queue[i]));
+    m_queue.clear();
+    m_head = 0;
+  }
+
+  for (std::function<void()> &func : ready)
+    func();
+  return ready.size();
+}
+
+void ctEventLoop::Stop()
+{
+  {
+    ctScopeLock lock(m_lock);
+    m_stopped = true;
+  }
+  m_wake.notify_all();
+}
+
+void ctEventLoop::Restart()
+{
+  ctScopeLock lock(m_lock);
+  m_stopped = false;
+}
+
+bool ctEventLoop::IsStopped() const { return m_stopped; }
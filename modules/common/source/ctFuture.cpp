@@ -0,0 +1,129 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctFuture.h"
+
+//*********************
+// ctCancellationToken
+//*********************
+
+ctCancellationToken::ctCancellationToken() : m_pState(nullptr) {}
+ctCancellationToken::ctCancellationToken(const ctCancellationToken &copy) : m_pState(nullptr) { *this = copy; }
+ctCancellationToken::ctCancellationToken(ctCancellationToken &&move) : m_pState(nullptr) { *this = std::move(move); }
+ctCancellationToken::~ctCancellationToken() { Release(); }
+
+ctCancellationToken ctCancellationToken::Create()
+{
+  ctCancellationToken token;
+  token.m_pState = ctNew(State);
+  token.m_pState->refs = 1;
+  token.m_pState->cancelled = false;
+  return token;
+}
+
+void ctCancellationToken::Cancel()
+{
+  if (m_pState)
+    m_pState->cancelled.store(true, std::memory_order_release);
+}
+
+bool ctCancellationToken::IsCancelled() const { return m_pState && m_pState->cancelled.load(std::memory_order_acquire); }
+bool ctCancellationToken::CanBeCancelled() const { return m_pState != nullptr; }
+
+ctCancellationToken& ctCancellationToken::operator=(const ctCancellationToken &copy)
+{
+  if (copy.m_pState)
+    ++copy.m_pState->refs;
+  Release();
+  m_pState = copy.m_pState;
+  return *this;
+}
+
+ctCancellationToken& ctCancellationToken::operator=(ctCancellationToken &&move)
+{
+  std::swap(m_pState, move.m_pState);
+  return *this;
+}
+
+void ctCancellationToken::Release()
+{
+  if (m_pState && --m_pState->refs == 0)
+    ctDelete(m_pState);
+  m_pState = nullptr;
+}
+
+//********************
+// _ctFutureStateBase
+//********************
+
+_ctFutureStateBase::_ctFutureStateBase()
+  : refs(0)
+  , promises(0)
+  , status(ctFS_Pending)
+  , done(1)
+{}
+
+_ctFutureStateBase::~_ctFutureStateBase() {}
+
+void _ctFutureStateBase::Acquire() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+void _ctFutureStateBase::Release()
+{
+  if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    ctDelete(this);
+}
+
+void _ctFutureStateBase::AcquirePromise()
+{
+  Acquire();
+  promises.fetch_add(1, std::memory_order_relaxed);
+}
+
+void _ctFutureStateBase::ReleasePromise()
+{
+  if (promises.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    Complete(ctFS_Failed, []() {});
+  Release();
+}
+
+void _ctFutureStateBase::AddCallback(std::function<void()> callback)
+{
+  {
+    ctScopeLock guard(lock);
+    if (status.load(std::memory_order_acquire) == ctFS_Pending)
+    {
+      callbacks.push_back(std::move(callback));
+      return;
+    }
+  }
+
+  callback();
+}
+
+void _ctFutureStateBase::RunCallbacks(ctVector<std::function<void()>> *pCallbacks)
+{
+  for (std::function<void()> &callback : *pCallbacks)
+    callback();
+  pCallbacks->clear();
+}
@@ -25,6 +25,7 @@
 
 #include "ctHash.h"
 #include "ctIterator.h"
+#include "ctThreadLocal.h"
 
 uint64_t atMurmur(const void *key, int64_t len, uint64_t seed = 2147483647)
 {
@@ -78,7 +79,15 @@ uint64_t atOneAtTime(const void *pData, int64_t len, uint64_t seed = 2147483647)
   return hash;
 }
 
-int64_t ctHash(const ctMemoryWriter &mem) { return (int64_t)(atMurmur(mem.m_data.data(), mem.m_data.size())); }
+int64_t ctHash(const ctMemoryWriter &mem)
+{
+  if (!mem.IsChunked())
+    return (int64_t)(atMurmur(mem.m_data.data(), mem.m_data.size()));
+
+  ctVector<uint8_t> data(mem.Length(), (uint8_t)0);
+  mem.CopyTo(data.data(), data.size());
+  return (int64_t)(atMurmur(data.data(), data.size()));
+}
 int64_t ctHash(const int64_t val) { return val; }
 int64_t ctHash(const int32_t val) { return (int64_t)val; }
 int64_t ctHash(const int16_t val) { return (int64_t)val; }
@@ -92,6 +101,8 @@ int64_t ctHash(const float val) { return *(int64_t*)&val; }
 
 ctMemoryWriter* atHash_MemWriter()
 {
-  static thread_local ctMemoryWriter writer;
-  return &writer;
+  // Never destroyed so threads that hash during shutdown still have a writer.
+  // Each thread's writer is freed when the thread exits.
+  static ctThreadLocal<ctMemoryWriter> *pWriters = ctNew(ctThreadLocal<ctMemoryWriter>);
+  return &pWriters->Get();
 }
@@ -0,0 +1,491 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctJobSystem.h"
+#include "ctMetrics.h"
+#include "ctThreading.h"
+
+static ctMetricCounter *_pJobsExecuted = ctMetrics::Counter("ctJobSystem.jobsExecuted");
+static ctMetricCounter *_pJobsStolen = ctMetrics::Counter("ctJobSystem.jobsStolen");
+
+// Number of failed attempts to find work before a worker goes to sleep
+static const int64_t _idleSpinCount = 64;
+
+struct ctJob
+{
+  ctJobSystem::JobFunc func;
+  ctJobSystem *pSystem = nullptr;
+  ctJobCounter *pCounter = nullptr;
+};
+
+// A Chase-Lev work-stealing deque. The owning worker pushes and pops jobs at the
+// bottom while other threads steal from the top.
+class ctJobWorker
+{
+public:
+  ctJobWorker(ctJobSystem *pSystem, const int64_t index)
+    : pSystem(pSystem)
+    , index(index)
+    , randomState((uint64_t)index * 0x9E3779B97F4A7C15ull + 1)
+    , m_top(0)
+    , m_bottom(0)
+  {
+    m_pArray = ctNew(Array)(1024);
+  }
+
+  ~ctJobWorker()
+  {
+    ctDelete(m_pArray.load());
+    for (Array *pArray : m_retired)
+      ctDelete(pArray);
+  }
+
+  // Called by the owning worker only
+  void Push(ctJob *pJob)
+  {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    Array *pArray = m_pArray.load(std::memory_order_relaxed);
+    if (bottom - top >= pArray->capacity)
+      pArray = Grow(pArray, top, bottom);
+
+    pArray->Put(bottom, pJob);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // Called by the owning worker only
+  ctJob* Pop()
+  {
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    Array *pArray = m_pArray.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    { // Empty
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    ctJob *pJob = pArray->Get(bottom);
+    if (top == bottom)
+    { // Last item, race against thieves for it
+      if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        pJob = nullptr;
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return pJob;
+  }
+
+  // Can be called from any thread
+  ctJob* Steal()
+  {
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+      return nullptr;
+
+    ctJob *pJob = m_pArray.load(std::memory_order_acquire)->Get(top);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return nullptr;
+    return pJob;
+  }
+
+  // Cheap random number used to pick a victim to steal from
+  uint64_t NextRandom()
+  {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+  }
+
+  ctJobSystem *pSystem;
+  int64_t index;
+  uint64_t randomState;
+
+protected:
+  struct Array
+  {
+    Array(const int64_t capacity)
+      : capacity(capacity)
+      , mask(capacity - 1)
+      , pItems((std::atomic<ctJob*>*)ctAlloc(sizeof(std::atomic<ctJob*>) * capacity))
+    {}
+
+    ~Array() { ctFree(pItems); }
+
+    ctJob* Get(const int64_t index) const { return pItems[index & mask].load(std::memory_order_relaxed); }
+    void Put(const int64_t index, ctJob *pJob) { pItems[index & mask].store(pJob, std::memory_order_relaxed); }
+
+    int64_t capacity;
+    int64_t mask;
+    std::atomic<ctJob*> *pItems;
+  };
+
+  Array* Grow(Array *pArray, const int64_t top, const int64_t bottom)
+  {
+    Array *pNewArray = ctNew(Array)(pArray->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i)
+      pNewArray->Put(i, pArray->Get(i));
+
+    // Thieves may still be reading the old array so it is kept until the worker is destroyed
+    m_retired.push_back(pArray);
+    m_pArray.store(pNewArray, std::memory_order_release);
+    return pNewArray;
+  }
+
+  // Keep the indices on separate cache lines as the owner and thieves write to them independently
+  std::atomic<int64_t> m_top;
+  uint8_t m_topPadding[ctCACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> m_bottom;
+  uint8_t m_bottomPadding[ctCACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  std::atomic<Array*> m_pArray;
+  ctVector<Array*> m_retired;
+};
+
+static thread_local ctJobWorker *_pCurrentWorker = nullptr;
+
+//**************
+// ctJobCounter
+//**************
+
+ctJobCounter::ctJobCounter(const int64_t initialValue)
+  : m_value(initialValue)
+{}
+
+ctJobCounter::~ctJobCounter()
+{
+  // Wait for a decrement that may still be releasing dependents
+  ctScopeLock lock(m_lock);
+  ctAssert(m_dependents.size() == 0, "A ctJobCounter was destroyed while jobs were still waiting on it");
+}
+
+void ctJobCounter::Increment(const int64_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+
+void ctJobCounter::Decrement()
+{
+  // Fast path when this cannot be the final decrement
+  int64_t value = m_value.load(std::memory_order_relaxed);
+  while (value > 1)
+    if (m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+      return;
+
+  // The final decrement is done under the lock so that nothing touches the counter
+  // after a thread observing it reach zero acquires the lock.
+  ctVector<ctJob*> released;
+  ctVector<ctJobSystem*> waiting;
+  {
+    ctScopeLock lock(m_lock);
+    if (m_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+
+    std::swap(released, m_dependents);
+    waiting = m_waitingSystems;
+  }
+
+  for (ctJob *pJob : released)
+    pJob->pSystem->Release(pJob);
+
+  for (ctJobSystem *pSystem : waiting)
+    pSystem->WakeAll();
+}
+
+int64_t ctJobCounter::Value() const { return m_value.load(std::memory_order_acquire); }
+bool ctJobCounter::Done() const { return Value() == 0; }
+
+bool ctJobCounter::AddDependent(ctJob *pJob)
+{
+  ctScopeLock lock(m_lock);
+  if (m_value.load(std::memory_order_acquire) == 0)
+    return false;
+  m_dependents.push_back(pJob);
+  return true;
+}
+
+bool ctJobCounter::BeginWait(ctJobSystem *pSystem)
+{
+  ctScopeLock lock(m_lock);
+  if (m_value.load(std::memory_order_acquire) == 0)
+    return false;
+  m_waitingSystems.push_back(pSystem);
+  return true;
+}
+
+void ctJobCounter::EndWait(ctJobSystem *pSystem)
+{
+  ctScopeLock lock(m_lock);
+  for (int64_t i = 0; i < m_waitingSystems.size(); ++i)
+    if (m_waitingSystems[i] == pSystem)
+    {
+      m_waitingSystems.erase(i);
+      return;
+    }
+}
+
+//*************
+// ctJobSystem
+//*************
+
+ctJobSystem::ctJobSystem(const int64_t workerCount)
+  : m_queued(0)
+  , m_waiting(0)
+  , m_sleeping(0)
+  , m_stop(false)
+  , m_sharedHead(0)
+{
+  int64_t count = workerCount;
+  if (count < 0)
+    count = ctMax((int64_t)std::thread::hardware_concurrency() - 1, 1ll);
+
+  for (int64_t i = 0; i < count; ++i)
+    m_workers.push_back(ctNew(ctJobWorker)(this, i));
+
+  // Start the threads once all workers exist so they can steal from each other
+  for (ctJobWorker *pWorker : m_workers)
+    m_threads.push_back(ctNew(std::thread)(&ctJobSystem::WorkerMain, this, pWorker));
+}
+
+ctJobSystem::~ctJobSystem()
+{
+  m_stop = true;
+  WakeAll();
+
+  for (std::thread *pThread : m_threads)
+  {
+    pThread->join();
+    ctDelete(pThread);
+  }
+
+  { // Wait for a Release() on another thread to finish with the system
+    ctScopeLock lock(m_sleepLock);
+  }
+
+  for (ctJobWorker *pWorker : m_workers)
+    ctDelete(pWorker);
+}
+
+ctJobSystem* ctJobSystem::Global()
+{
+  static ctJobSystem system;
+  return &system;
+}
+
+void ctJobSystem::Run(JobFunc func, ctJobCounter *pCounter, ctJobCounter *pDependency)
+{
+  ctJob *pJob = ctNew(ctJob);
+  pJob->func = std::move(func);
+  pJob->pSystem = this;
+  pJob->pCounter = pCounter;
+
+  if (pCounter)
+    pCounter->Increment();
+
+  if (pDependency)
+  {
+    m_waiting.fetch_add(1, std::memory_order_seq_cst);
+    if (pDependency->AddDependent(pJob))
+      return;
+    m_waiting.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+  Submit(pJob);
+}
+
+void ctJobSystem::Run(const int64_t count, const std::function<void(int64_t)> &func, ctJobCounter *pCounter, ctJobCounter *pDependency)
+{
+  for (int64_t i = 0; i < count; ++i)
+    Run([func, i]() { func(i); }, pCounter, pDependency);
+}
+
+void ctJobSystem::Wait(ctJobCounter *pCounter)
+{
+  if (!pCounter->BeginWait(this))
+    return;
+
+  ctJobWorker *pWorker = _pCurrentWorker && _pCurrentWorker->pSystem == this ? _pCurrentWorker : nullptr;
+  while (!pCounter->Done())
+  {
+    ctJob *pJob = FindJob(pWorker);
+    if (pJob)
+      Execute(pJob);
+    else
+      Idle(pCounter);
+  }
+
+  pCounter->EndWait(this);
+}
+
+bool ctJobSystem::TryRunOne()
+{
+  ctJob *pJob = FindJob(_pCurrentWorker && _pCurrentWorker->pSystem == this ? _pCurrentWorker : nullptr);
+  if (!pJob)
+    return false;
+  Execute(pJob);
+  return true;
+}
+
+int64_t ctJobSystem::WorkerCount() const { return m_workers.size(); }
+
+int64_t ctJobSystem::CurrentWorker() const
+{
+  return _pCurrentWorker && _pCurrentWorker->pSystem == this ? _pCurrentWorker->index : -1;
+}
+
+void ctJobSystem::Submit(ctJob *pJob)
+{
+  if (_pCurrentWorker && _pCurrentWorker->pSystem == this)
+  {
+    _pCurrentWorker->Push(pJob);
+  }
+  else
+  {
+    ctScopeLock lock(m_sharedLock);
+    m_sharedQueue.push_back(pJob);
+  }
+
+  m_queued.fetch_add(1, std::memory_order_seq_cst);
+  if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+  {
+    { // Synchronise with threads that are about to sleep
+      ctScopeLock lock(m_sleepLock);
+    }
+    m_wake.notify_one();
+  }
+}
+
+void ctJobSystem::Release(ctJob *pJob)
+{
+  // Queue the job first so a stopping worker never sees it as neither waiting nor queued
+  Submit(pJob);
+
+  // The system may be destroyed as soon as the job stops counting as waiting. This is done
+  // under m_sleepLock, which the destructor acquires after the workers have stopped.
+  ctScopeLock lock(m_sleepLock);
+  if (m_waiting.fetch_sub(1, std::memory_order_seq_cst) == 1 && m_stop.load())
+    m_wake.notify_all();
+}
+
+void ctJobSystem::Execute(ctJob *pJob)
+{
+  pJob->func();
+  if (pJob->pCounter)
+    pJob->pCounter->Decrement();
+  _pJobsExecuted->Add();
+  ctDelete(pJob);
+}
+
+ctJob* ctJobSystem::FindJob(ctJobWorker *pWorker)
+{
+  if (m_queued.load(std::memory_order_acquire) <= 0)
+    return nullptr;
+
+  ctJob *pJob = pWorker ? pWorker->Pop() : nullptr;
+
+  if (!pJob)
+  {
+    ctScopeLock lock(m_sharedLock);
+    if (m_sharedHead < m_sharedQueue.size())
+    {
+      pJob = m_sharedQueue[m_sharedHead++];
+      if (m_sharedHead == m_sharedQueue.size())
+      {
+        m_sharedQueue.clear();
+        m_sharedHead = 0;
+      }
+    }
+  }
+
+  if (!pJob && m_workers.size() > 0)
+  { // Try to steal from another worker, starting at a random victim
+    int64_t start = (int64_t)((pWorker ? pWorker->NextRandom() : (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id())) % (uint64_t)m_workers.size());
+    for (int64_t i = 0; i < m_workers.size() && !pJob; ++i)
+    {
+      ctJobWorker *pVictim = m_workers[(start + i) % m_workers.size()];
+      if (pVictim != pWorker)
+        pJob = pVictim->Steal();
+    }
+
+    if (pJob)
+      _pJobsStolen->Add();
+  }
+
+  if (pJob)
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+  return pJob;
+}
+
+void ctJobSystem::Idle(ctJobCounter *pCounter)
+{
+  std::unique_lock<std::mutex> lock(m_sleepLock);
+  m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+  m_wake.wait(lock, [this, pCounter]() {
+    return m_queued.load(std::memory_order_seq_cst) > 0 || (m_stop.load() && m_waiting.load() <= 0) || (pCounter && pCounter->Done());
+  });
+  m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ctJobSystem::WakeAll()
+{
+  {
+    ctScopeLock lock(m_sleepLock);
+  }
+  m_wake.notify_all();
+}
+
+void ctJobSystem::WorkerMain(ctJobSystem *pSystem, ctJobWorker *pWorker)
+{
+  _pCurrentWorker = pWorker;
+
+  int64_t spins = 0;
+  while (true)
+  {
+    ctJob *pJob = pSystem->FindJob(pWorker);
+    if (pJob)
+    {
+      pSystem->Execute(pJob);
+      spins = 0;
+      continue;
+    }
+
+    // m_waiting is read first as Release() queues a job before it stops counting as waiting
+    if (pSystem->m_stop.load() && pSystem->m_waiting.load() <= 0 && pSystem->m_queued.load() <= 0)
+      break;
+
+    if (++spins < _idleSpinCount)
+    {
+      ctYield();
+      continue;
+    }
+
+    pSystem->Idle(nullptr);
+    spins = 0;
+  }
+
+  _pCurrentWorker = nullptr;
+}
@@ -0,0 +1,87 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctMemoryReader.h"
+#include <cstring>
+
+ctMemoryReader::ctMemoryReader() {}
+ctMemoryReader::ctMemoryReader(const void *pData, const int64_t size) { Open(pData, size); }
+ctMemoryReader::ctMemoryReader(const ctVector<uint8_t> &data) { Open(data.data(), data.size()); }
+
+void ctMemoryReader::Open(const void *pData, const int64_t size)
+{
+  m_pData = (const uint8_t*)pData;
+  m_size = pData ? ctMax(size, (int64_t)0) : 0;
+  m_pos = 0;
+}
+
+int64_t ctMemoryReader::Read(void *pBuffer, const int64_t size)
+{
+  int64_t count = Peek(pBuffer, size);
+  m_pos += count;
+  return count;
+}
+
+int64_t ctMemoryReader::Peek(void *pBuffer, const int64_t size)
+{
+  int64_t count = ctClamp(size, (int64_t)0, m_size - m_pos);
+  if (count > 0)
+    memcpy(pBuffer, m_pData + m_pos, (size_t)count);
+  return count;
+}
+
+const uint8_t* ctMemoryReader::ReadView(const int64_t size)
+{
+  const uint8_t *pView = PeekView(size);
+  if (pView)
+    m_pos += size;
+  return pView;
+}
+
+const uint8_t* ctMemoryReader::PeekView(const int64_t size) const
+{
+  return size >= 0 && size <= m_size - m_pos ? m_pData + m_pos : nullptr;
+}
+
+bool ctMemoryReader::Seek(const int64_t loc, const ctSeekOrigin origin)
+{
+  int64_t pos = 0;
+  switch (origin)
+  {
+  case atSO_Current: pos = m_pos + loc; break;
+  case atSO_End: pos = m_size + loc; break;
+  case atSO_Start: pos = loc; break;
+  default: return false;
+  }
+
+  if (pos < 0 || pos > m_size)
+    return false;
+  m_pos = pos;
+  return true;
+}
+
+int64_t ctMemoryReader::Tell() const { return m_pos; }
+int64_t ctMemoryReader::Length() const { return m_size; }
+int64_t ctMemoryReader::Available() const { return m_size - m_pos; }
+const uint8_t* ctMemoryReader::Data() const { return m_pData; }
@@ -26,42 +26,222 @@
 #include "ctMemoryWriter.h"
 
 ctMemoryWriter::ctMemoryWriter() {}
-ctMemoryWriter::ctMemoryWriter(ctMemoryWriter &&move) : m_data(std::move(move.m_data)) {}
-ctMemoryWriter::ctMemoryWriter(const ctMemoryWriter &copy) : m_data(copy.m_data) {}
-ctMemoryWriter::~ctMemoryWriter() {}
+ctMemoryWriter::ctMemoryWriter(ctMemoryWriter &&move) { *this = std::move(move); }
+ctMemoryWriter::ctMemoryWriter(const ctMemoryWriter &copy) { *this = copy; }
+ctMemoryWriter::ctMemoryWriter(const int64_t chunkSize) : m_chunkSize(ctMax(chunkSize, (int64_t)1)) {}
+ctMemoryWriter::~ctMemoryWriter() { FreeChunks(); }
+
+ctMemoryWriter& ctMemoryWriter::operator=(ctMemoryWriter &&rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  FreeChunks();
+  m_data = std::move(rhs.m_data);
+  m_chunks = std::move(rhs.m_chunks);
+  m_pos = rhs.m_pos;
+  m_chunkSize = rhs.m_chunkSize;
+  m_length = rhs.m_length;
+  rhs.m_chunks.clear();
+  rhs.m_pos = 0;
+  rhs.m_length = 0;
+  return *this;
+}
+
+ctMemoryWriter& ctMemoryWriter::operator=(const ctMemoryWriter &rhs)
+{
+  if (this == &rhs)
+    return *this;
+
+  FreeChunks();
+  m_data = rhs.m_data;
+  m_pos = rhs.m_pos;
+  m_chunkSize = rhs.m_chunkSize;
+  m_length = rhs.m_length;
+  for (const uint8_t *pChunk : rhs.m_chunks)
+  {
+    uint8_t *pCopy = (uint8_t*)ctAlloc(m_chunkSize);
+    memcpy(pCopy, pChunk, (size_t)m_chunkSize);
+    m_chunks.push_back(pCopy);
+  }
+  return *this;
+}
 
 int64_t ctMemoryWriter::Write(const void *pData, const int64_t len)
 {
+  if (m_chunkSize > 0)
+    return WriteChunked(pData, len);
+
   m_data.resize(ctMax(m_pos + len, m_data.size()));
   memcpy(m_data.data() + m_pos, pData, (size_t)len);
   m_pos += len;
   return len;
 }
 
+int64_t ctMemoryWriter::WriteV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+    total += pSlices[i].size;
+
+  if (m_chunkSize > 0)
+  {
+    for (int64_t i = 0; i < count; ++i)
+      WriteChunked(pSlices[i].pData, pSlices[i].size);
+    return total;
+  }
+
+  m_data.resize(ctMax(m_pos + total, m_data.size()));
+  for (int64_t i = 0; i < count; ++i)
+  {
+    if (pSlices[i].size > 0)
+      memcpy(m_data.data() + m_pos, pSlices[i].pData, (size_t)pSlices[i].size);
+    m_pos += pSlices[i].size;
+  }
+  return total;
+}
+
+int64_t ctMemoryWriter::WriteChunked(const void *pData, const int64_t len)
+{
+  int64_t end = m_pos + len;
+  while (m_chunks.size() * m_chunkSize < end)
+    m_chunks.push_back((uint8_t*)ctAlloc(m_chunkSize));
+
+  const uint8_t *pSrc = (const uint8_t*)pData;
+  while (m_pos < end)
+  {
+    int64_t offset = m_pos % m_chunkSize;
+    int64_t count = ctMin(m_chunkSize - offset, end - m_pos);
+    memcpy(m_chunks[m_pos / m_chunkSize] + offset, pSrc, (size_t)count);
+    pSrc += count;
+    m_pos += count;
+  }
+
+  m_length = ctMax(m_length, end);
+  return len;
+}
+
 void ctMemoryWriter::Clear()
 {
   m_data.clear();
+  FreeChunks();
   m_pos = 0;
 }
 
+bool ctMemoryWriter::IsChunked() const { return m_chunkSize > 0; }
+int64_t ctMemoryWriter::ChunkSize() const { return m_chunkSize; }
+
+ctVector<ctIOSlice> ctMemoryWriter::GetSlices() const
+{
+  ctVector<ctIOSlice> slices;
+  if (m_chunkSize == 0)
+  {
+    if (m_data.size() > 0)
+      slices.push_back({ (void*)m_data.data(), m_data.size() });
+    return slices;
+  }
+
+  slices.reserve(m_chunks.size());
+  for (int64_t i = 0; i < m_chunks.size(); ++i)
+    slices.push_back({ m_chunks[i], ctMin(m_chunkSize, m_length - i * m_chunkSize) });
+  return slices;
+}
+
+int64_t ctMemoryWriter::CopyTo(void *pDst, const int64_t size, const int64_t offset) const
+{
+  int64_t start = ctClamp(offset, (int64_t)0, Length());
+  int64_t end = ctClamp(offset + size, start, Length());
+  if (m_chunkSize == 0)
+  {
+    memcpy(pDst, m_data.data() + start, (size_t)(end - start));
+    return end - start;
+  }
+
+  uint8_t *pOut = (uint8_t*)pDst;
+  for (int64_t pos = start; pos < end;)
+  {
+    int64_t chunkOffset = pos % m_chunkSize;
+    int64_t count = ctMin(m_chunkSize - chunkOffset, end - pos);
+    memcpy(pOut, m_chunks[pos / m_chunkSize] + chunkOffset, (size_t)count);
+    pOut += count;
+    pos += count;
+  }
+  return end - start;
+}
+
+void ctMemoryWriter::Flatten()
+{
+  if (m_chunkSize == 0)
+    return;
+
+  m_data.resize(m_length);
+  for (int64_t i = 0; i < m_chunks.size(); ++i)
+  {
+    memcpy(m_data.data() + i * m_chunkSize, m_chunks[i], (size_t)ctMin(m_chunkSize, m_length - i * m_chunkSize));
+    ctFree(m_chunks[i]);
+    m_chunks[i] = nullptr;
+  }
+
+  m_chunks.clear();
+  m_chunkSize = 0;
+  m_length = 0;
+}
+
+void ctMemoryWriter::FreeChunks()
+{
+  for (uint8_t *pChunk : m_chunks)
+    ctFree(pChunk);
+  m_chunks.clear();
+  m_length = 0;
+}
+
 bool ctMemoryWriter::Seek(const int64_t offset, const ctSeekOrigin origin)
 {
   switch (origin)
   {
   case atSO_Current: m_pos = m_pos + offset; break;
-  case atSO_End: m_pos = m_data.size() + offset; break;
+  case atSO_End: m_pos = Length() + offset; break;
   case atSO_Start: m_pos = 0 + offset; break;
   default: return false;
   }
 
-  m_pos = ctMax(0, ctMin(m_pos, m_data.size()));
+  m_pos = ctMax(0, ctMin(m_pos, Length()));
   return true;
 }
 
+int64_t ctMemoryWriter::Tell() const
+{
+  return m_pos;
+}
+
 int64_t ctMemoryWriter::Length() const
 {
-  return m_data.size();
+  return m_chunkSize > 0 ? m_length : m_data.size();
 }
 
 bool ctMemoryWriter::operator!=(const ctMemoryWriter &rhs) { return !(*this == rhs); }
-bool ctMemoryWriter::operator==(const ctMemoryWriter &rhs) { return rhs.m_data.size() == m_data.size() && memcmp(rhs.m_data.data(), m_data.data(), (size_t)m_data.size()) == 0; }
+
+bool ctMemoryWriter::operator==(const ctMemoryWriter &rhs)
+{
+  if (Length() != rhs.Length())
+    return false;
+
+  if (m_chunkSize == 0)
+  {
+    if (rhs.m_chunkSize == 0)
+      return memcmp(rhs.m_data.data(), m_data.data(), (size_t)m_data.size()) == 0;
+    return const_cast<ctMemoryWriter&>(rhs) == *this;
+  }
+
+  // Compare each of our chunks with the same range of rhs
+  ctVector<uint8_t> block(m_chunkSize, (uint8_t)0);
+  int64_t offset = 0;
+  for (const ctIOSlice &slice : GetSlices())
+  {
+    rhs.CopyTo(block.data(), slice.size, offset);
+    if (memcmp(block.data(), slice.pData, (size_t)slice.size) != 0)
+      return false;
+    offset += slice.size;
+  }
+  return true;
+}
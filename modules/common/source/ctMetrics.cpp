@@ -0,0 +1,333 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctMetrics.h"
+#include "ctHashMap.h"
+#include "ctThreading.h"
+#include <chrono>
+
+#if ctMSVC
+#include <intrin.h>
+#endif
+
+template<typename T>
+struct _ctMetricList
+{
+  ctHashMap<ctString, T*> lookup;
+  ctVector<T*> metrics;
+
+  T* FindOrAdd(const ctString &name)
+  {
+    T **ppMetric = lookup.TryGet(name);
+    if (ppMetric)
+      return *ppMetric;
+
+    // Plain new so the cache line alignment of counter shards is respected
+    T *pMetric = new T(name);
+    lookup.Add(name, pMetric);
+    metrics.push_back(pMetric);
+    return pMetric;
+  }
+};
+
+struct _ctMetricRegistry
+{
+  std::mutex lock;
+  _ctMetricList<ctMetricCounter> counters;
+  _ctMetricList<ctMetricGauge> gauges;
+  _ctMetricList<ctMetricHistogram> histograms;
+};
+
+static _ctMetricRegistry& _Registry()
+{
+  // Intentionally never freed so metrics can be updated during static destruction
+  static _ctMetricRegistry *pRegistry = ctNew(_ctMetricRegistry);
+  return *pRegistry;
+}
+
+static int64_t _ShardIndex()
+{
+  static std::atomic<int64_t> nextShard(0);
+  static thread_local int64_t shard = nextShard++ % ctMETRIC_COUNTER_SHARDS;
+  return shard;
+}
+
+static int64_t _HighestBit(const uint64_t value)
+{
+#if ctMSVC
+  unsigned long index = 0;
+  _BitScanReverse64(&index, value);
+  return (int64_t)index;
+#else
+  return 63 - (int64_t)__builtin_clzll(value);
+#endif
+}
+
+//*****************
+// ctMetricCounter
+//*****************
+
+ctMetricCounter::ctMetricCounter(const ctString &name)
+  : m_name(name)
+{
+  Reset();
+}
+
+void ctMetricCounter::Add(const int64_t amount) { m_shards[_ShardIndex()].value.fetch_add(amount, std::memory_order_relaxed); }
+
+int64_t ctMetricCounter::Value() const
+{
+  int64_t total = 0;
+  for (const Shard &shard : m_shards)
+    total += shard.value.load(std::memory_order_relaxed);
+  return total;
+}
+
+void ctMetricCounter::Reset()
+{
+  for (Shard &shard : m_shards)
+    shard.value.store(0, std::memory_order_relaxed);
+}
+
+const ctString& ctMetricCounter::Name() const { return m_name; }
+
+//***************
+// ctMetricGauge
+//***************
+
+ctMetricGauge::ctMetricGauge(const ctString &name)
+  : m_name(name)
+  , m_value(0)
+{}
+
+void ctMetricGauge::Set(const int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+void ctMetricGauge::Add(const int64_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+void ctMetricGauge::Sub(const int64_t amount) { m_value.fetch_sub(amount, std::memory_order_relaxed); }
+int64_t ctMetricGauge::Value() const { return m_value.load(std::memory_order_relaxed); }
+const ctString& ctMetricGauge::Name() const { return m_name; }
+
+//*******************
+// ctMetricHistogram
+//*******************
+
+ctMetricHistogram::ctMetricHistogram(const ctString &name)
+  : m_name(name)
+{
+  Reset();
+}
+
+void ctMetricHistogram::Record(const int64_t value)
+{
+  int64_t val = ctMax(value, 0ll);
+  m_buckets[BucketIndex(val)].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(val, std::memory_order_relaxed);
+
+  int64_t current = m_min.load(std::memory_order_relaxed);
+  while (val < current && !m_min.compare_exchange_weak(current, val, std::memory_order_relaxed));
+
+  current = m_max.load(std::memory_order_relaxed);
+  while (val > current && !m_max.compare_exchange_weak(current, val, std::memory_order_relaxed));
+}
+
+int64_t ctMetricHistogram::Count() const
+{
+  int64_t count = 0;
+  for (const std::atomic<int64_t> &bucket : m_buckets)
+    count += bucket.load(std::memory_order_relaxed);
+  return count;
+}
+
+int64_t ctMetricHistogram::Sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+int64_t ctMetricHistogram::Min() const
+{
+  int64_t min = m_min.load(std::memory_order_relaxed);
+  return min == INT64_MAX ? 0 : min;
+}
+
+int64_t ctMetricHistogram::Max() const { return m_max.load(std::memory_order_relaxed); }
+
+double ctMetricHistogram::Mean() const
+{
+  int64_t count = Count();
+  return count > 0 ? (double)Sum() / count : 0.0;
+}
+
+int64_t ctMetricHistogram::Percentile(const double percentile) const
+{
+  int64_t count = Count();
+  if (count == 0)
+    return 0;
+
+  int64_t rank = ctClamp((int64_t)(ctClamp(percentile, 0.0, 100.0) / 100.0 * count + 0.5), 1ll, count);
+  int64_t seen = 0;
+  for (int64_t i = 0; i < ctMETRIC_HISTOGRAM_BUCKETS; ++i)
+  {
+    seen += m_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return ctClamp(BucketUpperBound(i), Min(), Max());
+  }
+
+  return Max();
+}
+
+void ctMetricHistogram::Reset()
+{
+  for (std::atomic<int64_t> &bucket : m_buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  m_sum.store(0, std::memory_order_relaxed);
+  m_min.store(INT64_MAX, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+const ctString& ctMetricHistogram::Name() const { return m_name; }
+
+int64_t ctMetricHistogram::BucketIndex(const int64_t value)
+{
+  if (value < ctMETRIC_HISTOGRAM_SUB_BUCKETS)
+    return value;
+
+  // Values in [2^msb, 2^(msb+1)) are split into linear sub-buckets
+  int64_t msb = _HighestBit((uint64_t)value);
+  int64_t shift = msb - ctMETRIC_HISTOGRAM_SUB_BITS;
+  int64_t sub = (value >> shift) - ctMETRIC_HISTOGRAM_SUB_BUCKETS;
+  return (shift + 1) * ctMETRIC_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+int64_t ctMetricHistogram::BucketLowerBound(const int64_t bucket)
+{
+  if (bucket < ctMETRIC_HISTOGRAM_SUB_BUCKETS)
+    return bucket;
+
+  int64_t shift = bucket / ctMETRIC_HISTOGRAM_SUB_BUCKETS - 1;
+  int64_t sub = bucket % ctMETRIC_HISTOGRAM_SUB_BUCKETS;
+  return (ctMETRIC_HISTOGRAM_SUB_BUCKETS + sub) << shift;
+}
+
+int64_t ctMetricHistogram::BucketUpperBound(const int64_t bucket)
+{
+  if (bucket < ctMETRIC_HISTOGRAM_SUB_BUCKETS)
+    return bucket;
+
+  int64_t shift = bucket / ctMETRIC_HISTOGRAM_SUB_BUCKETS - 1;
+  return BucketLowerBound(bucket) + (1ll << shift) - 1;
+}
+
+//***********
+// ctMetrics
+//***********
+
+ctMetricCounter* ctMetrics::Counter(const ctString &name)
+{
+  _ctMetricRegistry &registry = _Registry();
+  ctScopeLock lock(registry.lock);
+  return registry.counters.FindOrAdd(name);
+}
+
+ctMetricGauge* ctMetrics::Gauge(const ctString &name)
+{
+  _ctMetricRegistry &registry = _Registry();
+  ctScopeLock lock(registry.lock);
+  return registry.gauges.FindOrAdd(name);
+}
+
+ctMetricHistogram* ctMetrics::Histogram(const ctString &name)
+{
+  _ctMetricRegistry &registry = _Registry();
+  ctScopeLock lock(registry.lock);
+  return registry.histograms.FindOrAdd(name);
+}
+
+ctMetricsSnapshot ctMetrics::Snapshot()
+{
+  _ctMetricRegistry &registry = _Registry();
+  ctScopeLock lock(registry.lock);
+
+  ctMetricsSnapshot snapshot;
+  snapshot.timestamp = Timestamp();
+
+  for (ctMetricCounter *pCounter : registry.counters.metrics)
+  {
+    ctMetricsSnapshot::Value value;
+    value.name = pCounter->Name();
+    value.value = pCounter->Value();
+    snapshot.counters.push_back(value);
+  }
+
+  for (ctMetricGauge *pGauge : registry.gauges.metrics)
+  {
+    ctMetricsSnapshot::Value value;
+    value.name = pGauge->Name();
+    value.value = pGauge->Value();
+    snapshot.gauges.push_back(value);
+  }
+
+  for (ctMetricHistogram *pHistogram : registry.histograms.metrics)
+  {
+    ctMetricsSnapshot::Distribution dist;
+    dist.name  = pHistogram->Name();
+    dist.count = pHistogram->Count();
+    dist.sum   = pHistogram->Sum();
+    dist.min   = pHistogram->Min();
+    dist.max   = pHistogram->Max();
+    dist.mean  = pHistogram->Mean();
+    dist.p50   = pHistogram->Percentile(50);
+    dist.p90   = pHistogram->Percentile(90);
+    dist.p99   = pHistogram->Percentile(99);
+    dist.p999  = pHistogram->Percentile(99.9);
+    snapshot.histograms.push_back(dist);
+  }
+
+  return snapshot;
+}
+
+void ctMetrics::Reset()
+{
+  _ctMetricRegistry &registry = _Registry();
+  ctScopeLock lock(registry.lock);
+  for (ctMetricCounter *pCounter : registry.counters.metrics)
+    pCounter->Reset();
+  for (ctMetricHistogram *pHistogram : registry.histograms.metrics)
+    pHistogram->Reset();
+}
+
+int64_t ctMetrics::Timestamp()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//********************
+// ctMetricScopeTimer
+//********************
+
+ctMetricScopeTimer::ctMetricScopeTimer(ctMetricHistogram *pHistogram)
+  : m_pHistogram(pHistogram)
+  , m_start(ctMetrics::Timestamp())
+{}
+
+ctMetricScopeTimer::~ctMetricScopeTimer()
+{
+  if (m_pHistogram)
+    m_pHistogram->Record(ctMetrics::Timestamp() - m_start);
+}
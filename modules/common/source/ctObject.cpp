@@ -25,82 +25,92 @@
 
 #include "ctObject.h"
 
-ctObject::ctObject()
-  : m_typeInfo(typeid(void))
-  , m_destructFunc(nullptr)
-{}
+ctObject::ctObject() {}
 
 ctObject::ctObject(const ctObject &copy)
-  : ctObject()
 {
-  Assign(copy);
+  if (copy.m_pOps)
+  {
+    void *pData = copy.m_pOps->isInline ? m_storage.buffer : ctAlloc(copy.m_pOps->size);
+    copy.m_pOps->copy(pData, copy.Data());
+    if (!copy.m_pOps->isInline)
+      m_storage.pHeap = pData;
+    m_pOps = copy.m_pOps;
+  }
+
+  if (copy.m_pMembers)
+    m_pMembers = ctNew(ctHashMap<ctString, ctObject>)(*copy.m_pMembers);
 }
 
 ctObject::ctObject(ctObject &&move)
-  : ctObject()
 {
-  Assign(std::move(move));
+  TakeValue(move);
+  std::swap(m_pMembers, move.m_pMembers);
 }
 
-ctObject::~ctObject() { Destroy(); }
+ctObject::~ctObject()
+{
+  Destroy();
+  if (m_pMembers)
+    ctDelete(m_pMembers);
+}
 
 void ctObject::Assign(const ctObject &value)
 {
-  SetType(value);
+  if (this == &value)
+    return;
 
-  // Call type specific copy assign
-  if (m_copyFunc)
-    m_copyFunc(&m_data, value.m_data.data());
-
-  // Copy members
-  m_members = value.m_members;
+  // Copy first as value may be one of our members
+  ctObject copy(value);
+  Swap(copy);
 }
 
 void ctObject::Assign(ctObject &&value)
 {
-  SetType(value);
-
-  // Call type specific move assign
-  if (m_moveFunc)
-    m_moveFunc(&m_data, value.m_data.data());
+  if (this == &value)
+    return;
 
-  // Move members
-  m_members = std::move(value.m_members);
+  ctObject tmp(std::move(value));
+  Swap(tmp);
 }
 
 void ctObject::SetMember(const ctString &name, const ctObject &value)
 {
-  m_members[name] = value;
+  Members().GetOrAdd(name) = value;
 }
 
 void ctObject::SetMember(const ctString &name, ctObject &&value)
 {
-  m_members[name] = std::move(value);
+  Members().GetOrAdd(name) = std::move(value);
 }
 
 void ctObject::Destroy()
 {
-  if (m_destructFunc)
-    m_destructFunc(&m_data);
-  m_destructFunc = nullptr;
-  m_copyFunc = nullptr;
-  m_moveFunc = nullptr;
-  m_typeInfo = typeid(void);
+  if (!m_pOps)
+    return;
+
+  m_pOps->destruct(Data());
+  if (!m_pOps->isInline)
+    ctFree(m_storage.pHeap);
+  m_pOps = nullptr;
 }
 
 bool ctObject::HasMember(const ctString &name) const
 {
-  return m_members.Contains(name);
+  return m_pMembers && m_pMembers->Contains(name);
 }
 
 ctObject& ctObject::GetMember(const ctString &name)
 {
-  return m_members[name];
+  return Members().GetOrAdd(name);
 }
 
 const ctObject& ctObject::GetMember(const ctString &name) const
 {
-  return m_members[name];
+  static const ctObject empty;
+  const ctObject *pMember = m_pMembers ? m_pMembers->TryGet(name) : nullptr;
+  ctAssert(pMember != nullptr, "[name] is not a member");
+  return pMember ? *pMember : empty;
 }
 
 ctObject& ctObject::operator=(const ctObject &rhs)
@@ -125,11 +135,45 @@ const ctObject& ctObject::operator[](const ctString &name) const
   return GetMember(name);
 }
 
-bool ctObject::Empty() const { return m_data.size() == 0 && m_members.Size() == 0 && m_typeInfo == typeid(void); }
+bool ctObject::Empty() const { return m_pOps == nullptr && (m_pMembers == nullptr || m_pMembers->Size() == 0); }
+
+ctString ctObject::Typename() const { return (m_pOps ? *m_pOps->pType : typeid(void)).name(); }
 
-ctString ctObject::Typename() const { return m_typeInfo.name(); }
+ctVector<ctString> ctObject::GetMemberNames() const { return m_pMembers ? m_pMembers->GetKeys() : ctVector<ctString>(); }
 
-ctVector<ctString> ctObject::GetMemberNames() const { return m_members.GetKeys(); }
+void ctObject::TakeValue(ctObject &src)
+{
+  m_pOps = src.m_pOps;
+  if (!m_pOps)
+    return;
+
+  if (m_pOps->isInline)
+  {
+    m_pOps->move(m_storage.buffer, src.m_storage.buffer);
+    m_pOps->destruct(src.m_storage.buffer);
+  }
+  else
+  {
+    m_storage.pHeap = src.m_storage.pHeap;
+  }
+  src.m_pOps = nullptr;
+}
+
+void ctObject::Swap(ctObject &other)
+{
+  ctObject tmp;
+  tmp.TakeValue(*this);
+  TakeValue(other);
+  other.TakeValue(tmp);
+  std::swap(m_pMembers, other.m_pMembers);
+}
+
+ctHashMap<ctString, ctObject>& ctObject::Members()
+{
+  if (!m_pMembers)
+    m_pMembers = ctNew(ctHashMap<ctString, ctObject>);
+  return *m_pMembers;
+}
 
 int64_t ctStreamRead(ctReadStream *pStream, ctObject *pData, const int64_t count)
 {
@@ -137,21 +181,32 @@ int64_t ctStreamRead(ctReadStream *pStream, ctObject *pData, const int64_t count
   for (int64_t i = 0; i < count; ++i)
     if (!pData[i].Is<void>())
     {
-      size += pData[i].m_readFunc(pStream, &pData->m_data);
-      size += ctStreamRead(pStream, &pData->m_members, 1);
+      ctAssert(pData[i].m_pOps->read != nullptr, "The type stored in this ctObject cannot be read from a stream");
+      if (pData[i].m_pOps->read)
+        size += pData[i].m_pOps->read(pStream, pData[i].Data());
+
+      // Read into a temporary so objects without members stay unallocated
+      ctHashMap<ctString, ctObject> members;
+      size += ctStreamRead(pStream, &members, 1);
+      if (members.Size() > 0 || pData[i].m_pMembers)
+        pData[i].Members() = std::move(members);
     }
 
   return size;
 }
 
-int64_t ctStreamWrite(ctWriteStream *pStream, ctObject *pData, const int64_t count)
+int64_t ctStreamWrite(ctWriteStream *pStream, const ctObject *pData, const int64_t count)
 {
+  static const ctHashMap<ctString, ctObject> noMembers;
+
   int64_t size = 0;
   for (int64_t i = 0; i < count; ++i)
     if (!pData[i].Is<void>())
     {
-      size += pData[i].m_writeFunc(pStream, &pData->m_data);
-      size += ctStreamWrite(pStream, &pData->m_members, 1);
+      ctAssert(pData[i].m_pOps->write != nullptr, "The type stored in this ctObject cannot be written to a stream");
+      if (pData[i].m_pOps->write)
+        size += pData[i].m_pOps->write(pStream, pData[i].Data());
+      size += ctStreamWrite(pStream, pData[i].m_pMembers ? pData[i].m_pMembers : &noMembers, 1);
     }
 
   return size;
@@ -0,0 +1,41 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctParallel.h"
+
+// Number of chunks to aim for per thread. More chunks balance uneven work better
+// but add scheduling overhead.
+static const int64_t _chunksPerThread = 4;
+
+// Smallest number of items worth running as a separate job
+static const int64_t _minGrainSize = 256;
+
+int64_t ctParallelGrainSize(const int64_t count, ctJobSystem *pJobs)
+{
+  if (!pJobs)
+    pJobs = ctJobSystem::Global();
+
+  int64_t threadCount = pJobs->WorkerCount() + 1;
+  return ctMax(count / (threadCount * _chunksPerThread), ctMin(_minGrainSize, count), (int64_t)1);
+}
@@ -38,3 +38,16 @@ int64_t ctReadStream::Peek(void *pBuffer, const int64_t size)
   Seek(location);
   return len;
 }
+
+int64_t ctReadStream::ReadV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    int64_t read = Read(pSlices[i].pData, pSlices[i].size);
+    total += ctMax(read, (int64_t)0);
+    if (read != pSlices[i].size)
+      break;
+  }
+  return total;
+}
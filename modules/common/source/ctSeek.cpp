@@ -34,9 +34,14 @@ bool ctSeek::SkipWhitespace(const char **ppText) { return _Seek(ppText, ctString
 bool ctSeek::SeekToWhitespace(const char **ppText) { return _Seek(ppText, ctString::_find_first_of(*ppText, ctString::Whitespace())); }
 
 ctStringSeeker::ctStringSeeker(ctString const * pStr)
-  : m_pStr(pStr)
+  : ctStringSeeker(pStr->c_str(), pStr->length())
+{}
+
+ctStringSeeker::ctStringSeeker(const char *pText, const int64_t &length)
+  : m_pBegin(pText)
+  , m_pEnd(pText + length)
 {
-  m_pText = m_pLast = m_pLastLast = m_pStr->c_str();
+  m_pText = m_pLast = m_pLastLast = m_pBegin;
 }
 
 bool ctStringSeeker::Seek(int64_t pos, const ctSeekOrigin &origin)
@@ -48,32 +53,32 @@ bool ctStringSeeker::Seek(int64_t pos, const ctSeekOrigin &origin)
   case atSO_Current:
     break;
   case atSO_Start:
-    m_pText = m_pStr->begin();
+    m_pText = m_pBegin;
     break;
   case atSO_End:
-    m_pText = m_pStr->end();
+    m_pText = m_pEnd;
     pos = -pos;
     break;
   }
 
   m_pText += pos;
 
-  bool result = m_pText < m_pStr->begin() || m_pText > m_pStr->end();
-  m_pText = ctClamp(m_pText, m_pStr->begin(), m_pStr->end());
+  bool result = m_pText < m_pBegin || m_pText > m_pEnd;
+  m_pText = ctClamp(m_pText, m_pBegin, m_pEnd);
   m_pLast = m_pText;
   return result;
 }
 
-int64_t ctStringSeeker::Length() const { return m_pStr->length(); }
+int64_t ctStringSeeker::Length() const { return m_pEnd - m_pBegin; }
 const char* ctStringSeeker::Text() const { return m_pText; }
 const char* ctStringSeeker::LastText() const { return m_pLastLast; }
-const char* ctStringSeeker::begin() const { return m_pStr->begin(); }
-const char* ctStringSeeker::end() const { return m_pStr->end(); }
+const char* ctStringSeeker::begin() const { return m_pBegin; }
+const char* ctStringSeeker::end() const { return m_pEnd; }
 
 ctString ctStringSeeker::GetString(const int64_t &endIdx, const int64_t &startIdx)
 {
   const char *startPos = startIdx == CT_INVALID_INDEX ? m_pText : (m_pText + startIdx);
-  const char *endPos = endIdx == CT_INVALID_INDEX ? m_pStr->end() : (m_pText + endIdx);
+  const char *endPos = endIdx == CT_INVALID_INDEX ? m_pEnd : (m_pText + endIdx);
   return ctString(ctClamp(startPos, begin(), end()), ctClamp(endPos, begin(), end()));
 }
 
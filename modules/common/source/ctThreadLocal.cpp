@@ -0,0 +1,169 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ctThreadLocal.h"
+
+thread_local _ctThreadLocalSlot *_ctThreadLocalSlots = nullptr;
+thread_local int64_t _ctThreadLocalSlotCount = 0;
+
+// Tracks the live ctThreadLocal instances so values can be released when threads exit
+class _ctThreadLocalRegistry
+{
+public:
+  static _ctThreadLocalRegistry* Get()
+  {
+    // Never destroyed so threads that exit during shutdown can still use it
+    static _ctThreadLocalRegistry *pRegistry = ctNew(_ctThreadLocalRegistry);
+    return pRegistry;
+  }
+
+  // Release the values owned by the calling thread
+  static void ReleaseThread()
+  {
+    _ctThreadLocalRegistry *pRegistry = Get();
+    ctScopeLock lock(pRegistry->m_lock);
+    for (int64_t i = 0; i < _ctThreadLocalSlotCount; ++i)
+    {
+      _ctThreadLocalSlot &slot = _ctThreadLocalSlots[i];
+      if (slot.pValue == nullptr || i >= pRegistry->m_owners.size())
+        continue;
+
+      _ctThreadLocalBase *pOwner = pRegistry->m_owners[i];
+      if (pOwner != nullptr && pRegistry->m_generations[i] == slot.generation)
+        pOwner->ReleaseValue(slot.pValue);
+    }
+
+    ctFree(_ctThreadLocalSlots);
+    _ctThreadLocalSlots = nullptr;
+    _ctThreadLocalSlotCount = 0;
+  }
+
+  std::mutex m_lock;
+  ctVector<_ctThreadLocalBase*> m_owners;
+  ctVector<uint64_t> m_generations;
+  ctVector<int64_t> m_freeIndices;
+};
+
+// Releases the thread's values when it exits. Constructed by a thread's first Create().
+class _ctThreadLocalExitHook
+{
+public:
+  ~_ctThreadLocalExitHook() { _ctThreadLocalRegistry::ReleaseThread(); }
+
+  void Touch() {}
+};
+
+static thread_local _ctThreadLocalExitHook _exitHook;
+
+_ctThreadLocalBase::_ctThreadLocalBase()
+{
+  _ctThreadLocalRegistry *pRegistry = _ctThreadLocalRegistry::Get();
+  ctScopeLock lock(pRegistry->m_lock);
+  if (pRegistry->m_freeIndices.size() > 0)
+  {
+    m_index = pRegistry->m_freeIndices.back();
+    pRegistry->m_freeIndices.pop_back();
+  }
+  else
+  {
+    m_index = pRegistry->m_owners.size();
+    pRegistry->m_owners.push_back(nullptr);
+    pRegistry->m_generations.push_back(0);
+  }
+
+  // Use a new generation so slots left by the previous owner of the index are ignored
+  m_generation = ++pRegistry->m_generations[m_index];
+  pRegistry->m_owners[m_index] = this;
+}
+
+_ctThreadLocalBase::~_ctThreadLocalBase()
+{
+  ctAssert(m_values.size() == 0, "ctThreadLocal values must be released by the derived class");
+
+  _ctThreadLocalRegistry *pRegistry = _ctThreadLocalRegistry::Get();
+  ctScopeLock lock(pRegistry->m_lock);
+  pRegistry->m_owners[m_index] = nullptr;
+  pRegistry->m_freeIndices.push_back(m_index);
+}
+
+int64_t _ctThreadLocalBase::ThreadCount() const
+{
+  ctScopeLock lock(m_lock);
+  return m_values.size();
+}
+
+void* _ctThreadLocalBase::Create()
+{
+  _exitHook.Touch();
+
+  if (m_index >= _ctThreadLocalSlotCount)
+  {
+    int64_t count = ctMax(m_index + 1, _ctThreadLocalSlotCount * 2);
+    _ctThreadLocalSlot *pSlots = (_ctThreadLocalSlot*)ctAlloc(sizeof(_ctThreadLocalSlot) * count);
+    for (int64_t i = 0; i < count; ++i)
+      pSlots[i] = i < _ctThreadLocalSlotCount ? _ctThreadLocalSlots[i] : _ctThreadLocalSlot();
+
+    ctFree(_ctThreadLocalSlots);
+    _ctThreadLocalSlots = pSlots;
+    _ctThreadLocalSlotCount = count;
+  }
+
+  void *pValue = Construct();
+  {
+    ctScopeLock lock(m_lock);
+    m_values.push_back(pValue);
+  }
+
+  _ctThreadLocalSlots[m_index].generation = m_generation;
+  _ctThreadLocalSlots[m_index].pValue = pValue;
+  return pValue;
+}
+
+void _ctThreadLocalBase::Release()
+{
+  _ctThreadLocalRegistry *pRegistry = _ctThreadLocalRegistry::Get();
+  ctScopeLock registryLock(pRegistry->m_lock);
+
+  // Invalidate the slots of every thread
+  m_generation = ++pRegistry->m_generations[m_index];
+
+  ctScopeLock lock(m_lock);
+  for (void *pValue : m_values)
+    Destruct(pValue);
+  m_values.clear();
+}
+
+void _ctThreadLocalBase::ReleaseValue(void *pValue)
+{
+  ctScopeLock lock(m_lock);
+  for (int64_t i = 0; i < m_values.size(); ++i)
+  {
+    if (m_values[i] == pValue)
+    {
+      m_values.swap_pop_back(i);
+      Destruct(pValue);
+      return;
+    }
+  }
+}
@@ -15,6 +15,124 @@ void ctSleep(const int64_t milliseconds)
 
 void ctYield() { std::this_thread::yield(); }
 
+// Bounds for the number of spins ctAdaptiveMutex makes before parking
+static const int32_t _minAdaptiveSpins = 16;
+static const int32_t _maxAdaptiveSpins = 2048;
+
+// Number of spins a ctRWLock makes before parking
+static const int64_t _rwLockSpins = 128;
+
+//*****************
+// ctAdaptiveMutex
+//*****************
+
+ctAdaptiveMutex::ctAdaptiveMutex()
+  : m_state(Unlocked)
+  , m_spinLimit(100)
+{}
+
+void ctAdaptiveMutex::LockSlow()
+{
+  // Spin while the lock is held, on the assumption it will be released soon
+  int32_t limit = m_spinLimit.load(std::memory_order_relaxed);
+  for (int32_t spins = 0; spins < limit; ++spins)
+  {
+    ctCpuRelax();
+    int32_t state = Unlocked;
+    if (m_state.load(std::memory_order_relaxed) == Unlocked && m_state.compare_exchange_strong(state, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+    { // Move the limit towards twice the spins that were needed
+      m_spinLimit.store(ctClamp(limit + (spins * 2 - limit) / 8, _minAdaptiveSpins, _maxAdaptiveSpins), std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  // Spinning didn't pay off, so spin less next time and park
+  m_spinLimit.store(ctMax(limit - limit / 8, _minAdaptiveSpins), std::memory_order_relaxed);
+  while (m_state.exchange(Contended, std::memory_order_acquire) != Unlocked)
+  {
+    std::unique_lock<std::mutex> lock(m_parkLock);
+    m_parked.wait(lock, [this]() { return m_state.load(std::memory_order_relaxed) != Contended; });
+  }
+}
+
+void ctAdaptiveMutex::Wake()
+{
+  { // Synchronise with threads that are about to park
+    ctScopeLock lock(m_parkLock);
+  }
+  m_parked.notify_one();
+}
+
+//**********
+// ctRWLock
+//**********
+
+ctRWLock::ctRWLock()
+  : m_state(0)
+  , m_parkedCount(0)
+{}
+
+void ctRWLock::LockSlow()
+{
+  for (int64_t spins = 0; ; ++spins)
+  {
+    int64_t state = m_state.load(std::memory_order_relaxed);
+    if ((state & (Writer | ReaderMask)) == 0)
+    {
+      if (m_state.compare_exchange_weak(state, Writer, std::memory_order_acquire, std::memory_order_relaxed))
+        return;
+      continue;
+    }
+
+    // Stop new readers from acquiring the lock
+    if ((state & WriterPending) == 0)
+      m_state.fetch_or(WriterPending, std::memory_order_relaxed);
+
+    if (spins < _rwLockSpins)
+      ctCpuRelax();
+    else
+      Park(Writer | ReaderMask);
+  }
+}
+
+void ctRWLock::LockSharedSlow()
+{
+  for (int64_t spins = 0; ; ++spins)
+  {
+    int64_t state = m_state.load(std::memory_order_relaxed);
+    if ((state & (Writer | WriterPending)) == 0)
+    {
+      if (m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        return;
+      continue;
+    }
+
+    if (spins < _rwLockSpins)
+      ctCpuRelax();
+    else
+      Park(Writer | WriterPending);
+  }
+}
+
+void ctRWLock::Park(const int64_t blockingMask)
+{
+  std::unique_lock<std::mutex> lock(m_parkLock);
+  m_parkedCount.fetch_add(1, std::memory_order_seq_cst);
+  m_parked.wait(lock, [this, blockingMask]() { return (m_state.load(std::memory_order_seq_cst) & blockingMask) == 0; });
+  m_parkedCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ctRWLock::WakeAll()
+{
+  if (m_parkedCount.load(std::memory_order_seq_cst) == 0)
+    return;
+
+  { // Synchronise with threads that are about to park
+    ctScopeLock lock(m_parkLock);
+  }
+  m_parked.notify_all();
+}
+
 ctConditionalScopeLock::ctConditionalScopeLock(std::mutex &_mutex, const bool &shouldLock)
   : m_mutex(_mutex)
   , m_isLocked(shouldLock)
@@ -43,14 +161,26 @@ ctConditionalRecursiveScopeLock::~ctConditionalRecursiveScopeLock()
     m_mutex.unlock();
 }
 
-ctThreadedObject::ctThreadedObject(void *pUserData)
+static ctMetricHistogram* _WakeLatencyMetric(const char *name)
+{
+  static ctMetricHistogram *pShared = ctMetrics::Histogram("ctThreadedObject.wakeLatency");
+  if (!name || name[0] == 0)
+    return pShared;
+  return ctMetrics::Histogram(ctString("ctThreadedObject.wakeLatency.") + name);
+}
+
+ctThreadedObject::ctThreadedObject(void *pUserData, const char *name)
   : m_isPaused(true)
   , m_pUserData(pUserData)
   , m_shouldPause(true)
   , m_isRunning(true)
+  , m_isSleeping(false)
   , m_shouldStop(false)
+  , m_notified(false)
+  , m_notifyTime(0)
   , m_nextSleepTime(0)
   , m_threadID(0)
+  , m_pWakeLatency(_WakeLatencyMetric(name))
   , m_thread(&ctThreadedObject::Run, this)
 {
   m_threadID = (uint64_t)std::hash<std::thread::id>()(m_thread.get_id());
@@ -59,81 +189,146 @@ ctThreadedObject::ctThreadedObject(void *pUserData)
 ctThreadedObject::~ctThreadedObject()
 {
   Stop();
-  while (IsRunning())
-    ctSleep(1);
   m_thread.join();
 }
 
 void ctThreadedObject::Start()
 {
-  m_shouldPause = false;
-  m_shouldStop = false;
+  {
+    ctScopeLock lock(m_lock);
+    m_shouldPause = false;
+    m_shouldStop = false;
+  }
+  m_wake.notify_all();
+}
+
+void ctThreadedObject::Pause()
+{
+  {
+    ctScopeLock lock(m_lock);
+    m_shouldPause = true;
+  }
+  m_wake.notify_all();
+}
+
+void ctThreadedObject::Stop()
+{
+  {
+    ctScopeLock lock(m_lock);
+    m_shouldStop = true;
+  }
+  m_wake.notify_all();
+}
+
+void ctThreadedObject::Notify()
+{
+  {
+    ctScopeLock lock(m_lock);
+    if (!m_notified)
+      m_notifyTime = ctMetrics::Timestamp();
+    m_notified = true;
+  }
+  m_wake.notify_all();
 }
 
 void ctThreadedObject::Sleep(const int64_t duration)
 {
-  ctScopeLock lock(m_writeLock);
+  ctScopeLock lock(m_lock);
   m_nextSleepTime += duration;
 }
 
 void ctThreadedObject::Run(ctThreadedObject *pBase)
 {
-  while (pBase->IsRunning())
+  std::unique_lock<std::mutex> lock(pBase->m_lock);
+  while (!pBase->m_shouldStop)
   {
-    if (!pBase->IsPaused())
+    if (pBase->m_shouldPause)
     {
-      switch (pBase->Execute(pBase->m_pUserData))
-      {
-      case CO_Pause: pBase->Pause(); break;
-      case CO_Sleep: pBase->Sleep(); break;
-      case CO_Stop: pBase->Stop(); break;
-      case CO_Continue: default: break;
-      }
-    }
-    else
-    {
-      pBase->Sleep();
+      pBase->m_isPaused = true;
+      pBase->m_wake.wait(lock, [=]() { return !pBase->m_shouldPause || pBase->m_shouldStop; });
+      pBase->m_isPaused = false;
+      continue;
     }
 
+    pBase->OnWake();
+
+    lock.unlock();
+    ControlOption option = pBase->Execute(pBase->m_pUserData);
+    int64_t sleepTime = option == CO_Sleep ? pBase->SleepTime() : 0;
+    lock.lock();
+
+    switch (option)
+    {
+    case CO_Pause: pBase->m_shouldPause = true; break;
+    case CO_Stop: pBase->m_shouldStop = true; break;
+    case CO_Wait: pBase->Wait(lock, nullptr); break;
+    case CO_Sleep:
     {
-      ctScopeLock lock(pBase->m_writeLock);
-      pBase->m_isPaused = pBase->m_shouldPause;
-      pBase->m_isRunning = !pBase->m_shouldStop;
+      std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(sleepTime + pBase->m_nextSleepTime);
+      pBase->m_nextSleepTime = 0;
+      pBase->Wait(lock, &deadline);
+    } break;
+    case CO_Continue: default: break;
     }
   }
+
+  pBase->m_isRunning = false;
 }
 
-void ctThreadedObject::Sleep()
+bool ctThreadedObject::WaitUntil(const std::chrono::steady_clock::time_point &deadline)
 {
-  m_isSleeping = true;
-  ctSleep(SleepTime() + m_nextSleepTime);
-  
-  m_writeLock.lock();
-  m_nextSleepTime = 0; // Lock here as two threads could write to this variable
-  m_writeLock.unlock();
+  std::unique_lock<std::mutex> lock(m_lock);
+  bool notified = Wait(lock, &deadline);
+  OnWake();
+  return notified;
+}
 
+bool ctThreadedObject::WaitFor(const int64_t milliseconds)
+{
+  return WaitUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds));
+}
+
+bool ctThreadedObject::Wait(std::unique_lock<std::mutex> &lock, const std::chrono::steady_clock::time_point *pDeadline)
+{
+  auto isWoken = [this]() { return m_notified || m_shouldStop || m_shouldPause; };
+
+  m_isSleeping = true;
+  if (pDeadline)
+    m_wake.wait_until(lock, *pDeadline, isWoken);
+  else
+    m_wake.wait(lock, isWoken);
   m_isSleeping = false;
+  return m_notified;
 }
 
-void ctThreadedObject::Pause() { m_shouldPause = true; }
-void ctThreadedObject::Stop() { m_shouldStop = true; }
+void ctThreadedObject::OnWake()
+{
+  if (!m_notified)
+    return;
+
+  m_pWakeLatency->Record(ctMetrics::Timestamp() - m_notifyTime);
+  m_notified = false;
+}
 
 bool ctThreadedObject::IsRunning()
 {
-  ctScopeLock lock(m_writeLock);
+  ctScopeLock lock(m_lock);
   return m_isRunning;
 }
 
 bool ctThreadedObject::IsPaused()
 {
-  ctScopeLock lock(m_writeLock);
+  ctScopeLock lock(m_lock);
   return m_isPaused;
 }
+
 bool ctThreadedObject::IsSleeping()
 {
-  ctScopeLock lock(m_writeLock);
+  ctScopeLock lock(m_lock);
   return m_isSleeping;
 }
 
+const ctMetricHistogram& ctThreadedObject::WakeLatency() const { return *m_pWakeLatency; }
+
 uint64_t ctThreadedObject::ID() const { return m_threadID; }
 std::thread::id ctThreadedObject::ThreadID() const { return m_thread.get_id(); }
@@ -30,3 +30,16 @@ int64_t ctStreamWrite(ctWriteStream *pStream, const void *pData, const int64_t s
 {
   return pStream->Write(pData, size);
 }
+
+int64_t ctWriteStream::WriteV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    int64_t written = Write(pSlices[i].pData, pSlices[i].size);
+    total += ctMax(written, (int64_t)0);
+    if (written != pSlices[i].size)
+      break;
+  }
+  return total;
+}
@@ -18,6 +18,9 @@ public:
 
   bool Parse(const ctString &csv);
 
+  // Parse 'length' bytes of CSV text in place, e.g. from a ctMappedFile
+  bool Parse(const char *csv, const int64_t &length);
+
   ctStringValue Get(const int64_t &row, const int64_t &column) const;
   ctType GetType(const int64_t &row, const int64_t &column) const;
 
@@ -18,6 +18,10 @@ public:
   // Parse a JSON string and assign the result to this object
   bool Parse(const ctString &json);
 
+  // Parse 'length' bytes of JSON text in place, e.g. from a ctMappedFile.
+  // The text must be followed by a null terminator.
+  bool Parse(const char *json, const int64_t &length);
+
   // Set the JSON value from an object
   // atToString must be defined for for type T
   // This isString to true by default so for standard 
@@ -132,8 +136,6 @@ protected:
   ctString *m_pValue = nullptr;
   ctVector<ctJSON> *m_pArray = nullptr;
   ctHashMap<ctString, ctJSON> *m_pObject = nullptr;
-
-  int64_t Parse(const char *pStart, const int64_t &length);
 };
 
 ctString ctToString(const ctJSON &json);
@@ -3,6 +3,7 @@
 
 #include "ctMath.h"
 #include "ctObjectDescriptor.h"
+#include "ctMetrics.h"
 #include "../../math/include/Statistics/ctBPGNetwork.h"
 
 // Built-ins
@@ -59,5 +60,12 @@ template<typename Key, typename Value> void ctDeserialize(const ctObjectDescript
 void ctSerialize(ctObjectDescriptor *pSerialized, const ctBPGNetwork &src);
 void ctDeserialize(const ctObjectDescriptor &serialized, ctBPGNetwork *pDst);
 
+void ctSerialize(ctObjectDescriptor *pSerialized, const ctMetricsSnapshot::Distribution &src);
+void ctDeserialize(const ctObjectDescriptor &serialized, ctMetricsSnapshot::Distribution *pDst);
+
+// Metrics are written as objects keyed by the metric name
+void ctSerialize(ctObjectDescriptor *pSerialized, const ctMetricsSnapshot &src);
+void ctDeserialize(const ctObjectDescriptor &serialized, ctMetricsSnapshot *pDst);
+
 #include "ctSerialize.inl"
 #endif // atSerialize_h__
@@ -17,6 +17,10 @@ public:
 
   bool Parse(const ctString &xml);
 
+  // Parse 'length' bytes of XML text in place, e.g. from a ctMappedFile.
+  // The parser scans for delimiters up to a null terminator, so the text must be followed by one.
+  bool Parse(const char *xml, const int64_t &length);
+
   // Tag
   void SetTag(const ctString &tag);
   const ctString& GetTag() const;
@@ -1,5 +1,6 @@
 #include "ctCSV.h"
 #include "ctScan.h"
+#include "ctMetrics.h"
 
 ctCSV::ctCSV(const ctString &csv) { Parse(csv); }
 ctCSV::ctCSV(ctCSV &&csv) { *this = std::move(csv); }
@@ -17,26 +18,41 @@ ctCSV& ctCSV::operator=(const ctCSV &rhs)
   return *this;
 }
 
-bool ctCSV::Parse(const ctString &csv)
+bool ctCSV::Parse(const ctString &csv) { return Parse(csv.c_str(), csv.length()); }
+
+bool ctCSV::Parse(const char *csv, const int64_t &length)
 {
   *this = ctCSV();
 
-  if (csv.length() == 0)
+  if (length == 0)
     return false;
 
-  ctString cellTrimChars = ctString("\"") + ctString::Whitespace();
-  // Split by row
-  ctVector<ctString> rows = csv.split("\r\n", true);
-  m_cells.reserve(rows.size());
+  static ctMetricCounter *pBytesParsed = ctMetrics::Counter("ctCSV.bytesParsed");
+  static ctMetricHistogram *pParseTime = ctMetrics::Histogram("ctCSV.parseTime");
+  ctMetricScopeTimer timer(pParseTime);
+  pBytesParsed->Add(length);
 
-  for (const ctString &row : rows)
+  ctString cellTrimChars = ctString("\"") + ctString::Whitespace();
+  const char *pEnd = csv + length;
+  const char *pRow = csv;
+  while (pRow < pEnd)
   {
-    // Rows by columns
-    ctVector<ctString> cols = row.trim(ctString::Whitespace()).split(',', false);
-    m_cells.emplace_back();
-    m_cells.back().reserve(cols.size());
-    for (ctString &val : cols)
-      m_cells.back().emplace_back(val.trim(cellTrimChars));
+    // Split by row, skipping empty lines
+    const char *pRowEnd = pRow;
+    while (pRowEnd < pEnd && *pRowEnd != '\r' && *pRowEnd != '\n')
+      ++pRowEnd;
+
+    if (pRowEnd > pRow)
+    {
+      // Rows by columns
+      ctVector<ctString> cols = ctString(pRow, pRowEnd).trim(ctString::Whitespace()).split(',', false);
+      m_cells.emplace_back();
+      m_cells.back().reserve(cols.size());
+      for (ctString &val : cols)
+        m_cells.back().emplace_back(val.trim(cellTrimChars));
+    }
+
+    pRow = pRowEnd + 1;
   }
 
   return true;
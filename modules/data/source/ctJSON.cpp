@@ -1,5 +1,6 @@
 #include "ctJSON.h"
 #include "ctScan.h"
+#include "ctMetrics.h"
 
 static const ctString _delimterSet = ctString("[]{},:");
 static const ctString _delimiterAndWhitespaceSet = ctString::Whitespace() + _delimterSet;
@@ -8,6 +9,7 @@ static ctString _ParseString(const char **pJson, int64_t *pLength);
 static ctJSON _ParseObject(const char **pJson, int64_t *pLength);
 static ctJSON _ParseArray(const char **pJson, int64_t *pLength);
 static ctJSON _ParseValue(const char **pJson, int64_t *pLength);
+static bool _SkipWhitespace(const char **pJson, int64_t *pLength);
 
 ctJSON::ctJSON(ctJSON &&o) { *this = std::move(o); }
 ctJSON::ctJSON(const ctJSON &o) { *this = o; }
@@ -130,13 +132,22 @@ void ctJSON::MakeValue(const bool &isString)
   m_isString = isString;
 }
 
-int64_t ctJSON::Parse(const char *json, const int64_t &length)
+bool ctJSON::Parse(const char *json, const int64_t &length)
 {
   if (length == 0)
-    return 0;
+    return true;
+
+  static ctMetricCounter *pBytesParsed = ctMetrics::Counter("ctJSON.bytesParsed");
+  static ctMetricHistogram *pParseTime = ctMetrics::Histogram("ctJSON.parseTime");
+  ctMetricScopeTimer timer(pParseTime);
+  pBytesParsed->Add(length);
+
   int64_t len = length;
   *this = _ParseValue(&json, &len);
-  return length - len;
+
+  // Allow trailing whitespace, such as the newline at the end of a file
+  _SkipWhitespace(&json, &len);
+  return len == 0;
 }
 
 void ctJSON::SetElement(const int64_t &index, const ctJSON &value)
@@ -212,7 +223,7 @@ ctJSON& ctJSON::operator[](const int64_t &index) { return GetElement(index); }
 const ctJSON& ctJSON::operator[](const ctString &key) const { return *TryGetMember(key); }
 const ctJSON& ctJSON::operator[](const int64_t &index) const { return *TryGetElement(index); }
 
-bool ctJSON::Parse(const ctString &json) { return Parse(json.c_str(), json.length()) == json.length(); }
+bool ctJSON::Parse(const ctString &json) { return Parse(json.c_str(), json.length()); }
 
 ctString ctToString(const ctJSON &json) { return json.ToString(); }
 ctJSON ctFromString(const ctString &json) { return ctJSON(json); }
@@ -221,7 +221,7 @@ void ctObjectDescriptor::SetType(const ObjectType &type)
 
 ctObjectDescriptor ctObjectDescriptor::Add(const ctString &name, const ObjectType &type /*= OT_Value*/)
 {
-  if (GetObjectType() == OT_Value)
+  if (GetObjectType() == OT_Value || GetObjectType() == OT_Null)
     SetType(name.length() > 0 ? OT_Object : OT_Array);
   int64_t idx = Find(name);
   if (idx >= 0)
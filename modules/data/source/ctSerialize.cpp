@@ -78,3 +78,73 @@ void ctDeserialize(const ctObjectDescriptor &serialized, ctBPGNetwork *pDst)
     pDst->SetLayerWeights(i, weights);
   }
 }
+
+void ctSerialize(ctObjectDescriptor *pSerialized, const ctMetricsSnapshot::Distribution &src)
+{
+  pSerialized->Add("count").Serialize(src.count);
+  pSerialized->Add("sum").Serialize(src.sum);
+  pSerialized->Add("min").Serialize(src.min);
+  pSerialized->Add("max").Serialize(src.max);
+  pSerialized->Add("mean").Serialize(src.mean);
+  pSerialized->Add("p50").Serialize(src.p50);
+  pSerialized->Add("p90").Serialize(src.p90);
+  pSerialized->Add("p99").Serialize(src.p99);
+  pSerialized->Add("p999").Serialize(src.p999);
+}
+
+void ctDeserialize(const ctObjectDescriptor &serialized, ctMetricsSnapshot::Distribution *pDst)
+{
+  pDst->name = serialized.GetName();
+  serialized["count"].Deserialize(&pDst->count);
+  serialized["sum"].Deserialize(&pDst->sum);
+  serialized["min"].Deserialize(&pDst->min);
+  serialized["max"].Deserialize(&pDst->max);
+  serialized["mean"].Deserialize(&pDst->mean);
+  serialized["p50"].Deserialize(&pDst->p50);
+  serialized["p90"].Deserialize(&pDst->p90);
+  serialized["p99"].Deserialize(&pDst->p99);
+  serialized["p999"].Deserialize(&pDst->p999);
+}
+
+void ctSerialize(ctObjectDescriptor *pSerialized, const ctMetricsSnapshot &src)
+{
+  pSerialized->Add("timestamp").Serialize(src.timestamp);
+
+  ctObjectDescriptor counters = pSerialized->Add("counters", ctObjectDescriptor::OT_Object);
+  for (const ctMetricsSnapshot::Value &counter : src.counters)
+    counters.Add(counter.name).Serialize(counter.value);
+
+  ctObjectDescriptor gauges = pSerialized->Add("gauges", ctObjectDescriptor::OT_Object);
+  for (const ctMetricsSnapshot::Value &gauge : src.gauges)
+    gauges.Add(gauge.name).Serialize(gauge.value);
+
+  ctObjectDescriptor histograms = pSerialized->Add("histograms", ctObjectDescriptor::OT_Object);
+  for (const ctMetricsSnapshot::Distribution &histogram : src.histograms)
+    histograms.Add(histogram.name).Serialize(histogram);
+}
+
+void ctDeserialize(const ctObjectDescriptor &serialized, ctMetricsSnapshot *pDst)
+{
+  *pDst = ctMetricsSnapshot();
+  serialized["timestamp"].Deserialize(&pDst->timestamp);
+
+  for (const ctObjectDescriptor &member : serialized.Get("counters").GetMembers())
+  {
+    pDst->counters.emplace_back();
+    pDst->counters.back().name = member.GetName();
+    member.Deserialize(&pDst->counters.back().value);
+  }
+
+  for (const ctObjectDescriptor &member : serialized.Get("gauges").GetMembers())
+  {
+    pDst->gauges.emplace_back();
+    pDst->gauges.back().name = member.GetName();
+    member.Deserialize(&pDst->gauges.back().value);
+  }
+
+  for (const ctObjectDescriptor &member : serialized.Get("histograms").GetMembers())
+  {
+    pDst->histograms.emplace_back();
+    member.Deserialize(&pDst->histograms.back());
+  }
+}
@@ -1,5 +1,6 @@
 #include "ctXML.h"
 #include "ctScan.h"
+#include "ctMetrics.h"
 #include "ctSeek.h"
 
 #define XML_SEPERATOR " \t\r\n/=<>"
@@ -31,39 +32,20 @@ ctXML& ctXML::operator=(const ctXML &rhs)
   return *this;
 }
 
-bool ctXML::Parse(const ctString &xml)
+bool ctXML::Parse(const ctString &xml) { return Parse(xml.c_str(), xml.length()); }
+
+bool ctXML::Parse(const char *xml, const int64_t &length)
 {
-  if (xml.length() == 0)
+  if (length == 0)
     return false;
 
-  // Strip XML comments
-  ctString strippedXml;
-  {
-    ctStringSeeker seeker(&xml);
-    bool addEnd = true;
-    const char *lastPos = seeker.Text();
-    while (seeker.SeekTo("<!--"))
-    {
-      strippedXml += ctString(lastPos, seeker.Text());
-
-      if (!seeker.SeekTo("-->", true))
-      {
-        addEnd = false;
-        break;
-      }
-
-      lastPos = seeker.Text();
-    }
-
-    if (addEnd)
-      strippedXml += lastPos;
-  }
-
-  if (strippedXml.length() == 0)
-    return false;
+  static ctMetricCounter *pBytesParsed = ctMetrics::Counter("ctXML.bytesParsed");
+  static ctMetricHistogram *pParseTime = ctMetrics::Histogram("ctXML.parseTime");
+  ctMetricScopeTimer timer(pParseTime);
+  pBytesParsed->Add(length);
 
-  { // Build XML elements
-    ctStringSeeker seeker(&strippedXml);
+  { // Build XML elements. Comments are skipped by BuildElement() as they are found.
+    ctStringSeeker seeker(xml, length);
     ctXML child;
     ctString endTag;
     ctVector<ctString> tags;
@@ -140,11 +122,53 @@ static ctString _FormatContent(const ctString &text)
   return formatted;
 }
 
+static bool _IsComment(const char *text) { return strncmp(text, "<!--", 4) == 0; }
+
+// Seek past the comment at the current position. Returns false if the comment is not closed.
+static bool _SkipComment(ctStringSeeker *pSeeker)
+{
+  int64_t commentEnd = ctString::_find(pSeeker->Text(), "-->", 4);
+  if (commentEnd == CT_INVALID_INDEX)
+  {
+    pSeeker->Seek(0, atSO_End);
+    return false;
+  }
+
+  pSeeker->Seek(commentEnd + 3);
+  return true;
+}
+
+// Read the content up to the next tag, skipping any comments within it
+static ctString _ReadContent(ctStringSeeker *pSeeker)
+{
+  ctString content;
+  do
+  {
+    int64_t nextTagPos = ctString::_find_first_of(pSeeker->Text(), '<');
+    content += pSeeker->GetString(nextTagPos);
+    if (nextTagPos == CT_INVALID_INDEX)
+      pSeeker->Seek(0, atSO_End);
+    else
+      pSeeker->Seek(nextTagPos);
+  } while (_IsComment(pSeeker->Text()) && _SkipComment(pSeeker));
+
+  return _FormatContent(content);
+}
+
 int64_t ctXML::BuildElement(ctStringSeeker *pSeeker, ctXML *pElem, ctVector<ctString> *pTagStack, ctString *pEndTag)
 {
   *pElem = ctXML();
 
-  pSeeker->SeekTo('<');
+  while (true)
+  { // Find the next tag, skipping comments
+    if (!pSeeker->SeekTo('<'))
+      return 0;
+    if (!_IsComment(pSeeker->Text()))
+      break;
+    if (!_SkipComment(pSeeker))
+      return 0;
+  }
+
   if (pSeeker->Text()[1] == '/')
   {
     if (pEndTag->length() == 0)
@@ -222,9 +246,7 @@ int64_t ctXML::BuildElement(ctStringSeeker *pSeeker, ctXML *pElem, ctVector<ctSt
   pSeeker->Seek(end - pSeeker->begin() + 1 + !hasBody, atSO_Start);
 
   // Find any content before any child elements
-  int64_t nextTagPos = ctString::_find_first_of(pSeeker->Text(), '<');
-  pElem->m_value = _FormatContent(pSeeker->GetString(nextTagPos));
-  pSeeker->Seek(nextTagPos);
+  pElem->m_value = _ReadContent(pSeeker);
 
   if (pElem->m_tag == "br")
     return 1;
@@ -252,13 +274,9 @@ int64_t ctXML::BuildElement(ctStringSeeker *pSeeker, ctXML *pElem, ctVector<ctSt
     }
 
     // Find any content after this child
-    int64_t nextTagPos = ctString::_find_first_of(pSeeker->Text(), '<');
-
-    ctString extra = _FormatContent(pSeeker->GetString(nextTagPos));
+    ctString extra = _ReadContent(pSeeker);
     if (extra.length())
       pElem->m_value += (pElem->m_value.length() ? "\n": "") + extra;
-
-    pSeeker->Seek(nextTagPos);
   }
 
   bool hasEndTag = false;
@@ -9,7 +9,7 @@ template<typename T> class ctRect
 public:
   template<typename T2 = T> ctRect(const ctRect<T2> &o);
 
-  ctRect(const ctVector2<T> &min = atLimitsMax<T>(), const ctVector2<T> &max = atLimitsMin<T>());
+  ctRect(const ctVector2<T> &min = ctLimitsMax<T>(), const ctVector2<T> &max = ctLimitsMin<T>());
   ctRect(const T &left, const T &top, const T &right, const T &bottom);
   ctRect(const ctVector4<T> &rect);
 
@@ -37,7 +37,7 @@ template<typename T> inline T ctSphere<T>::Volume() const
 
 template<typename T> inline T ctSphere<T>::SurfaceArea() const
 {
-  return T(4 * atPi * m_radius * m_radius);
+  return T(4 * ctPi * m_radius * m_radius);
 }
 
 template<typename T> inline void ctSphere<T>::GrowToContain(const ctVector3<T> &point)
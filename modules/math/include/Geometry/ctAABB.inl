@@ -24,7 +24,7 @@
 // -----------------------------------------------------------------------------
 
 #include "ctAABB.h"
-#include "atLimits.h"
+#include "ctLimits.h"
 
 template<typename T> ctAABB<T>::ctAABB(const ctAABB &copy)
   : m_min(copy.m_min)
@@ -101,7 +101,7 @@ template<typename T> inline typename ctAABB<T>::Vec3 ctAABB<T>::ClosestPointBoun
   Vec3 closestPoint = ClosestPoint(point);
   Vec3 distToMin[2] = { closestPoint - m_min, closestPoint - m_max };
   int64_t smallestIndex = 0;
-  T smallest = atLimitsMax<T>();
+  T smallest = ctLimitsMax<T>();
   for (int64_t i = 0; i < 6; ++i)
   {
     const T &val = distToMin[i / 3][i % 3];
@@ -26,7 +26,7 @@
 #ifndef atIntersects_h__
 #define atIntersects_h__
 
-#include "atMath.h"
+#include "ctMath.h"
 
 template<typename T> class ctRay;
 template<typename T> class ctBVH;
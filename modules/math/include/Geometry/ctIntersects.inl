@@ -73,14 +73,14 @@ template<typename T> inline bool ctIntersects(const ctSphere<T> &sphere, const c
 {
   ctVector3<T> aToB = sphere2.m_position - sphere.m_position;
   T distToB = aToB.Length();
-  T maxDist = atSquare(sphere.m_radius + sphere2.m_radius);
+  T maxDist = ctSquare(sphere.m_radius + sphere2.m_radius);
   bool hit = distToB < maxDist;
   if (hit && pPoint)
   {
-    distToB = atSqrt(distToB);
+    distToB = ctSqrt(distToB);
     maxDist = sphere.m_radius + sphere2.m_radius;
     T overlapDist = (maxDist - distToB) / 2;
-    *pPoint = atLerp(sphere.m_position, sphere2.m_position, (sphere.m_radius + overlapDist) / maxDist);
+    *pPoint = ctLerp(sphere.m_position, sphere2.m_position, (sphere.m_radius + overlapDist) / maxDist);
   }
 
   return hit;
@@ -117,7 +117,7 @@ template<typename T> inline bool ctIntersects(const ctOBB<T> &obb, const ctOBB<T
 
   { // Uses separating axis theorem to test the boxes are intersecting
     ctOBB<T> obb2To1 = obb2;
-    atQuaternion<T> invRot = obb.m_orientation.Inverse();
+    ctQuaternion<T> invRot = obb.m_orientation.Inverse();
     ctVector3<T> toCenter = obb2Center - obbCenter;
     toCenter = invRot.Rotate(toCenter) - toCenter;
     obb2To1.m_orientation *= invRot;
@@ -129,7 +129,7 @@ template<typename T> inline bool ctIntersects(const ctOBB<T> &obb, const ctOBB<T
 
   {
     ctOBB<T> obb1To2 = obb;
-    atQuaternion<T> invRot = obb2.m_orientation.Inverse();
+    ctQuaternion<T> invRot = obb2.m_orientation.Inverse();
     ctVector3<T> toCenter = obbCenter - obb2Center;
     toCenter = invRot.Rotate(toCenter) - toCenter;
     obb1To2.m_orientation *= invRot;
@@ -229,5 +229,5 @@ template<typename T> bool ctIntersects(const ctTriangle<T> &tri, const ctTriangl
   return true;
 }
 
-template<typename T> bool ctIntersects(const ctRay<T> &ray, const ctRay<T> &ray2, T *pTime) { return atIntersects<T, T>(ray, ray2, pTime); }
+template<typename T> bool ctIntersects(const ctRay<T> &ray, const ctRay<T> &ray2, T *pTime) { return ctIntersects<T, T>(ray, ray2, pTime); }
 template<typename T, typename T2> bool ctIntersects(const ctRay<T2> &ray, const ctBVH<T> &bvh, T2 *pTime) { return ctIntersects(ray, bvh.m_root, pTime); }
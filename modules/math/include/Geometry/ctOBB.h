@@ -34,10 +34,10 @@ public:
   using Vec3 = ctVector3<T>;
 
   ctOBB();
-  ctOBB(const ctAABB<T> &aabb, const atQuaternion<T> &orientation = atQuaternion<T>::Identity());
+  ctOBB(const ctAABB<T> &aabb, const ctQuaternion<T> &orientation = ctQuaternion<T>::Identity());
   ctOBB(const ctAABB<T> &aabb, const ctMatrix4<T> &rotation = ctMatrix4<T>::Identity());
   ctOBB(const ctAABB<T> &aabb, const ctVector3<T> &rotation = { 0 });
-  ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const atQuaternion<T> &orientation = atQuaternion<T>::Identity());
+  ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const ctQuaternion<T> &orientation = ctQuaternion<T>::Identity());
   ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const ctMatrix4<T> &rotation = ctMatrix4<T>::Identity());
   ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const ctVector3<T> &rotation = { 0 });
 
@@ -53,7 +53,7 @@ public:
   Vec3 OBBToWorld(const Vec3 &point) const;
   
   ctAABB<T> m_aabb;
-  atQuaternion<T> m_orientation;
+  ctQuaternion<T> m_orientation;
 };
 
 template<typename T> ctAABB<T> ctBounds(const ctOBB<T> &obb);
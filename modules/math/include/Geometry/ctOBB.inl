@@ -29,7 +29,7 @@ template<typename T> inline ctOBB<T>::ctOBB()
   , m_orientation(ctQuaternion<T>::Identity())
 {}
 
-template<typename T> inline ctOBB<T>::ctOBB(const ctAABB<T> &aabb, const atQuaternion<T> &orientation)
+template<typename T> inline ctOBB<T>::ctOBB(const ctAABB<T> &aabb, const ctQuaternion<T> &orientation)
   : m_aabb(aabb)
   , m_orientation(orientation)
 {}
@@ -44,7 +44,7 @@ template<typename T> inline ctOBB<T>::ctOBB(const ctAABB<T> &aabb, const ctVecto
   , m_orientation(rotation)
 {}
 
-template<typename T> inline ctOBB<T>::ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const atQuaternion<T> &orientation)
+template<typename T> inline ctOBB<T>::ctOBB(const ctVector3<T> &min, const ctVector3<T> &max, const ctQuaternion<T> &orientation)
   : m_aabb(min, max)
   , m_orientation(orientation)
 {}
@@ -0,0 +1,96 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#ifndef ctAsyncIO_h__
+#define ctAsyncIO_h__
+
+#include "ctTask.h"
+
+#if ctCOROUTINES
+
+#include "networking/ctIOPoller.h"
+#include "networking/ctSocket.h"
+#include "file/ctFile.h"
+
+// Coroutine I/O for ctTask.
+//
+// A task that awaits one of these is suspended without blocking a thread, and
+// resumed on its executor when the operation completes. Sockets passed by reference
+// must stay open until the returned task completes.
+//
+// ctNetwork jobs can be awaited through their future:
+//   ctFuture<void> sent = co_await network.Send(handle, data).Future();
+
+// Awaitable that waits until a socket is ready for an event.
+// co_await returns false if the socket could not be watched.
+struct ctSocketReady
+{
+  bool await_ready() const noexcept { return false; }
+  template<typename Promise> bool await_suspend(std::coroutine_handle<Promise> caller);
+  bool await_resume() const noexcept { return ok; }
+
+  atSocketHandle handle;
+  ctIOPoller::Event event;
+  ctIOPoller *pPoller;
+  bool ok;
+};
+
+// If pPoller is null the global poller is used
+ctSocketReady ctWaitReadable(const ctSocket &socket, ctIOPoller *pPoller = nullptr);
+ctSocketReady ctWaitWritable(const ctSocket &socket, ctIOPoller *pPoller = nullptr);
+
+// Read up to maxLen bytes once the socket has data.
+// Returns the number of bytes read, 0 if the connection was closed, or -1 on error.
+ctTask<int64_t> ctAsyncRead(const ctSocket &socket, uint8_t *pData, const int64_t maxLen);
+
+// Write all 'len' bytes, waiting whenever the socket's send buffer is full.
+// Returns the number of bytes written, which is less than 'len' on error.
+ctTask<int64_t> ctAsyncWrite(const ctSocket &socket, const uint8_t *pData, const int64_t len);
+
+// Accept a connection on a host socket once one is pending
+ctTask<ctSocket> ctAsyncAccept(const ctSocket &host);
+
+// Connect to a host. The blocking connect is run on pJobs (or the global job system).
+ctTask<ctSocket> ctAsyncConnect(ctString addr, ctString port, ctJobSystem *pJobs = nullptr);
+
+// Read a file on pJobs (or the global job system)
+ctTask<ctVector<uint8_t>> ctAsyncReadFile(ctFilename filename, bool *pResult = nullptr, ctJobSystem *pJobs = nullptr);
+ctTask<ctString> ctAsyncReadText(ctFilename filename, bool *pResult = nullptr, ctJobSystem *pJobs = nullptr);
+
+template<typename Promise>
+inline bool ctSocketReady::await_suspend(std::coroutine_handle<Promise> caller)
+{
+  ctExecutor *pExecutor = _ctCoroutineExecutor(caller);
+  ok = true;
+  if (pPoller->Wait(handle, event, [pExecutor, caller]() { _ctResumeOn(pExecutor, caller); }))
+    return true;
+
+  // Resume immediately
+  ok = false;
+  return false;
+}
+
+#endif // ctCOROUTINES
+
+#endif // ctAsyncIO_h__
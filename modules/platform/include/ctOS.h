@@ -3,6 +3,8 @@
 
 #include "file/ctFileCommon.h"
 #include "ctStreamSeekable.h"
+#include "ctIOSlice.h"
+#include <functional>
 
 typedef void* ctFileHandle;
 
@@ -26,9 +28,29 @@ public:
     static int64_t Read(const ctFileHandle &handle, void *pDst, const int64_t &size);
     static int64_t Write(const ctFileHandle &handle, const void *pSrc, const int64_t &size);
 
+    // Scatter/gather versions of Read() and Write()
+    static int64_t ReadV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count);
+    static int64_t WriteV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count);
+
+    // Read/write at an absolute offset without moving the file position. Returns -1 on error.
+    static int64_t ReadAt(const ctFileHandle &handle, const int64_t &offset, void *pDst, const int64_t &size);
+    static int64_t WriteAt(const ctFileHandle &handle, const int64_t &offset, const void *pSrc, const int64_t &size);
+
+    // Get the OS file descriptor (Linux) or HANDLE (Windows) for an open file
+    static intptr_t Descriptor(const ctFileHandle &handle);
+
+    static bool Advise(const ctFileHandle &handle, const ctFileAdvice &advice, const int64_t &offset, const int64_t &size);
+    static bool Allocate(const ctFileHandle &handle, const int64_t &offset, const int64_t &size);
+
+    // Called while copying with the number of bytes copied so far and the total size.
+    // Return false to cancel the copy.
+    typedef std::function<bool(int64_t copied, int64_t total)> CopyProgress;
+
     static bool Exists(const char *path);
-    static bool Copy(const char *src, const char *dst, bool overwrite = false);
-    static bool Move(const char *src, const char *dst);
+    static bool Copy(const char *src, const char *dst, bool overwrite = false, const CopyProgress &progress = nullptr);
+
+    // Fails if dst exists. Moves across devices copy the file and then delete src.
+    static bool Move(const char *src, const char *dst, const CopyProgress &progress = nullptr);
     static bool EndOfFile(const ctFileHandle &handle);
   };
 };
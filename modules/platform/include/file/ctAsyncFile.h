@@ -0,0 +1,113 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#ifndef ctAsyncFile_h__
+#define ctAsyncFile_h__
+
+#include "ctFile.h"
+#include "ctFuture.h"
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+// Maximum number of files ReadFiles() keeps open at once, well below the usual descriptor limits
+#define ctASYNC_FILE_MAX_OPEN 256
+
+class ctJobSystem;
+
+// Batched asynchronous file reads and writes.
+// On Linux requests are submitted to an io_uring when the kernel supports it. Otherwise
+// each request is run as a positional read or write on a small pool of I/O threads.
+//
+// Files and buffers must stay valid until their requests complete. Destroying a
+// ctAsyncFile waits for all submitted requests.
+class ctAsyncFile
+{
+public:
+  enum Operation : int64_t
+  {
+    AO_Read,
+    AO_Write,
+  };
+
+  // Called with the number of bytes transferred, or -1 on error. Reads that reach the end
+  // of the file transfer fewer bytes than requested. Callbacks run on an I/O thread, so they
+  // should be short and must not block.
+  typedef std::function<void(int64_t)> Callback;
+
+  struct Request
+  {
+    Operation op = AO_Read;
+    const ctFile *pFile = nullptr;
+    int64_t offset = 0;
+    void *pData = nullptr;
+    int64_t size = 0;
+    Callback callback;
+  };
+
+  // threadCount is the size of the fallback thread pool
+  ctAsyncFile(const int64_t threadCount = 4);
+  ~ctAsyncFile();
+
+  ctAsyncFile(const ctAsyncFile &) = delete;
+  ctAsyncFile& operator=(const ctAsyncFile &) = delete;
+
+  // A process wide instance, created on first use
+  static ctAsyncFile* Global();
+
+  // Submit a batch of requests together. Write requests must use files opened for writing.
+  // Returns false if a request is invalid, in which case nothing is submitted.
+  bool Submit(const Request *pRequests, const int64_t count);
+  bool Submit(const ctVector<Request> &requests);
+
+  // Futures complete with the number of bytes transferred, and fail on error
+  ctFuture<int64_t> Read(const ctFile &file, const int64_t offset, void *pBuffer, const int64_t size);
+  ctFuture<int64_t> Write(ctFile &file, const int64_t offset, const void *pData, const int64_t size);
+
+  // Read whole files. Files are opened on the calling thread and submitted in batches.
+  // At most ctASYNC_FILE_MAX_OPEN files are open at once, so this blocks until the last
+  // file has been opened when there are more. A future fails if its file could not be opened or read.
+  ctFuture<ctVector<uint8_t>> ReadFile(const ctFilename &filename);
+  ctVector<ctFuture<ctVector<uint8_t>>> ReadFiles(const ctVector<ctFilename> &filenames);
+
+  // Returns true if requests are handled by the kernel (io_uring) rather than the thread pool
+  bool IsNative() const;
+
+protected:
+  static bool IsValid(const Request &request);
+
+  // Run requests as blocking positional reads/writes on the thread pool
+  void SubmitToPool(const Request *pRequests, const int64_t count);
+
+  class Context;
+  Context *m_pContext = nullptr;
+  ctJobSystem *m_pPool = nullptr;
+
+  // Files opened by ReadFiles() that have not completed yet
+  std::mutex m_openLock;
+  std::condition_variable m_openReleased;
+  int64_t m_openFiles = 0;
+};
+
+#endif // ctAsyncFile_h__
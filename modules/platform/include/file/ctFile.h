@@ -30,6 +30,7 @@
 #include "ctFileInfo.h"
 #include "ctReadStream.h"
 #include "ctWriteStream.h"
+#include "ctFuture.h"
 
 class ctFile : public ctReadStream, public ctWriteStream
 {
@@ -64,6 +65,9 @@ public:
   // Writes pData to the file
   int64_t Write(const void *pData, const int64_t len) override;
 
+  // Large gathers are written with a single writev instead of through the stream buffer
+  int64_t WriteV(const ctIOSlice *pSlices, const int64_t count) override;
+
   // Writes pData to the file
   int64_t WriteText(const ctString &text);
 
@@ -71,6 +75,11 @@ public:
   static ctString ReadText(const ctFilename &filename, bool *pResult = nullptr);
   static ctVector<uint8_t> ReadFile(const ctFilename &filename, bool *pResult = nullptr);
 
+  // Read a file as a job on pJobs (or the global job system).
+  // The future fails if the file could not be read.
+  static ctFuture<ctString> ReadTextAsync(const ctFilename &filename, ctJobSystem *pJobs = nullptr);
+  static ctFuture<ctVector<uint8_t>> ReadFileAsync(const ctFilename &filename, ctJobSystem *pJobs = nullptr);
+
   static int64_t WriteFile(const ctFilename &filename, const void *pData, const int64_t &len);
   static int64_t WriteTextFile(const ctFilename &filename, const ctString &content);
 
@@ -79,8 +88,24 @@ public:
   // Read data into pBuffer. 
   // Returns the number of bytes read
   int64_t Read(void *pBuffer, const int64_t size);
+  int64_t ReadV(const ctIOSlice *pSlices, const int64_t count) override;
+
+  // Read/write at an absolute offset without moving the file position.
+  // Many threads can use ReadAt() on the same file at once. These bypass the buffer
+  // used by Read() and Write(), so call Flush() before reading back buffered writes.
+  // Returns the number of bytes transferred, which is short at the end of the file, or -1 on error.
+  int64_t ReadAt(const int64_t offset, void *pBuffer, const int64_t size) const;
+  int64_t WriteAt(const int64_t offset, const void *pData, const int64_t size);
+
+  // Hint how a range of the file will be accessed. A size of 0 covers the rest of the file.
+  bool Advise(const ctFileAdvice advice, const int64_t offset = 0, const int64_t size = 0);
+
+  // Reserve disk space for the first 'size' bytes of the file without changing its length.
+  // Returns false if the file system does not support preallocation.
+  bool Reserve(const int64_t size);
 
   const ctFileInfo &Info() const;
+  ctFileHandle Handle() const;
 
   int64_t GetMode() const;
   bool IsOpen() const;
@@ -94,8 +119,18 @@ public:
   static bool Exists(const ctFilename &fn);
   static bool Create(const ctFilename &fn);
   static bool Delete(const ctFilename &fn);
-  static bool Copy(const ctFilename &src, const ctFilename &dst, bool overwrite = false);
-  static bool Move(const ctFilename &src, const ctFilename &dst);
+
+  // Copy or move a file. The copy is done by the kernel where possible, sharing the
+  // data blocks on file systems that support it. If progress returns false the copy
+  // is cancelled and the partial destination file is deleted.
+  static bool Copy(const ctFilename &src, const ctFilename &dst, bool overwrite = false, const ctOS::File::CopyProgress &progress = nullptr);
+  static bool Move(const ctFilename &src, const ctFilename &dst, const ctOS::File::CopyProgress &progress = nullptr);
+
+  // Copy src[i] to dst[i] for each file. Returns the number of files copied.
+  // progress reports the bytes copied across all of the files. If parallel is true the files
+  // are copied on pJobs (or the global job system) and progress is called from the worker
+  // threads, one call at a time.
+  static int64_t CopyFiles(const ctVector<ctFilename> &src, const ctVector<ctFilename> &dst, bool overwrite = false, const ctOS::File::CopyProgress &progress = nullptr, const bool parallel = false, ctJobSystem *pJobs = nullptr);
 
 protected:
   ctFileHandle m_handle = 0;
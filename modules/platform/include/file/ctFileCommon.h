@@ -41,6 +41,16 @@ enum ctFileMode
   atFM_ReadWriteBinary = atFM_ReadWrite | atFM_Binary,
 };
 
+// Access pattern hints for an open file (posix_fadvise on Linux)
+enum ctFileAdvice
+{
+  atFA_Normal,
+  atFA_Sequential,
+  atFA_Random,
+  atFA_WillNeed,
+  atFA_DontNeed,
+};
+
 class ctFileCommon
 {
 public:
@@ -28,6 +28,9 @@
 
 #include "ctFileCommon.h"
 #include "ctFilename.h"
+#include <functional>
+
+class ctJobSystem;
 
 class ctFileSystem
 {
@@ -37,15 +40,58 @@ public:
   struct FileInfo
   {
     bool isFolder = false;
+    bool isLink = false;
     int64_t size = 0;
     ctFilename path;
   };
 
+  // Called for each entry found by Walk(). Return false to stop the walk.
+  typedef std::function<bool(const FileInfo &info)> WalkCallback;
+
+  struct WalkOptions
+  {
+    bool files = true;
+    bool folders = true;
+
+    // Get the size of each file. On Linux this costs a stat() per file.
+    bool fileSizes = true;
+
+    // Search linked folders. Cyclic links are only stopped by maxDepth.
+    bool followLinks = false;
+
+    // The number of folder levels to search below the root. -1 searches them all.
+    int64_t maxDepth = -1;
+
+    // Glob patterns, see MatchGlob(). If include is not empty, only entries matching
+    // one of them are reported. Entries matching an exclude pattern are not reported
+    // and excluded folders are not searched.
+    ctVector<ctString> include;
+    ctVector<ctString> exclude;
+
+    // Search subfolders in parallel on pJobs (or the global job system).
+    // The callback is then called from several threads at once, in no particular order.
+    bool parallel = false;
+    ctJobSystem *pJobs = nullptr;
+  };
+
   static bool CreateFolders(const ctFilename &path);
   static ctVector<FileInfo> EnumerateFiles(const ctFilename &path);
   static ctVector<FileInfo> EnumerateFolders(const ctFilename &path);
   static ctVector<FileInfo> Enumerate(const ctFilename &path);
 
+  // Visit every entry below 'path', parents before their children.
+  // Returns false if 'path' could not be read or the callback stopped the walk.
+  static bool Walk(const ctFilename &path, const WalkCallback &callback);
+  static bool Walk(const ctFilename &path, const WalkCallback &callback, const WalkOptions &options);
+  static ctVector<FileInfo> Walk(const ctFilename &path);
+  static ctVector<FileInfo> Walk(const ctFilename &path, const WalkOptions &options);
+
+  // Match a path against a glob pattern.
+  // '*' and '?' match any characters except '/', '**' matches any number of folders and
+  // [abc], [a-z] or [!abc] match one character in (or not in) a set.
+  // A pattern without a '/' is matched against the last part of the path only.
+  static bool MatchGlob(const ctString &pattern, const ctString &path);
+
   static ctFilename GetDirectory_AppData();
   static ctFilename GetDirectory_AppData_Local();
   static ctFilename GetDirectory_Windows();
@@ -57,6 +103,10 @@ public:
   static ctFilename GetDirectory_StartMenu();
   static ctFilename GetDirectory_ProgramFiles();
   static ctFilename GetDirectory_ProgramFiles86();
+
+protected:
+  // Append the entries of a single folder to pEntries. Implemented per platform.
+  static bool ReadFolder(const ctFilename &path, const bool findFiles, const bool findFolders, const bool fileSizes, ctVector<FileInfo> *pEntries);
 };
 
 #endif // atFileSystem_h__
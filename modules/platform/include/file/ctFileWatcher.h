@@ -0,0 +1,101 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+
+#ifndef ctFileWatcher_h__
+#define ctFileWatcher_h__
+
+#include "ctFilename.h"
+#include "ctHashMap.h"
+#include <functional>
+
+// Watches files and folders for changes and reports them from a background thread.
+// On Linux changes are read from inotify, on Windows from ReadDirectoryChangesW.
+//
+// Changes to a path are merged until it has been quiet for the debounce window, so the
+// burst of events caused by saving a file or switching branches is reported as one event
+// per path. A path that keeps changing is reported every ten windows.
+class ctFileWatcher
+{
+public:
+  enum EventFlags : int64_t
+  {
+    FWE_Created = 1 << 0,
+    FWE_Modified = 1 << 1,
+    FWE_Deleted = 1 << 2,
+
+    // Events were lost because they arrived faster than they could be read.
+    // Reload everything that is watched.
+    FWE_Overflow = 1 << 3,
+  };
+
+  struct Event
+  {
+    ctFilename path;
+    int64_t flags = 0; // All EventFlags seen for the path within the window
+    bool isFolder = false;
+  };
+
+  // Called on the watcher thread with the events that are ready. Changes that happen
+  // while it runs are queued by the OS and reported in a later call.
+  typedef std::function<void(const ctVector<Event> &events)> Callback;
+
+  ctFileWatcher(const Callback &callback, const int64_t debounceMs = 100);
+
+  // Stops the watcher thread. Events that have not been reported are discarded.
+  ~ctFileWatcher();
+
+  ctFileWatcher(const ctFileWatcher &) = delete;
+  ctFileWatcher& operator=(const ctFileWatcher &) = delete;
+
+  // Watch a file, or the entries of a folder. If recursive is true all subfolders are
+  // watched too, including ones created later.
+  bool Watch(const ctFilename &path, const bool recursive = false);
+  bool Unwatch(const ctFilename &path);
+
+protected:
+  struct Pending
+  {
+    Event event;
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+  };
+
+  // Used by the watcher thread to merge a change into the pending events
+  void Queue(const ctString &path, const int64_t flags, const bool isFolder);
+
+  // Report the pending events that are ready.
+  // Returns the milliseconds until the next event is ready, or -1 if none are pending.
+  int64_t Deliver();
+
+  class Context;
+  Context *m_pContext = nullptr;
+
+  Callback m_callback;
+  int64_t m_debounceMs = 0;
+  ctVector<Pending> m_pending;
+  ctHashMap<ctString, int64_t> m_pendingIndex;
+};
+
+#endif // ctFileWatcher_h__
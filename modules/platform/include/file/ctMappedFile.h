@@ -0,0 +1,129 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#ifndef ctMappedFile_h__
+#define ctMappedFile_h__
+
+#include "ctFilename.h"
+#include "ctReadStream.h"
+
+// Maps a file into memory so it can be read, or modified, in place.
+// Read-only mappings are always followed by a zero byte, so text parsers
+// can run directly over Data() without copying the file into a string.
+class ctMappedFile : public ctReadStream
+{
+public:
+  enum Mode : int64_t
+  {
+    MM_ReadOnly,
+    MM_ReadWrite,
+  };
+
+  // Access pattern hints passed on to the OS (madvise on Linux)
+  enum Advice : int64_t
+  {
+    MA_Normal,
+    MA_Sequential,
+    MA_Random,
+    MA_WillNeed,
+    MA_DontNeed,
+  };
+
+  ctMappedFile();
+  ctMappedFile(const ctFilename &path, const Mode mode = MM_ReadOnly, const int64_t size = -1);
+  ctMappedFile(ctMappedFile &&move);
+  ~ctMappedFile();
+
+  ctMappedFile(const ctMappedFile &) = delete;
+  ctMappedFile& operator=(const ctMappedFile &) = delete;
+  ctMappedFile& operator=(ctMappedFile &&rhs);
+
+  // Map 'path' into memory. If size is not negative the file is resized to 'size'
+  // bytes first, creating it if it does not exist. Resizing requires MM_ReadWrite.
+  bool Open(const ctFilename &path, const Mode mode = MM_ReadOnly, const int64_t size = -1);
+
+  // Unmap the file. Changes made through MutableData() are not guaranteed to be
+  // on disk until Flush() has been called.
+  void Close();
+
+  // Hint how a range of the file will be accessed. A size of -1 covers the rest of the file.
+  bool Advise(const Advice advice, const int64_t offset = 0, const int64_t size = -1);
+
+  // Write modified pages back to the file. If async is true this only schedules the write.
+  bool Flush(const bool async = false);
+
+  bool IsOpen() const;
+  Mode GetMode() const;
+  const ctFilename& Filename() const;
+
+  const uint8_t* Data() const;
+
+  // Returns nullptr unless the file was mapped with MM_ReadWrite
+  uint8_t* MutableData();
+
+  int64_t Size() const;
+
+  // Reads up to size bytes. Returns the number of bytes read.
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  int64_t Peek(void *pBuffer, const int64_t size) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  // Get a pointer to the next size bytes without copying them, and move past them.
+  // Returns nullptr, without moving, if fewer than size bytes are available.
+  const uint8_t* ReadView(const int64_t size);
+
+  // Get a pointer to the next size bytes without moving past them.
+  // Returns nullptr if fewer than size bytes are available.
+  const uint8_t* PeekView(const int64_t size) const;
+
+  // Returns false, without moving, if the location is outside of the file
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+  int64_t Available() const override;
+
+protected:
+  // Implemented per platform. Map() fills in m_pData and m_size, leaving m_pData
+  // null for an empty file. Unmap() releases whatever Map() acquired, even on failure.
+  bool Map(const int64_t size);
+  void Unmap();
+
+  void Swap(ctMappedFile &other);
+
+  uint8_t *m_pData = nullptr;
+  int64_t m_size = 0;
+  int64_t m_pos = 0;
+  Mode m_mode = MM_ReadOnly;
+  ctFilename m_fn;
+
+  // Platform specific state for the mapping
+  void *m_pView = nullptr;
+  int64_t m_viewSize = 0;
+  void *m_hFile = nullptr;
+  void *m_hMapping = nullptr;
+};
+
+template<typename T> int64_t ctMappedFile::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
+
+#endif // ctMappedFile_h__
@@ -0,0 +1,64 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#ifndef ctIOPoller_h__
+#define ctIOPoller_h__
+
+#include "ctSocket.h"
+#include <functional>
+
+// Watches sockets and calls back when they are ready for reading or writing.
+// A single background thread waits on all registered sockets (epoll on Linux).
+class ctIOPoller
+{
+public:
+  enum Event : int64_t
+  {
+    IOE_Read = 1,
+    IOE_Write = 1 << 1,
+  };
+
+  typedef std::function<void()> Callback;
+
+  ctIOPoller();
+  ~ctIOPoller();
+
+  ctIOPoller(const ctIOPoller &) = delete;
+  ctIOPoller& operator=(const ctIOPoller &) = delete;
+
+  // A process wide poller, created on first use
+  static ctIOPoller* Global();
+
+  // Call 'callback' once, on the poller thread, when 'handle' is ready for 'event' or
+  // has an error. Only one wait per handle and event can be pending at a time, and the
+  // handle must stay open until the callback is called. The callback should be short
+  // and must not block.
+  bool Wait(const atSocketHandle handle, const Event event, Callback callback);
+
+protected:
+  class Context;
+  Context *m_pContext;
+};
+
+#endif // ctIOPoller_h__
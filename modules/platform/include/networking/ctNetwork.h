@@ -4,6 +4,7 @@
 #include "ctSocket.h"
 #include "ctHashMap.h"
 #include "ctThreading.h"
+#include "ctFuture.h"
 
 typedef int64_t ctConnectionHandle;
 
@@ -32,6 +33,10 @@ public:
     bool Failed() const;
     ctConnectionHandle Handle() const;
 
+    // Get a future that completes when the job is done, or fails if the job fails.
+    // Use this to chain work with Then() instead of polling Done().
+    ctFuture<void> Future() const;
+
     const JobStatus& operator=(const JobStatus &copy);
     const JobStatus& operator=(JobStatus &&copy);
 
@@ -27,6 +27,8 @@
 #define atSocket_h__
 
 #include "ctString.h"
+#include "ctIOSlice.h"
+#include <atomic>
 
 #define atWSAMajorVer 2
 #define atWSAMinorVer 2
@@ -54,6 +56,11 @@ public:
   int64_t Read(uint8_t *pData, const int64_t maxLen) const;
   int64_t Write(const uint8_t *pData, const int64_t len) const;
 
+  // Scatter/gather versions of Read() and Write() that transfer all slices in one call.
+  // Like Read() and Write(), they may transfer fewer bytes than requested.
+  int64_t ReadV(const ctIOSlice *pSlices, const int64_t count) const;
+  int64_t WriteV(const ctIOSlice *pSlices, const int64_t count) const;
+
   const atSocketHandle &Handle() const;
   const ctString &Port() const;
   const ctString &Address() const;
@@ -66,7 +73,7 @@ protected:
   ctString m_port;
   bool m_isHost;
 
-  static int64_t m_nSockets;
+  static std::atomic<int64_t> m_nSockets;
 };
 
 #endif // atSocket_h__
@@ -0,0 +1,74 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ctSocketStream_h__
+#define ctSocketStream_h__
+
+#include "ctSocket.h"
+#include "ctReadStream.h"
+#include "ctWriteStream.h"
+
+// Reads and writes a connected socket through the stream interfaces, so stream
+// adapters and ctStreamRead()/ctStreamWrite() can be used over a network connection.
+// Read() and Write() block until all of the data is transferred or the connection fails,
+// waiting on ctIOPoller when a non-blocking socket is not ready.
+class ctSocketStream : public ctReadStream, public ctWriteStream
+{
+public:
+  ctSocketStream(const ctSocket *pSocket);
+
+  int64_t Read(void *pBuffer, const int64_t size) override;
+  int64_t ReadV(const ctIOSlice *pSlices, const int64_t count) override;
+  template<typename T> int64_t Read(T *pBuffer, const int64_t count = 1);
+
+  int64_t Write(const void *pData, const int64_t len) override;
+  int64_t WriteV(const ctIOSlice *pSlices, const int64_t count) override;
+  template<typename T> int64_t Write(const T *pData, const int64_t count = 1);
+  template<typename T> int64_t Write(const T &data);
+
+  // Sockets can not seek. Tell() and Length() return the number of bytes transferred.
+  bool Seek(const int64_t loc, const ctSeekOrigin origin = atSO_Start) override;
+  int64_t Tell() const override;
+  int64_t Length() const override;
+
+  // Returns the number of bytes that can be read without blocking
+  int64_t Available() const override;
+
+  const ctSocket* Socket() const;
+
+protected:
+  // Transfer the slices left after the first 'done' bytes, one at a time
+  int64_t ReadRemaining(const ctIOSlice *pSlices, const int64_t count, int64_t done);
+  int64_t WriteRemaining(const ctIOSlice *pSlices, const int64_t count, int64_t done);
+
+  const ctSocket *m_pSocket = nullptr;
+  int64_t m_transferred = 0;
+};
+
+template<typename T> inline int64_t ctSocketStream::Read(T *pBuffer, const int64_t count) { return ctStreamRead(this, pBuffer, count); }
+template<typename T> inline int64_t ctSocketStream::Write(const T *pData, const int64_t count) { return ctStreamWrite(this, pData, count); }
+template<typename T> inline int64_t ctSocketStream::Write(const T &data) { return Write(&data, 1); }
+
+#endif // ctSocketStream_h__
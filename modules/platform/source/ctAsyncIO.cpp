@@ -0,0 +1,83 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "ctAsyncIO.h"
+
+#if ctCOROUTINES
+
+ctSocketReady ctWaitReadable(const ctSocket &socket, ctIOPoller *pPoller)
+{
+  return ctSocketReady{ socket.Handle(), ctIOPoller::IOE_Read, pPoller ? pPoller : ctIOPoller::Global(), false };
+}
+
+ctSocketReady ctWaitWritable(const ctSocket &socket, ctIOPoller *pPoller)
+{
+  return ctSocketReady{ socket.Handle(), ctIOPoller::IOE_Write, pPoller ? pPoller : ctIOPoller::Global(), false };
+}
+
+ctTask<int64_t> ctAsyncRead(const ctSocket &socket, uint8_t *pData, const int64_t maxLen)
+{
+  bool ready = co_await ctWaitReadable(socket);
+  co_return ready ? socket.Read(pData, maxLen) : -1;
+}
+
+ctTask<int64_t> ctAsyncWrite(const ctSocket &socket, const uint8_t *pData, const int64_t len)
+{
+  int64_t written = 0;
+  while (written < len)
+  {
+    bool ready = co_await ctWaitWritable(socket);
+    if (!ready)
+      break;
+
+    int64_t sent = socket.Write(pData + written, len - written);
+    if (sent <= 0)
+      break;
+    written += sent;
+  }
+  co_return written;
+}
+
+ctTask<ctSocket> ctAsyncAccept(const ctSocket &host)
+{
+  bool ready = co_await ctWaitReadable(host);
+  co_return ready ? host.Accept() : ctSocket();
+}
+
+ctTask<ctSocket> ctAsyncConnect(ctString addr, ctString port, ctJobSystem *pJobs)
+{
+  co_return co_await ctOffload([&addr, &port]() { return ctSocket::Connect(addr, port); }, pJobs);
+}
+
+ctTask<ctVector<uint8_t>> ctAsyncReadFile(ctFilename filename, bool *pResult, ctJobSystem *pJobs)
+{
+  co_return co_await ctOffload([&filename, pResult]() { return ctFile::ReadFile(filename, pResult); }, pJobs);
+}
+
+ctTask<ctString> ctAsyncReadText(ctFilename filename, bool *pResult, ctJobSystem *pJobs)
+{
+  co_return co_await ctOffload([&filename, pResult]() { return ctFile::ReadText(filename, pResult); }, pJobs);
+}
+
+#endif
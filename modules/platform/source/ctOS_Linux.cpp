@@ -1,6 +1,7 @@
 #include "ctOS.h"
 
 #ifdef ctPLATFORM_LINUX
+#include "ctVector.h"
 
 #include<stdio.h>
 #include<unistd.h>
@@ -8,10 +9,19 @@
 #include<sys/types.h>
 #include<sys/stat.h>
 #include<fcntl.h>
+#include<limits.h>
+#include<stddef.h>
+#include<sys/uio.h>
+#include<sys/ioctl.h>
+#include<sys/sendfile.h>
+#include<linux/fs.h>
+
+// Sequential reads and writes go through the stdio buffer. Positional reads and
+// writes use the underlying descriptor directly, so they never take the stream lock.
+static int _Descriptor(const ctFileHandle &handle) { return fileno_unlocked((FILE*)handle); }
 
 ctFileHandle ctOS::File::Open(const char *path, const ctFileMode &mode)
 {
-  FILE *pFile = nullptr;
   return fopen(path, ctFileCommon::FileMode(mode));
 }
 
@@ -41,8 +51,9 @@ bool ctOS::File::Seek(const ctFileHandle &handle, const int64_t &loc, const ctSe
     return false;
   }
 
-  fseek((FILE*)handle, (long)loc, (int)sysOrigin);
-  
+  if (fseeko((FILE*)handle, (off_t)loc, sysOrigin) != 0)
+    return false;
+
   if (pNewPosition)
     *pNewPosition = Tell(handle);
 
@@ -51,20 +62,219 @@ bool ctOS::File::Seek(const ctFileHandle &handle, const int64_t &loc, const ctSe
 
 int64_t ctOS::File::Tell(const ctFileHandle &handle)
 {
-  return ftell((FILE*)handle);
+  return (int64_t)ftello((FILE*)handle);
 }
 
+// A ctFile's stream position is not thread safe, so the per-call stream lock is skipped
 int64_t ctOS::File::Read(const ctFileHandle &handle, void *pDst, const int64_t &size)
 {
   int64_t bytesRead = 0;
   if (handle != nullptr && pDst != nullptr && size > 0)
-    bytesRead = fread(pDst, 1, (size_t)size, (FILE *)handle);
+    bytesRead = fread_unlocked(pDst, 1, (size_t)size, (FILE *)handle);
   return bytesRead;
 }
 
 int64_t ctOS::File::Write(const ctFileHandle &handle, const void *pSrc, const int64_t &size)
 {
-  return fwrite(pSrc, 1, size, (FILE*)handle);
+  int64_t bytesWritten = 0;
+  if (handle != nullptr && pSrc != nullptr && size > 0)
+    bytesWritten = fwrite_unlocked(pSrc, 1, (size_t)size, (FILE*)handle);
+  return bytesWritten;
+}
+
+static_assert(sizeof(ctIOSlice) == sizeof(iovec) && offsetof(ctIOSlice, size) == offsetof(iovec, iov_len), "ctIOSlice must match iovec");
+
+// Gathers smaller than this are copied through the stdio buffer, which is cheaper
+// than a system call. Larger ones skip the buffer.
+static const int64_t _directIOSize = 16 * 1024;
+
+static int64_t _TotalSize(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+    total += pSlices[i].size;
+  return total;
+}
+
+// Call preadv/pwritev until all slices are transferred, or the call fails or reaches the end of the file
+template<typename Func> static int64_t _TransferV(const ctIOSlice *pSlices, const int64_t count, Func &&transfer)
+{
+  ctVector<iovec> slices((const iovec*)pSlices, count);
+  iovec *pNext = slices.data();
+  int64_t remaining = count;
+  int64_t total = 0;
+  while (remaining > 0)
+  {
+    ssize_t res = transfer(pNext, (int)ctMin(remaining, (int64_t)IOV_MAX), total);
+    if (res < 0 && errno == EINTR)
+      continue;
+    if (res <= 0)
+      break;
+
+    total += res;
+    while (remaining > 0 && (size_t)res >= pNext->iov_len)
+    {
+      res -= pNext->iov_len;
+      ++pNext;
+      --remaining;
+    }
+
+    if (remaining > 0)
+    {
+      pNext->iov_base = (uint8_t*)pNext->iov_base + res;
+      pNext->iov_len -= res;
+    }
+  }
+  return total;
+}
+
+int64_t ctOS::File::ReadV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count)
+{
+  if (handle == nullptr)
+    return 0;
+
+  FILE *pFile = (FILE*)handle;
+  if (_TotalSize(pSlices, count) < _directIOSize)
+  {
+    int64_t total = 0;
+    for (int64_t i = 0; i < count; ++i)
+    {
+      int64_t bytesRead = Read(handle, pSlices[i].pData, pSlices[i].size);
+      total += bytesRead;
+      if (bytesRead != pSlices[i].size)
+        break;
+    }
+    return total;
+  }
+
+  // Read from the stream's logical position, then move the stream past what was read
+  int64_t pos = Tell(handle);
+  if (pos < 0)
+    return 0;
+
+  int fd = _Descriptor(handle);
+  int64_t total = _TransferV(pSlices, count, [fd, pos](const iovec *pIov, int iovCount, int64_t done) {
+    return preadv(fd, pIov, iovCount, (off_t)(pos + done));
+  });
+  fseeko(pFile, (off_t)(pos + total), SEEK_SET);
+  return total;
+}
+
+int64_t ctOS::File::WriteV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count)
+{
+  if (handle == nullptr)
+    return 0;
+
+  FILE *pFile = (FILE*)handle;
+  if (_TotalSize(pSlices, count) < _directIOSize)
+  {
+    int64_t total = 0;
+    for (int64_t i = 0; i < count; ++i)
+    {
+      int64_t bytesWritten = Write(handle, pSlices[i].pData, pSlices[i].size);
+      total += bytesWritten;
+      if (bytesWritten != pSlices[i].size)
+        break;
+    }
+    return total;
+  }
+
+  // Write out anything buffered first so the data stays in order
+  int64_t pos = Tell(handle);
+  if (pos < 0 || fflush(pFile) != 0)
+    return 0;
+
+  int fd = _Descriptor(handle);
+  bool append = (fcntl(fd, F_GETFL) & O_APPEND) != 0;
+  int64_t total = _TransferV(pSlices, count, [fd, pos, append](const iovec *pIov, int iovCount, int64_t done) {
+    return append ? writev(fd, pIov, iovCount) : pwritev(fd, pIov, iovCount, (off_t)(pos + done));
+  });
+
+  if (append)
+    fseeko(pFile, 0, SEEK_END);
+  else
+    fseeko(pFile, (off_t)(pos + total), SEEK_SET);
+  return total;
+}
+
+int64_t ctOS::File::ReadAt(const ctFileHandle &handle, const int64_t &offset, void *pDst, const int64_t &size)
+{
+  int64_t bytesRead = 0;
+  if (handle == nullptr || pDst == nullptr || offset < 0)
+    return -1;
+
+  while (bytesRead < size)
+  {
+    ssize_t res = pread(_Descriptor(handle), (uint8_t*)pDst + bytesRead, (size_t)(size - bytesRead), (off_t)(offset + bytesRead));
+    if (res < 0 && errno == EINTR)
+      continue;
+    if (res < 0)
+      return -1;
+    if (res == 0)
+      break; // End of file
+    bytesRead += res;
+  }
+
+  return bytesRead;
+}
+
+int64_t ctOS::File::WriteAt(const ctFileHandle &handle, const int64_t &offset, const void *pSrc, const int64_t &size)
+{
+  int64_t bytesWritten = 0;
+  if (handle == nullptr || pSrc == nullptr || offset < 0)
+    return -1;
+
+  while (bytesWritten < size)
+  {
+    ssize_t res = pwrite(_Descriptor(handle), (const uint8_t*)pSrc + bytesWritten, (size_t)(size - bytesWritten), (off_t)(offset + bytesWritten));
+    if (res < 0 && errno == EINTR)
+      continue;
+    if (res <= 0)
+      return -1;
+    bytesWritten += res;
+  }
+
+  return bytesWritten;
+}
+
+intptr_t ctOS::File::Descriptor(const ctFileHandle &handle)
+{
+  return handle ? (intptr_t)_Descriptor(handle) : -1;
+}
+
+bool ctOS::File::Advise(const ctFileHandle &handle, const ctFileAdvice &advice, const int64_t &offset, const int64_t &size)
+{
+  if (!handle)
+    return false;
+
+  int sysAdvice = POSIX_FADV_NORMAL;
+  switch (advice)
+  {
+  case atFA_Normal:     sysAdvice = POSIX_FADV_NORMAL; break;
+  case atFA_Sequential: sysAdvice = POSIX_FADV_SEQUENTIAL; break;
+  case atFA_Random:     sysAdvice = POSIX_FADV_RANDOM; break;
+  case atFA_WillNeed:   sysAdvice = POSIX_FADV_WILLNEED; break;
+  case atFA_DontNeed:   sysAdvice = POSIX_FADV_DONTNEED; break;
+  default:
+    return false;
+  }
+
+  // A length of 0 covers the rest of the file
+  return posix_fadvise(_Descriptor(handle), (off_t)offset, (off_t)ctMax(size, (int64_t)0), sysAdvice) == 0;
+}
+
+bool ctOS::File::Allocate(const ctFileHandle &handle, const int64_t &offset, const int64_t &size)
+{
+  if (!handle || offset < 0 || size <= 0)
+    return false;
+
+  // Reserve the blocks without changing the file size. Not every file system supports this.
+  int res = 0;
+  do
+  {
+    res = fallocate(_Descriptor(handle), FALLOC_FL_KEEP_SIZE, (off_t)offset, (off_t)size);
+  } while (res != 0 && errno == EINTR);
+  return res == 0;
 }
 
 bool ctOS::File::Exists(const char *path)
@@ -72,6 +282,160 @@ bool ctOS::File::Exists(const char *path)
   return access(path, F_OK) != -1;
 }
 
+// Chunk size used between progress callbacks. Without a callback each call copies as much as the kernel allows
+static const int64_t _copyChunkSize = 16 * 1024 * 1024;
+static const int64_t _copyBufferSize = 1024 * 1024;
+
+enum _CopyMethod
+{
+  _CM_CopyFileRange,
+  _CM_SendFile,
+  _CM_Buffer,
+};
+
+static int64_t _CopyChunk(const _CopyMethod method, int srcFd, int dstFd, const size_t size, ctVector<uint8_t> *pBuffer)
+{
+  switch (method)
+  {
+  case _CM_CopyFileRange: return copy_file_range(srcFd, nullptr, dstFd, nullptr, size, 0);
+  case _CM_SendFile:      return sendfile(dstFd, srcFd, nullptr, size);
+  default: break;
+  }
+
+  if (pBuffer->size() == 0)
+    pBuffer->resize(_copyBufferSize);
+
+  ssize_t bytesRead = read(srcFd, pBuffer->data(), ctMin(size, (size_t)pBuffer->size()));
+  if (bytesRead <= 0)
+    return bytesRead;
+
+  for (ssize_t written = 0; written < bytesRead;)
+  {
+    ssize_t res = write(dstFd, pBuffer->data() + written, bytesRead - written);
+    if (res < 0 && errno != EINTR)
+      return -1;
+    written += ctMax(res, (ssize_t)0);
+  }
+  return bytesRead;
+}
+
+// Copy the contents of srcFd to dstFd from their current positions.
+// Tries the cheapest method first and falls back when the file systems do not support it.
+static bool _CopyData(int srcFd, int dstFd, const int64_t size, const ctOS::File::CopyProgress &progress)
+{
+#ifdef FICLONE
+  // Share the source extents if the file system supports reflinks (btrfs, xfs)
+  if (size > 0 && ioctl(dstFd, FICLONE, srcFd) == 0)
+    return !progress || progress(size, size);
+#endif
+
+  // Pseudo files report a size of 0 but may still have content, so only a plain read will do
+  _CopyMethod method = size > 0 ? _CM_CopyFileRange : _CM_Buffer;
+  if (method == _CM_Buffer)
+    posix_fadvise(srcFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  const size_t chunkSize = progress ? (size_t)_copyChunkSize : (size_t)INT_MAX;
+  ctVector<uint8_t> buffer;
+  int64_t copied = 0;
+  while (true)
+  {
+    int64_t res = _CopyChunk(method, srcFd, dstFd, chunkSize, &buffer);
+    if (res == 0 && (copied >= size || method == _CM_Buffer))
+      break;
+
+    if (res <= 0)
+    {
+      if (res < 0 && errno == EINTR)
+        continue;
+
+      // Unsupported by the file systems involved, or the kernel stopped early. Both descriptors
+      // have been advanced past the data copied so far, so the next method carries on from there.
+      if (method == _CM_Buffer || (res < 0 && errno != EXDEV && errno != EINVAL && errno != ENOSYS && errno != EOPNOTSUPP))
+        return false;
+
+      method = (_CopyMethod)(method + 1);
+      if (method == _CM_Buffer)
+        posix_fadvise(srcFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+      continue;
+    }
+
+    copied += res;
+    if (progress && !progress(copied, ctMax(size, copied)))
+      return false;
+  }
+
+  return true;
+}
+
+bool ctOS::File::Copy(const char *src, const char *dst, bool overwrite, const CopyProgress &progress)
+{
+  int srcFd = open(src, O_RDONLY | O_CLOEXEC);
+  if (srcFd < 0)
+    return false;
+
+  struct stat srcStat;
+  if (fstat(srcFd, &srcStat) != 0 || !S_ISREG(srcStat.st_mode))
+  {
+    close(srcFd);
+    return false;
+  }
+
+  // Truncate after opening so copying a file onto itself does not destroy it
+  int dstFd = open(dst, O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? 0 : O_EXCL), srcStat.st_mode & 0777);
+  if (dstFd < 0)
+  {
+    close(srcFd);
+    return false;
+  }
+
+  struct stat dstStat;
+  bool success = fstat(dstFd, &dstStat) == 0
+    && (dstStat.st_dev != srcStat.st_dev || dstStat.st_ino != srcStat.st_ino)
+    && ftruncate(dstFd, 0) == 0;
+  bool truncated = success;
+
+  if (success)
+  {
+    success = _CopyData(srcFd, dstFd, srcStat.st_size, progress);
+
+    // Keep the permissions and modification time, as CopyFile does on Windows
+    if (success)
+    {
+      timespec times[2] = { srcStat.st_atim, srcStat.st_mtim };
+      fchmod(dstFd, srcStat.st_mode & 07777);
+      futimens(dstFd, times);
+    }
+  }
+
+  close(srcFd);
+  success &= close(dstFd) == 0;
+
+  if (!success && truncated)
+    unlink(dst);
+  return success;
+}
+
+bool ctOS::File::Move(const char *src, const char *dst, const CopyProgress &progress)
+{
+  if (Exists(dst))
+    return false;
+
+  if (rename(src, dst) == 0)
+    return true;
+
+  if (errno != EXDEV)
+    return false;
+
+  if (!Copy(src, dst, false, progress))
+    return false;
+
+  if (unlink(src) == 0)
+    return true;
+
+  unlink(dst);
+  return false;
+}
+
 bool ctOS::File::EndOfFile(const ctFileHandle &handle)
 {
   return feof((FILE*)handle) != 0;
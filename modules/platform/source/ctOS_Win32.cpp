@@ -2,6 +2,7 @@
 
 #ifdef ctPLATFORM_WIN32
 #include <windows.h>
+#include <io.h>
 
 ctFileHandle ctOS::File::Open(const char *path, const ctFileMode &mode)
 {
@@ -37,8 +38,9 @@ bool ctOS::File::Seek(const ctFileHandle &handle, const int64_t &loc, const ctSe
     return false;
   }
 
-  fseek((FILE*)handle, (long)loc, (int)sysOrigin);
-  
+  if (_fseeki64((FILE*)handle, loc, (int)sysOrigin) != 0)
+    return false;
+
   if (pNewPosition)
     *pNewPosition = Tell(handle);
 
@@ -47,7 +49,7 @@ bool ctOS::File::Seek(const ctFileHandle &handle, const int64_t &loc, const ctSe
 
 int64_t ctOS::File::Tell(const ctFileHandle &handle)
 {
-  return ftell((FILE*)handle);
+  return _ftelli64((FILE*)handle);
 }
 
 int64_t ctOS::File::Read(const ctFileHandle &handle, void *pDst, const int64_t &size)
@@ -63,6 +65,112 @@ int64_t ctOS::File::Write(const ctFileHandle &handle, const void *pSrc, const in
   return fwrite(pSrc, 1, size, (FILE*)handle);
 }
 
+int64_t ctOS::File::ReadV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    int64_t bytesRead = Read(handle, pSlices[i].pData, pSlices[i].size);
+    total += bytesRead;
+    if (bytesRead != pSlices[i].size)
+      break;
+  }
+  return total;
+}
+
+int64_t ctOS::File::WriteV(const ctFileHandle &handle, const ctIOSlice *pSlices, const int64_t &count)
+{
+  int64_t total = 0;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    int64_t bytesWritten = Write(handle, pSlices[i].pData, pSlices[i].size);
+    total += bytesWritten;
+    if (bytesWritten != pSlices[i].size)
+      break;
+  }
+  return total;
+}
+
+// The CRT stream shares its file pointer with the OS handle, so positional
+// reads save and restore the stream position while holding the stream lock.
+int64_t ctOS::File::ReadAt(const ctFileHandle &handle, const int64_t &offset, void *pDst, const int64_t &size)
+{
+  if (handle == nullptr || pDst == nullptr || offset < 0)
+    return -1;
+  if (size <= 0)
+    return 0;
+
+  FILE *pFile = (FILE*)handle;
+  _lock_file(pFile);
+  int64_t pos = _ftelli64_nolock(pFile);
+  int64_t bytesRead = -1;
+  if (_fseeki64_nolock(pFile, offset, SEEK_SET) == 0)
+  {
+    bytesRead = _fread_nolock(pDst, 1, (size_t)size, pFile);
+    if (bytesRead < size && ferror(pFile))
+    { // A short read that is not the end of the file
+      clearerr(pFile);
+      bytesRead = -1;
+    }
+  }
+  _fseeki64_nolock(pFile, pos, SEEK_SET);
+  _unlock_file(pFile);
+  return bytesRead;
+}
+
+int64_t ctOS::File::WriteAt(const ctFileHandle &handle, const int64_t &offset, const void *pSrc, const int64_t &size)
+{
+  if (handle == nullptr || pSrc == nullptr || offset < 0)
+    return -1;
+  if (size <= 0)
+    return 0;
+
+  FILE *pFile = (FILE*)handle;
+  _lock_file(pFile);
+  int64_t pos = _ftelli64_nolock(pFile);
+  int64_t bytesWritten = -1;
+  if (_fseeki64_nolock(pFile, offset, SEEK_SET) == 0)
+  {
+    bytesWritten = _fwrite_nolock(pSrc, 1, (size_t)size, pFile);
+    if (bytesWritten < size)
+    {
+      clearerr(pFile);
+      bytesWritten = -1;
+    }
+  }
+  _fseeki64_nolock(pFile, pos, SEEK_SET);
+  _unlock_file(pFile);
+  return bytesWritten;
+}
+
+intptr_t ctOS::File::Descriptor(const ctFileHandle &handle)
+{
+  return handle ? _get_osfhandle(_fileno((FILE*)handle)) : (intptr_t)INVALID_HANDLE_VALUE;
+}
+
+bool ctOS::File::Advise(const ctFileHandle &handle, const ctFileAdvice &advice, const int64_t &offset, const int64_t &size)
+{
+  // Windows only takes access hints when a file is opened
+  (void)advice; (void)offset; (void)size;
+  return handle != nullptr;
+}
+
+bool ctOS::File::Allocate(const ctFileHandle &handle, const int64_t &offset, const int64_t &size)
+{
+  if (!handle || offset < 0 || size <= 0)
+    return false;
+
+  HANDLE hFile = (HANDLE)_get_osfhandle(_fileno((FILE*)handle));
+  LARGE_INTEGER fileSize;
+  if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &fileSize))
+    return false;
+
+  // Only grow the allocation, the file size is left unchanged
+  FILE_ALLOCATION_INFO info;
+  info.AllocationSize.QuadPart = ctMax(fileSize.QuadPart, offset + size);
+  return SetFileInformationByHandle(hFile, FileAllocationInfo, &info, sizeof(info)) != 0;
+}
+
 bool ctOS::File::Exists(const char *path)
 {
   bool invalid = GetFileAttributesA(path) == INVALID_FILE_ATTRIBUTES;
@@ -73,14 +181,24 @@ bool ctOS::File::Exists(const char *path)
     errorCode == ERROR_BAD_PATHNAME || errorCode == ERROR_BAD_NETPATH));
 }
 
-bool ctOS::File::Copy(const char *src, const char *dst, bool overwrite)
+static DWORD CALLBACK _CopyProgressRoutine(LARGE_INTEGER total, LARGE_INTEGER copied, LARGE_INTEGER, LARGE_INTEGER, DWORD, DWORD, HANDLE, HANDLE, LPVOID pUserData)
+{
+  const ctOS::File::CopyProgress &progress = *(const ctOS::File::CopyProgress*)pUserData;
+  return progress(copied.QuadPart, total.QuadPart) ? PROGRESS_CONTINUE : PROGRESS_CANCEL;
+}
+
+bool ctOS::File::Copy(const char *src, const char *dst, bool overwrite, const CopyProgress &progress)
 {
-  return CopyFile(src, dst, !overwrite) != 0;
+  if (!progress)
+    return CopyFile(src, dst, !overwrite) != 0;
+  return CopyFileExA(src, dst, _CopyProgressRoutine, (LPVOID)&progress, nullptr, overwrite ? 0 : COPY_FILE_FAIL_IF_EXISTS) != 0;
 }
 
-bool ctOS::File::Move(const char *src, const char *dst)
+bool ctOS::File::Move(const char *src, const char *dst, const CopyProgress &progress)
 {
-  return MoveFile(src, dst) != 0;
+  if (!progress)
+    return MoveFileExA(src, dst, MOVEFILE_COPY_ALLOWED) != 0;
+  return MoveFileWithProgressA(src, dst, _CopyProgressRoutine, (LPVOID)&progress, MOVEFILE_COPY_ALLOWED) != 0;
 }
 
 bool ctOS::File::EndOfFile(const ctFileHandle &handle)
@@ -4,7 +4,7 @@
 #include <dlfcn.h>
 
 ctSharedLib::ctSharedLib(const ctFilename &path)
-  : m_module(ctNew(Module)(path))
+  : m_module(ctMakePtr<Module>(path))
 {}
 
 bool ctSharedLib::HasFunction(const ctString &name) { return m_module && m_module->GetFunction(name) != nullptr; }
@@ -21,7 +21,8 @@ ctSharedLib::Module::Module(const ctFilename &path)
 
 ctSharedLib::Module::~Module()
 {
-  dlclose(pHandle);
+  if (pHandle)
+    dlclose(pHandle);
 }
 
 ctSharedLib::NullFunc ctSharedLib::Module::GetFunction(const ctString &name)
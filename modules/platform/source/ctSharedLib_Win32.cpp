@@ -4,7 +4,7 @@
 #include <Windows.h>
 
 ctSharedLib::ctSharedLib(const ctFilename &path)
-  : m_module(ctNew(Module)(path))
+  : m_module(ctMakePtr<Module>(path))
 {}
 
 bool ctSharedLib::HasFunction(const ctString &name) { return m_module && m_module->GetFunction(name) != nullptr; }
@@ -19,7 +19,11 @@ ctSharedLib::Module::Module(const ctFilename &path)
   pHandle = LoadLibrary(path.Path().replace('/', '\\'));
 }
 
-ctSharedLib::Module::~Module() { FreeLibrary((HMODULE)pHandle); }
+ctSharedLib::Module::~Module()
+{
+  if (pHandle)
+    FreeLibrary((HMODULE)pHandle);
+}
 
 ctSharedLib::NullFunc ctSharedLib::Module::GetFunction(const ctString &name)
 {
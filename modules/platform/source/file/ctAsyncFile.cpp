@@ -0,0 +1,185 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctAsyncFile.h"
+#include "ctJobSystem.h"
+
+// State for a whole file read, owned by its request until the read completes
+struct _ctAsyncFileRead
+{
+  ctFile file;
+  ctVector<uint8_t> data;
+  ctPromise<ctVector<uint8_t>> promise;
+};
+
+ctAsyncFile* ctAsyncFile::Global()
+{
+  static ctAsyncFile asyncFile;
+  return &asyncFile;
+}
+
+bool ctAsyncFile::Submit(const ctVector<Request> &requests) { return Submit(requests.data(), requests.size()); }
+
+ctFuture<int64_t> ctAsyncFile::Read(const ctFile &file, const int64_t offset, void *pBuffer, const int64_t size)
+{
+  ctPromise<int64_t> promise;
+  Request request;
+  request.op = AO_Read;
+  request.pFile = &file;
+  request.offset = offset;
+  request.pData = pBuffer;
+  request.size = size;
+  request.callback = [promise](int64_t result) mutable {
+    if (result < 0)
+      promise.SetFailed();
+    else
+      promise.SetValue(result);
+  };
+
+  if (!Submit(&request, 1))
+    promise.SetFailed();
+  return promise.Future();
+}
+
+ctFuture<int64_t> ctAsyncFile::Write(ctFile &file, const int64_t offset, const void *pData, const int64_t size)
+{
+  ctPromise<int64_t> promise;
+  Request request;
+  request.op = AO_Write;
+  request.pFile = &file;
+  request.offset = offset;
+  request.pData = (void*)pData;
+  request.size = size;
+  request.callback = [promise](int64_t result) mutable {
+    if (result < 0)
+      promise.SetFailed();
+    else
+      promise.SetValue(result);
+  };
+
+  if (!Submit(&request, 1))
+    promise.SetFailed();
+  return promise.Future();
+}
+
+ctFuture<ctVector<uint8_t>> ctAsyncFile::ReadFile(const ctFilename &filename) { return ReadFiles({ filename })[0]; }
+
+ctVector<ctFuture<ctVector<uint8_t>>> ctAsyncFile::ReadFiles(const ctVector<ctFilename> &filenames)
+{
+  ctVector<ctFuture<ctVector<uint8_t>>> futures;
+  ctVector<Request> requests;
+  futures.reserve(filenames.size());
+
+  auto submitBatch = [this, &requests]() {
+    if (!Submit(requests))
+      for (Request &request : requests)
+        request.callback(-1);
+    requests.clear();
+  };
+
+  auto releaseFile = [this]() {
+    ctScopeLock lock(m_openLock);
+    --m_openFiles;
+    m_openReleased.notify_one();
+  };
+
+  for (const ctFilename &filename : filenames)
+  {
+    { // Wait for a completion to close a file if too many are open
+      std::unique_lock<std::mutex> lock(m_openLock);
+      if (m_openFiles >= ctASYNC_FILE_MAX_OPEN && requests.size() > 0)
+      {
+        lock.unlock();
+        submitBatch();
+        lock.lock();
+      }
+      m_openReleased.wait(lock, [this]() { return m_openFiles < ctASYNC_FILE_MAX_OPEN; });
+      ++m_openFiles;
+    }
+
+    _ctAsyncFileRead *pRead = ctNew(_ctAsyncFileRead);
+    futures.push_back(pRead->promise.Future());
+    if (!pRead->file.Open(filename, atFM_ReadBinary))
+    {
+      pRead->promise.SetFailed();
+      ctDelete(pRead);
+      releaseFile();
+      continue;
+    }
+
+    if (pRead->file.Info().Size() == 0)
+    {
+      pRead->promise.SetValue();
+      ctDelete(pRead);
+      releaseFile();
+      continue;
+    }
+
+    pRead->data.resize(pRead->file.Info().Size());
+
+    Request request;
+    request.op = AO_Read;
+    request.pFile = &pRead->file;
+    request.offset = 0;
+    request.pData = pRead->data.data();
+    request.size = pRead->data.size();
+    request.callback = [pRead, releaseFile](int64_t result) {
+      if (result == pRead->data.size())
+        pRead->promise.SetValue(std::move(pRead->data));
+      else
+        pRead->promise.SetFailed();
+      ctDelete(pRead); // Closes the file
+      releaseFile();
+    };
+    requests.push_back(std::move(request));
+  }
+
+  if (requests.size() > 0)
+    submitBatch();
+  return futures;
+}
+
+bool ctAsyncFile::IsValid(const Request &request)
+{
+  if (request.pFile == nullptr || !request.pFile->IsOpen() || request.offset < 0 || request.size < 0 || (request.pData == nullptr && request.size > 0))
+    return false;
+
+  int64_t mode = request.pFile->GetMode();
+  return request.op == AO_Read ? (mode & atFM_Read) != 0 : (mode & (atFM_Write | atFM_Append)) != 0;
+}
+
+void ctAsyncFile::SubmitToPool(const Request *pRequests, const int64_t count)
+{
+  for (int64_t i = 0; i < count; ++i)
+  {
+    m_pPool->Run([request = pRequests[i]]() {
+      // ReadAt/WriteAt return -1 on error, so errors are not reported as short transfers
+      int64_t result = request.op == AO_Read
+        ? request.pFile->ReadAt(request.offset, request.pData, request.size)
+        : const_cast<ctFile*>(request.pFile)->WriteAt(request.offset, request.pData, request.size);
+      if (request.callback)
+        request.callback(result);
+    });
+  }
+}
@@ -0,0 +1,347 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctAsyncFile.h"
+
+#ifdef ctPLATFORM_LINUX
+#include "ctJobSystem.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#include <condition_variable>
+#include <thread>
+
+static const uint32_t _ringEntries = 256;
+
+// A minimal io_uring driven through the raw system calls. One thread submits at a
+// time, and a completion thread reaps results and calls the request callbacks.
+class ctAsyncFile::Context
+{
+public:
+  struct Operation
+  {
+    Request request;
+    int fd = -1;
+    int64_t done = 0;
+    iovec iov;
+  };
+
+  Context() : inFlight(0), stop(false) {}
+
+  ~Context()
+  {
+    if (thread.joinable())
+    {
+      { // Wait for submitted requests, then wake the completion thread with a no-op
+        std::unique_lock<std::mutex> lock(submitLock);
+        idle.wait(lock, [this]() { return inFlight == 0; });
+        stop = true;
+        Push(IORING_OP_NOP, -1, 0, nullptr, 0);
+        Enter(1, 0, 0);
+      }
+      thread.join();
+    }
+
+    if (pSqes != nullptr) munmap(pSqes, sqesSize);
+    if (pCqRing != nullptr && pCqRing != pSqRing) munmap(pCqRing, cqRingSize);
+    if (pSqRing != nullptr) munmap(pSqRing, sqRingSize);
+    if (ringFd >= 0) close(ringFd);
+  }
+
+  // Returns false if io_uring is not available, e.g. on an old kernel or when it is blocked by a sandbox
+  bool Init()
+  {
+    io_uring_params params = { 0 };
+    ringFd = (int)syscall(__NR_io_uring_setup, _ringEntries, &params);
+    if (ringFd < 0)
+      return false;
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+      sqRingSize = cqRingSize = ctMax(sqRingSize, cqRingSize);
+
+    pSqRing = Map(sqRingSize, IORING_OFF_SQ_RING);
+    pCqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? pSqRing : Map(cqRingSize, IORING_OFF_CQ_RING);
+    pSqes = (io_uring_sqe*)Map(sqesSize, IORING_OFF_SQES);
+    if (pSqRing == nullptr || pCqRing == nullptr || pSqes == nullptr)
+      return false;
+
+    pSqHead = (uint32_t*)(pSqRing + params.sq_off.head);
+    pSqTail = (uint32_t*)(pSqRing + params.sq_off.tail);
+    sqMask = *(uint32_t*)(pSqRing + params.sq_off.ring_mask);
+    pSqArray = (uint32_t*)(pSqRing + params.sq_off.array);
+    sqEntries = params.sq_entries;
+
+    pCqHead = (uint32_t*)(pCqRing + params.cq_off.head);
+    pCqTail = (uint32_t*)(pCqRing + params.cq_off.tail);
+    cqMask = *(uint32_t*)(pCqRing + params.cq_off.ring_mask);
+    pCqes = (io_uring_cqe*)(pCqRing + params.cq_off.cqes);
+
+    // Never have more requests in flight than fit in the completion queue
+    maxInFlight = params.cq_entries;
+
+    thread = std::thread(&Context::Run, this);
+    return true;
+  }
+
+  void Submit(const Request *pRequests, const int64_t count)
+  {
+    std::unique_lock<std::mutex> lock(submitLock);
+    for (int64_t i = 0; i < count; ++i)
+    {
+      if (inFlight >= maxInFlight)
+      {
+        Flush();
+        lock.unlock();
+        CompleteFailed();
+        lock.lock();
+        idle.wait(lock, [this]() { return inFlight < maxInFlight; });
+      }
+
+      Operation *pOp = ctNew(Operation);
+      pOp->request = pRequests[i];
+      pOp->fd = (int)ctOS::File::Descriptor(pOp->request.pFile->Handle());
+      Queue(pOp);
+
+      // Publishes the operation to the completion thread. It is not handed to the kernel until the next Flush().
+      ++inFlight;
+    }
+    Flush();
+    lock.unlock();
+    CompleteFailed();
+  }
+
+protected:
+  uint8_t* Map(const int64_t size, const int64_t offset)
+  {
+    void *pMem = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, (off_t)offset);
+    return pMem == MAP_FAILED ? nullptr : (uint8_t*)pMem;
+  }
+
+  int Enter(const uint32_t toSubmit, const uint32_t minComplete, const uint32_t flags)
+  {
+    return (int)syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0);
+  }
+
+  // Add an entry to the submission queue. submitLock must be held.
+  void Push(const uint8_t opcode, const int fd, const int64_t offset, Operation *pOp, const uint32_t len)
+  {
+    if (pending == sqEntries)
+      Flush();
+
+    uint32_t tail = *pSqTail;
+    uint32_t index = tail & sqMask;
+    io_uring_sqe *pSqe = pSqes + index;
+    memset(pSqe, 0, sizeof(io_uring_sqe));
+    pSqe->opcode = opcode;
+    pSqe->fd = fd;
+    pSqe->off = (uint64_t)offset;
+    pSqe->addr = pOp ? (uint64_t)&pOp->iov : 0;
+    pSqe->len = len;
+    pSqe->user_data = (uint64_t)pOp;
+    pSqArray[index] = index;
+    __atomic_store_n(pSqTail, tail + 1, __ATOMIC_RELEASE);
+    ++pending;
+  }
+
+  // Queue the remaining part of an operation. submitLock must be held.
+  void Queue(Operation *pOp)
+  {
+    pOp->iov.iov_base = (uint8_t*)pOp->request.pData + pOp->done;
+    pOp->iov.iov_len = (size_t)(pOp->request.size - pOp->done);
+    Push(pOp->request.op == AO_Read ? IORING_OP_READV : IORING_OP_WRITEV, pOp->fd, pOp->request.offset + pOp->done, pOp, 1);
+  }
+
+  // Hand queued entries to the kernel. submitLock must be held.
+  // Entries the kernel refuses are taken back out of the ring and added to 'failed'.
+  void Flush()
+  {
+    while (pending > 0)
+    {
+      int submitted = Enter(pending, 0, 0);
+      if (submitted >= 0)
+      {
+        pending -= (uint32_t)submitted;
+        continue;
+      }
+
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+        continue;
+
+      // The kernel only reads the queue during Enter(), so unconsumed entries can be removed
+      uint32_t head = __atomic_load_n(pSqHead, __ATOMIC_ACQUIRE);
+      for (uint32_t i = head; i != *pSqTail; ++i)
+      {
+        Operation *pOp = (Operation*)pSqes[pSqArray[i & sqMask]].user_data;
+        if (pOp != nullptr)
+          failed.push_back(pOp);
+      }
+      __atomic_store_n(pSqTail, head, __ATOMIC_RELEASE);
+      pending = 0;
+    }
+  }
+
+  // Fail the operations that could not be submitted. submitLock must not be held.
+  void CompleteFailed()
+  {
+    ctVector<Operation*> ops;
+    {
+      ctScopeLock lock(submitLock);
+      std::swap(ops, failed);
+    }
+
+    for (Operation *pOp : ops)
+    {
+      if (pOp->request.callback)
+        pOp->request.callback(-1);
+      ctDelete(pOp);
+
+      ctScopeLock lock(submitLock);
+      --inFlight;
+      idle.notify_all();
+    }
+  }
+
+  void Run()
+  {
+    while (true)
+    {
+      uint32_t head = *pCqHead;
+      uint32_t tail = __atomic_load_n(pCqTail, __ATOMIC_ACQUIRE);
+      if (head == tail)
+      {
+        if (stop && inFlight == 0)
+          break;
+        Enter(0, 1, IORING_ENTER_GETEVENTS);
+        continue;
+      }
+
+      for (; head != tail; ++head)
+      {
+        const io_uring_cqe &cqe = pCqes[head & cqMask];
+        Complete((Operation*)cqe.user_data, cqe.res);
+      }
+      __atomic_store_n(pCqHead, head, __ATOMIC_RELEASE);
+    }
+  }
+
+  void Complete(Operation *pOp, const int32_t result)
+  {
+    if (pOp == nullptr)
+      return; // Wake up no-op
+
+    // Pairs with the increment in Submit(). The kernel orders the hand off, but make it explicit.
+    inFlight.load(std::memory_order_acquire);
+
+    if (result == -EINTR || result == -EAGAIN || (result > 0 && pOp->done + result < pOp->request.size))
+    { // Short transfer, submit the rest
+      pOp->done += ctMax(result, 0);
+      {
+        ctScopeLock lock(submitLock);
+        Queue(pOp);
+        Flush();
+      }
+      CompleteFailed();
+      return;
+    }
+
+    int64_t transferred = result < 0 ? -1 : pOp->done + result;
+    if (pOp->request.callback)
+      pOp->request.callback(transferred);
+    ctDelete(pOp);
+
+    ctScopeLock lock(submitLock);
+    --inFlight;
+    idle.notify_all();
+  }
+
+  int ringFd = -1;
+  uint8_t *pSqRing = nullptr;
+  uint8_t *pCqRing = nullptr;
+  io_uring_sqe *pSqes = nullptr;
+  int64_t sqRingSize = 0;
+  int64_t cqRingSize = 0;
+  int64_t sqesSize = 0;
+
+  uint32_t *pSqHead = nullptr;
+  uint32_t *pSqTail = nullptr;
+  uint32_t *pSqArray = nullptr;
+  uint32_t sqMask = 0;
+  uint32_t sqEntries = 0;
+  uint32_t *pCqHead = nullptr;
+  uint32_t *pCqTail = nullptr;
+  uint32_t cqMask = 0;
+  io_uring_cqe *pCqes = nullptr;
+
+  std::mutex submitLock;
+  std::condition_variable idle;
+  uint32_t pending = 0;
+  ctVector<Operation*> failed; // Refused by the kernel, see CompleteFailed()
+  std::atomic<int64_t> inFlight;
+  int64_t maxInFlight = 0;
+  std::atomic<bool> stop;
+  std::thread thread;
+};
+
+ctAsyncFile::ctAsyncFile(const int64_t threadCount)
+{
+  m_pContext = ctNew(Context);
+  if (!m_pContext->Init())
+  {
+    ctDelete(m_pContext);
+    m_pContext = nullptr;
+    m_pPool = ctNew(ctJobSystem)(ctMax(threadCount, (int64_t)1));
+  }
+}
+
+ctAsyncFile::~ctAsyncFile()
+{
+  if (m_pContext)
+    ctDelete(m_pContext);
+  if (m_pPool)
+    ctDelete(m_pPool);
+}
+
+bool ctAsyncFile::Submit(const Request *pRequests, const int64_t count)
+{
+  for (int64_t i = 0; i < count; ++i)
+    if (!IsValid(pRequests[i]))
+      return false;
+
+  if (m_pContext)
+    m_pContext->Submit(pRequests, count);
+  else
+    SubmitToPool(pRequests, count);
+  return true;
+}
+
+bool ctAsyncFile::IsNative() const { return m_pContext != nullptr; }
+
+#endif
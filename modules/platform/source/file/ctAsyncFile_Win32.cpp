@@ -0,0 +1,48 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctAsyncFile.h"
+
+#ifdef ctPLATFORM_WIN32
+#include "ctJobSystem.h"
+
+// Requests always run on the thread pool on Windows
+class ctAsyncFile::Context {};
+
+ctAsyncFile::ctAsyncFile(const int64_t threadCount) { m_pPool = ctNew(ctJobSystem)(ctMax(threadCount, (int64_t)1)); }
+ctAsyncFile::~ctAsyncFile() { ctDelete(m_pPool); }
+
+bool ctAsyncFile::Submit(const Request *pRequests, const int64_t count)
+{
+  for (int64_t i = 0; i < count; ++i)
+    if (!IsValid(pRequests[i]))
+      return false;
+
+  SubmitToPool(pRequests, count);
+  return true;
+}
+
+bool ctAsyncFile::IsNative() const { return false; }
+
+#endif
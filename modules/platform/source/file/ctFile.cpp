@@ -26,6 +26,8 @@
 #include "ctOS.h"
 #include "file/ctFile.h"
 #include "file/ctFileSystem.h"
+#include "ctParallel.h"
+#include "ctThreading.h"
 
 ctFile::ctFile() : m_handle(nullptr) { Close(); }
 ctFile::ctFile(const ctFilename &file, const ctFileMode mode) : m_handle(nullptr), m_mode(atFM_None) { Open(file, mode); }
@@ -99,6 +101,13 @@ int64_t ctFile::Write(const void *pData, const int64_t len)
   return amountWritten;
 }
 
+int64_t ctFile::WriteV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t amountWritten = ctOS::File::WriteV(m_handle, pSlices, count);
+  m_pos += amountWritten;
+  return amountWritten;
+}
+
 ctString ctFile::ReadText(bool *pResult)
 {
   if (pResult)
@@ -144,6 +153,34 @@ ctVector<uint8_t> ctFile::ReadFile(const ctFilename &filename, bool *pResult)
   return data;
 }
 
+ctFuture<ctString> ctFile::ReadTextAsync(const ctFilename &filename, ctJobSystem *pJobs)
+{
+  ctPromise<ctString> promise;
+  (pJobs ? pJobs : ctJobSystem::Global())->Run([=]() mutable {
+    bool result = false;
+    ctString text = ReadText(filename, &result);
+    if (result)
+      promise.SetValue(std::move(text));
+    else
+      promise.SetFailed();
+  });
+  return promise.Future();
+}
+
+ctFuture<ctVector<uint8_t>> ctFile::ReadFileAsync(const ctFilename &filename, ctJobSystem *pJobs)
+{
+  ctPromise<ctVector<uint8_t>> promise;
+  (pJobs ? pJobs : ctJobSystem::Global())->Run([=]() mutable {
+    bool result = false;
+    ctVector<uint8_t> data = ReadFile(filename, &result);
+    if (result)
+      promise.SetValue(std::move(data));
+    else
+      promise.SetFailed();
+  });
+  return promise.Future();
+}
+
 int64_t ctFile::WriteFile(const ctFilename &filename, const void *pData, const int64_t &len)
 {
   ctFile output;
@@ -169,6 +206,33 @@ int64_t ctFile::Read(void *pBuffer, const int64_t size)
   return amountRead;
 }
 
+int64_t ctFile::ReadV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t amountRead = ctOS::File::ReadV(m_handle, pSlices, count);
+  m_pos += amountRead;
+  return amountRead;
+}
+
+int64_t ctFile::ReadAt(const int64_t offset, void *pBuffer, const int64_t size) const
+{
+  return ctOS::File::ReadAt(m_handle, offset, pBuffer, size);
+}
+
+int64_t ctFile::WriteAt(const int64_t offset, const void *pData, const int64_t size)
+{
+  return ctOS::File::WriteAt(m_handle, offset, pData, size);
+}
+
+bool ctFile::Advise(const ctFileAdvice advice, const int64_t offset, const int64_t size)
+{
+  return ctOS::File::Advise(m_handle, advice, offset, size);
+}
+
+bool ctFile::Reserve(const int64_t size)
+{
+  return ctOS::File::Allocate(m_handle, 0, size);
+}
+
 ctFilename ctFile::Find(const ctFilename &fn, bool *pResult)
 {
   if (pResult)
@@ -198,17 +262,63 @@ bool ctFile::Exists(const ctFilename &fn)
 int64_t ctFile::WriteText(const ctString &text) { return Write(text.c_str(), text.length()); }
 bool ctFile::Create(const ctFilename &fn) { return ctFile(fn, atFM_Append).IsOpen(); }
 
-bool ctFile::Copy(const ctFilename &src, const ctFilename &dst, bool overwrite)
+bool ctFile::Copy(const ctFilename &src, const ctFilename &dst, bool overwrite, const ctOS::File::CopyProgress &progress)
+{
+  return ctOS::File::Copy(src.c_str(), dst.c_str(), overwrite, progress);
+}
+
+bool ctFile::Move(const ctFilename &src, const ctFilename &dst, const ctOS::File::CopyProgress &progress)
 {
-  return ctOS::File::Copy(src.c_str(), dst.c_str(), overwrite);
+  return ctOS::File::Move(src.c_str(), dst.c_str(), progress);
 }
 
-bool ctFile::Move(const ctFilename &src, const ctFilename &dst)
+int64_t ctFile::CopyFiles(const ctVector<ctFilename> &src, const ctVector<ctFilename> &dst, bool overwrite, const ctOS::File::CopyProgress &progress, const bool parallel, ctJobSystem *pJobs)
 {
-  return ctOS::File::Move(src.c_str(), dst.c_str());
+  int64_t count = ctMin(src.size(), dst.size());
+  int64_t total = 0;
+  if (progress)
+    for (int64_t i = 0; i < count; ++i)
+      total += ctMax(ctFileInfo::Size(src[i]), (int64_t)0);
+
+  std::atomic<int64_t> copied(0);
+  std::atomic<int64_t> succeeded(0);
+  std::atomic<bool> cancelled(false);
+  std::mutex progressLock;
+
+  auto copyFile = [&](const int64_t i) {
+    if (cancelled.load(std::memory_order_relaxed))
+      return;
+
+    int64_t fileCopied = 0;
+    ctOS::File::CopyProgress fileProgress;
+    if (progress)
+    {
+      fileProgress = [&](int64_t bytes, int64_t) {
+        int64_t totalCopied = copied.fetch_add(bytes - fileCopied) + bytes - fileCopied;
+        fileCopied = bytes;
+
+        ctScopeLock lock(progressLock);
+        if (!cancelled && !progress(totalCopied, ctMax(total, totalCopied)))
+          cancelled = true;
+        return !cancelled;
+      };
+    }
+
+    if (Copy(src[i], dst[i], overwrite, fileProgress))
+      ++succeeded;
+  };
+
+  if (parallel)
+    ctParallelFor(0, count, 1, copyFile, pJobs);
+  else
+    for (int64_t i = 0; i < count; ++i)
+      copyFile(i);
+
+  return succeeded;
 }
 
 const ctFileInfo& ctFile::Info() const { return m_info; }
+ctFileHandle ctFile::Handle() const { return m_handle; }
 int64_t ctFile::GetMode() const { return m_mode; }
 bool ctFile::IsOpen() const { return m_handle && m_mode != atFM_None; }
 bool ctFile::Delete(const ctFilename &fn) { return remove(fn.Path().c_str()) == 0; }
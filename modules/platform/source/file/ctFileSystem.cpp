@@ -24,85 +24,229 @@
 // -----------------------------------------------------------------------------
 
 #include "file/ctFileSystem.h"
+#include "ctJobSystem.h"
+#include "ctThreading.h"
+#include <atomic>
 
-#ifdef ctPLATFORM_WIN32
-#include <direct.h>
-#include <shlobj.h>
+ctFileSystem::ctFileSystem() {}
+
+//***************
+// Glob matching
+//***************
 
-static bool _CreateFoldersRecursive(const ctString &done, const ctString &remaining)
+// Match one character against a set starting at *ppPattern ('['), advancing it past the closing ']'
+static bool _MatchSet(const char **ppPattern, const char c, bool *pMatched)
 {
-  if (remaining.length() == 0)
-    return true;
+  const char *pPattern = *ppPattern + 1;
+  bool negate = *pPattern == '!';
+  pPattern += negate;
+
+  bool matched = false;
+  for (bool first = true; *pPattern != ']' || first; first = false)
+  {
+    if (*pPattern == 0)
+      return false; // No closing bracket, '[' is a literal
+
+    char low = *pPattern++;
+    char high = low;
+    if (pPattern[0] == '-' && pPattern[1] != ']' && pPattern[1] != 0)
+    {
+      high = pPattern[1];
+      pPattern += 2;
+    }
+    matched |= c >= low && c <= high;
+  }
+
+  *ppPattern = pPattern;
+  *pMatched = matched != negate && c != '/';
+  return true;
+}
+
+static bool _MatchGlob(const char *pPattern, const char *pPath)
+{
+  while (*pPattern != 0)
+  {
+    if (pPattern[0] == '*' && pPattern[1] == '*')
+    {
+      pPattern += 2;
+
+      // "**/" can also match no folders at all
+      if (*pPattern == '/' && _MatchGlob(pPattern + 1, pPath))
+        return true;
+
+      for (;; ++pPath)
+      {
+        if (_MatchGlob(pPattern, pPath))
+          return true;
+        if (*pPath == 0)
+          return false;
+      }
+    }
+
+    if (*pPattern == '*')
+    {
+      ++pPattern;
+      for (;; ++pPath)
+      {
+        if (_MatchGlob(pPattern, pPath))
+          return true;
+        if (*pPath == 0 || *pPath == '/')
+          return false;
+      }
+    }
+
+    if (*pPath == 0)
+      return false;
+
+    bool matched = false;
+    if (*pPattern == '[' && _MatchSet(&pPattern, *pPath, &matched))
+    {
+      if (!matched)
+        return false;
+    }
+    else if (*pPattern == '?' ? *pPath == '/' : *pPattern != *pPath)
+    {
+      return false;
+    }
 
-  int64_t nextSlash = ctMax(remaining.find_first_of('/'));
-  ctString nextFolder = remaining.substr(0, nextSlash);
-  int64_t res = _mkdir(done + nextFolder);
-  if (res < 0 && errno != EEXIST && *(nextFolder.end() - 1) != ':')
-    return false;
+    ++pPattern;
+    ++pPath;
+  }
 
-  return nextSlash != -1 ? _CreateFoldersRecursive(done + nextFolder + "/", remaining.substr(nextSlash + 1, -1)) : true;
+  return *pPath == 0;
 }
 
-static ctFilename _GetSystemPath(const int &folderID)
+static bool _MatchAny(const ctVector<ctString> &patterns, const char *path)
 {
-  char buffer[MAX_PATH] = { 0 };
-  SHGetSpecialFolderPathA(0, buffer, folderID, false);
-  return buffer;
+  const char *name = strrchr(path, '/');
+  name = name ? name + 1 : path;
+  for (const ctString &pattern : patterns)
+    if (_MatchGlob(pattern.c_str(), pattern.find('/') == -1 ? name : path))
+      return true;
+  return false;
 }
 
-ctFileSystem::ctFileSystem() {}
-bool ctFileSystem::CreateFolders(const ctFilename &path) { return _CreateFoldersRecursive("", path.Path()); }
+bool ctFileSystem::MatchGlob(const ctString &pattern, const ctString &path)
+{
+  return _MatchAny({ pattern }, path.c_str());
+}
 
-static ctVector<ctFileSystem::FileInfo> _EnumerateFolder(const ctFilename &path, const bool &findFiles, const bool &findFolders)
+//*************
+// Enumeration
+//*************
+
+ctVector<ctFileSystem::FileInfo> ctFileSystem::EnumerateFiles(const ctFilename &path)
 {
-  ctVector<ctFileSystem::FileInfo> fileInfo;
+  ctVector<FileInfo> entries;
+  ReadFolder(path, true, false, true, &entries);
+  return entries;
+}
 
-  // Find the first file in the directory.
-  WIN32_FIND_DATA ffd;
-  LARGE_INTEGER filesize;
-  HANDLE hFind = FindFirstFile(path.Path().replace("/", "\\") + "\\*", &ffd);
+ctVector<ctFileSystem::FileInfo> ctFileSystem::EnumerateFolders(const ctFilename &path)
+{
+  ctVector<FileInfo> entries;
+  ReadFolder(path, false, true, true, &entries);
+  return entries;
+}
 
-  if (INVALID_HANDLE_VALUE == hFind)
-    return{};
+ctVector<ctFileSystem::FileInfo> ctFileSystem::Enumerate(const ctFilename &path)
+{
+  ctVector<FileInfo> entries;
+  ReadFolder(path, true, true, true, &entries);
+  return entries;
+}
 
-  // List all the files in the directory with some info about them.
+//*********
+// Walking
+//*********
 
-  do
+bool ctFileSystem::Walk(const ctFilename &path, const WalkCallback &callback, const WalkOptions &options)
+{
+  class Walker
   {
-    ctFileSystem::FileInfo newInfo;
-    newInfo.isFolder = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) > 0;
-    if ((newInfo.isFolder && findFolders) || (!newInfo.isFolder && findFiles))
+  public:
+    Walker(const ctFilename &root, const WalkCallback &callback, const WalkOptions &options)
+      : m_callback(callback)
+      , m_options(options)
+      , m_pJobs(options.parallel ? (options.pJobs ? options.pJobs : ctJobSystem::Global()) : nullptr)
+      , m_stopped(false)
+    {
+      // Patterns are matched against the path relative to the root
+      ctString rootPath = root.Path();
+      m_rootLength = rootPath.length() + (rootPath.length() > 0 && rootPath[rootPath.length() - 1] != '/');
+    }
+
+    bool Run(const ctFilename &root)
+    {
+      bool result = Search(root, 0);
+      if (m_pJobs)
+        m_pJobs->Wait(&m_pending);
+      return result && !m_stopped;
+    }
+
+  protected:
+    bool Search(const ctFilename &folder, const int64_t depth)
     {
-      if (!newInfo.isFolder)
+      ctVector<FileInfo> entries;
+      if (!ReadFolder(folder, m_options.files, true, m_options.fileSizes, &entries))
+        return false;
+
+      for (const FileInfo &entry : entries)
       {
-        filesize.LowPart = ffd.nFileSizeLow;
-        filesize.HighPart = ffd.nFileSizeHigh;
-        newInfo.size = filesize.QuadPart;
+        if (m_stopped.load(std::memory_order_relaxed))
+          return true;
+
+        const char *relative = entry.path.c_str() + m_rootLength;
+        if (m_options.exclude.size() > 0 && _MatchAny(m_options.exclude, relative))
+          continue;
+
+        bool report = entry.isFolder ? m_options.folders : m_options.files;
+        if (report && (m_options.include.size() == 0 || _MatchAny(m_options.include, relative)) && !m_callback(entry))
+        {
+          m_stopped = true;
+          return true;
+        }
+
+        if (!entry.isFolder || (entry.isLink && !m_options.followLinks) || (m_options.maxDepth >= 0 && depth >= m_options.maxDepth))
+          continue;
+
+        if (m_pJobs)
+        {
+          ctFilename subFolder = entry.path;
+          m_pJobs->Run([this, subFolder, depth]() { Search(subFolder, depth + 1); }, &m_pending);
+        }
+        else
+        {
+          Search(entry.path, depth + 1);
+        }
       }
 
-      newInfo.path = path.Path() + "/" + ffd.cFileName;
-      fileInfo.push_back(newInfo);
+      return true;
     }
-  } while (FindNextFile(hFind, &ffd) != 0);
 
-  FindClose(hFind);
-  return fileInfo;
+    const WalkCallback &m_callback;
+    const WalkOptions &m_options;
+    ctJobSystem *m_pJobs;
+    ctJobCounter m_pending;
+    std::atomic<bool> m_stopped;
+    int64_t m_rootLength;
+  };
+
+  Walker walker(path, callback, options);
+  return walker.Run(path);
 }
 
-ctVector<ctFileSystem::FileInfo> ctFileSystem::EnumerateFiles(const ctFilename &path) { return _EnumerateFolder(path, true, false); }
-ctVector<ctFileSystem::FileInfo> ctFileSystem::EnumerateFolders(const ctFilename &path) { return _EnumerateFolder(path, false, true); }
-ctVector<ctFileSystem::FileInfo> ctFileSystem::Enumerate(const ctFilename &path) { return _EnumerateFolder(path, true, true); }
-
-ctFilename ctFileSystem::GetDirectory_AppData() { return _GetSystemPath(CSIDL_APPDATA); }
-ctFilename ctFileSystem::GetDirectory_AppData_Local() { return _GetSystemPath(CSIDL_LOCAL_APPDATA); }
-ctFilename ctFileSystem::GetDirectory_Windows() { return _GetSystemPath(CSIDL_WINDOWS); }
-ctFilename ctFileSystem::GetDirectory_Desktop() { return _GetSystemPath(CSIDL_DESKTOP); }
-ctFilename ctFileSystem::GetDirectory_Documents() { return _GetSystemPath(CSIDL_MYDOCUMENTS); }
-ctFilename ctFileSystem::GetDirectory_Fonts() { return _GetSystemPath(CSIDL_FONTS); }
-ctFilename ctFileSystem::GetDirectory_History() { return _GetSystemPath(CSIDL_HISTORY); }
-ctFilename ctFileSystem::GetDirectory_Recents() { return _GetSystemPath(CSIDL_RECENT); }
-ctFilename ctFileSystem::GetDirectory_StartMenu() { return _GetSystemPath(CSIDL_STARTMENU); }
-ctFilename ctFileSystem::GetDirectory_ProgramFiles() { return _GetSystemPath(CSIDL_PROGRAM_FILES); }
-ctFilename ctFileSystem::GetDirectory_ProgramFiles86() { return _GetSystemPath(CSIDL_PROGRAM_FILESX86); }
-
-#endif
+bool ctFileSystem::Walk(const ctFilename &path, const WalkCallback &callback) { return Walk(path, callback, WalkOptions()); }
+ctVector<ctFileSystem::FileInfo> ctFileSystem::Walk(const ctFilename &path) { return Walk(path, WalkOptions()); }
+
+ctVector<ctFileSystem::FileInfo> ctFileSystem::Walk(const ctFilename &path, const WalkOptions &options)
+{
+  std::mutex lock;
+  ctVector<FileInfo> entries;
+  Walk(path, [&](const FileInfo &info) {
+    ctScopeLock guard(lock);
+    entries.push_back(info);
+    return true;
+  }, options);
+  return entries;
+}
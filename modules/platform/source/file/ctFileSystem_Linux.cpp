@@ -0,0 +1,138 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+
+#include "file/ctFileSystem.h"
+
+#ifdef ctPLATFORM_LINUX
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// The record returned by getdents64
+struct _ctDirent64
+{
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+static const int64_t _direntBufferSize = 32 * 1024;
+
+bool ctFileSystem::CreateFolders(const ctFilename &path)
+{
+  ctString folders = path.Path();
+  for (int64_t end = folders.find('/', 1); ; end = folders.find('/', end + 1))
+  {
+    ctString folder = end < 0 ? folders : folders.substr(0, end);
+    if (mkdir(folder.c_str(), 0777) != 0 && errno != EEXIST)
+      return false;
+
+    if (end < 0)
+      return true;
+  }
+}
+
+bool ctFileSystem::ReadFolder(const ctFilename &path, const bool findFiles, const bool findFolders, const bool fileSizes, ctVector<FileInfo> *pEntries)
+{
+  ctString folder = path.Path();
+  int fd = open(folder.length() > 0 ? folder.c_str() : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  if (folder.length() > 0 && folder[folder.length() - 1] != '/')
+    folder += "/";
+
+  // getdents64 returns many entries per call, and each one has its type so
+  // a stat() is only needed for file sizes, links and file systems without d_type.
+  alignas(8) char buffer[_direntBufferSize];
+  bool success = true;
+  while (true)
+  {
+    long bytesRead = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+    if (bytesRead == 0)
+      break;
+
+    if (bytesRead < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      success = false;
+      break;
+    }
+
+    for (long offset = 0; offset < bytesRead;)
+    {
+      const _ctDirent64 *pEntry = (const _ctDirent64*)(buffer + offset);
+      offset += pEntry->d_reclen;
+
+      const char *name = pEntry->d_name;
+      if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+        continue;
+
+      FileInfo info;
+      unsigned char type = pEntry->d_type;
+      if (type == DT_UNKNOWN)
+      {
+        struct stat st;
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+          continue;
+        type = S_ISLNK(st.st_mode) ? DT_LNK : S_ISDIR(st.st_mode) ? DT_DIR : DT_REG;
+      }
+
+      info.isLink = type == DT_LNK;
+      info.isFolder = type == DT_DIR;
+      bool needsStat = info.isLink || (fileSizes && findFiles && !info.isFolder);
+      if (!needsStat && !(info.isFolder ? findFolders : findFiles))
+        continue;
+
+      if (needsStat)
+      {
+        // Links take the type and size of their target. Broken links are reported as files.
+        struct stat st;
+        if (fstatat(fd, name, &st, 0) == 0)
+        {
+          info.isFolder = S_ISDIR(st.st_mode);
+          info.size = info.isFolder || !fileSizes ? 0 : (int64_t)st.st_size;
+        }
+
+        if (!(info.isFolder ? findFolders : findFiles))
+          continue;
+      }
+
+      info.path.assign(folder + name);
+      pEntries->push_back(std::move(info));
+    }
+  }
+
+  close(fd);
+  return success;
+}
+
+#endif
@@ -0,0 +1,98 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+
+#include "file/ctFileWatcher.h"
+#include <chrono>
+
+// A path that keeps changing is reported after this many debounce windows
+static const int64_t _maxDelayWindows = 10;
+
+static int64_t _NowMs()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ctFileWatcher::Queue(const ctString &path, const int64_t flags, const bool isFolder)
+{
+  int64_t now = _NowMs();
+  int64_t *pIndex = m_pendingIndex.TryGet(path);
+  if (pIndex != nullptr)
+  {
+    Pending &pending = m_pending[*pIndex];
+    pending.event.flags |= flags;
+    pending.event.isFolder |= isFolder;
+    pending.lastTime = now;
+    return;
+  }
+
+  Pending pending;
+  pending.event.path.assign(path);
+  pending.event.flags = flags;
+  pending.event.isFolder = isFolder;
+  pending.firstTime = now;
+  pending.lastTime = now;
+  m_pendingIndex.Add(path, m_pending.size());
+  m_pending.push_back(std::move(pending));
+}
+
+int64_t ctFileWatcher::Deliver()
+{
+  int64_t now = _NowMs();
+  ctVector<Event> ready;
+  int64_t kept = 0;
+  for (int64_t i = 0; i < m_pending.size(); ++i)
+  {
+    Pending &pending = m_pending[i];
+    if (ctMin(pending.lastTime + m_debounceMs, pending.firstTime + m_debounceMs * _maxDelayWindows) <= now)
+    {
+      ready.push_back(std::move(pending.event));
+    }
+    else
+    {
+      if (kept != i)
+        m_pending[kept] = std::move(pending);
+      ++kept;
+    }
+  }
+
+  if (ready.size() > 0)
+  {
+    m_pending.resize(kept);
+    m_pendingIndex.Clear();
+    for (int64_t i = 0; i < m_pending.size(); ++i)
+      m_pendingIndex.Add(m_pending[i].event.path.Path(), i);
+
+    m_callback(ready);
+    now = _NowMs();
+  }
+
+  int64_t next = -1;
+  for (const Pending &pending : m_pending)
+  {
+    int64_t due = ctMin(pending.lastTime + m_debounceMs, pending.firstTime + m_debounceMs * _maxDelayWindows);
+    next = ctMax(0ll, next < 0 ? due - now : ctMin(next, due - now));
+  }
+  return next;
+}
@@ -0,0 +1,253 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+
+#include "file/ctFileWatcher.h"
+
+#ifdef ctPLATFORM_LINUX
+#include "file/ctFileSystem.h"
+#include "ctThreading.h"
+
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+static const uint32_t _watchMask = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_EXCL_UNLINK;
+
+static const int64_t _eventBufferSize = 64 * 1024;
+
+// inotify only watches a single folder, so recursive watches add one for each subfolder
+// and for folders that are created or moved in while watching.
+class ctFileWatcher::Context
+{
+public:
+  struct Watch
+  {
+    ctString path;
+    ctString root; // The path passed to Watch()
+    bool recursive = false;
+  };
+
+  Context(ctFileWatcher *pWatcher)
+    : pWatcher(pWatcher)
+    , stop(false)
+  {}
+
+  ~Context()
+  {
+    if (thread.joinable())
+    {
+      stop = true;
+      uint64_t wake = 1;
+      write(wakeFd, &wake, sizeof(wake));
+      thread.join();
+    }
+
+    if (wakeFd >= 0) close(wakeFd);
+    if (inotifyFd >= 0) close(inotifyFd);
+  }
+
+  bool Init()
+  {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0)
+      return false;
+
+    thread = std::thread(&Context::Run, this);
+    return true;
+  }
+
+  bool AddRoot(const ctString &path, const bool recursive)
+  {
+    ctScopeLock lock(watchLock);
+    return Add(path, path, recursive, false);
+  }
+
+  bool RemoveRoot(const ctString &path)
+  {
+    ctScopeLock lock(watchLock);
+    ctVector<int64_t> removed;
+    for (const ctKeyValue<int64_t, Watch> &kvp : watches)
+      if (kvp.m_val.root == path)
+        removed.push_back(kvp.m_key);
+
+    for (const int64_t wd : removed)
+    {
+      inotify_rm_watch(inotifyFd, (int)wd);
+      watches.Remove(wd);
+    }
+    return removed.size() > 0;
+  }
+
+protected:
+  // Add a watch for path, and for each folder below it if recursive.
+  // If reportExisting is true the entries found below path are reported as created,
+  // since they may have been added before the watch was.
+  bool Add(const ctString &path, const ctString &root, const bool recursive, const bool reportExisting)
+  {
+    if (!AddWatch(path, root, recursive))
+      return false;
+
+    if (recursive)
+    {
+      ctFileSystem::WalkOptions options;
+      options.files = reportExisting;
+      options.fileSizes = false;
+      ctFileSystem::Walk(path, [&](const ctFileSystem::FileInfo &info) {
+        if (info.isFolder && !info.isLink)
+          AddWatch(info.path.Path(), root, true);
+        if (reportExisting)
+          pWatcher->Queue(info.path.Path(), FWE_Created, info.isFolder);
+        return true;
+      }, options);
+    }
+    return true;
+  }
+
+  bool AddWatch(const ctString &path, const ctString &root, const bool recursive)
+  {
+    int wd = inotify_add_watch(inotifyFd, path.c_str(), _watchMask);
+    if (wd < 0)
+      return false;
+
+    // Watching the same folder twice returns the same descriptor
+    Watch &watch = watches.GetOrAdd(wd);
+    watch.path = path;
+    watch.root = root;
+    watch.recursive = recursive;
+    return true;
+  }
+
+  void Run()
+  {
+    alignas(inotify_event) char buffer[_eventBufferSize];
+    pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+    while (!stop)
+    {
+      int64_t timeout = pWatcher->Deliver();
+      if (poll(fds, 2, (int)timeout) <= 0 || (fds[0].revents & POLLIN) == 0)
+        continue;
+
+      ssize_t size = 0;
+      while ((size = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+      {
+        ctScopeLock lock(watchLock);
+        for (ssize_t offset = 0; offset < size;)
+        {
+          const inotify_event *pEvent = (const inotify_event*)(buffer + offset);
+          offset += sizeof(inotify_event) + pEvent->len;
+          Handle(*pEvent);
+        }
+      }
+    }
+  }
+
+  void Handle(const inotify_event &event)
+  {
+    if (event.mask & IN_Q_OVERFLOW)
+    {
+      pWatcher->Queue("", FWE_Overflow, false);
+      return;
+    }
+
+    Watch *pWatch = watches.TryGet(event.wd);
+    if (pWatch == nullptr)
+      return;
+
+    if (event.mask & IN_IGNORED)
+    {
+      watches.Remove(event.wd);
+      return;
+    }
+
+    int64_t flags = 0;
+    if (event.mask & (IN_CREATE | IN_MOVED_TO))
+      flags |= FWE_Created;
+    if (event.mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+      flags |= FWE_Modified;
+    if (event.mask & (IN_DELETE | IN_MOVED_FROM))
+      flags |= FWE_Deleted;
+
+    // Subfolders are reported through their parent. Only the root needs reporting here.
+    if ((event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && pWatch->path == pWatch->root)
+      flags |= FWE_Deleted;
+
+    if (flags == 0)
+      return;
+
+    bool isFolder = (event.mask & IN_ISDIR) != 0;
+    ctString path = event.len > 0 ? pWatch->path + "/" + event.name : pWatch->path;
+    pWatcher->Queue(path, flags, isFolder);
+
+    if (isFolder && (flags & FWE_Created) && pWatch->recursive)
+    {
+      ctString root = pWatch->root;
+      Add(path, root, true, true);
+    }
+  }
+
+  ctFileWatcher *pWatcher = nullptr;
+  int inotifyFd = -1;
+  int wakeFd = -1;
+  std::atomic<bool> stop;
+  std::thread thread;
+
+  std::mutex watchLock;
+  ctHashMap<int64_t, Watch> watches;
+};
+
+ctFileWatcher::ctFileWatcher(const Callback &callback, const int64_t debounceMs)
+  : m_callback(callback)
+  , m_debounceMs(debounceMs)
+{
+  m_pContext = ctNew(Context)(this);
+  if (!m_pContext->Init())
+  {
+    ctDelete(m_pContext);
+    m_pContext = nullptr;
+  }
+}
+
+ctFileWatcher::~ctFileWatcher()
+{
+  if (m_pContext)
+    ctDelete(m_pContext);
+}
+
+static ctString _WatchPath(const ctFilename &path)
+{
+  ctString watchPath = path.Path();
+  while (watchPath.length() > 1 && watchPath[watchPath.length() - 1] == '/')
+    watchPath = watchPath.substr(0, watchPath.length() - 1);
+  return watchPath;
+}
+
+bool ctFileWatcher::Watch(const ctFilename &path, const bool recursive) { return m_pContext && m_pContext->AddRoot(_WatchPath(path), recursive); }
+bool ctFileWatcher::Unwatch(const ctFilename &path) { return m_pContext && m_pContext->RemoveRoot(_WatchPath(path)); }
+
+#endif
@@ -0,0 +1,323 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+
+#include "file/ctFileWatcher.h"
+
+#ifdef ctPLATFORM_WIN32
+#include "ctThreading.h"
+
+#include <windows.h>
+#include <atomic>
+#include <thread>
+
+static const DWORD _notifyBufferSize = 64 * 1024;
+static const DWORD _notifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES |
+  FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION;
+
+// Each watch has an overlapped ReadDirectoryChangesW outstanding. Reads are issued and
+// cancelled on the watcher thread, since pending I/O belongs to the thread that started it.
+class ctFileWatcher::Context
+{
+public:
+  struct Watch
+  {
+    ctString path;     // The path passed to Watch()
+    ctString folder;   // The folder being read
+    ctString fileName; // Set when a single file is watched
+    bool recursive = false;
+    HANDLE hFolder = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = { 0 };
+    DWORD buffer[_notifyBufferSize / sizeof(DWORD)];
+  };
+
+  Context(ctFileWatcher *pWatcher)
+    : pWatcher(pWatcher)
+    , stop(false)
+  {}
+
+  ~Context()
+  {
+    if (thread.joinable())
+    {
+      stop = true;
+      SetEvent(hWake);
+      thread.join();
+    }
+
+    for (Watch *pWatch : added)
+      Close(pWatch);
+    if (hWake != nullptr)
+      CloseHandle(hWake);
+  }
+
+  bool Init()
+  {
+    hWake = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (hWake == nullptr)
+      return false;
+
+    thread = std::thread(&Context::Run, this);
+    return true;
+  }
+
+  bool AddRoot(const ctFilename &path, const bool recursive)
+  {
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+      return false;
+
+    Watch *pWatch = ctNew(Watch);
+    pWatch->path = path.Path();
+    pWatch->recursive = recursive;
+    if (attributes & FILE_ATTRIBUTE_DIRECTORY)
+    {
+      pWatch->folder = pWatch->path;
+    }
+    else
+    { // Files are watched through their folder
+      pWatch->folder = path.Directory().length() > 0 ? path.Directory() : ".";
+      pWatch->fileName = path.Name();
+    }
+
+    pWatch->hFolder = CreateFileA(pWatch->folder.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+      nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    pWatch->overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    if (pWatch->hFolder == INVALID_HANDLE_VALUE || pWatch->overlapped.hEvent == nullptr)
+    {
+      Close(pWatch);
+      return false;
+    }
+
+    ctScopeLock lock(watchLock);
+    if (watches.size() + added.size() >= MAXIMUM_WAIT_OBJECTS - 1)
+    {
+      Close(pWatch);
+      return false;
+    }
+
+    added.push_back(pWatch);
+    SetEvent(hWake);
+    return true;
+  }
+
+  bool RemoveRoot(const ctString &path)
+  {
+    ctScopeLock lock(watchLock);
+    bool found = false;
+    for (int64_t i = added.size() - 1; i >= 0; --i)
+    {
+      if (added[i]->path == path)
+      {
+        Close(added[i]);
+        added.erase(i);
+        found = true;
+      }
+    }
+
+    for (Watch *pWatch : watches)
+    {
+      if (pWatch->path == path)
+      {
+        removed.push_back(pWatch);
+        found = true;
+      }
+    }
+
+    SetEvent(hWake);
+    return found;
+  }
+
+protected:
+  void Run()
+  {
+    ctVector<HANDLE> handles;
+    while (!stop)
+    {
+      int64_t timeout = pWatcher->Deliver();
+      Update();
+
+      handles.clear();
+      handles.push_back(hWake);
+      for (Watch *pWatch : watches)
+        handles.push_back(pWatch->overlapped.hEvent);
+
+      DWORD result = WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, timeout < 0 ? INFINITE : (DWORD)timeout);
+      if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size())
+        Read(result - WAIT_OBJECT_0 - 1);
+    }
+
+    for (Watch *pWatch : watches)
+      Close(pWatch);
+    watches.clear();
+  }
+
+  // Start reading new watches and stop removed ones
+  void Update()
+  {
+    ctScopeLock lock(watchLock);
+    for (Watch *pWatch : added)
+    {
+      if (Issue(pWatch))
+        watches.push_back(pWatch);
+      else
+        Close(pWatch);
+    }
+    added.clear();
+
+    for (Watch *pWatch : removed)
+    {
+      for (int64_t i = 0; i < watches.size(); ++i)
+      {
+        if (watches[i] == pWatch)
+        {
+          Close(pWatch);
+          watches.erase(i);
+          break;
+        }
+      }
+    }
+    removed.clear();
+  }
+
+  bool Issue(Watch *pWatch)
+  {
+    ResetEvent(pWatch->overlapped.hEvent);
+    return ReadDirectoryChangesW(pWatch->hFolder, pWatch->buffer, sizeof(pWatch->buffer), pWatch->recursive && pWatch->fileName.length() == 0,
+      _notifyFilter, nullptr, &pWatch->overlapped, nullptr) != 0;
+  }
+
+  void Read(const int64_t index)
+  {
+    Watch *pWatch = watches[index];
+    DWORD bytes = 0;
+    if (!GetOverlappedResult(pWatch->hFolder, &pWatch->overlapped, &bytes, FALSE))
+    { // The folder is gone
+      pWatcher->Queue(pWatch->path, FWE_Deleted, pWatch->fileName.length() == 0);
+      Drop(index);
+      return;
+    }
+
+    // No data means the buffer overflowed
+    if (bytes == 0)
+      pWatcher->Queue("", FWE_Overflow, false);
+
+    const uint8_t *pData = (const uint8_t*)pWatch->buffer;
+    for (DWORD offset = 0; bytes > 0;)
+    {
+      const FILE_NOTIFY_INFORMATION *pInfo = (const FILE_NOTIFY_INFORMATION*)(pData + offset);
+      HandleChange(pWatch, *pInfo);
+      if (pInfo->NextEntryOffset == 0)
+        break;
+      offset += pInfo->NextEntryOffset;
+    }
+
+    if (!Issue(pWatch))
+      Drop(index);
+  }
+
+  void Drop(const int64_t index)
+  {
+    ctScopeLock lock(watchLock);
+    for (int64_t i = removed.size() - 1; i >= 0; --i)
+      if (removed[i] == watches[index])
+        removed.erase(i);
+
+    Close(watches[index]);
+    watches.erase(index);
+  }
+
+  void HandleChange(const Watch *pWatch, const FILE_NOTIFY_INFORMATION &info)
+  {
+    char name[MAX_PATH * 4];
+    int length = WideCharToMultiByte(CP_UTF8, 0, info.FileName, (int)(info.FileNameLength / sizeof(WCHAR)), name, sizeof(name), nullptr, nullptr);
+    ctString relative = ctString(name, name + length).replace('\\', '/');
+    if (pWatch->fileName.length() > 0 && relative != pWatch->fileName)
+      return;
+
+    int64_t flags = 0;
+    switch (info.Action)
+    {
+    case FILE_ACTION_ADDED: case FILE_ACTION_RENAMED_NEW_NAME: flags = FWE_Created; break;
+    case FILE_ACTION_REMOVED: case FILE_ACTION_RENAMED_OLD_NAME: flags = FWE_Deleted; break;
+    case FILE_ACTION_MODIFIED: flags = FWE_Modified; break;
+    default: return;
+    }
+
+    ctString path = pWatch->folder + "/" + relative;
+    DWORD attributes = flags == FWE_Deleted ? INVALID_FILE_ATTRIBUTES : GetFileAttributesA(path.c_str());
+    pWatcher->Queue(path, flags, attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0);
+  }
+
+  void Close(Watch *pWatch)
+  {
+    if (pWatch->hFolder != INVALID_HANDLE_VALUE)
+    { // Wait for the cancelled read before the buffer is freed
+      DWORD bytes = 0;
+      if (CancelIo(pWatch->hFolder))
+        GetOverlappedResult(pWatch->hFolder, &pWatch->overlapped, &bytes, TRUE);
+      CloseHandle(pWatch->hFolder);
+    }
+
+    if (pWatch->overlapped.hEvent != nullptr)
+      CloseHandle(pWatch->overlapped.hEvent);
+    ctDelete(pWatch);
+  }
+
+  ctFileWatcher *pWatcher = nullptr;
+  HANDLE hWake = nullptr;
+  std::atomic<bool> stop;
+  std::thread thread;
+
+  // Watches owned by the watcher thread
+  ctVector<Watch*> watches;
+
+  // Changes requested by other threads, applied by the watcher thread
+  std::mutex watchLock;
+  ctVector<Watch*> added;
+  ctVector<Watch*> removed;
+};
+
+ctFileWatcher::ctFileWatcher(const Callback &callback, const int64_t debounceMs)
+  : m_callback(callback)
+  , m_debounceMs(debounceMs)
+{
+  m_pContext = ctNew(Context)(this);
+  if (!m_pContext->Init())
+  {
+    ctDelete(m_pContext);
+    m_pContext = nullptr;
+  }
+}
+
+ctFileWatcher::~ctFileWatcher()
+{
+  if (m_pContext)
+    ctDelete(m_pContext);
+}
+
+bool ctFileWatcher::Watch(const ctFilename &path, const bool recursive) { return m_pContext && m_pContext->AddRoot(path, recursive); }
+bool ctFileWatcher::Unwatch(const ctFilename &path) { return m_pContext && m_pContext->RemoveRoot(path.Path()); }
+
+#endif
@@ -26,17 +26,20 @@
 #include "file/ctFilename.h"
 
 ctFilename::ctFilename(ctFilename &&move)
-  : m_fullpath(move.m_fullpath)
-  , m_directory(move.m_directory)
-  , m_extension(move.m_extension)
-  , m_name(move.m_name)
+  : m_fullpath(std::move(move.m_fullpath))
+  , m_name(std::move(move.m_name))
+  , m_extension(std::move(move.m_extension))
+  , m_directory(std::move(move.m_directory))
+  , m_drive(std::move(move.m_drive))
 {}
 
 void ctFilename::assign(const ctString &path)
 {
   m_fullpath = path;
-  m_fullpath = m_fullpath.replace('\\', '/');
-  m_fullpath = m_fullpath.replace("//", "/");
+  if (m_fullpath.find('\\') >= 0)
+    m_fullpath = m_fullpath.replace('\\', '/');
+  if (m_fullpath.find("//") >= 0)
+    m_fullpath = m_fullpath.replace("//", "/");
 
   const int64_t lastDot = m_fullpath.find_last('.');
   const int64_t lastSlash = m_fullpath.find_last('/');
@@ -0,0 +1,144 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctMappedFile.h"
+
+// Empty files are not mapped. They point here so Data() is still a valid, zero terminated buffer.
+static uint8_t _emptyFile[1] = { 0 };
+
+ctMappedFile::ctMappedFile() {}
+ctMappedFile::ctMappedFile(const ctFilename &path, const Mode mode, const int64_t size) { Open(path, mode, size); }
+ctMappedFile::ctMappedFile(ctMappedFile &&move) { Swap(move); }
+ctMappedFile::~ctMappedFile() { Close(); }
+
+ctMappedFile& ctMappedFile::operator=(ctMappedFile &&rhs)
+{
+  Close();
+  Swap(rhs);
+  return *this;
+}
+
+bool ctMappedFile::Open(const ctFilename &path, const Mode mode, const int64_t size)
+{
+  Close();
+  if (size >= 0 && mode != MM_ReadWrite)
+    return false;
+
+  m_fn = path;
+  m_mode = mode;
+  if (!Map(size))
+  {
+    Close();
+    return false;
+  }
+
+  if (m_pData == nullptr)
+    m_pData = _emptyFile;
+  return true;
+}
+
+void ctMappedFile::Close()
+{
+  Unmap();
+
+  m_pData = nullptr;
+  m_size = 0;
+  m_pos = 0;
+  m_mode = MM_ReadOnly;
+  m_fn = ctFilename();
+  m_pView = nullptr;
+  m_viewSize = 0;
+  m_hFile = nullptr;
+  m_hMapping = nullptr;
+}
+
+bool ctMappedFile::IsOpen() const { return m_pData != nullptr; }
+ctMappedFile::Mode ctMappedFile::GetMode() const { return m_mode; }
+const ctFilename& ctMappedFile::Filename() const { return m_fn; }
+const uint8_t* ctMappedFile::Data() const { return m_pData; }
+uint8_t* ctMappedFile::MutableData() { return m_mode == MM_ReadWrite ? m_pData : nullptr; }
+int64_t ctMappedFile::Size() const { return m_size; }
+
+int64_t ctMappedFile::Read(void *pBuffer, const int64_t size)
+{
+  int64_t count = Peek(pBuffer, size);
+  m_pos += count;
+  return count;
+}
+
+int64_t ctMappedFile::Peek(void *pBuffer, const int64_t size)
+{
+  int64_t count = ctClamp(size, (int64_t)0, m_size - m_pos);
+  if (count > 0)
+    memcpy(pBuffer, m_pData + m_pos, (size_t)count);
+  return count;
+}
+
+const uint8_t* ctMappedFile::ReadView(const int64_t size)
+{
+  const uint8_t *pView = PeekView(size);
+  if (pView)
+    m_pos += size;
+  return pView;
+}
+
+const uint8_t* ctMappedFile::PeekView(const int64_t size) const
+{
+  return m_pData && size >= 0 && size <= m_size - m_pos ? m_pData + m_pos : nullptr;
+}
+
+bool ctMappedFile::Seek(const int64_t loc, const ctSeekOrigin origin)
+{
+  int64_t pos = 0;
+  switch (origin)
+  {
+  case atSO_Current: pos = m_pos + loc; break;
+  case atSO_End: pos = m_size + loc; break;
+  case atSO_Start: pos = loc; break;
+  default: return false;
+  }
+
+  if (pos < 0 || pos > m_size)
+    return false;
+
+  m_pos = pos;
+  return true;
+}
+
+int64_t ctMappedFile::Tell() const { return m_pos; }
+int64_t ctMappedFile::Length() const { return m_size; }
+int64_t ctMappedFile::Available() const { return m_size - m_pos; }
+
+void ctMappedFile::Swap(ctMappedFile &other)
+{
+  std::swap(m_pData, other.m_pData);
+  std::swap(m_size, other.m_size);
+  std::swap(m_pos, other.m_pos);
+  std::swap(m_mode, other.m_mode);
+  std::swap(m_fn, other.m_fn);
+  std::swap(m_pView, other.m_pView);
+  std::swap(m_viewSize, other.m_viewSize);
+  std::swap(m_hFile, other.m_hFile);
+  std::swap(m_hMapping, other.m_hMapping);
+}
@@ -0,0 +1,129 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctMappedFile.h"
+
+#ifdef ctPLATFORM_LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static int64_t _PageSize()
+{
+  static int64_t pageSize = (int64_t)sysconf(_SC_PAGESIZE);
+  return pageSize;
+}
+
+bool ctMappedFile::Map(const int64_t size)
+{
+  int flags = (m_mode == MM_ReadWrite ? O_RDWR : O_RDONLY) | O_CLOEXEC;
+  if (size >= 0)
+    flags |= O_CREAT;
+
+  int fd = open(m_fn.c_str(), flags, 0644);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if ((size >= 0 && ftruncate(fd, (off_t)size) != 0) || fstat(fd, &info) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  if (info.st_size == 0)
+  {
+    close(fd);
+    return true;
+  }
+
+  // Reserve at least one byte past the end of the file so the data is always
+  // followed by zeros, even when the file size is a multiple of the page size.
+  const int64_t fileSize = (int64_t)info.st_size;
+  const int64_t viewSize = (fileSize / _PageSize() + 1) * _PageSize();
+  void *pView = mmap(nullptr, (size_t)viewSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (pView == MAP_FAILED)
+  {
+    close(fd);
+    return false;
+  }
+
+  const int prot = PROT_READ | (m_mode == MM_ReadWrite ? PROT_WRITE : 0);
+  void *pData = mmap(pView, (size_t)fileSize, prot, MAP_SHARED | MAP_FIXED, fd, 0);
+  close(fd);
+  if (pData == MAP_FAILED)
+  {
+    munmap(pView, (size_t)viewSize);
+    return false;
+  }
+
+  m_pView = pView;
+  m_viewSize = viewSize;
+  m_pData = (uint8_t*)pData;
+  m_size = fileSize;
+  return true;
+}
+
+void ctMappedFile::Unmap()
+{
+  if (m_pView != nullptr)
+    munmap(m_pView, (size_t)m_viewSize);
+}
+
+bool ctMappedFile::Advise(const Advice advice, const int64_t offset, const int64_t size)
+{
+  if (!IsOpen() || offset < 0 || offset > m_size)
+    return false;
+  if (m_size == 0)
+    return true;
+
+  int sysAdvice = MADV_NORMAL;
+  switch (advice)
+  {
+  case MA_Normal:     sysAdvice = MADV_NORMAL; break;
+  case MA_Sequential: sysAdvice = MADV_SEQUENTIAL; break;
+  case MA_Random:     sysAdvice = MADV_RANDOM; break;
+  case MA_WillNeed:   sysAdvice = MADV_WILLNEED; break;
+  case MA_DontNeed:   sysAdvice = MADV_DONTNEED; break;
+  default: return false;
+  }
+
+  // madvise() requires a page aligned address
+  const int64_t end = size < 0 ? m_size : ctMin(offset + size, m_size);
+  const int64_t start = offset - offset % _PageSize();
+  return end <= start || madvise(m_pData + start, (size_t)(end - start), sysAdvice) == 0;
+}
+
+bool ctMappedFile::Flush(const bool async)
+{
+  if (!IsOpen())
+    return false;
+  if (m_mode != MM_ReadWrite || m_size == 0)
+    return true;
+
+  return msync(m_pView, (size_t)m_size, async ? MS_ASYNC : MS_SYNC) == 0;
+}
+
+#endif
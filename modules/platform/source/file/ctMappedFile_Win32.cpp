@@ -0,0 +1,138 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "file/ctMappedFile.h"
+
+#ifdef ctPLATFORM_WIN32
+#include <windows.h>
+
+static int64_t _PageSize()
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (int64_t)info.dwPageSize;
+}
+
+bool ctMappedFile::Map(const int64_t size)
+{
+  const bool readWrite = m_mode == MM_ReadWrite;
+  HANDLE hFile = CreateFileA(m_fn.c_str(), GENERIC_READ | (readWrite ? GENERIC_WRITE : 0), FILE_SHARE_READ | FILE_SHARE_WRITE,
+    nullptr, size >= 0 ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  m_hFile = hFile;
+  if (size >= 0)
+  {
+    LARGE_INTEGER end;
+    end.QuadPart = size;
+    if (!SetFilePointerEx(hFile, end, nullptr, FILE_BEGIN) || !SetEndOfFile(hFile))
+      return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(hFile, &fileSize))
+    return false;
+
+  m_size = (int64_t)fileSize.QuadPart;
+  if (m_size == 0)
+    return true;
+
+  // Views are zero filled to the end of the last page. When the file ends exactly on a
+  // page boundary there is no room for the terminator, so read-only files are copied instead.
+  if (!readWrite && m_size % _PageSize() == 0)
+  {
+    m_pView = ctAlloc(m_size + 1);
+    m_pData = (uint8_t*)m_pView;
+    m_pData[m_size] = 0;
+
+    int64_t offset = 0;
+    while (offset < m_size)
+    {
+      DWORD bytesRead = 0;
+      DWORD chunk = (DWORD)ctMin(m_size - offset, (int64_t)(1 << 30));
+      if (!ReadFile(hFile, m_pData + offset, chunk, &bytesRead, nullptr) || bytesRead == 0)
+        return false;
+      offset += bytesRead;
+    }
+    return true;
+  }
+
+  m_hMapping = CreateFileMappingA(hFile, nullptr, readWrite ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+  if (m_hMapping == nullptr)
+    return false;
+
+  m_pView = MapViewOfFile((HANDLE)m_hMapping, readWrite ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+  m_pData = (uint8_t*)m_pView;
+  return m_pView != nullptr;
+}
+
+void ctMappedFile::Unmap()
+{
+  if (m_pView != nullptr)
+  {
+    if (m_hMapping == nullptr)
+      ctFree(m_pView);
+    else
+      UnmapViewOfFile(m_pView);
+  }
+
+  if (m_hMapping != nullptr)
+    CloseHandle((HANDLE)m_hMapping);
+  if (m_hFile != nullptr)
+    CloseHandle((HANDLE)m_hFile);
+}
+
+bool ctMappedFile::Advise(const Advice advice, const int64_t offset, const int64_t size)
+{
+  if (!IsOpen() || offset < 0 || offset > m_size)
+    return false;
+
+#if _WIN32_WINNT >= 0x0602
+  // Windows only exposes prefetching. The other hints are left to the memory manager.
+  if (advice == MA_WillNeed && m_hMapping != nullptr)
+  {
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = m_pData + offset;
+    range.NumberOfBytes = (SIZE_T)(size < 0 ? m_size - offset : ctMin(size, m_size - offset));
+    return range.NumberOfBytes == 0 || PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+  }
+#endif
+
+  return true;
+}
+
+bool ctMappedFile::Flush(const bool async)
+{
+  if (!IsOpen())
+    return false;
+  if (m_mode != MM_ReadWrite || m_size == 0)
+    return true;
+
+  if (!FlushViewOfFile(m_pView, 0))
+    return false;
+  return async || FlushFileBuffers((HANDLE)m_hFile);
+}
+
+#endif
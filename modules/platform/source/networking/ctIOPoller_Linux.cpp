@@ -0,0 +1,198 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "networking/ctIOPoller.h"
+
+#ifdef ctPLATFORM_LINUX
+#include "ctHashMap.h"
+#include "ctThreading.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <thread>
+
+static const int _maxEvents = 64;
+
+class ctIOPoller::Context
+{
+public:
+  struct Waiter
+  {
+    int64_t events = 0;
+    Callback onRead;
+    Callback onWrite;
+  };
+
+  Context()
+  {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    epoll_event ev = { 0 };
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    thread = std::thread(&Context::Run, this);
+  }
+
+  ~Context()
+  {
+    stop = true;
+    uint64_t one = 1;
+    ssize_t res = write(wakeFd, &one, sizeof(one));
+    (void)res;
+    thread.join();
+
+    close(wakeFd);
+    close(epollFd);
+  }
+
+  // Register interest in the pending events of a waiter. The registration is
+  // one-shot, so it is re-armed each time events are delivered.
+  bool Arm(const int fd, const int64_t events, const bool isNew)
+  {
+    epoll_event ev = { 0 };
+    ev.events = EPOLLONESHOT | EPOLLRDHUP;
+    ev.events |= (events & IOE_Read) ? EPOLLIN : 0;
+    ev.events |= (events & IOE_Write) ? EPOLLOUT : 0;
+    ev.data.fd = fd;
+
+    // Fall back to the other operation if the descriptor was closed, or is still
+    // registered from an earlier wait
+    int first = isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    int second = isNew ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    return epoll_ctl(epollFd, first, fd, &ev) == 0 || epoll_ctl(epollFd, second, fd, &ev) == 0;
+  }
+
+  void Run()
+  {
+    epoll_event events[_maxEvents];
+    ctVector<Callback> ready;
+    while (!stop)
+    {
+      int count = epoll_wait(epollFd, events, _maxEvents, -1);
+      if (count < 0)
+        continue; // Interrupted
+
+      {
+        ctScopeLock guard(lock);
+        for (int i = 0; i < count; ++i)
+        {
+          int fd = events[i].data.fd;
+          if (fd == wakeFd)
+          {
+            uint64_t value = 0;
+            ssize_t res = read(wakeFd, &value, sizeof(value));
+            (void)res;
+            continue;
+          }
+
+          Waiter *pWaiter = waiters.TryGet(fd);
+          if (pWaiter == nullptr)
+            continue;
+
+          // Errors and hang ups complete both reads and writes
+          uint32_t fired = events[i].events;
+          bool failed = (fired & (EPOLLERR | EPOLLHUP)) != 0;
+          if ((pWaiter->events & IOE_Read) && (failed || (fired & (EPOLLIN | EPOLLRDHUP))))
+          {
+            ready.push_back(std::move(pWaiter->onRead));
+            pWaiter->events &= ~IOE_Read;
+          }
+
+          if ((pWaiter->events & IOE_Write) && (failed || (fired & EPOLLOUT)))
+          {
+            ready.push_back(std::move(pWaiter->onWrite));
+            pWaiter->events &= ~IOE_Write;
+          }
+
+          if (pWaiter->events != 0)
+          {
+            Arm(fd, pWaiter->events, false);
+          }
+          else
+          {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            waiters.Remove(fd);
+          }
+        }
+      }
+
+      for (Callback &callback : ready)
+        callback();
+      ready.clear();
+    }
+  }
+
+  int epollFd = -1;
+  int wakeFd = -1;
+  std::atomic<bool> stop = { false };
+  std::mutex lock;
+  ctHashMap<int64_t, Waiter> waiters;
+  std::thread thread;
+};
+
+ctIOPoller::ctIOPoller() : m_pContext(ctNew(Context)) {}
+ctIOPoller::~ctIOPoller() { ctDelete(m_pContext); }
+
+ctIOPoller* ctIOPoller::Global()
+{
+  static ctIOPoller poller;
+  return &poller;
+}
+
+bool ctIOPoller::Wait(const atSocketHandle handle, const Event event, Callback callback)
+{
+  if (handle == 0)
+    return false;
+
+  ctScopeLock guard(m_pContext->lock);
+  Context::Waiter *pWaiter = m_pContext->waiters.TryGet(handle);
+  bool isNew = pWaiter == nullptr;
+  if (isNew)
+  {
+    m_pContext->waiters.Add(handle);
+    pWaiter = m_pContext->waiters.TryGet(handle);
+  }
+
+  ctAssert((pWaiter->events & event) == 0, "A wait for this event is already pending on the socket");
+  if (event == IOE_Read)
+    pWaiter->onRead = std::move(callback);
+  else
+    pWaiter->onWrite = std::move(callback);
+
+  pWaiter->events |= event;
+  if (m_pContext->Arm((int)handle, pWaiter->events, isNew))
+    return true;
+
+  // Registration failed. Undo the wait.
+  pWaiter->events &= ~event;
+  if (pWaiter->events == 0)
+    m_pContext->waiters.Remove(handle);
+  return false;
+}
+
+#endif
@@ -0,0 +1,153 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+// -----------------------------------------------------------------------------
+#include "networking/ctIOPoller.h"
+
+#ifdef ctPLATFORM_WIN32
+#include "ctHashMap.h"
+#include "ctThreading.h"
+
+#include <WinSock2.h>
+#include <thread>
+
+// WSAPoll can't be interrupted, so new waits are picked up after this many milliseconds
+static const int _pollInterval = 10;
+
+class ctIOPoller::Context
+{
+public:
+  struct Waiter
+  {
+    int64_t events = 0;
+    Callback onRead;
+    Callback onWrite;
+  };
+
+  Context() { thread = std::thread(&Context::Run, this); }
+
+  ~Context()
+  {
+    stop = true;
+    thread.join();
+  }
+
+  void Run()
+  {
+    ctVector<WSAPOLLFD> fds;
+    ctVector<Callback> ready;
+    while (!stop)
+    {
+      fds.clear();
+      {
+        ctScopeLock guard(lock);
+        for (auto &kvp : waiters)
+        {
+          WSAPOLLFD fd = { 0 };
+          fd.fd = (SOCKET)kvp.m_key;
+          fd.events |= (kvp.m_val.events & IOE_Read) ? POLLRDNORM : 0;
+          fd.events |= (kvp.m_val.events & IOE_Write) ? POLLWRNORM : 0;
+          fds.push_back(fd);
+        }
+      }
+
+      if (fds.size() == 0)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(_pollInterval));
+        continue;
+      }
+
+      if (WSAPoll(fds.data(), (ULONG)fds.size(), _pollInterval) <= 0)
+        continue;
+
+      {
+        ctScopeLock guard(lock);
+        for (const WSAPOLLFD &fd : fds)
+        {
+          Waiter *pWaiter = waiters.TryGet((int64_t)fd.fd);
+          if (pWaiter == nullptr || fd.revents == 0)
+            continue;
+
+          // Errors and hang ups complete both reads and writes
+          bool failed = (fd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+          if ((pWaiter->events & IOE_Read) && (failed || (fd.revents & POLLRDNORM)))
+          {
+            ready.push_back(std::move(pWaiter->onRead));
+            pWaiter->events &= ~IOE_Read;
+          }
+
+          if ((pWaiter->events & IOE_Write) && (failed || (fd.revents & POLLWRNORM)))
+          {
+            ready.push_back(std::move(pWaiter->onWrite));
+            pWaiter->events &= ~IOE_Write;
+          }
+
+          if (pWaiter->events == 0)
+            waiters.Remove((int64_t)fd.fd);
+        }
+      }
+
+      for (Callback &callback : ready)
+        callback();
+      ready.clear();
+    }
+  }
+
+  std::atomic<bool> stop = { false };
+  std::mutex lock;
+  ctHashMap<int64_t, Waiter> waiters;
+  std::thread thread;
+};
+
+ctIOPoller::ctIOPoller() : m_pContext(ctNew(Context)) {}
+ctIOPoller::~ctIOPoller() { ctDelete(m_pContext); }
+
+ctIOPoller* ctIOPoller::Global()
+{
+  static ctIOPoller poller;
+  return &poller;
+}
+
+bool ctIOPoller::Wait(const atSocketHandle handle, const Event event, Callback callback)
+{
+  if (handle == (atSocketHandle)INVALID_SOCKET)
+    return false;
+
+  ctScopeLock guard(m_pContext->lock);
+  Context::Waiter *pWaiter = m_pContext->waiters.TryGet(handle);
+  if (pWaiter == nullptr)
+  {
+    m_pContext->waiters.Add(handle);
+    pWaiter = m_pContext->waiters.TryGet(handle);
+  }
+
+  ctAssert((pWaiter->events & event) == 0, "A wait for this event is already pending on the socket");
+  if (event == IOE_Read)
+    pWaiter->onRead = std::move(callback);
+  else
+    pWaiter->onWrite = std::move(callback);
+  pWaiter->events |= event;
+  return true;
+}
+
+#endif
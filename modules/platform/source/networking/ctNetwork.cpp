@@ -1,7 +1,14 @@
 #include "networking/ctNetwork.h"
+#include "ctMetrics.h"
 
 static const int64_t recvBlockSize = 512;
 
+static ctMetricGauge *_pQueueDepth = ctMetrics::Gauge("ctNetwork.jobQueueDepth");
+static ctMetricCounter *_pBytesSent = ctMetrics::Counter("ctNetwork.bytesSent");
+static ctMetricCounter *_pBytesReceived = ctMetrics::Counter("ctNetwork.bytesReceived");
+static ctMetricCounter *_pJobsFailed = ctMetrics::Counter("ctNetwork.jobsFailed");
+static ctMetricHistogram *_pJobLatency = ctMetrics::Histogram("ctNetwork.jobLatency");
+
 enum _atConnectionJobType
 {
   _atCJT_Send,
@@ -27,6 +34,9 @@ struct ConnectionJob
   bool done = false;
   bool failed = false;
   int64_t refs = 0;
+  int64_t queuedAt = 0;
+
+  ctPromise<void> promise;
 };
 
 bool _DoHostJob(ctNetwork::Connection *pConnection, _atHostData *pData);
@@ -37,6 +47,7 @@ void _DoDisconnectJob(ctNetwork::Connection *pConnection, _atDisconnectData *pDa
 
 ctNetwork::ctNetwork(const bool asyncJobs)
   : m_running(true)
+  , m_pJobThread(nullptr)
 {
   if (asyncJobs)
     m_pJobThread = ctNew(std::thread)(&ctNetwork::ProcessJobs, this);
@@ -199,6 +210,7 @@ void ctNetwork::ProcessJobs()
     DoJob(stat.m_pJob);
     m_jobQueue.erase(0);
     m_jobLock.unlock();
+    _pQueueDepth->Sub();
   }
 }
 
@@ -214,19 +226,30 @@ void ctNetwork::DoJob(ConnectionJob *pJob)
   case _atCJT_Disconnect: _DoDisconnectJob(pJob->pConnection, (_atDisconnectData*)pJob->pJobData); break;
   }
   pJob->done = true;
+
+  if (pJob->failed)
+    pJob->promise.SetFailed();
+  else
+    pJob->promise.SetValue();
+
+  if (pJob->failed)
+    _pJobsFailed->Add();
+  _pJobLatency->Record(ctMetrics::Timestamp() - pJob->queuedAt);
 }
 
 ctNetwork::JobStatus ctNetwork::QueueJob(ConnectionJob *pJob, const ctConnectionHandle &handle)
 {
+  pJob->queuedAt = ctMetrics::Timestamp();
   if (m_pJobThread)
   { // If there is a worker thread then queue the job
     ctScopeLock lock(m_jobLock);
     m_jobQueue.push_back(JobStatus(pJob, handle));
+    _pQueueDepth->Add();
     return m_jobQueue.back();
   }
 
   // If there is no worker thread, do the job now and return the JobStatus
-  JobStatus localStat = m_jobQueue.back();
+  JobStatus localStat(pJob, handle);
   DoJob(localStat.m_pJob);
   return localStat;
 }
@@ -265,6 +288,8 @@ bool _DoConnectJob(ctNetwork::Connection *pConnection, _atConnectData *pData)
 bool _DoSendJob(ctNetwork::Connection *pConnection, _atSendData *pData)
 {
   int64_t sent = pConnection->socket.Write(pData->buffer.data(), pData->buffer.size());
+  if (sent > 0)
+    _pBytesSent->Add(sent);
   return pData->buffer.size() == sent;
 }
 
@@ -278,6 +303,7 @@ void _DoRecieveJob(ctNetwork::Connection *pConnection, _atReceiveData *pData)
     int64_t offset = recv.size();
     recv.resize(recv.size() + bytesRead);
     memcpy(recv.data() + offset, buffer, bytesRead);
+    _pBytesReceived->Add(bytesRead);
   }
 }
 
@@ -308,6 +334,7 @@ ctNetwork::JobStatus::~JobStatus() { Clear(); }
 bool ctNetwork::JobStatus::Done() const { return m_pJob && m_pJob->done; }
 bool ctNetwork::JobStatus::Failed() const { return m_pJob && m_pJob->failed; }
 ctConnectionHandle ctNetwork::JobStatus::Handle() const { return m_handle; }
+ctFuture<void> ctNetwork::JobStatus::Future() const { return m_pJob ? m_pJob->promise.Future() : ctFuture<void>(); }
 
 const ctNetwork::JobStatus& ctNetwork::JobStatus::operator=(const JobStatus &copy)
 {
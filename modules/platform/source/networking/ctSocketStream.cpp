@@ -0,0 +1,165 @@
+
+// -----------------------------------------------------------------------------
+// The MIT License
+// 
+// Copyright(c) 2020 Michael Batchelor, 
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "networking/ctSocketStream.h"
+#include "networking/ctIOPoller.h"
+#include "ctThreading.h"
+#include <condition_variable>
+
+// Block until a non-blocking socket is ready, or has an error
+static bool _WaitReady(const ctSocket *pSocket, const ctIOPoller::Event event)
+{
+  std::mutex lock;
+  std::condition_variable wake;
+  bool ready = false;
+  bool waiting = ctIOPoller::Global()->Wait(pSocket->Handle(), event, [&]() {
+    ctScopeLock guard(lock);
+    ready = true;
+    wake.notify_one();
+  });
+
+  if (!waiting)
+    return false;
+
+  std::unique_lock<std::mutex> guard(lock);
+  wake.wait(guard, [&]() { return ready; });
+  return true;
+}
+
+// Transfer all of the data, waiting whenever the socket would block.
+// A failure straight after the socket was reported ready is treated as an error.
+template<typename TransferFunc> static int64_t _TransferAll(const ctSocket *pSocket, const ctIOPoller::Event event, const int64_t size, TransferFunc transfer)
+{
+  int64_t total = 0;
+  bool waited = false;
+  while (total < size)
+  {
+    int64_t count = transfer(total);
+    if (count > 0)
+    {
+      total += count;
+      waited = false;
+      continue;
+    }
+
+    if (count == 0 || waited || !_WaitReady(pSocket, event))
+      break; // Closed, or a real error
+    waited = true;
+  }
+  return total;
+}
+
+ctSocketStream::ctSocketStream(const ctSocket *pSocket)
+  : m_pSocket(pSocket)
+{}
+
+int64_t ctSocketStream::Read(void *pBuffer, const int64_t size)
+{
+  int64_t total = _TransferAll(m_pSocket, ctIOPoller::IOE_Read, size, [this, pBuffer, size](int64_t done) {
+    return m_pSocket->Read((uint8_t*)pBuffer + done, size - done);
+  });
+
+  m_transferred += total;
+  return total;
+}
+
+int64_t ctSocketStream::ReadV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t read = ctMax(m_pSocket->ReadV(pSlices, count), (int64_t)0);
+  m_transferred += read;
+  return ReadRemaining(pSlices, count, read);
+}
+
+int64_t ctSocketStream::Write(const void *pData, const int64_t len)
+{
+  int64_t total = _TransferAll(m_pSocket, ctIOPoller::IOE_Write, len, [this, pData, len](int64_t done) {
+    return m_pSocket->Write((const uint8_t*)pData + done, len - done);
+  });
+
+  m_transferred += total;
+  return total;
+}
+
+int64_t ctSocketStream::WriteV(const ctIOSlice *pSlices, const int64_t count)
+{
+  int64_t written = ctMax(m_pSocket->WriteV(pSlices, count), (int64_t)0);
+  m_transferred += written;
+  return WriteRemaining(pSlices, count, written);
+}
+
+int64_t ctSocketStream::ReadRemaining(const ctIOSlice *pSlices, const int64_t count, int64_t done)
+{
+  int64_t total = done;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    if (done >= pSlices[i].size)
+    {
+      done -= pSlices[i].size;
+      continue;
+    }
+
+    int64_t size = pSlices[i].size - done;
+    int64_t read = Read((uint8_t*)pSlices[i].pData + done, size);
+    total += read;
+    done = 0;
+    if (read != size)
+      break;
+  }
+  return total;
+}
+
+int64_t ctSocketStream::WriteRemaining(const ctIOSlice *pSlices, const int64_t count, int64_t done)
+{
+  int64_t total = done;
+  for (int64_t i = 0; i < count; ++i)
+  {
+    if (done >= pSlices[i].size)
+    {
+      done -= pSlices[i].size;
+      continue;
+    }
+
+    int64_t size = pSlices[i].size - done;
+    int64_t written = Write((const uint8_t*)pSlices[i].pData + done, size);
+    total += written;
+    done = 0;
+    if (written != size)
+      break;
+  }
+  return total;
+}
+
+bool ctSocketStream::Seek(const int64_t loc, const ctSeekOrigin origin) { return false; }
+int64_t ctSocketStream::Tell() const { return m_transferred; }
+int64_t ctSocketStream::Length() const { return m_transferred; }
+
+int64_t ctSocketStream::Available() const
+{
+  int64_t count = 0;
+  m_pSocket->CanRead(&count);
+  return count;
+}
+
+const ctSocket* ctSocketStream::Socket() const { return m_pSocket; }
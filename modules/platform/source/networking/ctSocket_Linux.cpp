@@ -29,6 +29,8 @@
 #include "ctAssert.h"
 
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <limits.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
 #include <sys/select.h>
@@ -45,7 +47,7 @@ enum atSocketState
   atSS_Timeout = 1 << 3,
 };
 
-int64_t ctSocket::m_nSockets = 0;
+std::atomic<int64_t> ctSocket::m_nSockets(0);
 
 static int64_t _GetBytesAvailable(atSocketHandle handle)
 {
@@ -231,12 +233,29 @@ int64_t ctSocket::Read(uint8_t *pData, const int64_t maxLen) const
 {
   if (!IsValid())
     return 0;
-  int res = recv(Handle(), (char*)pData, (int)maxLen, 0);
-  if (res < 0)
-  {
-    printf("WSA error: %s (%d)\n", strerror(errno), errno);
-  }
-  return res;
+  return recv(Handle(), (char*)pData, (int)maxLen, 0);
+}
+
+int64_t ctSocket::ReadV(const ctIOSlice *pSlices, const int64_t count) const
+{
+  if (!IsValid())
+    return 0;
+
+  msghdr msg = { 0 };
+  msg.msg_iov = (iovec*)pSlices;
+  msg.msg_iovlen = (size_t)ctMin(count, (int64_t)IOV_MAX);
+  return recvmsg((int)Handle(), &msg, 0);
+}
+
+int64_t ctSocket::WriteV(const ctIOSlice *pSlices, const int64_t count) const
+{
+  if (!IsValid())
+    return 0;
+
+  msghdr msg = { 0 };
+  msg.msg_iov = (iovec*)pSlices;
+  msg.msg_iovlen = (size_t)ctMin(count, (int64_t)IOV_MAX);
+  return sendmsg((int)Handle(), &msg, 0);
 }
 
 const ctString& ctSocket::Port() const { return m_port; }
@@ -39,7 +39,7 @@ enum atSocketState
   atSS_Timeout = 1 << 3,
 };
 
-int64_t ctSocket::m_nSockets = 0;
+std::atomic<int64_t> ctSocket::m_nSockets(0);
 
 static void _InitialiseSockets()
 {
@@ -149,8 +149,7 @@ ctSocket::~ctSocket()
   if (m_handle != INVALID_SOCKET)
     _CloseSocket(m_handle);
   m_handle = INVALID_SOCKET;
-  --m_nSockets;
-  if (m_nSockets == 0)
+  if (--m_nSockets == 0)
     _DeInitSockets();
 }
 
@@ -238,12 +237,46 @@ int64_t ctSocket::Read(uint8_t *pData, const int64_t maxLen) const
 {
   if (!IsValid())
     return 0;
-  int res = recv(Handle(), (char*)pData, (int)maxLen, 0);
-  if (res < 0)
+  return recv(Handle(), (char*)pData, (int)maxLen, 0);
+}
+
+static ctVector<WSABUF> _MakeBuffers(const ctIOSlice *pSlices, const int64_t count)
+{
+  ctVector<WSABUF> buffers;
+  buffers.reserve(count);
+  for (int64_t i = 0; i < count; ++i)
   {
-    printf("WSA error %d\n", WSAGetLastError());
+    WSABUF buffer;
+    buffer.buf = (CHAR*)pSlices[i].pData;
+    buffer.len = (ULONG)pSlices[i].size;
+    buffers.push_back(buffer);
   }
-  return res;
+  return buffers;
+}
+
+int64_t ctSocket::ReadV(const ctIOSlice *pSlices, const int64_t count) const
+{
+  if (!IsValid())
+    return 0;
+
+  ctVector<WSABUF> buffers = _MakeBuffers(pSlices, count);
+  DWORD received = 0;
+  DWORD flags = 0;
+  if (WSARecv(Handle(), buffers.data(), (DWORD)buffers.size(), &received, &flags, nullptr, nullptr) != 0)
+    return -1;
+  return received;
+}
+
+int64_t ctSocket::WriteV(const ctIOSlice *pSlices, const int64_t count) const
+{
+  if (!IsValid())
+    return 0;
+
+  ctVector<WSABUF> buffers = _MakeBuffers(pSlices, count);
+  DWORD sent = 0;
+  if (WSASend(Handle(), buffers.data(), (DWORD)buffers.size(), &sent, 0, nullptr, nullptr) != 0)
+    return -1;
+  return sent;
 }
 
 const ctString& ctSocket::Port() const { return m_port; }
@@ -2,6 +2,12 @@ workspace "ctools"
   configurations {"Debug", "Release" }
   startproject "atEngine"
 
+  -- ctTask and the coroutine I/O functions need C++20
+  cppdialect "C++latest"
+  filter { "system:linux" }
+    buildoptions { "-std=c++20" }
+  filter {}
+
 ctools_bin = "../../builds/bin"
 
 win32Build = os.target() == "windows"
@@ -13,3 +13,6 @@ dofile "../modules/platform/project.lua"
 
 dofile "../modules/test/project.lua"
   location "projects/test/"
+
+dofile "../modules/bench/project.lua"
+  location "projects/bench/"